@@ -50,7 +50,27 @@ static struct argp_option options[] = {
 #if MAPREDUCE_DEFAULT_TYPE == 1
                               " [default]"
 #endif
-                              "\n", 1},
+                              , 1},
+    {"pipeline",     4, 0,       0, "Use mapreduce in pipeline mode (tokenizer "
+                              "threads feed counting threads)"
+#if MAPREDUCE_DEFAULT_TYPE == 2
+                              " [default]"
+#endif
+                              , 1},
+    {"shared",      10, 0,       0, "Use mapreduce in parallel mode with a "
+                              "single lock-free dictionary shared by all "
+                              "threads (other dictionaries and --partitions "
+                              "are ignored, --approx is rejected)"
+#if MAPREDUCE_DEFAULT_TYPE == 3
+                              " [default]"
+#endif
+                              , 1},
+    {"steal",        3, 0,       0, "Let idle map threads steal half of the "
+                              "largest remaining range (parallel mode with "
+                              "scattered chunks)\n", 1},
+    {"boundary-index", 5, 0,     0, "Align ranges on word boundaries found by a "
+                              "parallel pre-pass and cached in a sidecar "
+                              "file next to <file>", 1},
 
     {"mmap",    21,  0,  0, "Use filereader with mmap"
 #if MAPREDUCE_FR_DEFAULT_TYPE == 0
@@ -66,7 +86,7 @@ static struct argp_option options[] = {
                                "in read mode [default="
                                STR(MAPREDUCE_FR_DEFAULT_READ_SIZE)"]\n", 2},
 
-    {"iwords",    12,  0,  0, "Use wordstreamer with interleaved words"
+    {"iblocks",   12,  0,  0, "Use wordstreamer with interleaved blocks"
 #if MAPREDUCE_WS_DEFAULT_TYPE == 1
                               " [default]"
 #endif
@@ -76,13 +96,135 @@ static struct argp_option options[] = {
                               " [default]"
 #endif
                               "\n", 3},
+    {"dynamic",   13,  0,  0, "Use wordstreamer with dynamically claimed "
+                              "chunks"
+#if MAPREDUCE_WS_DEFAULT_TYPE == 2
+                              " [default]"
+#endif
+                              , 3},
+
+    {"approx",    19,  0,  0, "Use dictionary estimating the "
+                              STR(MAPREDUCE_DC_APPROX_TOPK)" most frequent "
+                              "words in bounded memory (Count-Min sketch and "
+                              "SpaceSaving, counts are upper bounds)"
+#if MAPREDUCE_DC_DEFAULT_TYPE == 6
+                              " [default]"
+#endif
+                              , 4},
+    {"buckets",   14,  0,  0, "Use dictionary with alphabetically sorted "
+                              "buckets"
+#if MAPREDUCE_DC_DEFAULT_TYPE == 0
+                              " [default]"
+#endif
+                              , 4},
+    {"compact",   18,  0,  0, "Use dictionary with compact entries in an arena "
+                              "(sorted at output)"
+#if MAPREDUCE_DC_DEFAULT_TYPE == 5
+                              " [default]"
+#endif
+                              , 4},
+    {"hash",      15,  0,  0, "Use dictionary with open addressing on full "
+                              "word hashes (sorted at output)"
+#if MAPREDUCE_DC_DEFAULT_TYPE == 1
+                              " [default]"
+#endif
+                              , 4},
+    {"partitions", 17, "P", 0, "Partition dictionaries of threads by word "
+                              "hash, partition r of all threads is merged by "
+                              "reducer r [default="
+                              STR(MAPREDUCE_DEFAULT_PARTITIONS)", max="
+                              STR(MAPREDUCE_MAX_PARTITIONS)"]", 4},
+    {"swiss",     16,  0,  0, "Use dictionary with fingerprints probed by "
+                              "groups with SIMD (sorted at output)"
+#if MAPREDUCE_DC_DEFAULT_TYPE == 2
+                              " [default]"
+#endif
+                              "\n", 4},
+
+    {"ngram",     31, "N",  0, "Count sequences of N words (with --hash unless "
+                              "another dictionary is chosen) [default="
+                              STR(MAPREDUCE_DEFAULT_NGRAM)", max="
+                              STR(MAPREDUCE_MAX_NGRAM)"]", 5},
+    {"stopwords", 30, "FILE", OPTION_ARG_OPTIONAL, "Drop stop words listed "
+                              "in FILE (built-in English list without FILE)",
+                              5},
+    {"csv",       26, "COLUMNS", 0, "Count values of COLUMNS (e.g. 2 or 1,4-5) "
+                              "in comma separated rows", 5},
+    {"tsv",       27, "COLUMNS", 0, "Count values of COLUMNS in tab separated "
+                              "rows\n", 5},
+
+    {"drop",       6, "PATTERN", 0, "Drop tokens matching PATTERN, e.g. '\\d+' "
+                              "for numbers (may be repeated)", 6},
+    {"keep",       7, "PATTERN", 0, "Only count tokens matching PATTERN (may be "
+                              "repeated)", 6},
+    {"max-length", 9, "N",  0, "Drop tokens longer than N characters", 6},
+    {"min-length", 8, "N",  0, "Drop tokens shorter than N characters\n", 6},
+
+    {"sort",     256, "ORDER", 0, "Display words in alpha(betical) order or by "
+                              "decreasing count (ties in alphabetical order) "
+                              "[default=alpha]", 7},
+    {"top",       24, "K",  0, "Only display the K most frequent words, by "
+                              "decreasing count (all words if 0) [default="
+                              STR(MAPREDUCE_DEFAULT_TOP)"]\n", 7},
+
+    {"full-compaction", 29, 0, 0, "Merge all segments of the store into one "
+                              "with --store", 8},
+    {"merge",     25, "FILE", 0, "Add counts of the binary dictionary FILE (or "
+                              "of all segments of the store FILE) to results "
+                              "(may be repeated)", 8},
+    {"save",      20, "FILE", 0, "Write results to FILE as a binary dictionary "
+                              "(sorted keys, counts and hash index) instead of "
+                              "displaying them", 8},
+    {"store",     28, "DIR", 0, "Add results to the store DIR as a new delta "
+                              "segment instead of displaying them (full levels "
+                              "of segments are compacted)", 8},
     { 0 }
 };
 
+/* Parse a list of columns such as 1,4-5 (columns start at 1) */
+static int parse_columns (const char *list, uint64_t *columns) {
+    *columns = 0;
+
+    while (*list) {
+        char *end;
+        long first = strtol(list, &end, 10), last = first;
+
+        if (end == list) return 1;
+        if (*end == '-') {
+            list = end + 1;
+            last = strtol(list, &end, 10);
+            if (end == list) return 1;
+        }
+
+        if (first < 1 || last < first || last > MAPREDUCE_MAX_COLUMNS) return 1;
+
+        for (; first<=last; first++) *columns |= 1ULL << (first - 1);
+
+        if (*end == ',') end++;
+        else if (*end) return 1;
+        list = end;
+    }
+
+    return !*columns;
+}
+
+/* Copy a token filter pattern */
+static int add_pattern (char **patterns, unsigned int *nb_patterns,
+                                                           const char *arg) {
+    if (*nb_patterns == MAPREDUCE_FILTER_MAX_PATTERNS) return 1;
+
+    patterns[*nb_patterns] = malloc(strlen(arg)+1);
+    assert(patterns[*nb_patterns] != NULL);
+    strcpy(patterns[(*nb_patterns)++], arg);
+
+    return 0;
+}
+
 /* Parse a single option */
 static error_t parse_opt (int key, char *arg, struct argp_state *state) {
     Arguments *args = state->input;
-    unsigned int read_buffer_size;
+    unsigned int read_buffer_size, ngram, partitions;
+    int top, length;
 
     switch (key) {
         case 1:
@@ -91,11 +233,78 @@ static error_t parse_opt (int key, char *arg, struct argp_state *state) {
         case 2:
             args->type = MR_SEQUENTIAL;
             break;
+        case 3:
+            args->steal = true;
+            break;
+        case 4:
+            args->type = MR_PIPELINE;
+            break;
+        case 5:
+            args->boundaries = true;
+            break;
+        case 6:
+        case 7:
+            if ((key == 6) ? add_pattern(args->drops, &args->nb_drops, arg)
+                           : add_pattern(args->keeps, &args->nb_keeps, arg)) {
+                argp_error(state, "too many patterns (max="
+                                  STR(MAPREDUCE_FILTER_MAX_PATTERNS)")");
+            }
+            break;
+        case 8:
+        case 9:
+            length = atoi(arg);
+            if (length < 1 || length > MAPREDUCE_MAX_WORD_SIZE) {
+                argp_error(state, "invalid length '%s' (min=1, max=%d)", arg,
+                                                     MAPREDUCE_MAX_WORD_SIZE);
+            }
+            if (key == 8) {
+                args->min_length = length;
+            } else {
+                args->max_length = length;
+            }
+            break;
+        case 10:
+            args->type = MR_SHARED;
+            break;
         case 11:
             args->wstreamer_type = WS_SCHUNKS;
             break;
         case 12:
-            args->wstreamer_type = WS_IWORDS;
+            args->wstreamer_type = WS_IBLOCKS;
+            break;
+        case 13:
+            args->wstreamer_type = WS_DYNAMIC;
+            break;
+        case 14:
+            args->dictionary_type = DC_BUCKETS;
+            args->dictionary_set = true;
+            break;
+        case 15:
+            args->dictionary_type = DC_HASH;
+            args->dictionary_set = true;
+            break;
+        case 16:
+            args->dictionary_type = DC_SWISS;
+            args->dictionary_set = true;
+            break;
+        case 17:
+            partitions = atoi(arg);
+            if (partitions >= 1 && partitions <= MAPREDUCE_MAX_PARTITIONS) {
+                args->partitions = partitions;
+            }
+            break;
+        case 18:
+            args->dictionary_type = DC_COMPACT;
+            args->dictionary_set = true;
+            break;
+        case 19:
+            args->dictionary_type = DC_APPROX;
+            args->dictionary_set = true;
+            break;
+        case 20:
+            args->save_path = malloc(strlen(arg)+1);
+            assert(args->save_path != NULL);
+            strcpy(args->save_path, arg);
             break;
         case 21:
             args->freader_type = FR_MMAP;
@@ -107,6 +316,56 @@ static error_t parse_opt (int key, char *arg, struct argp_state *state) {
             read_buffer_size = atoi(arg);
             if (read_buffer_size) args->read_buffer_size = read_buffer_size;
             break;
+        case 24:
+            top = atoi(arg);
+            if (top >= 0) args->top = top;
+            break;
+        case 25:
+            if (args->nb_merges == MAPREDUCE_MAX_SEGMENTS) {
+                argp_error(state, "too many binary dictionaries (max="
+                                  STR(MAPREDUCE_MAX_SEGMENTS)")");
+            }
+            args->merges[args->nb_merges] = malloc(strlen(arg)+1);
+            assert(args->merges[args->nb_merges] != NULL);
+            strcpy(args->merges[args->nb_merges++], arg);
+            break;
+        case 26:
+        case 27:
+            args->delimiter = (key == 26) ? ',' : '\t';
+            if (parse_columns(arg, &args->columns)) {
+                argp_error(state, "invalid list of columns '%s'", arg);
+            }
+            break;
+        case 28:
+            args->store_path = malloc(strlen(arg)+1);
+            assert(args->store_path != NULL);
+            strcpy(args->store_path, arg);
+            break;
+        case 29:
+            args->full_compaction = true;
+            break;
+        case 31:
+            ngram = atoi(arg);
+            if (ngram >= 1 && ngram <= MAPREDUCE_MAX_NGRAM) args->ngram = ngram;
+            break;
+        case 30:
+            args->stopwords = true;
+            if (arg != NULL) {
+                args->stopwords_path = malloc(strlen(arg)+1);
+                assert(args->stopwords_path != NULL);
+                strcpy(args->stopwords_path, arg);
+            }
+            break;
+        case 256:
+            if (!strcmp(arg, "alpha")) {
+                args->order = SO_ALPHA;
+            } else if (!strcmp(arg, "count")) {
+                args->order = SO_COUNT;
+            } else {
+                argp_error(state, "invalid sort order '%s' (alpha or count)",
+                                                                         arg);
+            }
+            break;
         case 'p':
             args->profiling = true;
           	break;
@@ -126,6 +385,24 @@ static error_t parse_opt (int key, char *arg, struct argp_state *state) {
         	if (state->arg_num != 2) {
                 argp_usage (state);
             }
+
+            /* N-grams share the prefixes of frequent words, which would pile
+               them up in the same buckets */
+            if (args->ngram > 1 && !args->dictionary_set) {
+                args->dictionary_type = MAPREDUCE_DC_NGRAM_TYPE;
+            }
+
+            /* The shared dictionary is always exact, approximate counting
+               would be silently lost */
+            if (args->type == MR_SHARED && args->dictionary_type == DC_APPROX) {
+                argp_error(state, "--approx cannot be used with --shared");
+            }
+
+            /* The filter would drop every token */
+            if (args->min_length > args->max_length) {
+                argp_error(state, "--min-length cannot be greater than "
+                                  "--max-length");
+            }
         	break;
         default:
         	return ARGP_ERR_UNKNOWN;
@@ -172,6 +449,17 @@ void _check_arguments(Arguments *args) {
     if (access (file_path, R_OK)) {
         mr_error(ERR_FILEACCESS);
     }
+
+    /* Check stop words file access in read mode */
+    if (args->stopwords_path != NULL && access(args->stopwords_path, R_OK)) {
+        mr_error(ERR_FILEACCESS);
+    }
+
+    /* Check binary dictionaries access in read mode */
+    unsigned int i;
+    for (i=0; i<args->nb_merges; i++) {
+        if (access(args->merges[i], R_OK)) mr_error(ERR_FILEACCESS);
+    }
 }
 
 
@@ -191,14 +479,34 @@ Arguments* mr_args_create(int argc, char **argv) {
     /* Initialize options with default values */
     args->quiet              =   MAPREDUCE_DEFAULT_QUIET;
     args->profiling          =   MAPREDUCE_DEFAULT_PROFILING;
+    args->steal              =   MAPREDUCE_DEFAULT_STEAL;
+    args->boundaries         =   MAPREDUCE_DEFAULT_BOUNDARIES;
+    args->ngram              =   MAPREDUCE_DEFAULT_NGRAM;
+    args->partitions         =   MAPREDUCE_DEFAULT_PARTITIONS;
+    args->top                =   MAPREDUCE_DEFAULT_TOP;
+    args->order              =   MAPREDUCE_DEFAULT_ORDER;
+    args->stopwords          =   MAPREDUCE_DEFAULT_STOPWORDS;
+    args->full_compaction    =   MAPREDUCE_DEFAULT_FULL_COMPACTION;
     args->freader_type       =   MAPREDUCE_FR_DEFAULT_TYPE;
     args->read_buffer_size   =   MAPREDUCE_FR_DEFAULT_READ_SIZE;
     args->wstreamer_type     =   MAPREDUCE_WS_DEFAULT_TYPE;
+    args->dictionary_type    =   MAPREDUCE_DC_DEFAULT_TYPE;
+    args->dictionary_set     =   false;
     args->type               =   MAPREDUCE_DEFAULT_TYPE;
 
     /* Initialize oother variables */
     args->file_path        =   NULL;
     args->nb_threads       =   1;
+    args->stopwords_path   =   NULL;
+    args->columns          =   0;
+    args->delimiter        =   ',';
+    args->nb_drops         =   0;
+    args->nb_keeps         =   0;
+    args->min_length       =   MAPREDUCE_DEFAULT_MIN_LENGTH;
+    args->max_length       =   MAPREDUCE_DEFAULT_MAX_LENGTH;
+    args->save_path        =   NULL;
+    args->store_path       =   NULL;
+    args->nb_merges        =   0;
 
     return args;
 }
@@ -214,7 +522,15 @@ void mr_args_delete(Arguments** args_ptr) {
     Arguments* args = *args_ptr;
 
     if (args != NULL) {
+        unsigned int i;
+
         if (args->file_path != NULL) free(args->file_path);
+        if (args->stopwords_path != NULL) free(args->stopwords_path);
+        for (i=0; i<args->nb_drops; i++) free(args->drops[i]);
+        for (i=0; i<args->nb_keeps; i++) free(args->keeps[i]);
+        for (i=0; i<args->nb_merges; i++) free(args->merges[i]);
+        if (args->save_path != NULL) free(args->save_path);
+        if (args->store_path != NULL) free(args->store_path);
         free(args);
     }
 
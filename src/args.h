@@ -26,8 +26,31 @@
         unsigned int read_buffer_size; /**<  Size in bytes of the read buffer */
         bool         profiling;        /**<  Profiling mode                   */
         bool         quiet;            /**<  Display every details            */
+        bool         steal;            /**<  Steal work between map threads   */
+        bool         boundaries;       /**<  Use an index of word boundaries  */
+        unsigned int ngram;            /**<  Words per counted key (n-grams)  */
+        unsigned int partitions;       /**<  Dictionary partitions (shuffle)  */
+        unsigned int top;              /**<  Words displayed (0: all)         */
+        so_type      order;            /**<  Sort order (see common.h)        */
+        bool         stopwords;        /**<  Drop stop words                  */
+        char*        stopwords_path;   /**<  Stop words file (NULL: built-in) */
+        uint64_t     columns;          /**<  Columns to count (record mode)   */
+        char         delimiter;        /**<  Field delimiter (record mode)    */
+        char*        drops[MAPREDUCE_FILTER_MAX_PATTERNS]; /**< Drop patterns */
+        unsigned int nb_drops;         /**<  Number of drop patterns          */
+        char*        keeps[MAPREDUCE_FILTER_MAX_PATTERNS]; /**< Keep patterns */
+        unsigned int nb_keeps;         /**<  Number of keep patterns          */
+        unsigned int min_length;       /**<  Drop shorter tokens              */
+        unsigned int max_length;       /**<  Drop longer tokens               */
+        char*        save_path;        /**<  Binary dictionary to write       */
+        char*        store_path;       /**<  Store to add a delta to          */
+        bool         full_compaction;  /**<  Merge all segments of the store  */
+        char*        merges[MAPREDUCE_MAX_SEGMENTS]; /**< Binary dict. to add */
+        unsigned int nb_merges;        /**<  Number of binary dict. to add    */
         fr_type      freader_type;     /**<  Type of filereader (see common.h)*/
         ws_type      wstreamer_type;   /**<  Type of wordstreamer (common.h)  */
+        dc_type      dictionary_type;  /**<  Type of dictionary (common.h)    */
+        bool         dictionary_set;   /**<  Dictionary chosen with an option */
         mr_type      type;             /**<  Type of mapreduce (see common.h) */
     } Arguments;
 
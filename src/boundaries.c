@@ -0,0 +1,598 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file boundaries.c
+ * @brief Index of word (or CSV row) boundaries computed in parallel and cached
+ *        in a sidecar file next to the indexed file.
+ * @author Jean-Yves VET
+ */
+
+#include "boundaries.h"
+#include "records.h"
+#include "tools.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Get an index of a file. The index is loaded from the sidecar file when it is
+ * still valid, otherwise it is computed and saved.
+ *
+ * @param   file_path[in]   String containing the path to the file
+ * @param   nb_threads[in]  Number of threads for the pre-pass
+ * @param   rows[in]        Index starts of CSV rows instead of words
+ * @param   profiling[in]   Activate the profiling mode
+ * @return  Pointer to the new Boundaries structure
+ */
+static Boundaries* _mr_boundaries_get(const char *file_path,
+      const unsigned int nb_threads, const bool rows, const bool profiling) {
+    assert(file_path != NULL);
+
+    Boundaries *b = _mr_boundaries_load(file_path, rows);
+
+    if (b == NULL) {
+        if (rows) {
+            b = _mr_boundaries_build_rows(file_path,
+                               MAPREDUCE_BOUNDARIES_GRANULARITY, nb_threads);
+        } else {
+            b = _mr_boundaries_build(file_path,
+                               MAPREDUCE_BOUNDARIES_GRANULARITY, nb_threads);
+        }
+
+        /* The index is only a cache, so failing to save it is harmless */
+        _mr_boundaries_save(b, file_path);
+    }
+
+    /* Display index details [Profiling mode] */
+    if (profiling) {
+        #if MAPREDUCE_DEFAULT_USECOLORS
+            printf("\e[34m |-[Boundaries] %s index:\e[1m %lld entries (%s)"
+                   "\e[0m\n", rows ? "row" : "word", b->nb_offsets,
+                   b->loaded ? "loaded" : "built");
+        #else
+            printf(" |-[Boundaries] %s index: %lld entries (%s)\n",
+                   rows ? "row" : "word", b->nb_offsets,
+                   b->loaded ? "loaded" : "built");
+        #endif
+    }
+
+    return b;
+}
+
+
+/**
+ * Get the index of word boundaries of a file.
+ *
+ * @param   file_path[in]   String containing the path to the file
+ * @param   nb_threads[in]  Number of threads for the pre-pass
+ * @param   profiling[in]   Activate the profiling mode
+ * @return  Pointer to the new Boundaries structure
+ */
+Boundaries* mr_boundaries_create(const char *file_path,
+                         const unsigned int nb_threads, const bool profiling) {
+    return _mr_boundaries_get(file_path, nb_threads, false, profiling);
+}
+
+
+/**
+ * Get the index of CSV row starts of a file (record mode).
+ *
+ * @param   file_path[in]   String containing the path to the file
+ * @param   nb_threads[in]  Number of threads for the pre-pass
+ * @param   profiling[in]   Activate the profiling mode
+ * @return  Pointer to the new Boundaries structure
+ */
+Boundaries* mr_boundaries_create_rows(const char *file_path,
+                         const unsigned int nb_threads, const bool profiling) {
+    return _mr_boundaries_get(file_path, nb_threads, true, profiling);
+}
+
+
+/**
+ * Delete a Boundaries structure and set pointer to NULL.
+ *
+ * @param   b_ptr[inout]   Pointer to pointer of a Boundaries structure
+ */
+void mr_boundaries_delete(Boundaries **b_ptr) {
+    assert(b_ptr != NULL);
+    Boundaries *b = *b_ptr;
+
+    if (b != NULL) {
+        free(b->offsets);
+        free(b);
+    }
+
+    *b_ptr = NULL;
+}
+
+
+/* ============================ Private functions =========================== */
+
+/**
+ * Build the path of the sidecar file.
+ *
+ * @param   file_path[in]   String containing the path to the indexed file
+ * @param   rows[in]        Index of rows
+ * @return  String to free once used
+ */
+static char* _mr_boundaries_path(const char *file_path, const bool rows) {
+    const char *suffix = rows ? MAPREDUCE_RECORDS_SUFFIX
+                              : MAPREDUCE_BOUNDARIES_SUFFIX;
+    char *path = malloc(strlen(file_path) + strlen(suffix) + 1);
+    assert(path != NULL);
+
+    strcpy(path, file_path);
+    strcat(path, suffix);
+
+    return path;
+}
+
+
+/**
+ * Fill the header of the sidecar file with the key of a file.
+ *
+ * @param   file_path[in]   String containing the path to the indexed file
+ * @param   rows[in]        Index of rows
+ * @param   header[out]     Header to fill
+ * @return  0 on success or 1 if the file cannot be accessed
+ */
+static int _mr_boundaries_key(const char *file_path, const bool rows,
+                                                   Boundaries_header *header) {
+    struct stat st;
+
+    if (stat(file_path, &st) != 0) return 1;
+
+    memset(header, 0, sizeof(Boundaries_header));
+    memcpy(header->magic, rows ? MAPREDUCE_RECORDS_MAGIC
+                               : MAPREDUCE_BOUNDARIES_MAGIC, sizeof(header->magic));
+    header->inode = st.st_ino;
+    header->size = st.st_size;
+    header->mtime_sec = st.st_mtim.tv_sec;
+    header->mtime_nsec = st.st_mtim.tv_nsec;
+
+    return 0;
+}
+
+
+/**
+ * Find the first delimiter at or after an offset.
+ *
+ * @param   fd[in]          File descriptor of the indexed file
+ * @param   offset[in]      Offset where to start the search
+ * @param   file_size[in]   File size in Bytes
+ * @return  Offset of the delimiter or the file size if there is none
+ */
+static long long _mr_boundaries_find(int fd, long long offset,
+                                                   const long long file_size) {
+    char buffer[MAPREDUCE_BOUNDARIES_SCAN_SIZE];
+
+    while (offset < file_size) {
+        int i;
+        ssize_t size = pread(fd, buffer, sizeof(buffer), offset);
+        assert(size > 0);
+
+        for (i=0; i<size; i++) {
+            if (ispunct(buffer[i]) || isspace(buffer[i])) return offset + i;
+        }
+
+        offset += size;
+    }
+
+    return file_size;
+}
+
+
+/**
+ * Thread function which computes a contiguous part of the index.
+ *
+ * @param   t_struct[inout]     Pointer to a struct dedicated to the thread
+ */
+static void* _thread_boundaries(void *t_struct) {
+    Boundaries_thread *t = (Boundaries_thread *) t_struct;
+    Boundaries *b = t->boundaries;
+    long long k;
+
+    for (k=t->first; k<=t->last; k++) {
+        long long offset = k * b->granularity;
+
+        /* Boundaries are non decreasing, so reuse the previous one when it is
+           already past the nominal offset (long words) */
+        if (k == 0) {
+            b->offsets[k] = 0;
+        } else if (k > t->first && b->offsets[k-1] >= offset) {
+            b->offsets[k] = b->offsets[k-1];
+        } else {
+            b->offsets[k] = _mr_boundaries_find(t->fd, offset, b->file_size);
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Count the quotes of a part of the file with masks of 64 bytes.
+ *
+ * @param   fd[in]          File descriptor of the indexed file
+ * @param   offset[in]      First byte of the part
+ * @param   size[in]        Bytes in the part
+ * @return  Number of quotes
+ */
+static long long _mr_boundaries_count_quotes(int fd, long long offset,
+                                                              long long size) {
+    char buffer[MAPREDUCE_BOUNDARIES_SCAN_SIZE + 64];
+    long long count = 0;
+
+    while (size > 0) {
+        int i;
+        ssize_t read_size = pread(fd, buffer, (size < sizeof(buffer) - 64)
+                                     ? size : sizeof(buffer) - 64, offset);
+        assert(read_size > 0);
+
+        /* Pad the last block */
+        memset(buffer + read_size, 0, 64);
+
+        for (i=0; i<read_size; i+=64) {
+            count += __builtin_popcountll(mr_records_mask(buffer + i,
+                                                           MR_RECORDS_QUOTE));
+        }
+
+        offset += read_size;
+        size -= read_size;
+    }
+
+    return count;
+}
+
+
+/**
+ * Find the first newline outside quotes at or after an offset.
+ *
+ * @param   fd[in]          File descriptor of the indexed file
+ * @param   offset[in]      Offset where to start the search
+ * @param   quoted[in]      The offset is inside quotes
+ * @param   file_size[in]   File size in Bytes
+ * @return  Offset of the byte following the newline or the file size if
+ *          there is none
+ */
+static long long _mr_boundaries_find_row(int fd, long long offset,
+                                  const bool quoted, const long long file_size) {
+    char buffer[MAPREDUCE_BOUNDARIES_SCAN_SIZE + 64];
+    uint64_t carry = quoted ? ~0ULL : 0;
+
+    while (offset < file_size) {
+        int i;
+        ssize_t size = pread(fd, buffer, MAPREDUCE_BOUNDARIES_SCAN_SIZE, offset);
+        assert(size > 0);
+
+        /* Pad the last block */
+        memset(buffer + size, 0, 64);
+
+        for (i=0; i<size; i+=64) {
+            uint64_t inside = mr_records_prefix_xor(
+                     mr_records_mask(buffer + i, MR_RECORDS_QUOTE)) ^ carry;
+            uint64_t newlines = mr_records_mask(buffer + i, MR_RECORDS_NEWLINE)
+                                                                     & ~inside;
+
+            if (size - i < 64) newlines &= (1ULL << (size - i)) - 1;
+            if (newlines) return offset + i + __builtin_ctzll(newlines) + 1;
+
+            carry = (uint64_t) ((int64_t) inside >> 63);
+        }
+
+        offset += size;
+    }
+
+    return file_size;
+}
+
+
+/**
+ * Thread function which computes whether entries are inside quotes (first
+ * pass of an index of rows). Entry k+1 first receives the parity of the
+ * quotes found between entries k and k+1.
+ *
+ * @param   t_struct[inout]     Pointer to a struct dedicated to the thread
+ */
+static void* _thread_rows_parity(void *t_struct) {
+    Boundaries_thread *t = (Boundaries_thread *) t_struct;
+    Boundaries *b = t->boundaries;
+    long long k;
+
+    for (k=t->first; k<=t->last; k++) {
+        long long offset = k * b->granularity;
+        long long size = b->granularity;
+
+        if (offset + size > b->file_size) size = b->file_size - offset;
+
+        t->quoted[k+1] = _mr_boundaries_count_quotes(t->fd, offset, size) & 1;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Thread function which computes a contiguous part of an index of rows
+ * (second pass).
+ *
+ * @param   t_struct[inout]     Pointer to a struct dedicated to the thread
+ */
+static void* _thread_rows(void *t_struct) {
+    Boundaries_thread *t = (Boundaries_thread *) t_struct;
+    Boundaries *b = t->boundaries;
+    long long k;
+
+    for (k=t->first; k<=t->last; k++) {
+        long long offset = k * b->granularity;
+
+        /* Reuse the previous entry when its row started after this one */
+        if (k == 0) {
+            b->offsets[k] = 0;
+        } else if (k > t->first && b->offsets[k-1] > offset) {
+            b->offsets[k] = b->offsets[k-1];
+        } else {
+            b->offsets[k] = _mr_boundaries_find_row(t->fd, offset,
+                                                   t->quoted[k], b->file_size);
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Allocate an index of a file.
+ *
+ * @param   file_path[in]    String containing the path to the file
+ * @param   granularity[in]  Bytes between nominal entries
+ * @param   rows[in]         Index of rows
+ * @return  Pointer to the new Boundaries structure
+ */
+static Boundaries* _mr_boundaries_alloc(const char *file_path,
+                               const long long granularity, const bool rows) {
+    assert(granularity > 0);
+
+    Boundaries *b = malloc(sizeof(Boundaries));
+    assert(b != NULL);
+
+    b->file_size = mr_tools_fsize(file_path);
+    b->granularity = granularity;
+    b->nb_offsets = b->file_size / granularity + 1;
+    b->loaded = false;
+    b->rows = rows;
+    b->offsets = malloc(b->nb_offsets*sizeof(long long));
+    assert(b->offsets != NULL);
+
+    return b;
+}
+
+
+/**
+ * Split the entries of an index between threads and run a thread function.
+ *
+ * @param   b[inout]         Pointer to the Boundaries structure
+ * @param   fd[in]           File descriptor of the indexed file
+ * @param   nb_threads[in]   Number of threads
+ * @param   quoted[inout]    Entries inside quotes (or NULL)
+ * @param   func[in]         Thread function
+ */
+static void _mr_boundaries_run(Boundaries *b, int fd,
+          const unsigned int nb_threads, bool *quoted, void* (*func)(void*)) {
+    int i;
+    unsigned int nb = nb_threads;
+    if (nb > b->nb_offsets) nb = b->nb_offsets;
+    Boundaries_thread threads[nb];
+
+    for(i=0; i<nb; i++) {
+        threads[i].boundaries = b;
+        threads[i].fd = fd;
+        threads[i].quoted = quoted;
+        threads[i].first = b->nb_offsets * i / nb;
+        threads[i].last = b->nb_offsets * (i+1) / nb - 1;
+        pthread_create(&threads[i].thread, NULL, func, &threads[i]);
+    }
+
+    for(i=0; i<nb; i++) {
+        pthread_join(threads[i].thread, NULL);
+    }
+}
+
+
+/**
+ * Check that the offsets of a loaded index are consistent, so that a stale or
+ * corrupted sidecar never gives ranges outside of the file or overlapping.
+ *
+ * @param   b[in]            Pointer to the Boundaries structure
+ * @return  true if the index is valid
+ */
+static bool _mr_boundaries_check(const Boundaries *b) {
+    long long k;
+
+    if (b->offsets[0] != 0) return false;
+
+    /* Entries never come before their nominal offset nor after the end */
+    for (k=1; k<b->nb_offsets; k++) {
+        if (b->offsets[k] < b->offsets[k-1] || b->offsets[k] < k*b->granularity
+            || b->offsets[k] > b->file_size) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * Compute the index of word boundaries with several threads.
+ *
+ * @param   file_path[in]    String containing the path to the file
+ * @param   granularity[in]  Bytes between nominal entries
+ * @param   nb_threads[in]   Number of threads
+ * @return  Pointer to the new Boundaries structure
+ */
+Boundaries* _mr_boundaries_build(const char *file_path,
+                  const long long granularity, const unsigned int nb_threads) {
+    assert(nb_threads > 0);
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) mr_error(ERR_FILEACCESS);
+
+    Boundaries *b = _mr_boundaries_alloc(file_path, granularity, false);
+    _mr_boundaries_run(b, fd, nb_threads, NULL, _thread_boundaries);
+
+    close(fd);
+
+    return b;
+}
+
+
+/**
+ * Compute the index of CSV rows with several threads. A first pass counts
+ * quotes between entries, so that the second pass knows whether each entry
+ * is inside a quoted field and may look for the next row independently.
+ *
+ * @param   file_path[in]    String containing the path to the file
+ * @param   granularity[in]  Bytes between nominal entries
+ * @param   nb_threads[in]   Number of threads
+ * @return  Pointer to the new Boundaries structure
+ */
+Boundaries* _mr_boundaries_build_rows(const char *file_path,
+                  const long long granularity, const unsigned int nb_threads) {
+    long long k;
+    assert(nb_threads > 0);
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) mr_error(ERR_FILEACCESS);
+
+    Boundaries *b = _mr_boundaries_alloc(file_path, granularity, true);
+    bool *quoted = malloc((b->nb_offsets+1)*sizeof(bool));
+    assert(quoted != NULL);
+
+    /* Parity of quotes between entries, then prefix xor */
+    _mr_boundaries_run(b, fd, nb_threads, quoted, _thread_rows_parity);
+
+    quoted[0] = false;
+    for (k=1; k<b->nb_offsets; k++) quoted[k] ^= quoted[k-1];
+
+    _mr_boundaries_run(b, fd, nb_threads, quoted, _thread_rows);
+
+    free(quoted);
+    close(fd);
+
+    return b;
+}
+
+
+/**
+ * Load the index from the sidecar file if it matches the indexed file.
+ *
+ * @param   file_path[in]   String containing the path to the indexed file
+ * @param   rows[in]        Index of rows
+ * @return  Pointer to the new Boundaries structure or NULL if there is no
+ *          valid index
+ */
+Boundaries* _mr_boundaries_load(const char *file_path, const bool rows) {
+    Boundaries_header key, header;
+    Boundaries *b = NULL;
+
+    if (_mr_boundaries_key(file_path, rows, &key)) return NULL;
+
+    char *path = _mr_boundaries_path(file_path, rows);
+    FILE *fp = fopen(path, "rb");
+    free(path);
+
+    if (fp == NULL) return NULL;
+
+    if (fread(&header, sizeof(header), 1, fp) == 1
+        && !memcmp(header.magic, key.magic, sizeof(header.magic))
+        && header.inode == key.inode
+        && header.size == key.size
+        && header.mtime_sec == key.mtime_sec
+        && header.mtime_nsec == key.mtime_nsec
+        && header.granularity > 0
+        && header.nb_offsets == header.size / header.granularity + 1) {
+
+        b = malloc(sizeof(Boundaries));
+        assert(b != NULL);
+
+        b->file_size = header.size;
+        b->granularity = header.granularity;
+        b->nb_offsets = header.nb_offsets;
+        b->loaded = true;
+        b->rows = rows;
+        b->offsets = malloc(b->nb_offsets*sizeof(long long));
+        assert(b->offsets != NULL);
+
+        /* Truncated or corrupted sidecar, the index is rebuilt */
+        if (fread(b->offsets, sizeof(long long), b->nb_offsets, fp)
+                                                             != b->nb_offsets
+            || !_mr_boundaries_check(b)) {
+            mr_boundaries_delete(&b);
+        }
+    }
+
+    fclose(fp);
+
+    return b;
+}
+
+
+/**
+ * Save the index in the sidecar file. The file is written under a temporary
+ * name and renamed so that concurrent jobs never read a partial index.
+ *
+ * @param   b[in]           Pointer to the Boundaries structure
+ * @param   file_path[in]   String containing the path to the indexed file
+ * @return  0 on success or 1 if the index could not be saved
+ */
+int _mr_boundaries_save(const Boundaries *b, const char *file_path) {
+    Boundaries_header header;
+    int ret = 1;
+
+    if (_mr_boundaries_key(file_path, b->rows, &header)) return 1;
+    if (header.size != b->file_size) return 1;
+
+    header.granularity = b->granularity;
+    header.nb_offsets = b->nb_offsets;
+
+    char *path = _mr_boundaries_path(file_path, b->rows);
+    char *tmp_path = malloc(strlen(path) + 5);
+    assert(tmp_path != NULL);
+    strcpy(tmp_path, path);
+    strcat(tmp_path, ".tmp");
+
+    FILE *fp = fopen(tmp_path, "wb");
+
+    if (fp != NULL) {
+        if (fwrite(&header, sizeof(header), 1, fp) == 1
+            && fwrite(b->offsets, sizeof(long long), b->nb_offsets, fp)
+                                                            == b->nb_offsets) {
+            ret = 0;
+        }
+
+        if (fclose(fp)) ret = 1;
+
+        if (!ret && rename(tmp_path, path)) ret = 1;
+        if (ret) remove(tmp_path);
+    }
+
+    free(tmp_path);
+    free(path);
+
+    return ret;
+}
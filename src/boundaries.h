@@ -0,0 +1,105 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_BOUNDARIES_H
+    #define HEADER_MAPREDUCE_BOUNDARIES_H
+
+    #include <pthread.h>
+    #include "common.h"
+
+    /**
+     * @struct boundaries_s
+     * @brief  Index of word boundaries in a file. Entry k holds the offset of
+     *         the first delimiter found at or after k*granularity (or the file
+     *         size if there is none), so that any range starting and stopping
+     *         on these offsets never splits a word. In an index of rows, entry
+     *         k holds the start of the first CSV row after k*granularity, so
+     *         that ranges never split a row (quoted newlines included).
+     */
+    typedef struct boundaries_s {
+        long long*     offsets;        /**<  Offsets of boundaries            */
+        long long      nb_offsets;     /**<  Number of entries                */
+        long long      granularity;    /**<  Bytes between nominal entries    */
+        long long      file_size;      /**<  File size in Bytes               */
+        bool           loaded;         /**<  Index was read from the sidecar  */
+        bool           rows;           /**<  Entries are starts of CSV rows   */
+    } Boundaries;
+
+
+    /**
+     * @struct boundaries_header_s
+     * @brief  Header of the sidecar file. The index is only reused when the
+     *         inode, size and modification time of the file did not change.
+     */
+    typedef struct boundaries_header_s {
+        char           magic[8];       /**<  Magic of the kind of index       */
+        uint64_t       inode;          /**<  Inode of the indexed file        */
+        uint64_t       size;           /**<  Size of the indexed file         */
+        uint64_t       mtime_sec;      /**<  Modification time (seconds)      */
+        uint64_t       mtime_nsec;     /**<  Modification time (nanoseconds)  */
+        uint64_t       granularity;    /**<  Bytes between nominal entries    */
+        uint64_t       nb_offsets;     /**<  Number of entries                */
+    } Boundaries_header;
+
+
+    /**
+     * @struct boundaries_thread_s
+     * @brief  Structure containing data for a thread of the pre-pass.
+     */
+    typedef struct boundaries_thread_s {
+        pthread_t      thread;         /**<  PThread handler                  */
+        Boundaries*    boundaries;     /**<  Index to fill                    */
+        int            fd;             /**<  File descriptor                  */
+        long long      first;          /**<  First entry to compute           */
+        long long      last;           /**<  Last entry to compute            */
+        bool*          quoted;         /**<  Entries inside quotes (rows)     */
+    } Boundaries_thread;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Move an offset to the next word boundary of the index. Any split point
+     * moved with this function on both sides of a split gives consistent
+     * ranges. Static inline definition to improve calling performance.
+     *
+     * @param   b[in]          Pointer to the Boundaries structure
+     * @param   offset[in]     Offset to move
+     * @return  Offset of a boundary (or the file size)
+     */
+    static inline long long mr_boundaries_snap(const Boundaries *b,
+                                                            long long offset) {
+        if (offset <= 0) return 0;
+
+        long long k = (offset + b->granularity - 1) / b->granularity;
+        if (k >= b->nb_offsets) return b->file_size;
+
+        return b->offsets[k];
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Boundaries*  mr_boundaries_create(const char*, const unsigned int,
+                                                                    const bool);
+    Boundaries*  mr_boundaries_create_rows(const char*, const unsigned int,
+                                                                    const bool);
+    void         mr_boundaries_delete(Boundaries**);
+
+    Boundaries*  _mr_boundaries_build(const char*, const long long,
+                                                            const unsigned int);
+    Boundaries*  _mr_boundaries_build_rows(const char*, const long long,
+                                                            const unsigned int);
+    Boundaries*  _mr_boundaries_load(const char*, const bool);
+    int          _mr_boundaries_save(const Boundaries*, const char*);
+#endif
@@ -116,7 +116,6 @@ void* mr_buffalloc_malloc(Buffalloc *ba, size_t size) {
     void *area = NULL;
     assert(ba != NULL);
     size_t chunk_size = ba->chunk_size;
-    assert(chunk_size >= size);
 
     /* Try to find available area in allocated chunks */
     Buffalloc_chunk *chunk = ba->last_chunk;
@@ -131,7 +130,8 @@ void* mr_buffalloc_malloc(Buffalloc *ba, size_t size) {
         chunk = chunk->next;
     }
 
-    /* We need to create a new chunk */
+    /* We need to create a new chunk (large areas get their own chunk) */
+    if (size > chunk_size) chunk_size = size;
     chunk = _mr_buffalloc_chunk_create(chunk_size);
     area = _mr_buffalloc_chunk_malloc(chunk, size);
 
@@ -22,16 +22,36 @@
 
     typedef enum {
         WS_SCHUNKS,         /* Wordstreamer type: scattered chunks   */
-        WS_IWORDS,          /* Wordstreamer type: interleaved words  */
+        WS_IBLOCKS,         /* Wordstreamer type: interleaved blocks */
+        WS_DYNAMIC,         /* Wordstreamer type: dynamic chunks     */
         WS_NB               /* Number of Wordstreamer types          */
     } ws_type;
 
+    typedef enum {
+        DC_BUCKETS,         /* Dictionary type: sorted buckets      */
+        DC_HASH,            /* Dictionary type: open addressing     */
+        DC_SWISS,           /* Dictionary type: SIMD probed groups  */
+        DC_SHARED,          /* Dictionary type: lock-free shared    */
+        DC_PARTITIONED,     /* Dictionary type: partitioned by hash */
+        DC_COMPACT,         /* Dictionary type: arena of entries    */
+        DC_APPROX,          /* Dictionary type: sketch of top words */
+        DC_NB               /* Number of Dictionary types           */
+    } dc_type;
+
     typedef enum {
         MR_PARALLEL,         /* Mapreduce type: parallel (pthreads)   */
         MR_SEQUENTIAL,       /* Mapreduce type: sequential            */
+        MR_PIPELINE,         /* Mapreduce type: tokenizers + counters */
+        MR_SHARED,           /* Mapreduce type: one shared dictionary */
         MR_NB                /* Number of Mapreduce types             */
     } mr_type;
 
+    typedef enum {
+        SO_ALPHA,            /* Sort order: alphabetical              */
+        SO_COUNT,            /* Sort order: count descending          */
+        SO_NB                /* Number of sort orders                 */
+    } so_type;
+
     #include <stdint.h>
     #include <stdio.h>
     #include <stdlib.h>
@@ -44,4 +64,5 @@
     #include "config.h"
     #include "error.h"
     #include "timer.h"
+    #include "stats.h"
 #endif
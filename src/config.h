@@ -19,11 +19,70 @@
     #define MAPREDUCE_DEFAULT_TYPE            MR_PARALLEL
     #define MAPREDUCE_FR_DEFAULT_TYPE         FR_MMAP
     #define MAPREDUCE_FR_DEFAULT_READ_SIZE    16384
+    #define MAPREDUCE_FR_MAX_BLOCK_SIZE       (1<<30)
     #define MAPREDUCE_WS_DEFAULT_TYPE         WS_SCHUNKS
     #define MAPREDUCE_WS_DEFAULT_CHUNK_SIZE   16
+    #define MAPREDUCE_WS_DYNAMIC_CHUNK_SIZE   2097152
+    #define MAPREDUCE_WS_SCHUNKS_BLOCK_SIZE   262144
+    #define MAPREDUCE_WS_IBLOCKS_BLOCK_SIZE   65536
+    #define MAPREDUCE_DC_DEFAULT_TYPE         DC_BUCKETS
+    #define MAPREDUCE_DC_NGRAM_TYPE           DC_HASH
+    #define MAPREDUCE_DC_HASH_INITIAL_SIZE    1024
+    #define MAPREDUCE_DC_HASH_MAX_LOAD        70
+    #define MAPREDUCE_DC_SWISS_INITIAL_SIZE   1024
+    #define MAPREDUCE_DC_SWISS_MAX_LOAD       87
+    #define MAPREDUCE_DC_SHARED_INITIAL_SIZE  65536
+    #define MAPREDUCE_DC_SHARED_MAX_LOAD      70
+    #define MAPREDUCE_DC_SHARED_GROWTH        4
+    #define MAPREDUCE_DC_SHARED_CACHE_SIZE    1024
+    #define MAPREDUCE_DC_COMPACT_INITIAL_SIZE 1024
+    #define MAPREDUCE_DC_COMPACT_MAX_LOAD     70
+    #define MAPREDUCE_DC_COMPACT_ARENA_SIZE   65536
+    #define MAPREDUCE_DC_APPROX_WIDTH         65536
+    #define MAPREDUCE_DC_APPROX_DEPTH         4
+    #define MAPREDUCE_DC_APPROX_TOPK          1024
+    #define MAPREDUCE_DC_APPROX_MAX_LENGTH    127
+    #define MAPREDUCE_DC_PARTITIONS           8
     #define MAPREDUCE_DEFAULT_USECOLORS       1
     #define MAPREDUCE_DEFAULT_QUIET           0
     #define MAPREDUCE_DEFAULT_PROFILING       0
+    #define MAPREDUCE_DEFAULT_STEAL           0
+    #define MAPREDUCE_DEFAULT_BOUNDARIES      0
+    #define MAPREDUCE_DEFAULT_NGRAM           1
+    #define MAPREDUCE_MAX_NGRAM               8
+    #define MAPREDUCE_DEFAULT_PARTITIONS      1
+    #define MAPREDUCE_DEFAULT_TOP             0
+    #define MAPREDUCE_DEFAULT_ORDER           SO_ALPHA
+    #define MAPREDUCE_OUTPUT_INSERTION_SIZE   32
+    #define MAPREDUCE_OUTPUT_PARALLEL_SIZE    65536
+    #define MAPREDUCE_MAX_PARTITIONS          64
+    #define MAPREDUCE_DEFAULT_STOPWORDS       0
+    #define MAPREDUCE_STOPWORDS_BUCKET_SIZE   2
+    #define MAPREDUCE_STOPWORDS_MAX_DISPLACEMENT  (1<<24)
+    #define MAPREDUCE_DEFAULT_MIN_LENGTH      1
+    #define MAPREDUCE_DEFAULT_MAX_LENGTH      MAPREDUCE_MAX_WORD_SIZE
+    #define MAPREDUCE_FILTER_MAX_STATES       4096
+    #define MAPREDUCE_FILTER_MAX_PATTERNS     64
+    #define MAPREDUCE_BOUNDARIES_GRANULARITY  65536
+    #define MAPREDUCE_BOUNDARIES_SCAN_SIZE    4096
+    #define MAPREDUCE_BOUNDARIES_SUFFIX       ".mrbi"
+    #define MAPREDUCE_BOUNDARIES_MAGIC        "MRBIDX1"
+    #define MAPREDUCE_RECORDS_SUFFIX          ".mrri"
+    #define MAPREDUCE_RECORDS_MAGIC           "MRRIDX1"
+    #define MAPREDUCE_SEGMENT_MAGIC           "MRDSEG2"
+    #define MAPREDUCE_SEGMENT_MAX_LOAD        70
+    #define MAPREDUCE_SEGMENT_INDEX           1
+    #define MAPREDUCE_MAX_SEGMENTS            64
+    #define MAPREDUCE_STORE_SUFFIX            ".mrds"
+    #define MAPREDUCE_STORE_FANOUT            4
+    #define MAPREDUCE_DEFAULT_FULL_COMPACTION 0
+    #define MAPREDUCE_MAX_COLUMNS             64
+    #define MAPREDUCE_STATS_MAX_LENGTH        16
+    #define MAPREDUCE_PIPELINE_MAX_PRODUCERS  2
+    #define MAPREDUCE_PIPELINE_THREADS_PER_PRODUCER 4
+    #define MAPREDUCE_PIPELINE_RING_SIZE      8
+    #define MAPREDUCE_PIPELINE_BATCHES        32
+    #define MAPREDUCE_PIPELINE_BATCH_SIZE     65536
     #define MAPREDUCE_MIN_THREADS             1
     #define MAPREDUCE_MAX_THREADS             64
     #define MAPREDUCE_USE_BUFFALLOC           1
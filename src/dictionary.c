@@ -13,45 +13,94 @@
 
 /**
  * @file dictionary.c
- * @brief A dictionary (hash table containing words where they are
- *        alphabetically sorted).
+ * @brief Dictionary interface to test several hash table implementations.
  * @author Jean-Yves VET
  */
 
 #include "dictionary.h"
+#include "dictionary_buckets.h"
+#include "dictionary_hash.h"
+#include "dictionary_swiss.h"
+#include "dictionary_shared.h"
+#include "dictionary_partitioned.h"
+#include "dictionary_compact.h"
+#include "dictionary_approx.h"
 
 /* ========================= Constructor / Destructor ======================= */
 
 /**
- * Create a Dictionary based on a Hashtable.
+ * Create a Dictionary.
  *
+ * @param   type[in]       Type of Dictionary (see common.h)
  * @param   profiling[in]  Activate the profiling mode
  * @return  Pointer to the new Dictionary structure
  */
-Dictionary *mr_dictionary_create(bool profiling) {
-    int i;
-    Dictionary *dico = malloc(sizeof(Dictionary));
-    assert(dico != NULL);
+Dictionary *mr_dictionary_create(const dc_type type, const bool profiling) {
+    Dictionary *dico;
 
-    /* Initialize variables for profiling */
-    dico->profiling = profiling;
-    _timer_init(&dico->timer_put, dico->profiling);
+    switch(type) {
+        default:
+        case DC_BUCKETS :
+            dico = mr_dictionary_buckets_create(profiling);
+            break;
+        case DC_HASH :
+            dico = mr_dictionary_hash_create(profiling);
+            break;
+        case DC_SWISS :
+            dico = mr_dictionary_swiss_create(profiling);
+            break;
+        case DC_SHARED :
+            dico = mr_dictionary_shared_create(profiling);
+            break;
+        case DC_PARTITIONED :
+            /* Partitions are hash tables (words are sorted at output) */
+            dico = mr_dictionary_partitioned_create(
+                           mr_dictionary_hash_create(profiling),
+                                                   MAPREDUCE_DC_PARTITIONS);
+            break;
+        case DC_COMPACT :
+            dico = mr_dictionary_compact_create(profiling);
+            break;
+        case DC_APPROX :
+            dico = mr_dictionary_approx_create(profiling);
+            break;
+    }
 
-    dico->hash_size = HASH_SIZE;
+    return dico;
+}
 
-    dico->hash_tab = malloc(dico->hash_size*sizeof(Bucket));
-    assert(dico->hash_tab != NULL);
 
-    /* Set to null first Word pointers in all buckets */
-    for (i=0; i<dico->hash_size; i++){
-        Bucket *b = &dico->hash_tab[i];
-        b->word = NULL;
-        #if MAPREDUCE_USE_BUFFALLOC
-            b->buffalloc = NULL;
-        #endif
+/**
+ * Constructor for the dictionaries of other threads. They are independent
+ * from the first one, except for shared dictionaries which give another
+ * handle on the same words.
+ *
+ * @param   first[in]   Pointer to the first Dictionary structure
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary* mr_dictionary_create_another(const Dictionary *first) {
+    return first->create_another(first);
+}
+
+
+/**
+ * Spread the words of an empty dictionary among partitions by hash, so
+ * that dictionaries of several threads may be merged partition by partition
+ * (see mr_parallel_merge). Shared, partitioned and approximate dictionaries
+ * are kept as they are.
+ *
+ * @param   dico[in]           Pointer to an empty Dictionary structure
+ * @param   nb_partitions[in]  Number of partitions (no partition if <= 1)
+ * @return  Pointer to the Dictionary to use instead
+ */
+Dictionary* mr_dictionary_partition(Dictionary *dico,
+                                            const unsigned int nb_partitions) {
+    if (nb_partitions <= 1 || dico->shared || dico->type == DC_PARTITIONED
+                                           || dico->type == DC_APPROX) {
+        return dico;
     }
 
-    return dico;
+    return mr_dictionary_partitioned_create(dico, nb_partitions);
 }
 
 
@@ -62,35 +111,14 @@ Dictionary *mr_dictionary_create(bool profiling) {
  * @param   ptr_dico[int]   Pointer to pointer of Dictionary structure
  */
 void mr_dictionary_delete(Dictionary **ptr_dico) {
-    int i;
     assert(ptr_dico != NULL);
     Dictionary *dico = *ptr_dico;
 
-    /* Display time info if requiered [Profiling mode] */
-    _timer_print(&dico->timer_put, "[Dictionary] put");
-
     if (dico != NULL) {
-        unsigned int hash_size = dico->hash_size;
-
-        /* Delete all words */
-        for (i=0; i<hash_size; i++){
-            Bucket *bucket = &dico->hash_tab[i];
-
-            #if MAPREDUCE_USE_BUFFALLOC
-                mr_buffalloc_delete(&bucket->buffalloc);
-            #else
-                Word *word = bucket->word;
-                while(word != NULL) {
-                    Word *word_ptr = word;
-                    word = word->next;
-                    mr_word_delete(&word_ptr);
-                }
-            #endif
-        }
+        /* Display time info if requiered [Profiling mode] */
+        _timer_print(&dico->timer_put, "[Dictionary] put");
 
-        /* Delete dictionary structure */
-        free(dico->hash_tab);
-        free(dico);
+        dico->delete(dico);
     }
 
     *ptr_dico = NULL;
@@ -100,160 +128,143 @@ void mr_dictionary_delete(Dictionary **ptr_dico) {
 /* ============================= Private functions ========================== */
 
 /**
- * Compute hash for a given word (hash based on the first 2 characters).
+ * Compare two words in alphabetical order (for qsort).
  *
- * @param   dico[in]   Pointer to a Dictionary structure
- * @param   word[in]   String containing the word
- * @return  hash code
+ * @param   a[in]   Pointer to a pointer of the first Word structure
+ * @param   b[in]   Pointer to a pointer of the second Word structure
+ * @return  Negative, zero or positive value as for strcmp
  */
-unsigned int _mr_dictionary_hash(Dictionary *dico, const char *word) {
-    unsigned int word_length = strlen(word);
-    unsigned int hash;
-
-    hash = (unsigned char)word[0] * HASH_CHAR_SIZE;
-    if (word_length > 1) hash += (unsigned char)word[1];
+static int _mr_dictionary_compare_words(const void *a, const void *b) {
+    const Word *first = *(Word * const *)a;
 
-    return hash;
+    return _mr_dictionary_compare(first->name, first->length,
+                                                         *(Word * const *)b);
 }
 
 
+/* ============================= Public functions =========================== */
+
 /**
- * Look for a given word in the dictionary and return a pointer to the Word
- * structure if found.
+ * Merge two dictionaries.
  *
- * @param   dico[in]   Pointer to a Dictionary structure
- * @param   word[in]   String containing the word
- * @return  Pointer to the Word structure or NULL if not found
+ * @param   first[inout]  Pointer to the first dictionary (outcome stored here)
+ * @param   second[in]    Pointer to the second dictionary
  */
-Word *_mr_dictionary_lookup_word(Dictionary *dico, const char *word) {
-    unsigned int hash = _mr_dictionary_hash(dico, word);
+void mr_dictionary_merge(Dictionary* first, Dictionary* second) {
+    int i;
+    mr_dictionary_flush(second);
+
+    /* Implementations merging their own way (e.g. sketches added together) */
+    if (first->merge != NULL && first->type == second->type) {
+        first->merge(first, second);
+        return;
+    }
+
+    unsigned int nb_words = second->nb_words;
+    Word **words = malloc((nb_words+1)*sizeof(Word*));
+    assert(words != NULL);
 
-    Bucket *bucket = &dico->hash_tab[hash];
-    Word *dico_word = bucket->word;
+    second->list(second, words);
 
-    while(dico_word != NULL && strcmp(word, dico_word->name)) {
-        dico_word = dico_word->next;
+    for (i=0; i<nb_words; i++){
+        Word *word = words[i];
+        first->add(first, word->name, word->length, word->hash, word->count);
     }
 
-    return dico_word;
+    free(words);
+    mr_dictionary_flush(first);
 }
 
 
 /**
- * Convert a character in a word to a number for comparison.
+ * Make counts final once threads stopped putting words in a shared
+ * dictionary (nothing to do for other dictionaries).
  *
- * @param   word[in]     String containing the word
- * @param   length[in]   Characters in the word
- * @param   pos[in]      Position of the character to convert to integer
- * @return  Integer (positive value of the char or -1 if out of range)
+ * @param   dico[inout]   Pointer to the dictionary
  */
-static inline int _mr_dictionary_char_value(const char *word,
-                                        unsigned int length, unsigned int pos) {
-    if (pos < length) {
-        return (int)((unsigned char) word[pos]);
-    } else {
-        return -1;
-    }
+void mr_dictionary_flush(Dictionary *dico) {
+    if (dico->flush != NULL) dico->flush(dico);
 }
 
 
 /**
- * Add number of occurrences to a Word structure in a Dictionary. Add the word
- * if it does not exist.
+ * Put new occurrence in the dictionary.
  *
- * @param   dico[inout]   Pointer to a Dictionary structure
+ * @param   dico[inout]   Pointer to the dictionary
  * @param   word[in]      String containing the word
- * @param   count[in]     Occurrences to add
  */
-void _mr_dictionary_add_word_count(Dictionary *dico, const char *word,
-                                                                    int count) {
-    unsigned int word_length = strlen(word), pos = HASH_CHARS_USED,
-                 hash = _mr_dictionary_hash(dico, word);
-    Bucket *bucket = &dico->hash_tab[hash];
-    Word **ptr = &bucket->word;
-    Word *dico_word = bucket->word;
-
-    while (pos < MAPREDUCE_MAX_WORD_SIZE) {
-        /* Empty bucket */
-        if (dico_word == NULL) {
-            #if MAPREDUCE_USE_BUFFALLOC
-                if(bucket->buffalloc == NULL) {
-                    bucket->buffalloc = mr_buffalloc_create();
-                }
-                *ptr = mr_word_create_buff(word, bucket->buffalloc);
-            #else
-                *ptr = mr_word_create(word);
-            #endif
-            (*ptr)->count = count;
-            break;
-        }
+void mr_dictionary_put_word(Dictionary *dico, const char *word) {
+    unsigned int length = strlen(word);
 
-        char *dest_word = dico_word->name;
-        int src = _mr_dictionary_char_value(word, word_length, pos);
-        int dest = _mr_dictionary_char_value(dest_word, dico_word->length, pos);
-
-        if (src < dest) {
-            #if MAPREDUCE_USE_BUFFALLOC
-                if(bucket->buffalloc == NULL) {
-                    bucket->buffalloc = mr_buffalloc_create();
-                }
-                Word *new_word = mr_word_create_buff(word, bucket->buffalloc);
-            #else
-                Word *new_word = mr_word_create(word);
-            #endif
-            new_word->count = count;
-            *ptr = new_word;
-            new_word->next = dico_word;
-            break;
-        } else if (src > dest) {
-            ptr = &dico_word->next;
-            dico_word = dico_word->next;
-            pos = HASH_CHARS_USED;
-        } else {
-            if (!strcmp(word, dest_word)) {
-                dico_word->count += count;
-                break;
-            } else {
-                pos++;
-            }
-        }
-    }
+    _timer_start(&dico->timer_put);
+    dico->add(dico, word, length, mr_word_hash_key(word, length), 1);
+    _timer_stop(&dico->timer_put);
 }
 
 
-/* ============================= Public functions =========================== */
-
 /**
- * Merge two dictionaries.
+ * Put new occurrence of a word which length and hash are already known (as
+ * computed by wordstreamers while retrieving the word).
  *
- * @param   first[inout]  Pointer to the first dictionary (outcome stored here)
- * @param   second[in]    Pointer to the second dictionary
+ * @param   dico[inout]   Pointer to the dictionary
+ * @param   word[in]      String containing the word
+ * @param   length[in]    Characters in the word
+ * @param   hash[in]      Hash of the word (see mr_word_hash)
  */
-void mr_dictionary_merge(Dictionary* first, Dictionary* second) {
-    int i;
-    assert(second->hash_size == first->hash_size);
-    unsigned int hash_size = second->hash_size;
-
-    for (i=0; i<hash_size; i++){
-        Bucket *bucket = &second->hash_tab[i];
-        Word *word = bucket->word;
-        while(word != NULL) {
-            _mr_dictionary_add_word_count(first, word->name, word->count);
-            word = word->next;
-        }
-    }
+void mr_dictionary_put_word_hashed(Dictionary *dico, const char *word,
+                                       unsigned int length, uint64_t hash) {
+    _timer_start(&dico->timer_put);
+    dico->add(dico, word, length, hash, 1);
+    _timer_stop(&dico->timer_put);
 }
 
 
 /**
- * Put new occurrence in the dictionary.
+ * Put new occurrence of a key made of several words (n-gram). The key is only
+ * built with spaces between words when it is not yet in the dictionary.
  *
  * @param   dico[inout]   Pointer to the dictionary
- * @param   word[in]      String containing the word
+ * @param   parts[in]     Words of the key
+ * @param   lengths[in]   Characters in each word of the key
+ * @param   nb_parts[in]  Number of words in the key
+ * @param   hash[in]      Hash of the key (see mr_word_hash_combine)
  */
-void mr_dictionary_put_word(Dictionary *dico, const char *word) {
+void mr_dictionary_put_parts(Dictionary *dico, const char **parts,
+                 const unsigned int *lengths, unsigned int nb_parts,
+                                                             uint64_t hash) {
+    int i;
+    unsigned int length = nb_parts - 1;
+    assert(nb_parts > 0);
+
     _timer_start(&dico->timer_put);
-    _mr_dictionary_add_word_count(dico, word, 1);
+
+    for (i=0; i<nb_parts; i++) length += lengths[i];
+
+    /* Estimated counts shall see all occurrences through add */
+    unsigned int *count = dico->approx ? NULL : dico->find(dico, parts,
+                                           lengths, nb_parts, length, hash);
+
+    if (count != NULL) {
+        if (dico->shared) {
+            __atomic_fetch_add(count, 1, __ATOMIC_RELAXED);
+        } else {
+            (*count)++;
+        }
+    } else {
+        /* New key */
+        char key[length+1];
+        char *ptr = key;
+
+        for (i=0; i<nb_parts; i++) {
+            if (i) *ptr++ = ' ';
+            memcpy(ptr, parts[i], lengths[i]);
+            ptr += lengths[i];
+        }
+        *ptr = '\0';
+
+        dico->add(dico, key, length, hash, 1);
+    }
+
     _timer_stop(&dico->timer_put);
 }
 
@@ -266,29 +277,33 @@ void mr_dictionary_put_word(Dictionary *dico, const char *word) {
  * @return  Count (0 if word not found)
  */
 unsigned int mr_dictionary_count_word(Dictionary *dico, const char *str) {
-    Word *word = _mr_dictionary_lookup_word(dico, str);
-    unsigned int count = (word != NULL) ? word->count : 0;
+    unsigned int length = strlen(str);
+    mr_dictionary_flush(dico);
+    unsigned int *count = dico->find(dico, &str, &length, 1, length,
+                                               mr_word_hash_key(str, length));
 
-    return count;
+    return (count != NULL) ? *count : 0;
 }
 
 
 /**
- * Display all occurrences. Words are already alphabetically sorted.
+ * Retrieve all words in alphabetical order. Words are only sorted here when
+ * the implementation does not keep them ordered.
  *
- * @param    dico[in]     Pointer to the dictionary
+ * @param   dico[in]     Pointer to the dictionary
+ * @return  Array of nb_words pointers to Word structures (to free)
  */
-void mr_dictionary_display(Dictionary *dico) {
-    int i;
-    unsigned int hash_size = dico->hash_size;
+Word** mr_dictionary_words(Dictionary *dico) {
+    mr_dictionary_flush(dico);
+    Word **words = malloc((dico->nb_words+1)*sizeof(Word*));
+    assert(words != NULL);
 
-    for (i=0; i<hash_size; i++){
-        Bucket *bucket = &dico->hash_tab[i];
-        Word *word = bucket->word;
+    dico->list(dico, words);
 
-        while(word != NULL) {
-            printf("%s=%d\n", word->name, word->count);
-            word = word->next;
-        }
+    if (!dico->ordered) {
+        qsort(words, dico->nb_words, sizeof(Word*),
+                                                _mr_dictionary_compare_words);
     }
+
+    return words;
 }
@@ -18,41 +18,125 @@
     #include "word.h"
     #include "buffalloc.h"
 
-    #define HASH_CHAR_SIZE 256
-    #define HASH_CHARS_USED 2
-    #define HASH_SIZE HASH_CHAR_SIZE*HASH_CHAR_SIZE
+    typedef struct dictionary_s Dictionary;
 
     /**
-     * @struct bucket_s
-     * @brief  Structure containing buckets for the hastable.
+     * @struct dictionary_s
+     * @brief  Structure containing information to manage dictionary.
      */
-    typedef struct bucket_s {
-        Word *word;                  /**<  String containing the word         */
-        #if MAPREDUCE_USE_BUFFALLOC
-            Buffalloc *buffalloc;    /**<  Pointer to a buffer to alloc words */
-        #endif
-    } Bucket;
+    struct dictionary_s {
+        void         (*add)();     /**<  Pointer to impl. of add              */
+        unsigned int* (*find)();   /**<  Pointer to impl. of find (count)     */
+        void         (*list)();    /**<  Pointer to impl. of list             */
+        void         (*flush)();   /**<  Pointer to impl. of flush (or NULL)  */
+        void         (*merge)();   /**<  Pointer to impl. of merge (or NULL)  */
+        void         (*delete)();  /**<  Pointer to impl. of delete           */
+        Dictionary*  (*create_another)(); /**< Pointer to impl. create_another*/
+        dc_type      type;         /**<  Dictionary type (see common.h)       */
+        bool         ordered;      /**<  Words are listed alphabetically      */
+        bool         shared;       /**<  Words shared with other threads      */
+        bool         approx;       /**<  Counts are estimated (upper bounds)  */
+        unsigned int nb_words;     /**<  Number of distinct words             */
+        bool         profiling;    /**<  Profiling mode                       */
+        Timer        timer_put;    /**<  Timer for put func. [Profiling mode] */
+        void*        ext;          /**<  Pointer to additional data           */
+    };
+
 
+    /* =========================== Static Elements ========================== */
 
     /**
-     * @struct dictionary_s
-     * @brief  Structure containing information to manage dictionary.
+     * Common constructor for implementations of Dictionary. Static inline
+     * definition to avoid to compile dictionary.c when using an implemention.
+     *
+     * @param   type[in]        Type of Dictionary (see common.h)
+     * @param   profiling[in]   Activate the profiling mode
+     * @return  Pointer to the new Dictionary structure
      */
-    typedef struct dictionary_s {
-        unsigned int  hash_size;  /**<  Hash size (max value for index)       */
-        Bucket*       hash_tab;   /**<  Array of buckets                      */
-        bool          profiling;  /**<  Profiling mode                        */
-        Timer         timer_put;  /**<  Timer for put func. [Profiling mode]  */
-    } Dictionary;
+    static inline Dictionary* _mr_dictionary_common_create(const dc_type type,
+                                                        const bool profiling) {
+        Dictionary *dico = malloc(sizeof(Dictionary));
+        assert(dico != NULL);
+
+        dico->type = type;
+        dico->nb_words = 0;
+        dico->flush = NULL;
+        dico->merge = NULL;
+        dico->shared = false;
+        dico->approx = false;
+
+        /* Initialize variables for profiling */
+        dico->profiling = profiling;
+        _timer_init(&dico->timer_put, profiling);
+
+        return dico;
+    }
+
+
+    /**
+     * Check if a key made of several words (separated by a space in the
+     * dictionary) is equal to the spelling of a stored key. Lengths shall
+     * already be known to be equal.
+     *
+     * @param   name[in]        Spelling of the stored key
+     * @param   parts[in]       Words of the key
+     * @param   lengths[in]     Characters in each word of the key
+     * @param   nb_parts[in]    Number of words in the key
+     * @return  true if both keys are equal
+     */
+    static inline bool _mr_dictionary_equal_parts(const char *name,
+                           const char **parts, const unsigned int *lengths,
+                                                     unsigned int nb_parts) {
+        int i;
+
+        if (nb_parts == 1) {
+            return mr_word_equal_spelling(name, parts[0], lengths[0]);
+        }
+
+        for (i=0; i<nb_parts; i++) {
+            if (i && *name++ != ' ') return false;
+            if (memcmp(name, parts[i], lengths[i])) return false;
+            name += lengths[i];
+        }
+
+        return true;
+    }
+
+
+    /**
+     * Compare a word with a Word structure in alphabetical order.
+     *
+     * @param   word[in]        String containing the word
+     * @param   length[in]      Characters in the word
+     * @param   dico_word[in]   Pointer to the Word structure
+     * @return  Negative, zero or positive value as for strcmp
+     */
+    static inline int _mr_dictionary_compare(const char *word,
+                               unsigned int length, const Word *dico_word) {
+        unsigned int min = (length < dico_word->length) ? length
+                                                        : dico_word->length;
+        int ret = memcmp(word, dico_word->name, min);
+
+        if (ret) return ret;
+
+        return (int)length - (int)dico_word->length;
+    }
 
 
     /* ============================== Prototypes ============================ */
 
-    Dictionary*    mr_dictionary_create(bool);
+    Dictionary*    mr_dictionary_create(const dc_type, const bool);
+    Dictionary*    mr_dictionary_create_another(const Dictionary*);
+    Dictionary*    mr_dictionary_partition(Dictionary*, const unsigned int);
     void           mr_dictionary_delete(Dictionary**);
 
     void           mr_dictionary_put_word(Dictionary*, const char*);
+    void           mr_dictionary_put_word_hashed(Dictionary*, const char*,
+                                                  unsigned int, uint64_t);
+    void           mr_dictionary_put_parts(Dictionary*, const char**,
+                                const unsigned int*, unsigned int, uint64_t);
     void           mr_dictionary_merge(Dictionary*, Dictionary*);
+    void           mr_dictionary_flush(Dictionary*);
     unsigned int   mr_dictionary_count_word(Dictionary*, const char*);
-    void           mr_dictionary_display(Dictionary*);
+    Word**         mr_dictionary_words(Dictionary*);
 #endif
@@ -0,0 +1,625 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file dictionary_approx.c
+ * @brief A dictionary of bounded size estimating the most frequent words. All
+ *        occurrences are counted by a Count-Min sketch (depth rows of width
+ *        counters) and the MAPREDUCE_DC_APPROX_TOPK most frequent words are
+ *        monitored with SpaceSaving. The sketch caps the counts of monitored
+ *        words and decides if a new word evicts the least frequent one. Counts
+ *        are upper bounds, each one with the error it may contain. Sketches
+ *        of several threads are merged by addition.
+ * @author Jean-Yves VET
+ */
+
+#include "dictionary_approx.h"
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Create a Dictionary estimating the most frequent words in bounded memory.
+ *
+ * @param   profiling[in]  Activate the profiling mode
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary *mr_dictionary_approx_create(const bool profiling) {
+    unsigned int size = 1;
+    Dictionary *dico = _mr_dictionary_common_create(DC_APPROX, profiling);
+
+    /* Set function pointers */
+    dico->add = mr_dictionary_approx_add;
+    dico->find = mr_dictionary_approx_find;
+    dico->list = mr_dictionary_approx_list;
+    dico->merge = mr_dictionary_approx_merge;
+    dico->delete = mr_dictionary_approx_delete;
+    dico->create_another = mr_dictionary_approx_create_another;
+    dico->ordered = false;
+    dico->approx = true;
+
+    Dictionary_approx *ext = malloc(sizeof(Dictionary_approx));
+    assert(ext != NULL);
+    dico->ext = ext;
+
+    ext->sketch = calloc(MAPREDUCE_DC_APPROX_DEPTH * MAPREDUCE_DC_APPROX_WIDTH,
+                                                         sizeof(unsigned int));
+    assert(ext->sketch != NULL);
+    ext->total = 0;
+
+    ext->candidates = malloc(MAPREDUCE_DC_APPROX_TOPK
+                                          * DICTIONARY_APPROX_CANDIDATE_SIZE);
+    ext->heap = malloc(MAPREDUCE_DC_APPROX_TOPK * sizeof(unsigned int));
+    assert(ext->candidates != NULL && ext->heap != NULL);
+    ext->nb_candidates = 0;
+    ext->floor = 0;
+
+    /* Index of candidates at most half full */
+    while (size < 2*MAPREDUCE_DC_APPROX_TOPK) size *= 2;
+    ext->slots = calloc(size, sizeof(unsigned int));
+    assert(ext->slots != NULL);
+    ext->mask = size - 1;
+
+    return dico;
+}
+
+
+/**
+ * Constructor for the dictionaries of other threads (independent ones).
+ *
+ * @param   first[in]   Pointer to the first Dictionary structure
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary* mr_dictionary_approx_create_another(const Dictionary *first) {
+    return mr_dictionary_approx_create(first->profiling);
+}
+
+
+/**
+ * Delete Dictionary with all associated words.
+ *
+ * @param   dico[in]   Pointer to the Dictionary structure
+ */
+void mr_dictionary_approx_delete(Dictionary *dico) {
+    if (dico != NULL) {
+        Dictionary_approx *ext = dico->ext;
+
+        /* Display sketch details [Profiling mode] */
+        if (dico->profiling) {
+            int i;
+            double confidence = 1.0;
+            double error = 2.718281828 * ext->total / MAPREDUCE_DC_APPROX_WIDTH;
+
+            /* Overestimation of the sketch is at most e/width of all
+               occurrences with a probability of 1 - e^-depth */
+            for (i=0; i<MAPREDUCE_DC_APPROX_DEPTH; i++) {
+                confidence /= 2.718281828;
+            }
+            confidence = 100.0 * (1.0 - confidence);
+
+            #if MAPREDUCE_DEFAULT_USECOLORS
+                printf("\e[34m |-[Dictionary] approx:\e[1m %u words, %llu "
+                       "occurrences, sketch error <= %.0f (%.1f%%)\e[0m\n",
+                       dico->nb_words, ext->total, error, confidence);
+            #else
+                printf(" |-[Dictionary] approx: %u words, %llu occurrences, "
+                       "sketch error <= %.0f (%.1f%%)\n", dico->nb_words,
+                       ext->total, error, confidence);
+            #endif
+        }
+
+        /* Delete dictionary structure */
+        free(ext->slots);
+        free(ext->heap);
+        free(ext->candidates);
+        free(ext->sketch);
+        free(ext);
+        free(dico);
+    }
+}
+
+
+/* ============================= Private functions ========================== */
+
+/**
+ * Counter of a word in a row of the sketch. Indexes of rows are derived from
+ * both halves of the hash of the word.
+ *
+ * @param   sketch[in]   Counters of the sketch
+ * @param   row[in]      Row of the sketch
+ * @param   hash[in]     Hash of the word (see mr_word_hash)
+ * @return  Pointer to the counter
+ */
+static inline unsigned int* _mr_dictionary_approx_counter(unsigned int *sketch,
+                                             unsigned int row, uint64_t hash) {
+    uint32_t h1 = (uint32_t)hash, h2 = (uint32_t)(hash >> 32) | 1;
+
+    return &sketch[row * MAPREDUCE_DC_APPROX_WIDTH
+                      + ((h1 + row * h2) & (MAPREDUCE_DC_APPROX_WIDTH - 1))];
+}
+
+
+/**
+ * Add occurrences of a word to the sketch.
+ *
+ * @param   ext[inout]   Pointer to the Dictionary_approx structure
+ * @param   hash[in]     Hash of the word (see mr_word_hash)
+ * @param   count[in]    Occurrences to add
+ * @return  Estimated occurrences of the word (upper bound)
+ */
+static inline unsigned int _mr_dictionary_approx_sketch_add(
+                   Dictionary_approx *ext, uint64_t hash, unsigned int count) {
+    int i;
+    unsigned int estimate = UINT_MAX;
+
+    for (i=0; i<MAPREDUCE_DC_APPROX_DEPTH; i++) {
+        unsigned int *counter = _mr_dictionary_approx_counter(ext->sketch, i,
+                                                                        hash);
+        *counter += count;
+        if (*counter < estimate) estimate = *counter;
+    }
+
+    return estimate;
+}
+
+
+/**
+ * Look for a word among candidates.
+ *
+ * @param   ext[in]      Pointer to the Dictionary_approx structure
+ * @param   word[in]     String containing the word
+ * @param   length[in]   Characters in the word
+ * @param   hash[in]     Hash of the word (see mr_word_hash)
+ * @return  Slot of the word or free slot where it may be indexed
+ */
+static unsigned int* _mr_dictionary_approx_slot(const Dictionary_approx *ext,
+                      const char *word, unsigned int length, uint64_t hash) {
+    unsigned int index = hash & ext->mask;
+
+    while (ext->slots[index] != 0) {
+        Dictionary_approx_candidate *candidate =
+                   _mr_dictionary_approx_candidate(ext, ext->slots[index] - 1);
+
+        if (candidate->word.hash == hash
+                  && mr_word_equal(&candidate->word, word, length)) break;
+
+        index = (index + 1) & ext->mask;
+    }
+
+    return &ext->slots[index];
+}
+
+
+/**
+ * Remove a candidate from the index. Next slots of the probe sequence are
+ * shifted back, so that no tombstone is needed.
+ *
+ * @param   ext[inout]   Pointer to the Dictionary_approx structure
+ * @param   index[in]    Slot of the candidate
+ */
+static void _mr_dictionary_approx_unindex(Dictionary_approx *ext,
+                                                        unsigned int index) {
+    unsigned int mask = ext->mask, next = index;
+
+    for (;;) {
+        next = (next + 1) & mask;
+        if (ext->slots[next] == 0) break;
+
+        unsigned int home = _mr_dictionary_approx_candidate(ext,
+                                  ext->slots[next] - 1)->word.hash & mask;
+
+        /* Move back the candidate if the hole is on its probe sequence */
+        if (((next - home) & mask) >= ((next - index) & mask)) {
+            ext->slots[index] = ext->slots[next];
+            index = next;
+        }
+    }
+
+    ext->slots[index] = 0;
+}
+
+
+/**
+ * Count of the candidate at a position of the heap.
+ *
+ * @param   ext[in]      Pointer to the Dictionary_approx structure
+ * @param   pos[in]      Position in the heap
+ * @return  Count of the candidate
+ */
+static inline unsigned int _mr_dictionary_approx_heap_count(
+                          const Dictionary_approx *ext, unsigned int pos) {
+    return _mr_dictionary_approx_candidate(ext, ext->heap[pos])->word.count;
+}
+
+
+/**
+ * Swap two candidates of the heap.
+ *
+ * @param   ext[inout]   Pointer to the Dictionary_approx structure
+ * @param   a[in]        Position of the first candidate
+ * @param   b[in]        Position of the second candidate
+ */
+static inline void _mr_dictionary_approx_heap_swap(Dictionary_approx *ext,
+                                            unsigned int a, unsigned int b) {
+    unsigned int tmp = ext->heap[a];
+
+    ext->heap[a] = ext->heap[b];
+    ext->heap[b] = tmp;
+    _mr_dictionary_approx_candidate(ext, ext->heap[a])->heap = a;
+    _mr_dictionary_approx_candidate(ext, ext->heap[b])->heap = b;
+}
+
+
+/**
+ * Move down a candidate of the heap which count increased.
+ *
+ * @param   ext[inout]   Pointer to the Dictionary_approx structure
+ * @param   pos[in]      Position of the candidate
+ */
+static void _mr_dictionary_approx_sift_down(Dictionary_approx *ext,
+                                                          unsigned int pos) {
+    unsigned int nb = ext->nb_candidates;
+
+    for (;;) {
+        unsigned int child = 2*pos + 1, min = pos;
+
+        if (child < nb && _mr_dictionary_approx_heap_count(ext, child)
+                            < _mr_dictionary_approx_heap_count(ext, min)) {
+            min = child;
+        }
+        if (child + 1 < nb && _mr_dictionary_approx_heap_count(ext, child + 1)
+                            < _mr_dictionary_approx_heap_count(ext, min)) {
+            min = child + 1;
+        }
+        if (min == pos) return;
+
+        _mr_dictionary_approx_heap_swap(ext, pos, min);
+        pos = min;
+    }
+}
+
+
+/**
+ * Move up a new candidate of the heap.
+ *
+ * @param   ext[inout]   Pointer to the Dictionary_approx structure
+ * @param   pos[in]      Position of the candidate
+ */
+static void _mr_dictionary_approx_sift_up(Dictionary_approx *ext,
+                                                          unsigned int pos) {
+    while (pos > 0 && _mr_dictionary_approx_heap_count(ext, (pos - 1)/2)
+                            > _mr_dictionary_approx_heap_count(ext, pos)) {
+        _mr_dictionary_approx_heap_swap(ext, pos, (pos - 1)/2);
+        pos = (pos - 1)/2;
+    }
+}
+
+
+/**
+ * Fill a candidate with a word.
+ *
+ * @param   candidate[out]  Pointer to the candidate
+ * @param   word[in]        String containing the word
+ * @param   length[in]      Characters in the word
+ * @param   hash[in]        Hash of the word (see mr_word_hash)
+ * @param   count[in]       Upper bound of occurrences
+ * @param   error[in]       Overestimation at most of the count
+ */
+static void _mr_dictionary_approx_set(Dictionary_approx_candidate *candidate,
+                      const char *word, unsigned int length, uint64_t hash,
+                                     unsigned int count, unsigned int error) {
+    candidate->error = error;
+    candidate->word.next = NULL;
+    candidate->word.count = count;
+    candidate->word.length = length;
+    candidate->word.hash = hash;
+    memcpy(candidate->word.name, word, length);
+    candidate->word.name[length] = '\0';
+}
+
+
+/**
+ * Compare two merged candidates by decreasing count, then by spelling so
+ * that kept words do not depend on the order of candidates (for qsort).
+ *
+ * @param   a[in]   Pointer to the first Dictionary_approx_merged structure
+ * @param   b[in]   Pointer to the second Dictionary_approx_merged structure
+ * @return  Negative, zero or positive value as for strcmp
+ */
+static int _mr_dictionary_approx_compare_merged(const void *a, const void *b) {
+    const Dictionary_approx_merged *first = a, *second = b;
+
+    if (first->count != second->count) {
+        return (first->count < second->count) ? 1 : -1;
+    }
+
+    return strcmp(first->candidate->word.name, second->candidate->word.name);
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Add number of occurrences of a word. The word becomes a candidate if there
+ * is room left or if its estimate is over the count of the least frequent
+ * candidate, which is evicted.
+ *
+ * @param   dico[inout]   Pointer to a Dictionary structure
+ * @param   word[in]      String containing the word
+ * @param   length[in]    Characters in the word
+ * @param   hash[in]      Hash of the word (see mr_word_hash)
+ * @param   count[in]     Occurrences to add
+ */
+void mr_dictionary_approx_add(Dictionary *dico, const char *word,
+                 unsigned int length, uint64_t hash, unsigned int count) {
+    Dictionary_approx *ext = dico->ext;
+    Dictionary_approx_candidate *candidate;
+    unsigned int estimate = _mr_dictionary_approx_sketch_add(ext, hash, count);
+    unsigned int *slot, index, upper;
+
+    ext->total += count;
+
+    /* Longer words are only counted by the sketch */
+    if (length > MAPREDUCE_DC_APPROX_MAX_LENGTH) return;
+
+    slot = _mr_dictionary_approx_slot(ext, word, length, hash);
+
+    if (*slot != 0) {
+        candidate = _mr_dictionary_approx_candidate(ext, *slot - 1);
+        unsigned int lower = candidate->word.count - candidate->error + count;
+
+        candidate->word.count += count;
+        if (candidate->word.count > estimate) candidate->word.count = estimate;
+        candidate->error = candidate->word.count - lower;
+        _mr_dictionary_approx_sift_down(ext, candidate->heap);
+        return;
+    }
+
+    /* A word which is not monitored occurred at most floor times before */
+    upper = ext->floor + count;
+    if (upper > estimate) upper = estimate;
+
+    if (ext->nb_candidates < MAPREDUCE_DC_APPROX_TOPK) {
+        index = ext->nb_candidates++;
+        candidate = _mr_dictionary_approx_candidate(ext, index);
+        _mr_dictionary_approx_set(candidate, word, length, hash, upper,
+                                                               upper - count);
+        *slot = index + 1;
+        ext->heap[index] = index;
+        candidate->heap = index;
+        _mr_dictionary_approx_sift_up(ext, index);
+        dico->nb_words = ext->nb_candidates;
+        return;
+    }
+
+    /* Keep the least frequent candidate if the word is not more frequent */
+    index = ext->heap[0];
+    candidate = _mr_dictionary_approx_candidate(ext, index);
+
+    if (upper <= candidate->word.count) {
+        if (upper > ext->floor) ext->floor = upper;
+        return;
+    }
+
+    /* Evict it otherwise, it occurred at most count times */
+    if (candidate->word.count > ext->floor) ext->floor = candidate->word.count;
+    _mr_dictionary_approx_unindex(ext, _mr_dictionary_approx_slot(ext,
+                          candidate->word.name, candidate->word.length,
+                                         candidate->word.hash) - ext->slots);
+
+    _mr_dictionary_approx_set(candidate, word, length, hash, upper,
+                                                               upper - count);
+    *_mr_dictionary_approx_slot(ext, word, length, hash) = index + 1;
+    _mr_dictionary_approx_sift_down(ext, 0);
+}
+
+
+/**
+ * Look for a key made of several words (separated by a space in the
+ * dictionary) among candidates. Occurrences shall not be added through
+ * the returned count, the sketch would miss them (see dico->approx).
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   parts[in]     Words of the key
+ * @param   lengths[in]   Characters in each word of the key
+ * @param   nb_parts[in]  Number of words in the key
+ * @param   length[in]    Characters in the key (spaces included)
+ * @param   hash[in]      Hash of the key (see mr_word_hash_key)
+ * @return  Pointer to the count of the key or NULL if not monitored
+ */
+unsigned int* mr_dictionary_approx_find(Dictionary *dico, const char **parts,
+                      const unsigned int *lengths, unsigned int nb_parts,
+                                       unsigned int length, uint64_t hash) {
+    Dictionary_approx *ext = dico->ext;
+    unsigned int index = hash & ext->mask;
+
+    while (ext->slots[index] != 0) {
+        Dictionary_approx_candidate *candidate =
+                   _mr_dictionary_approx_candidate(ext, ext->slots[index] - 1);
+
+        if (candidate->word.hash == hash && candidate->word.length == length
+              && _mr_dictionary_equal_parts(candidate->word.name, parts,
+                                                        lengths, nb_parts)) {
+            return &candidate->word.count;
+        }
+
+        index = (index + 1) & ext->mask;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * List all candidates (not sorted).
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   words[out]    Array of nb_words pointers to fill
+ */
+void mr_dictionary_approx_list(Dictionary *dico, Word **words) {
+    unsigned int i;
+    Dictionary_approx *ext = dico->ext;
+
+    for (i=0; i<ext->nb_candidates; i++) {
+        *words++ = &_mr_dictionary_approx_candidate(ext, i)->word;
+    }
+}
+
+
+/**
+ * Merge two dictionaries: sketches are added together, then bounds of
+ * candidates of both dictionaries are added (a word missing in one of them
+ * occurred at most floor times there) and the most frequent ones are kept.
+ *
+ * @param   first[inout]  Pointer to the first dictionary (outcome stored here)
+ * @param   second[in]    Pointer to the second dictionary
+ */
+void mr_dictionary_approx_merge(Dictionary *first, Dictionary *second) {
+    unsigned int i, nb = 0;
+    Dictionary_approx *ext = first->ext;
+    const Dictionary_approx *other = second->ext;
+    Dictionary_approx_merged *merged = malloc((ext->nb_candidates
+                + other->nb_candidates + 1) * sizeof(Dictionary_approx_merged));
+    bool *found = calloc(other->nb_candidates + 1, sizeof(bool));
+    char *candidates = malloc(MAPREDUCE_DC_APPROX_TOPK
+                                          * DICTIONARY_APPROX_CANDIDATE_SIZE);
+    assert(merged != NULL && found != NULL && candidates != NULL);
+
+    for (i=0; i<MAPREDUCE_DC_APPROX_DEPTH*MAPREDUCE_DC_APPROX_WIDTH; i++) {
+        ext->sketch[i] += other->sketch[i];
+    }
+    ext->total += other->total;
+
+    /* Candidates of the first dictionary */
+    for (i=0; i<ext->nb_candidates; i++) {
+        const Dictionary_approx_candidate *candidate =
+                                     _mr_dictionary_approx_candidate(ext, i);
+        const Word *word = &candidate->word;
+        unsigned int *slot = _mr_dictionary_approx_slot(other, word->name,
+                                                   word->length, word->hash);
+
+        merged[nb].candidate = candidate;
+        merged[nb].count = word->count + other->floor;
+        merged[nb].lower = word->count - candidate->error;
+
+        if (*slot != 0) {
+            const Dictionary_approx_candidate *twin =
+                             _mr_dictionary_approx_candidate(other, *slot - 1);
+
+            found[*slot - 1] = true;
+            merged[nb].count = word->count + twin->word.count;
+            merged[nb].lower += twin->word.count - twin->error;
+        }
+
+        nb++;
+    }
+
+    /* Candidates only monitored by the second dictionary */
+    for (i=0; i<other->nb_candidates; i++) {
+        if (!found[i]) {
+            const Dictionary_approx_candidate *candidate =
+                                   _mr_dictionary_approx_candidate(other, i);
+
+            merged[nb].candidate = candidate;
+            merged[nb].count = candidate->word.count + ext->floor;
+            merged[nb].lower = candidate->word.count - candidate->error;
+            nb++;
+        }
+    }
+
+    /* Upper bounds are also capped by the merged sketch */
+    for (i=0; i<nb; i++) {
+        unsigned int estimate = mr_dictionary_approx_estimate(first,
+                                           merged[i].candidate->word.hash);
+        if (estimate < merged[i].count) merged[i].count = estimate;
+    }
+
+    qsort(merged, nb, sizeof(Dictionary_approx_merged),
+                                         _mr_dictionary_approx_compare_merged);
+
+    /* Words which are not kept occurred at most floor times */
+    ext->floor += other->floor;
+    if (nb > MAPREDUCE_DC_APPROX_TOPK) {
+        if (merged[MAPREDUCE_DC_APPROX_TOPK].count > ext->floor) {
+            ext->floor = merged[MAPREDUCE_DC_APPROX_TOPK].count;
+        }
+        nb = MAPREDUCE_DC_APPROX_TOPK;
+    }
+
+    /* Rebuild candidates: decreasing counts are reversed into a heap */
+    memset(ext->slots, 0, (ext->mask + 1) * sizeof(unsigned int));
+
+    for (i=0; i<nb; i++) {
+        const Word *word = &merged[i].candidate->word;
+        Dictionary_approx_candidate *candidate = (Dictionary_approx_candidate*)
+                          (candidates + i * DICTIONARY_APPROX_CANDIDATE_SIZE);
+
+        _mr_dictionary_approx_set(candidate, word->name, word->length,
+               word->hash, merged[i].count, merged[i].count - merged[i].lower);
+        candidate->heap = nb - 1 - i;
+        ext->heap[nb - 1 - i] = i;
+    }
+
+    free(ext->candidates);
+    ext->candidates = candidates;
+    ext->nb_candidates = nb;
+    first->nb_words = nb;
+
+    for (i=0; i<nb; i++) {
+        const Word *word = &_mr_dictionary_approx_candidate(ext, i)->word;
+
+        *_mr_dictionary_approx_slot(ext, word->name, word->length,
+                                                         word->hash) = i + 1;
+    }
+
+    free(found);
+    free(merged);
+}
+
+
+/**
+ * Estimate occurrences of a word with the sketch (upper bound).
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   hash[in]      Hash of the word (see mr_word_hash)
+ * @return  Estimated occurrences
+ */
+unsigned int mr_dictionary_approx_estimate(const Dictionary *dico,
+                                                             uint64_t hash) {
+    int i;
+    const Dictionary_approx *ext = dico->ext;
+    unsigned int estimate = UINT_MAX;
+
+    for (i=0; i<MAPREDUCE_DC_APPROX_DEPTH; i++) {
+        unsigned int counter = *_mr_dictionary_approx_counter(ext->sketch, i,
+                                                                        hash);
+        if (counter < estimate) estimate = counter;
+    }
+
+    return estimate;
+}
+
+
+/**
+ * Retrieve the error of a listed word: it occurred between count - error
+ * and count times.
+ *
+ * @param   name[in]      Spelling of a Word listed by dictionary_approx
+ * @return  Overestimation at most of the count
+ */
+unsigned int mr_dictionary_approx_error(const char *name) {
+    const Dictionary_approx_candidate *candidate =
+             (const Dictionary_approx_candidate*)(name - offsetof(Word, name)
+                               - offsetof(Dictionary_approx_candidate, word));
+
+    return candidate->error;
+}
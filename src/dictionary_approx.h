@@ -0,0 +1,105 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_DICTIONARY_APPROX_H
+    #define HEADER_MAPREDUCE_DICTIONARY_APPROX_H
+
+    #include <limits.h>
+    #include <stddef.h>
+    #include "dictionary.h"
+
+    /**
+     * @struct dictionary_approx_candidate_s
+     * @brief  A word monitored by the SpaceSaving structure. The count of the
+     *         Word is an upper bound of its occurrences, the true count is at
+     *         least count - error. Candidates have a fixed room for spellings
+     *         of MAPREDUCE_DC_APPROX_MAX_LENGTH characters.
+     */
+    typedef struct dictionary_approx_candidate_s {
+        unsigned int  error;       /**<  Overestimation at most of the count */
+        unsigned int  heap;        /**<  Position in the heap                */
+        Word          word;        /**<  Spelling and upper bound of count   */
+        /* /!\ Keep the Word at the end: its spelling follows in the same
+               room of the candidates array. */
+    } Dictionary_approx_candidate;
+
+
+    /**
+     * @struct dictionary_approx_s
+     * @brief  Structure containing extra data for dictionary_approx: a
+     *         Count-Min sketch of all occurrences and the
+     *         MAPREDUCE_DC_APPROX_TOPK most frequent words (SpaceSaving).
+     *         Memory does not depend on the vocabulary and nothing is
+     *         allocated while words are added.
+     */
+    typedef struct dictionary_approx_s {
+        unsigned int* sketch;      /**<  Counters (depth rows of width)      */
+        unsigned long long total;  /**<  Occurrences added                   */
+        char*         candidates;  /**<  Monitored words (fixed size rooms)  */
+        unsigned int* heap;        /**<  Candidates by count (min first)     */
+        unsigned int* slots;       /**<  Index of candidates plus one (or 0) */
+        unsigned int  mask;        /**<  Number of slots minus one           */
+        unsigned int  nb_candidates; /**< Words monitored                    */
+        unsigned int  floor;       /**<  Upper bound of words not monitored  */
+    } Dictionary_approx;
+
+
+    /**
+     * @struct dictionary_approx_merged_s
+     * @brief  Bounds of a candidate of either dictionary during a merge.
+     */
+    typedef struct dictionary_approx_merged_s {
+        const Dictionary_approx_candidate* candidate; /**< Word to keep     */
+        unsigned int  count;       /**<  Upper bound of both dictionaries    */
+        unsigned int  lower;       /**<  Lower bound of both dictionaries    */
+    } Dictionary_approx_merged;
+
+
+    /* Bytes of a candidate and its spelling (aligned for the next one) */
+    #define DICTIONARY_APPROX_CANDIDATE_SIZE \
+        ((sizeof(Dictionary_approx_candidate) + MAPREDUCE_DC_APPROX_MAX_LENGTH \
+          + __alignof__(Dictionary_approx_candidate)) \
+         & ~(size_t)(__alignof__(Dictionary_approx_candidate) - 1))
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Retrieve a candidate from its index.
+     *
+     * @param   ext[in]      Pointer to the Dictionary_approx structure
+     * @param   index[in]    Index of the candidate
+     * @return  Pointer to the candidate
+     */
+    static inline Dictionary_approx_candidate* _mr_dictionary_approx_candidate(
+                      const Dictionary_approx *ext, unsigned int index) {
+        return (Dictionary_approx_candidate*)(ext->candidates
+                           + (size_t)index * DICTIONARY_APPROX_CANDIDATE_SIZE);
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Dictionary*    mr_dictionary_approx_create(const bool);
+    Dictionary*    mr_dictionary_approx_create_another(const Dictionary*);
+    void           mr_dictionary_approx_delete(Dictionary*);
+
+    void           mr_dictionary_approx_add(Dictionary*, const char*,
+                                     unsigned int, uint64_t, unsigned int);
+    unsigned int*  mr_dictionary_approx_find(Dictionary*, const char**,
+                  const unsigned int*, unsigned int, unsigned int, uint64_t);
+    void           mr_dictionary_approx_list(Dictionary*, Word**);
+    void           mr_dictionary_approx_merge(Dictionary*, Dictionary*);
+    unsigned int   mr_dictionary_approx_estimate(const Dictionary*, uint64_t);
+    unsigned int   mr_dictionary_approx_error(const char*);
+#endif
@@ -0,0 +1,262 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file dictionary_buckets.c
+ * @brief A dictionary (hash table containing words where they are
+ *        alphabetically sorted). Buckets are indexed by the first two
+ *        characters of words, so listing buckets in order gives all words in
+ *        alphabetical order.
+ * @author Jean-Yves VET
+ */
+
+#include "dictionary_buckets.h"
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Create a Dictionary based on a Hashtable.
+ *
+ * @param   profiling[in]  Activate the profiling mode
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary *mr_dictionary_buckets_create(const bool profiling) {
+    int i;
+    Dictionary *dico = _mr_dictionary_common_create(DC_BUCKETS, profiling);
+
+    /* Set function pointers */
+    dico->add = mr_dictionary_buckets_add;
+    dico->find = mr_dictionary_buckets_find;
+    dico->list = mr_dictionary_buckets_list;
+    dico->delete = mr_dictionary_buckets_delete;
+    dico->create_another = mr_dictionary_buckets_create_another;
+    dico->ordered = true;
+
+    Dictionary_buckets *ext = malloc(sizeof(Dictionary_buckets));
+    assert(ext != NULL);
+    dico->ext = ext;
+
+    ext->hash_size = HASH_SIZE;
+
+    ext->hash_tab = malloc(ext->hash_size*sizeof(Bucket));
+    assert(ext->hash_tab != NULL);
+
+    /* Set to null first Word pointers in all buckets */
+    for (i=0; i<ext->hash_size; i++){
+        Bucket *b = &ext->hash_tab[i];
+        b->word = NULL;
+        #if MAPREDUCE_USE_BUFFALLOC
+            b->buffalloc = NULL;
+        #endif
+    }
+
+    return dico;
+}
+
+
+/**
+ * Constructor for the dictionaries of other threads (independent ones).
+ *
+ * @param   first[in]   Pointer to the first Dictionary structure
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary* mr_dictionary_buckets_create_another(const Dictionary *first) {
+    return mr_dictionary_buckets_create(first->profiling);
+}
+
+
+/**
+ * Delete Dictionary with all associated words.
+ *
+ * @param   dico[in]   Pointer to the Dictionary structure
+ */
+void mr_dictionary_buckets_delete(Dictionary *dico) {
+    int i;
+
+    if (dico != NULL) {
+        Dictionary_buckets *ext = dico->ext;
+        unsigned int hash_size = ext->hash_size;
+
+        /* Delete all words */
+        for (i=0; i<hash_size; i++){
+            Bucket *bucket = &ext->hash_tab[i];
+
+            #if MAPREDUCE_USE_BUFFALLOC
+                mr_buffalloc_delete(&bucket->buffalloc);
+            #else
+                Word *word = bucket->word;
+                while(word != NULL) {
+                    Word *word_ptr = word;
+                    word = word->next;
+                    mr_word_delete(&word_ptr);
+                }
+            #endif
+        }
+
+        /* Delete dictionary structure */
+        free(ext->hash_tab);
+        free(ext);
+        free(dico);
+    }
+}
+
+
+/* ============================= Private functions ========================== */
+
+/**
+ * Compute bucket index for a given word (based on the first 2 characters).
+ *
+ * @param   word[in]     String containing the word
+ * @param   length[in]   Characters in the word
+ * @return  Index of the bucket
+ */
+static inline unsigned int _mr_dictionary_buckets_hash(const char *word,
+                                                        unsigned int length) {
+    unsigned int hash;
+
+    hash = (unsigned char)word[0] * HASH_CHAR_SIZE;
+    if (length > 1) hash += (unsigned char)word[1];
+
+    return hash;
+}
+
+
+/**
+ * Look for a given word in a bucket. Only words with the same hash are
+ * compared character by character.
+ *
+ * @param   bucket[in]   Pointer to the bucket
+ * @param   word[in]     String containing the word
+ * @param   length[in]   Characters in the word
+ * @param   hash[in]     Hash of the word (see mr_word_hash)
+ * @return  Pointer to the Word structure or NULL if not found
+ */
+static inline Word *_mr_dictionary_buckets_find(Bucket *bucket,
+                   const char *word, unsigned int length, uint64_t hash) {
+    Word *dico_word = bucket->word;
+
+    while (dico_word != NULL && (dico_word->hash != hash
+                                 || !mr_word_equal(dico_word, word, length))) {
+        dico_word = dico_word->next;
+    }
+
+    return dico_word;
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Add number of occurrences to a Word structure in a Dictionary. Add the word
+ * if it does not exist. Words of a bucket are kept in alphabetical order.
+ *
+ * @param   dico[inout]   Pointer to a Dictionary structure
+ * @param   word[in]      String containing the word
+ * @param   length[in]    Characters in the word
+ * @param   hash[in]      Hash of the word (see mr_word_hash)
+ * @param   count[in]     Occurrences to add
+ */
+void mr_dictionary_buckets_add(Dictionary *dico, const char *word,
+                 unsigned int length, uint64_t hash, unsigned int count) {
+    Dictionary_buckets *ext = dico->ext;
+    Bucket *bucket = &ext->hash_tab[_mr_dictionary_buckets_hash(word, length)];
+
+    /* Most words are already in the dictionary */
+    Word *dico_word = _mr_dictionary_buckets_find(bucket, word, length, hash);
+
+    if (dico_word != NULL) {
+        dico_word->count += count;
+        return;
+    }
+
+    /* Insert the new word before the first greater one */
+    Word **ptr = &bucket->word;
+
+    while (*ptr != NULL && _mr_dictionary_compare(word, length, *ptr) > 0) {
+        ptr = &(*ptr)->next;
+    }
+
+    #if MAPREDUCE_USE_BUFFALLOC
+        if(bucket->buffalloc == NULL) {
+            bucket->buffalloc = mr_buffalloc_create();
+        }
+        Word *new_word = mr_word_create_buff_hashed(word, length, hash,
+                                                            bucket->buffalloc);
+    #else
+        Word *new_word = mr_word_create(word);
+    #endif
+    new_word->count = count;
+    new_word->next = *ptr;
+    *ptr = new_word;
+    dico->nb_words++;
+}
+
+
+/**
+ * Look for a key made of several words (separated by a space in the
+ * dictionary) without building it.
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   parts[in]     Words of the key
+ * @param   lengths[in]   Characters in each word of the key
+ * @param   nb_parts[in]  Number of words in the key
+ * @param   length[in]    Characters in the key (spaces included)
+ * @param   hash[in]      Hash of the key (see mr_word_hash_key)
+ * @return  Pointer to the count of the key or NULL if not found
+ */
+unsigned int* mr_dictionary_buckets_find(Dictionary *dico, const char **parts,
+                      const unsigned int *lengths, unsigned int nb_parts,
+                                       unsigned int length, uint64_t hash) {
+    Dictionary_buckets *ext = dico->ext;
+
+    /* Bucket of the key built with spaces */
+    unsigned int index = (unsigned char)parts[0][0] * HASH_CHAR_SIZE;
+    if (lengths[0] > 1) {
+        index += (unsigned char)parts[0][1];
+    } else if (nb_parts > 1) {
+        index += ' ';
+    }
+
+    Word *dico_word = ext->hash_tab[index].word;
+
+    while (dico_word != NULL && (dico_word->hash != hash
+                           || dico_word->length != length
+                           || !_mr_dictionary_equal_parts(dico_word->name,
+                                                parts, lengths, nb_parts))) {
+        dico_word = dico_word->next;
+    }
+
+    return (dico_word != NULL) ? &dico_word->count : NULL;
+}
+
+
+/**
+ * List all words. Words are already alphabetically sorted.
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   words[out]    Array of nb_words pointers to fill
+ */
+void mr_dictionary_buckets_list(Dictionary *dico, Word **words) {
+    int i;
+    Dictionary_buckets *ext = dico->ext;
+    unsigned int hash_size = ext->hash_size;
+
+    for (i=0; i<hash_size; i++){
+        Word *word = ext->hash_tab[i].word;
+
+        while(word != NULL) {
+            *words++ = word;
+            word = word->next;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_DICTIONARY_BUCKETS_H
+    #define HEADER_MAPREDUCE_DICTIONARY_BUCKETS_H
+
+    #include "dictionary.h"
+
+    #define HASH_CHAR_SIZE 256
+    #define HASH_CHARS_USED 2
+    #define HASH_SIZE HASH_CHAR_SIZE*HASH_CHAR_SIZE
+
+    /**
+     * @struct bucket_s
+     * @brief  Structure containing buckets for the hastable.
+     */
+    typedef struct bucket_s {
+        Word *word;                  /**<  String containing the word         */
+        #if MAPREDUCE_USE_BUFFALLOC
+            Buffalloc *buffalloc;    /**<  Pointer to a buffer to alloc words */
+        #endif
+    } Bucket;
+
+
+    /**
+     * @struct dictionary_buckets_s
+     * @brief  Structure containing extra data for dictionary_buckets (words
+     *         of a bucket are kept in alphabetical order).
+     */
+    typedef struct dictionary_buckets_s {
+        unsigned int  hash_size;  /**<  Hash size (max value for index)       */
+        Bucket*       hash_tab;   /**<  Array of buckets                      */
+    } Dictionary_buckets;
+
+
+    /* ============================== Prototypes ============================ */
+
+    Dictionary*    mr_dictionary_buckets_create(const bool);
+    Dictionary*    mr_dictionary_buckets_create_another(const Dictionary*);
+    void           mr_dictionary_buckets_delete(Dictionary*);
+
+    void           mr_dictionary_buckets_add(Dictionary*, const char*,
+                                     unsigned int, uint64_t, unsigned int);
+    unsigned int*  mr_dictionary_buckets_find(Dictionary*, const char**,
+                  const unsigned int*, unsigned int, unsigned int, uint64_t);
+    void           mr_dictionary_buckets_list(Dictionary*, Word**);
+#endif
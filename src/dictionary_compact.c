@@ -0,0 +1,339 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file dictionary_compact.c
+ * @brief A dictionary based on an open addressing hash table (linear probing)
+ *        with compact entries. Slots hold a 32-bit fingerprint and a 32-bit
+ *        offset in an arena where each word only takes a count, its length
+ *        (one byte for words shorter than 128 characters) and its spelling.
+ *        This is about half the memory of Word structures referenced by
+ *        pointers and full hashes (see dictionary_hash.c).
+ * @author Jean-Yves VET
+ */
+
+#include "dictionary_compact.h"
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Create a Dictionary based on an open addressing hash table with compact
+ * entries.
+ *
+ * @param   profiling[in]  Activate the profiling mode
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary *mr_dictionary_compact_create(const bool profiling) {
+    Dictionary *dico = _mr_dictionary_common_create(DC_COMPACT, profiling);
+
+    /* Set function pointers */
+    dico->add = mr_dictionary_compact_add;
+    dico->find = mr_dictionary_compact_find;
+    dico->list = mr_dictionary_compact_list;
+    dico->delete = mr_dictionary_compact_delete;
+    dico->create_another = mr_dictionary_compact_create_another;
+    dico->ordered = false;
+
+    Dictionary_compact *ext = malloc(sizeof(Dictionary_compact));
+    assert(ext != NULL);
+    dico->ext = ext;
+
+    /* Free slots have a null offset */
+    ext->slots = calloc(MAPREDUCE_DC_COMPACT_INITIAL_SIZE,
+                                              sizeof(Dictionary_compact_slot));
+    assert(ext->slots != NULL);
+    ext->mask = MAPREDUCE_DC_COMPACT_INITIAL_SIZE - 1;
+    ext->max_words = (uint64_t)MAPREDUCE_DC_COMPACT_INITIAL_SIZE
+                                        * MAPREDUCE_DC_COMPACT_MAX_LOAD / 100;
+    ext->nb_resizes = 0;
+
+    /* Offset 0 is never used by an entry */
+    ext->arena = malloc(MAPREDUCE_DC_COMPACT_ARENA_SIZE);
+    assert(ext->arena != NULL);
+    ext->arena_used = DICTIONARY_COMPACT_ALIGN;
+    ext->arena_size = MAPREDUCE_DC_COMPACT_ARENA_SIZE;
+
+    ext->words = NULL;
+    ext->words_size = 0;
+
+    return dico;
+}
+
+
+/**
+ * Constructor for the dictionaries of other threads (independent ones).
+ *
+ * @param   first[in]   Pointer to the first Dictionary structure
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary* mr_dictionary_compact_create_another(const Dictionary *first) {
+    return mr_dictionary_compact_create(first->profiling);
+}
+
+
+/**
+ * Delete Dictionary with all associated words.
+ *
+ * @param   dico[in]   Pointer to the Dictionary structure
+ */
+void mr_dictionary_compact_delete(Dictionary *dico) {
+    if (dico != NULL) {
+        Dictionary_compact *ext = dico->ext;
+
+        /* Display table details [Profiling mode] */
+        if (dico->profiling) {
+            #if MAPREDUCE_DEFAULT_USECOLORS
+                printf("\e[34m |-[Dictionary] compact:\e[1m %u words, %u "
+                       "slots (%u resizes), %zu bytes of entries\e[0m\n",
+                       dico->nb_words, ext->mask + 1, ext->nb_resizes,
+                                                              ext->arena_used);
+            #else
+                printf(" |-[Dictionary] compact: %u words, %u slots (%u "
+                       "resizes), %zu bytes of entries\n", dico->nb_words,
+                       ext->mask + 1, ext->nb_resizes, ext->arena_used);
+            #endif
+        }
+
+        /* Delete dictionary structure */
+        free(ext->words);
+        free(ext->arena);
+        free(ext->slots);
+        free(ext);
+        free(dico);
+    }
+}
+
+
+/* ============================= Private functions ========================== */
+
+/**
+ * Double the number of slots. Slots are moved according to their
+ * fingerprint, so entries are not even read.
+ *
+ * @param   ext[inout]   Pointer to the Dictionary_compact structure
+ */
+static void _mr_dictionary_compact_resize(Dictionary_compact *ext) {
+    unsigned int i, size = ext->mask + 1;
+    unsigned int mask = 2*size - 1;
+    Dictionary_compact_slot *slots = calloc(2*size,
+                                              sizeof(Dictionary_compact_slot));
+    assert(slots != NULL);
+
+    for (i=0; i<size; i++) {
+        Dictionary_compact_slot *slot = &ext->slots[i];
+
+        if (slot->entry != 0) {
+            unsigned int index = slot->fingerprint & mask;
+
+            while (slots[index].entry != 0) index = (index + 1) & mask;
+            slots[index] = *slot;
+        }
+    }
+
+    free(ext->slots);
+    ext->slots = slots;
+    ext->mask = mask;
+    ext->max_words = (uint64_t)(mask + 1) * MAPREDUCE_DC_COMPACT_MAX_LOAD / 100;
+    ext->nb_resizes++;
+}
+
+
+/**
+ * Append a new entry at the end of the arena. The arena doubles when it is
+ * full (entries are addressed by offsets, so they may move).
+ *
+ * @param   ext[inout]   Pointer to the Dictionary_compact structure
+ * @param   word[in]     String containing the word
+ * @param   length[in]   Characters in the word
+ * @param   count[in]    Occurrences of the word
+ * @return  Offset of the new entry
+ */
+static uint32_t _mr_dictionary_compact_append(Dictionary_compact *ext,
+               const char *word, unsigned int length, unsigned int count) {
+    size_t needed = ext->arena_used + sizeof(unsigned int)
+                    + DICTIONARY_COMPACT_MAX_VARINT + length;
+
+    if (needed > ext->arena_size) {
+        while (needed > ext->arena_size) ext->arena_size *= 2;
+        ext->arena = realloc(ext->arena, ext->arena_size);
+        assert(ext->arena != NULL);
+    }
+
+    size_t offset = ext->arena_used / DICTIONARY_COMPACT_ALIGN;
+    assert(offset <= UINT32_MAX);
+
+    unsigned int *entry = _mr_dictionary_compact_entry(ext, offset);
+    unsigned char *ptr = (unsigned char*)(entry + 1);
+    unsigned int value = length;
+    *entry = count;
+
+    /* Length on as few bytes as possible (7 bits per byte) */
+    while (value >= 0x80) {
+        *ptr++ = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    *ptr++ = value;
+
+    /* Spelling without terminating character */
+    memcpy(ptr, word, length);
+    ptr += length;
+
+    ext->arena_used = (ptr - (unsigned char*)ext->arena
+                       + DICTIONARY_COMPACT_ALIGN - 1)
+                                     & ~(size_t)(DICTIONARY_COMPACT_ALIGN - 1);
+
+    return offset;
+}
+
+
+/**
+ * Size of the Word structure built for an entry when words are listed.
+ *
+ * @param   length[in]   Characters in the word
+ * @return  Bytes to allocate (aligned for the next Word structure)
+ */
+static inline size_t _mr_dictionary_compact_word_size(unsigned int length) {
+    return (sizeof(Word) + length + __alignof__(Word))
+                                            & ~(size_t)(__alignof__(Word) - 1);
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Add number of occurrences to a word in a Dictionary. Add the word if it
+ * does not exist.
+ *
+ * @param   dico[inout]   Pointer to a Dictionary structure
+ * @param   word[in]      String containing the word
+ * @param   length[in]    Characters in the word
+ * @param   hash[in]      Hash of the word (see mr_word_hash)
+ * @param   count[in]     Occurrences to add
+ */
+void mr_dictionary_compact_add(Dictionary *dico, const char *word,
+                 unsigned int length, uint64_t hash, unsigned int count) {
+    Dictionary_compact *ext = dico->ext;
+    unsigned int mask = ext->mask;
+    uint32_t fingerprint = (uint32_t)hash;
+    unsigned int index = fingerprint & mask;
+    Dictionary_compact_slot *slot = &ext->slots[index];
+
+    /* Probe until the word or a free slot is found */
+    while (slot->entry != 0) {
+        if (slot->fingerprint == fingerprint) {
+            unsigned int entry_length;
+            unsigned int *entry = _mr_dictionary_compact_entry(ext,
+                                                                 slot->entry);
+            const char *name = _mr_dictionary_compact_spelling(entry,
+                                                               &entry_length);
+
+            if (entry_length == length
+                       && mr_word_equal_spelling(name, word, length)) {
+                *entry += count;
+                return;
+            }
+        }
+
+        index = (index + 1) & mask;
+        slot = &ext->slots[index];
+    }
+
+    slot->fingerprint = fingerprint;
+    slot->entry = _mr_dictionary_compact_append(ext, word, length, count);
+    ext->words_size += _mr_dictionary_compact_word_size(length);
+
+    if (++dico->nb_words > ext->max_words) _mr_dictionary_compact_resize(ext);
+}
+
+
+/**
+ * Look for a key made of several words (separated by a space in the
+ * dictionary) without building it.
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   parts[in]     Words of the key
+ * @param   lengths[in]   Characters in each word of the key
+ * @param   nb_parts[in]  Number of words in the key
+ * @param   length[in]    Characters in the key (spaces included)
+ * @param   hash[in]      Hash of the key (see mr_word_hash_key)
+ * @return  Pointer to the count of the key or NULL if not found
+ */
+unsigned int* mr_dictionary_compact_find(Dictionary *dico, const char **parts,
+                      const unsigned int *lengths, unsigned int nb_parts,
+                                       unsigned int length, uint64_t hash) {
+    Dictionary_compact *ext = dico->ext;
+    unsigned int mask = ext->mask;
+    uint32_t fingerprint = (uint32_t)hash;
+    unsigned int index = fingerprint & mask;
+    Dictionary_compact_slot *slot = &ext->slots[index];
+
+    while (slot->entry != 0) {
+        if (slot->fingerprint == fingerprint) {
+            unsigned int entry_length;
+            unsigned int *entry = _mr_dictionary_compact_entry(ext,
+                                                                 slot->entry);
+            const char *name = _mr_dictionary_compact_spelling(entry,
+                                                               &entry_length);
+
+            if (entry_length == length
+                  && _mr_dictionary_equal_parts(name, parts, lengths,
+                                                               nb_parts)) {
+                return entry;
+            }
+        }
+
+        index = (index + 1) & mask;
+        slot = &ext->slots[index];
+    }
+
+    return NULL;
+}
+
+
+/**
+ * List all words in slot order (not sorted). Word structures are built from
+ * the entries, they stay valid until the next list or the deletion of the
+ * dictionary. Their full hash is computed again from the spelling.
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   words[out]    Array of nb_words pointers to fill
+ */
+void mr_dictionary_compact_list(Dictionary *dico, Word **words) {
+    unsigned int i;
+    Dictionary_compact *ext = dico->ext;
+
+    free(ext->words);
+    ext->words = malloc(ext->words_size + 1);
+    assert(ext->words != NULL);
+    char *ptr = ext->words;
+
+    for (i=0; i<=ext->mask; i++) {
+        if (ext->slots[i].entry != 0) {
+            unsigned int length;
+            const unsigned int *entry = _mr_dictionary_compact_entry(ext,
+                                                           ext->slots[i].entry);
+            const char *name = _mr_dictionary_compact_spelling(entry, &length);
+            Word *word = (Word*)ptr;
+
+            word->next = NULL;
+            word->count = *entry;
+            word->length = length;
+            memcpy(word->name, name, length);
+            word->name[length] = '\0';
+            word->hash = mr_word_hash_key(word->name, length);
+
+            *words++ = word;
+            ptr += _mr_dictionary_compact_word_size(length);
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_DICTIONARY_COMPACT_H
+    #define HEADER_MAPREDUCE_DICTIONARY_COMPACT_H
+
+    #include "dictionary.h"
+
+    /* Entries start on multiples of this size in the arena, so that their
+       count is aligned and 32-bit offsets address up to 16 GB of entries */
+    #define DICTIONARY_COMPACT_ALIGN 4
+
+    /* Bytes of an encoded length at most (7 bits per byte) */
+    #define DICTIONARY_COMPACT_MAX_VARINT 5
+
+    /**
+     * @struct dictionary_compact_slot_s
+     * @brief  Slot of the open addressing table. Only the low 32 bits of the
+     *         hash are kept as a fingerprint next to the offset of the entry,
+     *         which is enough to probe and to resize tables up to 2^32 slots.
+     */
+    typedef struct dictionary_compact_slot_s {
+        uint32_t      fingerprint; /**<  Low bits of the hash of the word    */
+        uint32_t      entry;       /**<  Offset in the arena (0 if free)     */
+    } Dictionary_compact_slot;
+
+
+    /**
+     * @struct dictionary_compact_s
+     * @brief  Structure containing extra data for dictionary_compact. Words
+     *         are stored in a single arena as entries made of a count, a
+     *         variable-length length and the spelling (no pointer, no hash,
+     *         no terminating character). Word structures are only built when
+     *         words are listed, they are sorted afterwards.
+     */
+    typedef struct dictionary_compact_s {
+        Dictionary_compact_slot* slots;   /**<  Array of slots (power of 2)  */
+        unsigned int  mask;        /**<  Number of slots minus one           */
+        unsigned int  max_words;   /**<  Words before the next resize        */
+        unsigned int  nb_resizes;  /**<  Resizes [Profiling mode]            */
+        char*         arena;       /**<  Entries of all words                */
+        size_t        arena_used;  /**<  Bytes used in the arena             */
+        size_t        arena_size;  /**<  Bytes allocated for the arena       */
+        char*         words;       /**<  Word structures of the last list    */
+        size_t        words_size;  /**<  Bytes needed to list all words      */
+    } Dictionary_compact;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Retrieve an entry of the arena from its offset.
+     *
+     * @param   ext[in]      Pointer to the Dictionary_compact structure
+     * @param   entry[in]    Offset of the entry (see Dictionary_compact_slot)
+     * @return  Pointer to the count of the entry
+     */
+    static inline unsigned int* _mr_dictionary_compact_entry(
+                             const Dictionary_compact *ext, uint32_t entry) {
+        return (unsigned int*)(ext->arena
+                                   + (size_t)entry * DICTIONARY_COMPACT_ALIGN);
+    }
+
+
+    /**
+     * Decode the length of an entry which follows its count (7 bits per
+     * byte, the high bit is set when another byte follows).
+     *
+     * @param   count[in]    Pointer to the count of the entry
+     * @param   length[out]  Number of characters in the spelling
+     * @return  Pointer to the spelling of the entry
+     */
+    static inline const char* _mr_dictionary_compact_spelling(
+                          const unsigned int *count, unsigned int *length) {
+        const unsigned char *ptr = (const unsigned char*)(count + 1);
+        unsigned int value = *ptr & 0x7f, shift = 7;
+
+        while (*ptr++ & 0x80) {
+            value |= (unsigned int)(*ptr & 0x7f) << shift;
+            shift += 7;
+        }
+
+        *length = value;
+
+        return (const char*)ptr;
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Dictionary*    mr_dictionary_compact_create(const bool);
+    Dictionary*    mr_dictionary_compact_create_another(const Dictionary*);
+    void           mr_dictionary_compact_delete(Dictionary*);
+
+    void           mr_dictionary_compact_add(Dictionary*, const char*,
+                                     unsigned int, uint64_t, unsigned int);
+    unsigned int*  mr_dictionary_compact_find(Dictionary*, const char**,
+                  const unsigned int*, unsigned int, unsigned int, uint64_t);
+    void           mr_dictionary_compact_list(Dictionary*, Word**);
+#endif
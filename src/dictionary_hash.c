@@ -0,0 +1,247 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file dictionary_hash.c
+ * @brief A dictionary based on an open addressing hash table (linear probing)
+ *        indexed by the full hash of words. The table doubles when its load
+ *        factor gets over MAPREDUCE_DC_HASH_MAX_LOAD percent. Words are only
+ *        sorted alphabetically when they are listed.
+ * @author Jean-Yves VET
+ */
+
+#include "dictionary_hash.h"
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Create a Dictionary based on an open addressing hash table.
+ *
+ * @param   profiling[in]  Activate the profiling mode
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary *mr_dictionary_hash_create(const bool profiling) {
+    Dictionary *dico = _mr_dictionary_common_create(DC_HASH, profiling);
+
+    /* Set function pointers */
+    dico->add = mr_dictionary_hash_add;
+    dico->find = mr_dictionary_hash_find;
+    dico->list = mr_dictionary_hash_list;
+    dico->delete = mr_dictionary_hash_delete;
+    dico->create_another = mr_dictionary_hash_create_another;
+    dico->ordered = false;
+
+    Dictionary_hash *ext = malloc(sizeof(Dictionary_hash));
+    assert(ext != NULL);
+    dico->ext = ext;
+
+    /* Free slots have a NULL word */
+    ext->slots = calloc(MAPREDUCE_DC_HASH_INITIAL_SIZE,
+                                                 sizeof(Dictionary_hash_slot));
+    assert(ext->slots != NULL);
+    ext->mask = MAPREDUCE_DC_HASH_INITIAL_SIZE - 1;
+    ext->max_words = (uint64_t)MAPREDUCE_DC_HASH_INITIAL_SIZE
+                                        * MAPREDUCE_DC_HASH_MAX_LOAD / 100;
+    ext->nb_resizes = 0;
+
+    #if MAPREDUCE_USE_BUFFALLOC
+        ext->buffalloc = mr_buffalloc_create();
+    #endif
+
+    return dico;
+}
+
+
+/**
+ * Constructor for the dictionaries of other threads (independent ones).
+ *
+ * @param   first[in]   Pointer to the first Dictionary structure
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary* mr_dictionary_hash_create_another(const Dictionary *first) {
+    return mr_dictionary_hash_create(first->profiling);
+}
+
+
+/**
+ * Delete Dictionary with all associated words.
+ *
+ * @param   dico[in]   Pointer to the Dictionary structure
+ */
+void mr_dictionary_hash_delete(Dictionary *dico) {
+    if (dico != NULL) {
+        Dictionary_hash *ext = dico->ext;
+
+        /* Display table details [Profiling mode] */
+        if (dico->profiling) {
+            #if MAPREDUCE_DEFAULT_USECOLORS
+                printf("\e[34m |-[Dictionary] hash:\e[1m %u words, %u slots "
+                       "(%u resizes)\e[0m\n", dico->nb_words, ext->mask + 1,
+                                                              ext->nb_resizes);
+            #else
+                printf(" |-[Dictionary] hash: %u words, %u slots (%u resizes)"
+                       "\n", dico->nb_words, ext->mask + 1, ext->nb_resizes);
+            #endif
+        }
+
+        /* Delete all words */
+        #if MAPREDUCE_USE_BUFFALLOC
+            mr_buffalloc_delete(&ext->buffalloc);
+        #else
+            unsigned int i;
+            for (i=0; i<=ext->mask; i++) {
+                if (ext->slots[i].word != NULL) {
+                    mr_word_delete(&ext->slots[i].word);
+                }
+            }
+        #endif
+
+        /* Delete dictionary structure */
+        free(ext->slots);
+        free(ext);
+        free(dico);
+    }
+}
+
+
+/* ============================= Private functions ========================== */
+
+/**
+ * Double the number of slots. Words are moved according to their stored
+ * hash, so keys are neither hashed nor compared again.
+ *
+ * @param   ext[inout]   Pointer to the Dictionary_hash structure
+ */
+static void _mr_dictionary_hash_resize(Dictionary_hash *ext) {
+    unsigned int i, size = ext->mask + 1;
+    unsigned int mask = 2*size - 1;
+    Dictionary_hash_slot *slots = calloc(2*size, sizeof(Dictionary_hash_slot));
+    assert(slots != NULL);
+
+    for (i=0; i<size; i++) {
+        Dictionary_hash_slot *slot = &ext->slots[i];
+
+        if (slot->word != NULL) {
+            unsigned int index = slot->hash & mask;
+
+            while (slots[index].word != NULL) index = (index + 1) & mask;
+            slots[index] = *slot;
+        }
+    }
+
+    free(ext->slots);
+    ext->slots = slots;
+    ext->mask = mask;
+    ext->max_words = (uint64_t)(mask + 1) * MAPREDUCE_DC_HASH_MAX_LOAD / 100;
+    ext->nb_resizes++;
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Add number of occurrences to a Word structure in a Dictionary. Add the word
+ * if it does not exist.
+ *
+ * @param   dico[inout]   Pointer to a Dictionary structure
+ * @param   word[in]      String containing the word
+ * @param   length[in]    Characters in the word
+ * @param   hash[in]      Hash of the word (see mr_word_hash)
+ * @param   count[in]     Occurrences to add
+ */
+void mr_dictionary_hash_add(Dictionary *dico, const char *word,
+                 unsigned int length, uint64_t hash, unsigned int count) {
+    Dictionary_hash *ext = dico->ext;
+    unsigned int mask = ext->mask;
+    unsigned int index = hash & mask;
+    Dictionary_hash_slot *slot = &ext->slots[index];
+
+    /* Probe until the word or a free slot is found */
+    while (slot->word != NULL) {
+        Word *dico_word = slot->word;
+
+        if (slot->hash == hash && mr_word_equal(dico_word, word, length)) {
+            dico_word->count += count;
+            return;
+        }
+
+        index = (index + 1) & mask;
+        slot = &ext->slots[index];
+    }
+
+    #if MAPREDUCE_USE_BUFFALLOC
+        Word *new_word = mr_word_create_buff_hashed(word, length, hash,
+                                                               ext->buffalloc);
+    #else
+        Word *new_word = mr_word_create(word);
+    #endif
+    new_word->count = count;
+    new_word->next = NULL;
+    slot->hash = hash;
+    slot->word = new_word;
+
+    if (++dico->nb_words > ext->max_words) _mr_dictionary_hash_resize(ext);
+}
+
+
+/**
+ * Look for a key made of several words (separated by a space in the
+ * dictionary) without building it.
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   parts[in]     Words of the key
+ * @param   lengths[in]   Characters in each word of the key
+ * @param   nb_parts[in]  Number of words in the key
+ * @param   length[in]    Characters in the key (spaces included)
+ * @param   hash[in]      Hash of the key (see mr_word_hash_key)
+ * @return  Pointer to the count of the key or NULL if not found
+ */
+unsigned int* mr_dictionary_hash_find(Dictionary *dico, const char **parts,
+                      const unsigned int *lengths, unsigned int nb_parts,
+                                       unsigned int length, uint64_t hash) {
+    Dictionary_hash *ext = dico->ext;
+    unsigned int mask = ext->mask;
+    unsigned int index = hash & mask;
+    Dictionary_hash_slot *slot = &ext->slots[index];
+
+    while (slot->word != NULL) {
+        Word *dico_word = slot->word;
+
+        if (slot->hash == hash && dico_word->length == length
+              && _mr_dictionary_equal_parts(dico_word->name, parts,
+                                                        lengths, nb_parts)) {
+            return &dico_word->count;
+        }
+
+        index = (index + 1) & mask;
+        slot = &ext->slots[index];
+    }
+
+    return NULL;
+}
+
+
+/**
+ * List all words in slot order (not sorted).
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   words[out]    Array of nb_words pointers to fill
+ */
+void mr_dictionary_hash_list(Dictionary *dico, Word **words) {
+    unsigned int i;
+    Dictionary_hash *ext = dico->ext;
+
+    for (i=0; i<=ext->mask; i++) {
+        if (ext->slots[i].word != NULL) *words++ = ext->slots[i].word;
+    }
+}
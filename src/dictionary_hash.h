@@ -0,0 +1,57 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_DICTIONARY_HASH_H
+    #define HEADER_MAPREDUCE_DICTIONARY_HASH_H
+
+    #include "dictionary.h"
+
+    /**
+     * @struct dictionary_hash_slot_s
+     * @brief  Slot of the open addressing table. The full hash is kept next
+     *         to the pointer so that probing rarely dereferences other words.
+     */
+    typedef struct dictionary_hash_slot_s {
+        uint64_t      hash;       /**<  Hash of the word (see mr_word_hash)   */
+        Word*         word;       /**<  Pointer to the word (NULL if free)    */
+    } Dictionary_hash_slot;
+
+
+    /**
+     * @struct dictionary_hash_s
+     * @brief  Structure containing extra data for dictionary_hash (words are
+     *         not ordered, they are sorted when listed).
+     */
+    typedef struct dictionary_hash_s {
+        Dictionary_hash_slot* slots;     /**<  Array of slots (power of 2)    */
+        unsigned int          mask;      /**<  Number of slots minus one      */
+        unsigned int          max_words; /**<  Words before the next resize   */
+        unsigned int          nb_resizes;/**<  Resizes [Profiling mode]       */
+        #if MAPREDUCE_USE_BUFFALLOC
+            Buffalloc*        buffalloc; /**<  Buffer to alloc words          */
+        #endif
+    } Dictionary_hash;
+
+
+    /* ============================== Prototypes ============================ */
+
+    Dictionary*    mr_dictionary_hash_create(const bool);
+    Dictionary*    mr_dictionary_hash_create_another(const Dictionary*);
+    void           mr_dictionary_hash_delete(Dictionary*);
+
+    void           mr_dictionary_hash_add(Dictionary*, const char*,
+                                     unsigned int, uint64_t, unsigned int);
+    unsigned int*  mr_dictionary_hash_find(Dictionary*, const char**,
+                  const unsigned int*, unsigned int, unsigned int, uint64_t);
+    void           mr_dictionary_hash_list(Dictionary*, Word**);
+#endif
@@ -0,0 +1,207 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file dictionary_partitioned.c
+ * @brief A dictionary made of several dictionaries of the same type, each
+ *        one holding the words of a range of hashes. Dictionaries of map
+ *        threads are partitioned the same way so that reduce merges each
+ *        partition independently (shuffle), in parallel and with a smaller
+ *        working set.
+ * @author Jean-Yves VET
+ */
+
+#include "dictionary_partitioned.h"
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Create a partitioned Dictionary. The first partition is provided, others
+ * are created with the same type.
+ *
+ * @param   first[in]          Pointer to an empty Dictionary (first partition)
+ * @param   nb_partitions[in]  Number of partitions
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary *mr_dictionary_partitioned_create(Dictionary *first,
+                                            const unsigned int nb_partitions) {
+    int i;
+    assert(first != NULL && nb_partitions > 0);
+    assert(first->nb_words == 0 && !first->shared);
+    Dictionary *dico = _mr_dictionary_common_create(DC_PARTITIONED,
+                                                            first->profiling);
+
+    /* Set function pointers */
+    dico->add = mr_dictionary_partitioned_add;
+    dico->find = mr_dictionary_partitioned_find;
+    dico->list = mr_dictionary_partitioned_list;
+    dico->flush = mr_dictionary_partitioned_flush;
+    dico->delete = mr_dictionary_partitioned_delete;
+    dico->create_another = mr_dictionary_partitioned_create_another;
+    dico->ordered = false;
+
+    Dictionary_partitioned *ext = malloc(sizeof(Dictionary_partitioned));
+    assert(ext != NULL);
+    dico->ext = ext;
+
+    ext->partitions = malloc(nb_partitions*sizeof(Dictionary*));
+    assert(ext->partitions != NULL);
+    ext->nb_partitions = nb_partitions;
+    ext->partitions[0] = first;
+
+    for (i=1; i<nb_partitions; i++) {
+        ext->partitions[i] = mr_dictionary_create_another(first);
+    }
+
+    return dico;
+}
+
+
+/**
+ * Constructor for the dictionaries of other threads, partitioned the same
+ * way as the first one.
+ *
+ * @param   first[in]   Pointer to the first Dictionary structure
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary* mr_dictionary_partitioned_create_another(const Dictionary *first) {
+    assert(first != NULL);
+    Dictionary_partitioned *first_ext = first->ext;
+
+    return mr_dictionary_partitioned_create(
+                        mr_dictionary_create_another(first_ext->partitions[0]),
+                                                     first_ext->nb_partitions);
+}
+
+
+/**
+ * Delete Dictionary with all partitions.
+ *
+ * @param   dico[in]   Pointer to the Dictionary structure
+ */
+void mr_dictionary_partitioned_delete(Dictionary *dico) {
+    int i;
+
+    if (dico != NULL) {
+        Dictionary_partitioned *ext = dico->ext;
+
+        /* Partitions were only filled through this dictionary */
+        for (i=0; i<ext->nb_partitions; i++) {
+            ext->partitions[i]->delete(ext->partitions[i]);
+        }
+
+        free(ext->partitions);
+        free(ext);
+        free(dico);
+    }
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Add number of occurrences to a Word structure in its partition. Add the
+ * word if it does not exist.
+ *
+ * @param   dico[inout]   Pointer to a Dictionary structure
+ * @param   word[in]      String containing the word
+ * @param   length[in]    Characters in the word
+ * @param   hash[in]      Hash of the word (see mr_word_hash)
+ * @param   count[in]     Occurrences to add
+ */
+void mr_dictionary_partitioned_add(Dictionary *dico, const char *word,
+                 unsigned int length, uint64_t hash, unsigned int count) {
+    Dictionary_partitioned *ext = dico->ext;
+    Dictionary *partition = ext->partitions[
+                      mr_dictionary_partitioned_index(hash, ext->nb_partitions)];
+    unsigned int nb_words = partition->nb_words;
+
+    partition->add(partition, word, length, hash, count);
+    dico->nb_words += partition->nb_words - nb_words;
+}
+
+
+/**
+ * Look for a key made of several words (separated by a space in the
+ * dictionary) in its partition.
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   parts[in]     Words of the key
+ * @param   lengths[in]   Characters in each word of the key
+ * @param   nb_parts[in]  Number of words in the key
+ * @param   length[in]    Characters in the key (spaces included)
+ * @param   hash[in]      Hash of the key (see mr_word_hash_key)
+ * @return  Pointer to the count of the key or NULL if not found
+ */
+unsigned int* mr_dictionary_partitioned_find(Dictionary *dico,
+                 const char **parts, const unsigned int *lengths,
+                 unsigned int nb_parts, unsigned int length, uint64_t hash) {
+    Dictionary_partitioned *ext = dico->ext;
+    Dictionary *partition = ext->partitions[
+                      mr_dictionary_partitioned_index(hash, ext->nb_partitions)];
+
+    return partition->find(partition, parts, lengths, nb_parts, length, hash);
+}
+
+
+/**
+ * List words of all partitions one after the other (not sorted).
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   words[out]    Array of nb_words pointers to fill
+ */
+void mr_dictionary_partitioned_list(Dictionary *dico, Word **words) {
+    int i;
+    Dictionary_partitioned *ext = dico->ext;
+
+    for (i=0; i<ext->nb_partitions; i++) {
+        Dictionary *partition = ext->partitions[i];
+
+        partition->list(partition, words);
+        words += partition->nb_words;
+    }
+}
+
+
+/**
+ * Count words again once partitions were filled directly (e.g. merged by
+ * reducers).
+ *
+ * @param   dico[inout]   Pointer to a Dictionary structure
+ */
+void mr_dictionary_partitioned_flush(Dictionary *dico) {
+    int i;
+    Dictionary_partitioned *ext = dico->ext;
+
+    dico->nb_words = 0;
+    for (i=0; i<ext->nb_partitions; i++) {
+        mr_dictionary_flush(ext->partitions[i]);
+        dico->nb_words += ext->partitions[i]->nb_words;
+    }
+}
+
+
+/**
+ * Get a partition.
+ *
+ * @param   dico[in]        Pointer to a Dictionary structure
+ * @param   partition[in]   Index of the partition
+ * @return  Pointer to the Dictionary of the partition
+ */
+Dictionary* mr_dictionary_partitioned_get(const Dictionary *dico,
+                                                const unsigned int partition) {
+    Dictionary_partitioned *ext = dico->ext;
+    assert(partition < ext->nb_partitions);
+
+    return ext->partitions[partition];
+}
@@ -0,0 +1,63 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_DICTIONARY_PARTITIONED_H
+    #define HEADER_MAPREDUCE_DICTIONARY_PARTITIONED_H
+
+    #include "dictionary.h"
+
+    /**
+     * @struct dictionary_partitioned_s
+     * @brief  Structure containing extra data for dictionary_partitioned.
+     *         Words are spread by hash among independent dictionaries, so
+     *         that partition r of several dictionaries may be merged by
+     *         reducer r without locks.
+     */
+    typedef struct dictionary_partitioned_s {
+        Dictionary**  partitions;    /**<  Dictionaries holding the words     */
+        unsigned int  nb_partitions; /**<  Number of partitions               */
+    } Dictionary_partitioned;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Partition of a word. Highest bits of the hash are used since the
+     * partitions index their words with the lowest ones.
+     *
+     * @param   hash[in]            Hash of the word (see mr_word_hash)
+     * @param   nb_partitions[in]   Number of partitions
+     * @return  Index of the partition
+     */
+    static inline unsigned int mr_dictionary_partitioned_index(uint64_t hash,
+                                           const unsigned int nb_partitions) {
+        return (unsigned int)(((hash >> 32) * nb_partitions) >> 32);
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Dictionary*    mr_dictionary_partitioned_create(Dictionary*,
+                                                           const unsigned int);
+    Dictionary*    mr_dictionary_partitioned_create_another(const Dictionary*);
+    void           mr_dictionary_partitioned_delete(Dictionary*);
+
+    void           mr_dictionary_partitioned_add(Dictionary*, const char*,
+                                     unsigned int, uint64_t, unsigned int);
+    unsigned int*  mr_dictionary_partitioned_find(Dictionary*, const char**,
+                  const unsigned int*, unsigned int, unsigned int, uint64_t);
+    void           mr_dictionary_partitioned_list(Dictionary*, Word**);
+    void           mr_dictionary_partitioned_flush(Dictionary*);
+    Dictionary*    mr_dictionary_partitioned_get(const Dictionary*,
+                                                           const unsigned int);
+#endif
@@ -0,0 +1,511 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file dictionary_shared.c
+ * @brief A dictionary shared by all map threads. Words are inserted in a
+ *        lock-free open addressing table with CAS on tagged slots, and counts
+ *        are incremented atomically. Counts of frequent words are first
+ *        accumulated in a small cache of each handle (one per thread) to
+ *        avoid bouncing their cache lines between cores. Words are only
+ *        sorted alphabetically when they are listed.
+ * @author Jean-Yves VET
+ */
+
+#include "dictionary_shared.h"
+
+static Dictionary* _mr_dictionary_shared_create_handle(
+                               Dictionary_shared_table*, const bool);
+static Dictionary_shared_level* _mr_dictionary_shared_level_create(
+                                                          const unsigned int);
+static void _mr_dictionary_shared_table_delete(Dictionary_shared_table*);
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Create a shared Dictionary and its first handle.
+ *
+ * @param   profiling[in]  Activate the profiling mode
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary *mr_dictionary_shared_create(const bool profiling) {
+    Dictionary_shared_table *table = malloc(sizeof(Dictionary_shared_table));
+    assert(table != NULL);
+
+    table->first = _mr_dictionary_shared_level_create(
+                                             MAPREDUCE_DC_SHARED_INITIAL_SIZE);
+    table->handles = NULL;
+    table->nb_handles = 0;
+    table->nb_words = 0;
+    table->nb_levels = 1;
+    table->profiling = profiling;
+
+    return _mr_dictionary_shared_create_handle(table, profiling);
+}
+
+
+/**
+ * Constructor for the handles of other threads on the same words. Handles
+ * shall be created before threads start putting words.
+ *
+ * @param   first[in]   Pointer to the first Dictionary structure
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary* mr_dictionary_shared_create_another(const Dictionary *first) {
+    assert(first != NULL);
+    Dictionary_shared *first_ext = first->ext;
+
+    return _mr_dictionary_shared_create_handle(first_ext->table,
+                                                            first->profiling);
+}
+
+
+/**
+ * Delete a handle. Words are deleted along with the last handle.
+ *
+ * @param   dico[in]   Pointer to the Dictionary structure
+ */
+void mr_dictionary_shared_delete(Dictionary *dico) {
+    if (dico != NULL) {
+        Dictionary_shared *ext = dico->ext;
+        Dictionary_shared_table *table = ext->table;
+
+        /* Handles hold words, they are freed with the table */
+        free(dico);
+
+        if (--table->nb_handles == 0) {
+            _mr_dictionary_shared_table_delete(table);
+        }
+    }
+}
+
+
+/* ============================= Private functions ========================== */
+
+/**
+ * Create a handle on a table.
+ *
+ * @param   table[inout]   Pointer to the shared table
+ * @param   profiling[in]  Activate the profiling mode
+ * @return  Pointer to the new Dictionary structure
+ */
+static Dictionary* _mr_dictionary_shared_create_handle(
+                   Dictionary_shared_table *table, const bool profiling) {
+    Dictionary *dico = _mr_dictionary_common_create(DC_SHARED, profiling);
+
+    /* Set function pointers */
+    dico->add = mr_dictionary_shared_add;
+    dico->find = mr_dictionary_shared_find;
+    dico->list = mr_dictionary_shared_list;
+    dico->flush = mr_dictionary_shared_flush;
+    dico->delete = mr_dictionary_shared_delete;
+    dico->create_another = mr_dictionary_shared_create_another;
+    dico->ordered = false;
+    dico->shared = true;
+
+    Dictionary_shared *ext = malloc(sizeof(Dictionary_shared));
+    assert(ext != NULL);
+    dico->ext = ext;
+
+    memset(ext->cache, 0, sizeof(ext->cache));
+    #if MAPREDUCE_USE_BUFFALLOC
+        ext->buffalloc = mr_buffalloc_create();
+    #endif
+
+    /* Register the handle */
+    ext->table = table;
+    ext->next = table->handles;
+    table->handles = ext;
+    table->nb_handles++;
+
+    return dico;
+}
+
+
+/**
+ * Create an empty level.
+ *
+ * @param   size[in]     Number of slots (power of 2)
+ * @return  Pointer to the new level
+ */
+static Dictionary_shared_level* _mr_dictionary_shared_level_create(
+                                                   const unsigned int size) {
+    Dictionary_shared_level *level = malloc(sizeof(Dictionary_shared_level));
+    assert(level != NULL);
+
+    level->slots = calloc(size, sizeof(uint64_t));
+    assert(level->slots != NULL);
+    level->mask = size - 1;
+    level->max_words = (uint64_t)size * MAPREDUCE_DC_SHARED_MAX_LOAD / 100;
+    level->nb_words = 0;
+    level->next = NULL;
+
+    return level;
+}
+
+
+/**
+ * Word pointed by a tagged slot.
+ *
+ * @param   slot[in]     Content of the slot (not 0)
+ * @return  Pointer to the Word structure
+ */
+static inline Word* _mr_dictionary_shared_word(uint64_t slot) {
+    return (Word *)(uintptr_t)(slot & ~DICTIONARY_SHARED_TAG_MASK);
+}
+
+
+/**
+ * Delete levels and words once all handles are deleted.
+ *
+ * @param   table[in]   Pointer to the shared table
+ */
+static void _mr_dictionary_shared_table_delete(
+                                             Dictionary_shared_table *table) {
+    Dictionary_shared_level *level = table->first;
+
+    /* Display table details [Profiling mode] */
+    if (table->profiling) {
+        #if MAPREDUCE_DEFAULT_USECOLORS
+            printf("\e[34m |-[Dictionary] shared:\e[1m %u words, %u slots "
+                   "(%u levels)\e[0m\n", table->nb_words, level->mask + 1,
+                                                            table->nb_levels);
+        #else
+            printf(" |-[Dictionary] shared: %u words, %u slots (%u levels)\n",
+                   table->nb_words, level->mask + 1, table->nb_levels);
+        #endif
+    }
+
+    while (level != NULL) {
+        Dictionary_shared_level *next = level->next;
+
+        #if !MAPREDUCE_USE_BUFFALLOC
+            unsigned int i;
+            for (i=0; i<=level->mask; i++) {
+                if (level->slots[i]) {
+                    Word *word = _mr_dictionary_shared_word(level->slots[i]);
+                    mr_word_delete(&word);
+                }
+            }
+        #endif
+
+        free(level->slots);
+        free(level);
+        level = next;
+    }
+
+    while (table->handles != NULL) {
+        Dictionary_shared *ext = table->handles;
+        table->handles = ext->next;
+
+        #if MAPREDUCE_USE_BUFFALLOC
+            mr_buffalloc_delete(&ext->buffalloc);
+        #endif
+        free(ext);
+    }
+
+    free(table);
+}
+
+
+/**
+ * Link a larger level after a level which reached its load factor. Only the
+ * thread which inserted the last allowed word does it.
+ *
+ * @param   table[inout]  Pointer to the shared table
+ * @param   level[inout]  Pointer to the full level
+ */
+static void _mr_dictionary_shared_grow(Dictionary_shared_table *table,
+                                            Dictionary_shared_level *level) {
+    Dictionary_shared_level *expected = NULL;
+    Dictionary_shared_level *next = _mr_dictionary_shared_level_create(
+                             (level->mask + 1) * MAPREDUCE_DC_SHARED_GROWTH);
+
+    if (__atomic_compare_exchange_n(&level->next, &expected, next, false,
+                                       __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(&table->nb_levels, 1, __ATOMIC_RELAXED);
+    } else {
+        free(next->slots);
+        free(next);
+    }
+}
+
+
+/**
+ * Look for a word in the table and insert it (with no occurrence) if it
+ * does not exist. Levels are searched in order, and new words are only
+ * inserted in the last one. A word may thus be inserted in two levels by
+ * concurrent threads, such duplicates are summed when flushing.
+ *
+ * @param   ext[inout]    Pointer to the handle of the thread
+ * @param   word[in]      String containing the word
+ * @param   length[in]    Characters in the word
+ * @param   hash[in]      Hash of the word (see mr_word_hash)
+ * @return  Pointer to the Word structure
+ */
+static Word* _mr_dictionary_shared_get(Dictionary_shared *ext,
+                   const char *word, unsigned int length, uint64_t hash) {
+    Dictionary_shared_table *table = ext->table;
+    Dictionary_shared_level *level = table->first;
+    uint64_t tag = hash & DICTIONARY_SHARED_TAG_MASK;
+    Word *new_word = NULL;
+
+    for (;;) {
+        unsigned int mask = level->mask;
+        unsigned int index = hash & mask;
+        Dictionary_shared_level *next = NULL;
+
+        while (next == NULL) {
+            uint64_t slot = __atomic_load_n(&level->slots[index],
+                                                           __ATOMIC_ACQUIRE);
+
+            if (slot == 0) {
+                /* New words only go to the last level */
+                next = __atomic_load_n(&level->next, __ATOMIC_ACQUIRE);
+                if (next != NULL) break;
+
+                if (new_word == NULL) {
+                    #if MAPREDUCE_USE_BUFFALLOC
+                        new_word = mr_word_create_buff_hashed(word, length,
+                                                       hash, ext->buffalloc);
+                    #else
+                        new_word = mr_word_create(word);
+                    #endif
+                    new_word->count = 0;
+                    new_word->next = NULL;
+                    assert(((uintptr_t)new_word & DICTIONARY_SHARED_TAG_MASK)
+                                                                        == 0);
+                }
+
+                if (__atomic_compare_exchange_n(&level->slots[index], &slot,
+                                     tag | (uintptr_t)new_word, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                    __atomic_fetch_add(&table->nb_words, 1, __ATOMIC_RELAXED);
+                    if (__atomic_add_fetch(&level->nb_words, 1,
+                                  __ATOMIC_RELAXED) == level->max_words) {
+                        _mr_dictionary_shared_grow(table, level);
+                    }
+                    return new_word;
+                }
+
+                /* Another thread took the slot first, check its word */
+            }
+
+            if ((slot & DICTIONARY_SHARED_TAG_MASK) == tag) {
+                Word *dico_word = _mr_dictionary_shared_word(slot);
+
+                if (dico_word->hash == hash
+                                 && mr_word_equal(dico_word, word, length)) {
+                    #if !MAPREDUCE_USE_BUFFALLOC
+                        if (new_word != NULL) mr_word_delete(&new_word);
+                    #endif
+                    return dico_word;
+                }
+            }
+
+            index = (index + 1) & mask;
+        }
+
+        level = next;
+    }
+}
+
+
+/**
+ * Move words of all levels to a single one. Duplicates are summed.
+ *
+ * @param   table[inout]   Pointer to the shared table
+ */
+static void _mr_dictionary_shared_rebuild(Dictionary_shared_table *table) {
+    unsigned int i, size = MAPREDUCE_DC_SHARED_INITIAL_SIZE;
+    Dictionary_shared_level *old = table->first;
+
+    while ((uint64_t)size * MAPREDUCE_DC_SHARED_MAX_LOAD / 100
+                                               <= table->nb_words) size *= 2;
+
+    Dictionary_shared_level *level = _mr_dictionary_shared_level_create(size);
+
+    while (old != NULL) {
+        Dictionary_shared_level *next = old->next;
+
+        for (i=0; i<=old->mask; i++) {
+            uint64_t slot = old->slots[i];
+            if (slot == 0) continue;
+
+            Word *word = _mr_dictionary_shared_word(slot);
+            unsigned int index = word->hash & level->mask;
+
+            while (level->slots[index]) {
+                Word *dico_word = _mr_dictionary_shared_word(
+                                                       level->slots[index]);
+
+                if (dico_word->hash == word->hash
+                               && mr_word_equal(dico_word, word->name,
+                                                           word->length)) {
+                    dico_word->count += word->count;
+                    #if !MAPREDUCE_USE_BUFFALLOC
+                        mr_word_delete(&word);
+                    #endif
+                    word = NULL;
+                    break;
+                }
+
+                index = (index + 1) & level->mask;
+            }
+
+            if (word != NULL) {
+                level->slots[index] = slot;
+                level->nb_words++;
+            }
+        }
+
+        free(old->slots);
+        free(old);
+        old = next;
+    }
+
+    table->first = level;
+    table->nb_words = level->nb_words;
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Add number of occurrences to a Word structure in a Dictionary. Add the word
+ * if it does not exist. Occurrences of the words cached by the handle are
+ * only added to the Word structure once the word leaves the cache or when
+ * flushing.
+ *
+ * @param   dico[inout]   Pointer to the handle of the thread
+ * @param   word[in]      String containing the word
+ * @param   length[in]    Characters in the word
+ * @param   hash[in]      Hash of the word (see mr_word_hash)
+ * @param   count[in]     Occurrences to add
+ */
+void mr_dictionary_shared_add(Dictionary *dico, const char *word,
+                 unsigned int length, uint64_t hash, unsigned int count) {
+    Dictionary_shared *ext = dico->ext;
+    Dictionary_shared_cache *cache = &ext->cache[(hash >> 32)
+                                        & (MAPREDUCE_DC_SHARED_CACHE_SIZE-1)];
+    Word *cached = cache->word;
+
+    if (cached != NULL && cached->hash == hash
+                                    && mr_word_equal(cached, word, length)) {
+        cache->count += count;
+        return;
+    }
+
+    if (cached != NULL) {
+        __atomic_fetch_add(&cached->count, cache->count, __ATOMIC_RELAXED);
+    }
+
+    cache->word = _mr_dictionary_shared_get(ext, word, length, hash);
+    cache->count = count;
+}
+
+
+/**
+ * Look for a key made of several words (separated by a space in the
+ * dictionary) without building it.
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   parts[in]     Words of the key
+ * @param   lengths[in]   Characters in each word of the key
+ * @param   nb_parts[in]  Number of words in the key
+ * @param   length[in]    Characters in the key (spaces included)
+ * @param   hash[in]      Hash of the key (see mr_word_hash_key)
+ * @return  Pointer to the count of the key or NULL if not found
+ */
+unsigned int* mr_dictionary_shared_find(Dictionary *dico, const char **parts,
+                      const unsigned int *lengths, unsigned int nb_parts,
+                                       unsigned int length, uint64_t hash) {
+    Dictionary_shared *ext = dico->ext;
+    Dictionary_shared_level *level = ext->table->first;
+    uint64_t tag = hash & DICTIONARY_SHARED_TAG_MASK;
+
+    while (level != NULL) {
+        unsigned int mask = level->mask;
+        unsigned int index = hash & mask;
+        uint64_t slot;
+
+        while ((slot = __atomic_load_n(&level->slots[index],
+                                                     __ATOMIC_ACQUIRE))) {
+            if ((slot & DICTIONARY_SHARED_TAG_MASK) == tag) {
+                Word *dico_word = _mr_dictionary_shared_word(slot);
+
+                if (dico_word->hash == hash && dico_word->length == length
+                      && _mr_dictionary_equal_parts(dico_word->name, parts,
+                                                        lengths, nb_parts)) {
+                    return &dico_word->count;
+                }
+            }
+
+            index = (index + 1) & mask;
+        }
+
+        level = __atomic_load_n(&level->next, __ATOMIC_ACQUIRE);
+    }
+
+    return NULL;
+}
+
+
+/**
+ * List all words in slot order (not sorted). The dictionary shall be
+ * flushed first.
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   words[out]    Array of nb_words pointers to fill
+ */
+void mr_dictionary_shared_list(Dictionary *dico, Word **words) {
+    unsigned int i;
+    Dictionary_shared *ext = dico->ext;
+    Dictionary_shared_level *level = ext->table->first;
+
+    for (i=0; i<=level->mask; i++) {
+        if (level->slots[i]) {
+            *words++ = _mr_dictionary_shared_word(level->slots[i]);
+        }
+    }
+}
+
+
+/**
+ * Add counts cached by all handles to the words, and move words to a single
+ * level. Threads shall not put words anymore.
+ *
+ * @param   dico[inout]   Pointer to a Dictionary structure
+ */
+void mr_dictionary_shared_flush(Dictionary *dico) {
+    int i;
+    Dictionary_shared *ext = dico->ext;
+    Dictionary_shared_table *table = ext->table;
+    Dictionary_shared *handle;
+
+    for (handle = table->handles; handle != NULL; handle = handle->next) {
+        for (i=0; i<MAPREDUCE_DC_SHARED_CACHE_SIZE; i++) {
+            Dictionary_shared_cache *cache = &handle->cache[i];
+
+            if (cache->word != NULL) {
+                cache->word->count += cache->count;
+                cache->word = NULL;
+                cache->count = 0;
+            }
+        }
+    }
+
+    if (table->first->next != NULL) _mr_dictionary_shared_rebuild(table);
+
+    dico->nb_words = table->nb_words;
+}
@@ -0,0 +1,94 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_DICTIONARY_SHARED_H
+    #define HEADER_MAPREDUCE_DICTIONARY_SHARED_H
+
+    #include "dictionary.h"
+
+    /* Slots hold pointers to words tagged with the 16 highest bits of their
+       hash (user space pointers fit in 48 bits) */
+    #define DICTIONARY_SHARED_TAG_MASK  0xffff000000000000ULL
+
+    /**
+     * @struct dictionary_shared_level_s
+     * @brief  Open addressing table (linear probing) filled with CAS. Once a
+     *         level reaches its load factor, a larger one is linked after it
+     *         and new words go there.
+     */
+    typedef struct dictionary_shared_level_s {
+        uint64_t*     slots;       /**<  Tagged words (0 if the slot is free) */
+        unsigned int  mask;        /**<  Number of slots minus one            */
+        unsigned int  max_words;   /**<  Words before the next level          */
+        unsigned int  nb_words;    /**<  Words in the level (atomic)          */
+        struct dictionary_shared_level_s* next; /**< Next level (or NULL)     */
+    } Dictionary_shared_level;
+
+
+    /**
+     * @struct dictionary_shared_cache_s
+     * @brief  Entry of the per-thread cache of counts for frequent words.
+     */
+    typedef struct dictionary_shared_cache_s {
+        Word*         word;        /**<  Pointer to the word (or NULL)        */
+        unsigned int  count;       /**<  Occurrences not yet in the word      */
+    } Dictionary_shared_cache;
+
+
+    typedef struct dictionary_shared_s Dictionary_shared;
+
+    /**
+     * @struct dictionary_shared_table_s
+     * @brief  Words shared by all handles.
+     */
+    typedef struct dictionary_shared_table_s {
+        Dictionary_shared_level* first;  /**<  First level                    */
+        Dictionary_shared*  handles;     /**<  Handles on the table           */
+        unsigned int        nb_handles;  /**<  Handles not yet deleted        */
+        unsigned int        nb_words;    /**<  Words in all levels (atomic)   */
+        unsigned int        nb_levels;   /**<  Levels created [Profiling mode]*/
+        bool                profiling;   /**<  Profiling mode                 */
+    } Dictionary_shared_table;
+
+
+    /**
+     * @struct dictionary_shared_s
+     * @brief  Structure containing extra data for dictionary_shared. Each
+     *         thread puts words through its own handle: words are allocated
+     *         in its own buffer and counts of frequent words are cached
+     *         there, so that threads rarely write the same cache lines.
+     */
+    struct dictionary_shared_s {
+        Dictionary_shared_table* table;  /**<  Shared table                   */
+        Dictionary_shared*  next;        /**<  Next handle on the table       */
+        #if MAPREDUCE_USE_BUFFALLOC
+            Buffalloc*      buffalloc;   /**<  Buffer to alloc words          */
+        #endif
+        Dictionary_shared_cache cache[MAPREDUCE_DC_SHARED_CACHE_SIZE];
+                                         /**<  Counts of frequent words       */
+    };
+
+
+    /* ============================== Prototypes ============================ */
+
+    Dictionary*    mr_dictionary_shared_create(const bool);
+    Dictionary*    mr_dictionary_shared_create_another(const Dictionary*);
+    void           mr_dictionary_shared_delete(Dictionary*);
+
+    void           mr_dictionary_shared_add(Dictionary*, const char*,
+                                     unsigned int, uint64_t, unsigned int);
+    unsigned int*  mr_dictionary_shared_find(Dictionary*, const char**,
+                  const unsigned int*, unsigned int, unsigned int, uint64_t);
+    void           mr_dictionary_shared_list(Dictionary*, Word**);
+    void           mr_dictionary_shared_flush(Dictionary*);
+#endif
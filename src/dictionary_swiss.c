@@ -0,0 +1,319 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file dictionary_swiss.c
+ * @brief A dictionary based on an open addressing hash table with a separate
+ *        array of control bytes (Swiss table). The 7 lowest bits of the hash
+ *        of words are kept as fingerprints in control bytes, so that a whole
+ *        group of slots is probed with one SIMD compare and words are only
+ *        compared on fingerprint hits. Words are only sorted alphabetically
+ *        when they are listed.
+ * @author Jean-Yves VET
+ */
+
+#include "dictionary_swiss.h"
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Allocate slots and control bytes (all slots are free).
+ *
+ * @param   ext[inout]   Pointer to the Dictionary_swiss structure
+ * @param   size[in]     Number of slots (power of 2, at least a group)
+ */
+static void _mr_dictionary_swiss_alloc(Dictionary_swiss *ext,
+                                                       unsigned int size) {
+    ext->ctrl = malloc(size + DICTIONARY_SWISS_GROUP);
+    assert(ext->ctrl != NULL);
+    memset(ext->ctrl, DICTIONARY_SWISS_EMPTY, size + DICTIONARY_SWISS_GROUP);
+
+    ext->words = malloc(size*sizeof(Word*));
+    assert(ext->words != NULL);
+
+    ext->mask = size - 1;
+    ext->max_words = (uint64_t)size * MAPREDUCE_DC_SWISS_MAX_LOAD / 100;
+}
+
+
+/**
+ * Create a Dictionary based on a Swiss table.
+ *
+ * @param   profiling[in]  Activate the profiling mode
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary *mr_dictionary_swiss_create(const bool profiling) {
+    Dictionary *dico = _mr_dictionary_common_create(DC_SWISS, profiling);
+
+    /* Set function pointers */
+    dico->add = mr_dictionary_swiss_add;
+    dico->find = mr_dictionary_swiss_find;
+    dico->list = mr_dictionary_swiss_list;
+    dico->delete = mr_dictionary_swiss_delete;
+    dico->create_another = mr_dictionary_swiss_create_another;
+    dico->ordered = false;
+
+    Dictionary_swiss *ext = malloc(sizeof(Dictionary_swiss));
+    assert(ext != NULL);
+    dico->ext = ext;
+
+    _mr_dictionary_swiss_alloc(ext, MAPREDUCE_DC_SWISS_INITIAL_SIZE);
+    ext->nb_resizes = 0;
+
+    #if MAPREDUCE_USE_BUFFALLOC
+        ext->buffalloc = mr_buffalloc_create();
+    #endif
+
+    return dico;
+}
+
+
+/**
+ * Constructor for the dictionaries of other threads (independent ones).
+ *
+ * @param   first[in]   Pointer to the first Dictionary structure
+ * @return  Pointer to the new Dictionary structure
+ */
+Dictionary* mr_dictionary_swiss_create_another(const Dictionary *first) {
+    return mr_dictionary_swiss_create(first->profiling);
+}
+
+
+/**
+ * Delete Dictionary with all associated words.
+ *
+ * @param   dico[in]   Pointer to the Dictionary structure
+ */
+void mr_dictionary_swiss_delete(Dictionary *dico) {
+    if (dico != NULL) {
+        Dictionary_swiss *ext = dico->ext;
+
+        /* Display table details [Profiling mode] */
+        if (dico->profiling) {
+            #if MAPREDUCE_DEFAULT_USECOLORS
+                printf("\e[34m |-[Dictionary] swiss:\e[1m %u words, %u slots "
+                       "(%u-slot groups, %u resizes)\e[0m\n", dico->nb_words,
+                       ext->mask + 1, DICTIONARY_SWISS_GROUP, ext->nb_resizes);
+            #else
+                printf(" |-[Dictionary] swiss: %u words, %u slots (%u-slot "
+                       "groups, %u resizes)\n", dico->nb_words, ext->mask + 1,
+                                    DICTIONARY_SWISS_GROUP, ext->nb_resizes);
+            #endif
+        }
+
+        /* Delete all words */
+        #if MAPREDUCE_USE_BUFFALLOC
+            mr_buffalloc_delete(&ext->buffalloc);
+        #else
+            unsigned int i;
+            for (i=0; i<=ext->mask; i++) {
+                if (ext->ctrl[i] != DICTIONARY_SWISS_EMPTY) {
+                    mr_word_delete(&ext->words[i]);
+                }
+            }
+        #endif
+
+        /* Delete dictionary structure */
+        free(ext->ctrl);
+        free(ext->words);
+        free(ext);
+        free(dico);
+    }
+}
+
+
+/* ============================= Private functions ========================== */
+
+/**
+ * Fill a free slot (and the copy of its control byte when it belongs to the
+ * first group).
+ *
+ * @param   ext[inout]   Pointer to the Dictionary_swiss structure
+ * @param   index[in]    Index of the free slot
+ * @param   word[in]     Pointer to the Word structure
+ */
+static inline void _mr_dictionary_swiss_set(Dictionary_swiss *ext,
+                                           unsigned int index, Word *word) {
+    uint8_t h2 = word->hash & 0x7f;
+
+    ext->ctrl[index] = h2;
+    if (index < DICTIONARY_SWISS_GROUP) ext->ctrl[ext->mask + 1 + index] = h2;
+    ext->words[index] = word;
+}
+
+
+/**
+ * Look for the first free slot on the probe sequence of a hash.
+ *
+ * @param   ext[in]    Pointer to the Dictionary_swiss structure
+ * @param   hash[in]   Hash of the word (see mr_word_hash)
+ * @return  Index of the free slot
+ */
+static inline unsigned int _mr_dictionary_swiss_free(Dictionary_swiss *ext,
+                                                             uint64_t hash) {
+    unsigned int mask = ext->mask;
+    unsigned int pos = (hash >> 7) & mask;
+    Dictionary_swiss_mask empty;
+
+    while (!(empty = _mr_dictionary_swiss_empty(&ext->ctrl[pos]))) {
+        pos = (pos + DICTIONARY_SWISS_GROUP) & mask;
+    }
+
+    return (pos + _mr_dictionary_swiss_first(empty)) & mask;
+}
+
+
+/**
+ * Double the number of slots. Words are moved according to their stored
+ * hash, so keys are neither hashed nor compared again.
+ *
+ * @param   ext[inout]   Pointer to the Dictionary_swiss structure
+ */
+static void _mr_dictionary_swiss_resize(Dictionary_swiss *ext) {
+    unsigned int i, size = ext->mask + 1;
+    uint8_t *ctrl = ext->ctrl;
+    Word **words = ext->words;
+
+    _mr_dictionary_swiss_alloc(ext, 2*size);
+
+    for (i=0; i<size; i++) {
+        if (ctrl[i] != DICTIONARY_SWISS_EMPTY) {
+            Word *word = words[i];
+            _mr_dictionary_swiss_set(ext,
+                              _mr_dictionary_swiss_free(ext, word->hash), word);
+        }
+    }
+
+    free(ctrl);
+    free(words);
+    ext->nb_resizes++;
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Add number of occurrences to a Word structure in a Dictionary. Add the word
+ * if it does not exist. Words are never removed, so the word is absent once
+ * a group with a free slot is reached.
+ *
+ * @param   dico[inout]   Pointer to a Dictionary structure
+ * @param   word[in]      String containing the word
+ * @param   length[in]    Characters in the word
+ * @param   hash[in]      Hash of the word (see mr_word_hash)
+ * @param   count[in]     Occurrences to add
+ */
+void mr_dictionary_swiss_add(Dictionary *dico, const char *word,
+                 unsigned int length, uint64_t hash, unsigned int count) {
+    Dictionary_swiss *ext = dico->ext;
+    unsigned int mask = ext->mask;
+    unsigned int pos = (hash >> 7) & mask;
+    uint8_t h2 = hash & 0x7f;
+    Dictionary_swiss_mask match, empty;
+
+    for (;;) {
+        const uint8_t *ctrl = &ext->ctrl[pos];
+
+        /* Compare words on fingerprint hits only */
+        for (match = _mr_dictionary_swiss_match(ctrl, h2); match;
+                                                         match &= match - 1) {
+            unsigned int index = (pos + _mr_dictionary_swiss_first(match))
+                                                                       & mask;
+            Word *dico_word = ext->words[index];
+
+            if (dico_word->hash == hash
+                                 && mr_word_equal(dico_word, word, length)) {
+                dico_word->count += count;
+                return;
+            }
+        }
+
+        empty = _mr_dictionary_swiss_empty(ctrl);
+        if (empty) break;
+
+        pos = (pos + DICTIONARY_SWISS_GROUP) & mask;
+    }
+
+    #if MAPREDUCE_USE_BUFFALLOC
+        Word *new_word = mr_word_create_buff_hashed(word, length, hash,
+                                                               ext->buffalloc);
+    #else
+        Word *new_word = mr_word_create(word);
+    #endif
+    new_word->count = count;
+    new_word->next = NULL;
+    _mr_dictionary_swiss_set(ext, (pos + _mr_dictionary_swiss_first(empty))
+                                                           & mask, new_word);
+
+    if (++dico->nb_words > ext->max_words) _mr_dictionary_swiss_resize(ext);
+}
+
+
+/**
+ * Look for a key made of several words (separated by a space in the
+ * dictionary) without building it.
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   parts[in]     Words of the key
+ * @param   lengths[in]   Characters in each word of the key
+ * @param   nb_parts[in]  Number of words in the key
+ * @param   length[in]    Characters in the key (spaces included)
+ * @param   hash[in]      Hash of the key (see mr_word_hash_key)
+ * @return  Pointer to the count of the key or NULL if not found
+ */
+unsigned int* mr_dictionary_swiss_find(Dictionary *dico, const char **parts,
+                      const unsigned int *lengths, unsigned int nb_parts,
+                                       unsigned int length, uint64_t hash) {
+    Dictionary_swiss *ext = dico->ext;
+    unsigned int mask = ext->mask;
+    unsigned int pos = (hash >> 7) & mask;
+    uint8_t h2 = hash & 0x7f;
+    Dictionary_swiss_mask match;
+
+    for (;;) {
+        const uint8_t *ctrl = &ext->ctrl[pos];
+
+        for (match = _mr_dictionary_swiss_match(ctrl, h2); match;
+                                                         match &= match - 1) {
+            unsigned int index = (pos + _mr_dictionary_swiss_first(match))
+                                                                       & mask;
+            Word *dico_word = ext->words[index];
+
+            if (dico_word->hash == hash && dico_word->length == length
+                  && _mr_dictionary_equal_parts(dico_word->name, parts,
+                                                        lengths, nb_parts)) {
+                return &dico_word->count;
+            }
+        }
+
+        if (_mr_dictionary_swiss_empty(ctrl)) return NULL;
+
+        pos = (pos + DICTIONARY_SWISS_GROUP) & mask;
+    }
+}
+
+
+/**
+ * List all words in slot order (not sorted).
+ *
+ * @param   dico[in]      Pointer to a Dictionary structure
+ * @param   words[out]    Array of nb_words pointers to fill
+ */
+void mr_dictionary_swiss_list(Dictionary *dico, Word **words) {
+    unsigned int i;
+    Dictionary_swiss *ext = dico->ext;
+
+    for (i=0; i<=ext->mask; i++) {
+        if (ext->ctrl[i] != DICTIONARY_SWISS_EMPTY) *words++ = ext->words[i];
+    }
+}
@@ -0,0 +1,136 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_DICTIONARY_SWISS_H
+    #define HEADER_MAPREDUCE_DICTIONARY_SWISS_H
+
+    #include "dictionary.h"
+
+    #if defined(__AVX2__) || defined(__SSE2__)
+        #include <immintrin.h>
+    #endif
+
+    #define DICTIONARY_SWISS_EMPTY 0x80
+
+    /* Slots probed at once: one control byte per slot is compared to the
+       fingerprint with a single instruction (AVX2, SSE2 or 64-bit words) */
+    #if defined(__AVX2__)
+        #define DICTIONARY_SWISS_GROUP 32
+        #define DICTIONARY_SWISS_SHIFT 0
+        typedef uint32_t Dictionary_swiss_mask;
+    #elif defined(__SSE2__)
+        #define DICTIONARY_SWISS_GROUP 16
+        #define DICTIONARY_SWISS_SHIFT 0
+        typedef uint32_t Dictionary_swiss_mask;
+    #else
+        #define DICTIONARY_SWISS_GROUP 8
+        #define DICTIONARY_SWISS_SHIFT 3
+        typedef uint64_t Dictionary_swiss_mask;
+    #endif
+
+    /**
+     * @struct dictionary_swiss_s
+     * @brief  Structure containing extra data for dictionary_swiss. Each slot
+     *         has a control byte: DICTIONARY_SWISS_EMPTY or the 7-bit
+     *         fingerprint of its word. The first group of control bytes is
+     *         copied after the last one so that any group can be loaded at
+     *         once. Words are not ordered, they are sorted when listed.
+     */
+    typedef struct dictionary_swiss_s {
+        uint8_t*      ctrl;       /**<  Control bytes (size + group)         */
+        Word**        words;      /**<  Array of words (power of 2)          */
+        unsigned int  mask;       /**<  Number of slots minus one            */
+        unsigned int  max_words;  /**<  Words before the next resize         */
+        unsigned int  nb_resizes; /**<  Resizes [Profiling mode]             */
+        #if MAPREDUCE_USE_BUFFALLOC
+            Buffalloc* buffalloc; /**<  Buffer to alloc words                */
+        #endif
+    } Dictionary_swiss;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Find control bytes equal to a fingerprint in the group starting at a
+     * given slot.
+     *
+     * @param   ctrl[in]    Control bytes of the group
+     * @param   h2[in]      Fingerprint (or DICTIONARY_SWISS_EMPTY)
+     * @return  Mask with one bit per matching slot (see
+     *          _mr_dictionary_swiss_first). Without SIMD, a few slots next to a
+     *          match may be reported too.
+     */
+    static inline Dictionary_swiss_mask _mr_dictionary_swiss_match(
+                                          const uint8_t *ctrl, uint8_t h2) {
+        #if defined(__AVX2__)
+            __m256i group = _mm256_loadu_si256((const __m256i *)ctrl);
+            return _mm256_movemask_epi8(_mm256_cmpeq_epi8(group,
+                                                    _mm256_set1_epi8(h2)));
+        #elif defined(__SSE2__)
+            __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(h2)));
+        #else
+            uint64_t group;
+            memcpy(&group, ctrl, sizeof(group));
+            group ^= 0x0101010101010101ULL * h2;
+            return (group - 0x0101010101010101ULL) & ~group
+                                                   & 0x8080808080808080ULL;
+        #endif
+    }
+
+
+    /**
+     * Find free slots in the group starting at a given slot.
+     *
+     * @param   ctrl[in]    Control bytes of the group
+     * @return  Mask with one bit per free slot
+     */
+    static inline Dictionary_swiss_mask _mr_dictionary_swiss_empty(
+                                                        const uint8_t *ctrl) {
+        #if defined(__AVX2__)
+            return _mm256_movemask_epi8(_mm256_loadu_si256(
+                                                     (const __m256i *)ctrl));
+        #elif defined(__SSE2__)
+            return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+        #else
+            uint64_t group;
+            memcpy(&group, ctrl, sizeof(group));
+            return group & 0x8080808080808080ULL;
+        #endif
+    }
+
+
+    /**
+     * Position in the group of the first slot of a mask.
+     *
+     * @param   mask[in]    Mask returned by a match (not 0)
+     * @return  Position of the slot in the group
+     */
+    static inline unsigned int _mr_dictionary_swiss_first(
+                                               Dictionary_swiss_mask mask) {
+        return __builtin_ctzll(mask) >> DICTIONARY_SWISS_SHIFT;
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Dictionary*    mr_dictionary_swiss_create(const bool);
+    Dictionary*    mr_dictionary_swiss_create_another(const Dictionary*);
+    void           mr_dictionary_swiss_delete(Dictionary*);
+
+    void           mr_dictionary_swiss_add(Dictionary*, const char*,
+                                     unsigned int, uint64_t, unsigned int);
+    unsigned int*  mr_dictionary_swiss_find(Dictionary*, const char**,
+                  const unsigned int*, unsigned int, unsigned int, uint64_t);
+    void           mr_dictionary_swiss_list(Dictionary*, Word**);
+#endif
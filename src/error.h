@@ -22,6 +22,10 @@
         ERR_MAXTHREADS,         /* Too many threads              */
         ERR_FILEACCESS,         /* File cannot be accessed       */
         ERR_MEMALLOC,           /* Allocation error.             */
+        ERR_PATTERN,            /* Invalid token filter pattern  */
+        ERR_SEGMENT,            /* Invalid binary dictionary     */
+        ERR_FILEWRITE,          /* File cannot be written        */
+        ERR_COUNTOVERFLOW,      /* Count too large to be merged  */
         ERR_LAST                /* Number of errors.             */
     } err_code;
 
@@ -32,6 +36,10 @@
         "You should start the program with fewer threads (maximum reached)",
         "File does not exist or cannot be accessed in read mode",
         "Allocation error",
+        "Invalid token filter pattern (or too many DFA states)",
+        "File is not a valid binary dictionary",
+        "File cannot be created or written",
+        "Count of a binary dictionary is too large to be merged",
     };
 
 
@@ -25,6 +25,7 @@
      */
     struct filereader_s {
         int         (*get_byte)();       /**<  Pointer to impl. of get_byte   */
+        unsigned int (*get_block)();     /**<  Pointer to impl. of get_block  */
         void        (*set_offsets)();    /**<  Pointer to impl. of set_offsets*/
         void        (*delete)();         /**<  Pointer to impl. of delete     */
         Filereader* (*create_another)(); /**<  Pointer to impl. create_another*/
@@ -101,6 +102,22 @@
     }
 
 
+    /**
+     * Get the next bytes from a filereader without copying them. The block
+     * stops at the end of the range (stop-offset included), at the end of
+     * the file, or at the end of the internal buffer of the reader. Static
+     * inline definition to improve calling performance.
+     *
+     * @param   fr[in]          Pointer to the Filereader structure
+     * @param   block[out]      Pointer to the first byte of the block
+     * @return  Number of bytes in the block (0 once the range is over)
+     */
+    static inline unsigned int mr_filereader_get_block(Filereader *fr,
+                                                         const char **block) {
+        return fr->get_block(fr, block);
+    }
+
+
     /* ============================== Prototypes ============================ */
 
     Filereader*  mr_filereader_create_first(const char*, const fr_type,
@@ -116,6 +116,7 @@ Filereader* _mr_filereader_mmap_create(const char *file_path,
     fr->create_another = mr_filereader_mmap_create_another;
     fr->delete = mr_filereader_mmap_delete;
     fr->get_byte = mr_filereader_mmap_get_byte;
+    fr->get_block = mr_filereader_mmap_get_block;
     fr->set_offsets = mr_filereader_mmap_set_offsets;
 
     /* Alloc and initialize mmap extra data */
@@ -160,24 +161,32 @@ void mr_filereader_mmap_set_offsets(Filereader *fr, long long start_offset,
  *          was reached, or the postion (>0) of the byte in the next area.
  */
 int mr_filereader_mmap_get_byte(Filereader *fr, char *buffer) {
-    long long offset = fr->offset;
-    long long file_size = fr->file_size;
+    return _mr_filereader_mmap_get_byte(fr, buffer);
+}
 
-    if (offset < file_size) {
-        long long stop_offset = fr->stop_offset;
-        Filereader_mmap *ext = fr->ext;
-        char *shared_map = ext->shared_map;
 
-        /* Retrieve byte */
-        char val = shared_map[offset];
-        buffer[0] = val;
+/**
+ * Get the next bytes of the range directly from the shared map.
+ *
+ * @param   fr[in]               Pointer to the Filereader structure
+ * @param   block[out]           Pointer to the first byte of the block
+ * @return  Number of bytes in the block (0 once the range is over)
+ */
+unsigned int mr_filereader_mmap_get_block(Filereader *fr, const char **block) {
+    long long offset = fr->offset;
+    long long end = fr->stop_offset + 1;
+    Filereader_mmap *ext = fr->ext;
 
-        /* Prepare offset for next fonction call */
-        fr->offset++;
+    if (end > fr->file_size) end = fr->file_size;
+    if (offset >= end) return 0;
 
-        /* End_offset reached */
-        if (offset > stop_offset) return (offset-stop_offset);
-        else return 0;
+    /* Keep the size representable */
+    if (end - offset > MAPREDUCE_FR_MAX_BLOCK_SIZE) {
+        end = offset + MAPREDUCE_FR_MAX_BLOCK_SIZE;
     }
-    else return -1; /* End of file reached */
+
+    *block = ext->shared_map + offset;
+    fr->offset = end;
+
+    return end - offset;
 }
@@ -24,6 +24,43 @@
         char*       shared_map;    /**<  Memory area where the file is mapped */
     } Filereader_mmap;
 
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Get next byte from a filereader. Static inline definition so that map
+     * loops specialized for mmap may inline it.
+     *
+     * @param   fr[in]               Pointer to the Filereader structure
+     * @param   buffer[out]          Buffer to hold the retrieved byte
+     * @return  0 if a byte was copied into the buffer, -1 if the end of the
+     *          file was reached, or the postion (>0) of the byte in the next
+     *          area.
+     */
+    static inline int _mr_filereader_mmap_get_byte(Filereader *fr,
+                                                               char *buffer) {
+        long long offset = fr->offset;
+        long long file_size = fr->file_size;
+
+        if (offset < file_size) {
+            long long stop_offset = fr->stop_offset;
+            Filereader_mmap *ext = fr->ext;
+            char *shared_map = ext->shared_map;
+
+            /* Retrieve byte */
+            char val = shared_map[offset];
+            buffer[0] = val;
+
+            /* Prepare offset for next fonction call */
+            fr->offset++;
+
+            /* End_offset reached */
+            if (offset > stop_offset) return (offset-stop_offset);
+            else return 0;
+        }
+        else return -1; /* End of file reached */
+    }
+
     /* ============================== Prototypes ============================ */
 
     Filereader*  mr_filereader_mmap_create_first(const char*);
@@ -31,6 +68,7 @@
     void         mr_filereader_mmap_delete(Filereader*);
 
     int          mr_filereader_mmap_get_byte(Filereader*, char*);
+    unsigned int mr_filereader_mmap_get_block(Filereader*, const char**);
     void         mr_filereader_mmap_set_offsets(Filereader*, long long,
                                                                      long long);
 
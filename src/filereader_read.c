@@ -98,6 +98,7 @@ Filereader* _mr_filereader_read_create(const char *file_path,
     fr->create_another = mr_filereader_read_create_another;
     fr->delete = mr_filereader_read_delete;
     fr->get_byte = mr_filereader_read_get_byte;
+    fr->get_block = mr_filereader_read_get_block;
     fr->set_offsets = mr_filereader_read_set_offsets;
 
     /* Alloc and initialize read extra data */
@@ -113,7 +114,7 @@ Filereader* _mr_filereader_read_create(const char *file_path,
     assert(fr->fd >= 0);
 
     /* Set filereader type */
-    fr->type = FR_MMAP;
+    fr->type = FR_READ;
 
     /* Set default offsets */
     mr_filereader_read_set_offsets(fr, 0, fr->file_size);
@@ -161,32 +162,41 @@ void mr_filereader_read_set_offsets(Filereader *fr, long long start_offset,
  *          was reached, or the postion (>0) of the byte in the next area.
  */
 int mr_filereader_read_get_byte(Filereader *fr, char *buffer) {
-    long long offset = fr->offset;
-    long long file_size = fr->file_size;
+    return _mr_filereader_read_get_byte(fr, buffer);
+}
 
-    if (offset < file_size) {
-        long long stop_offset = fr->stop_offset;
-        Filereader_read *ext = fr->ext;
 
-        /* If end of buffer reached, we nead to read again */
-        if (ext->buffer_offset >= ext->buffer_size) {
-            int ret = read(fr->fd, ext->buffer, ext->buffer_size);
-            assert(ret != -1);
+/**
+ * Get the next bytes of the range from the read buffer (which is refilled
+ * once exhausted).
+ *
+ * @param   fr[in]               Pointer to the Filereader structure
+ * @param   block[out]           Pointer to the first byte of the block
+ * @return  Number of bytes in the block (0 once the range is over)
+ */
+unsigned int mr_filereader_read_get_block(Filereader *fr, const char **block) {
+    long long offset = fr->offset;
+    long long end = fr->stop_offset + 1;
+    Filereader_read *ext = fr->ext;
 
-            ext->buffer_offset = 0;
-        }
+    if (end > fr->file_size) end = fr->file_size;
+    if (offset >= end) return 0;
 
-        /* Retrieve byte */
-        char *read_buffer = ext->buffer;
-        char val = read_buffer[ext->buffer_offset++];
-        buffer[0] = val;
+    /* If end of buffer reached, we nead to read again */
+    if (ext->buffer_offset >= ext->buffer_size) {
+        int ret = read(fr->fd, ext->buffer, ext->buffer_size);
+        assert(ret != -1);
 
-        /* Prepare offset for next fonction call */
-        fr->offset++;
+        ext->buffer_offset = 0;
+    }
 
-        /* End_offset reached */
-        if (offset > stop_offset) return (offset-stop_offset);
-        else return 0;
+    if (end - offset > ext->buffer_size - ext->buffer_offset) {
+        end = offset + ext->buffer_size - ext->buffer_offset;
     }
-    else return -1; /* End of file reached */
+
+    *block = ext->buffer + ext->buffer_offset;
+    ext->buffer_offset += end - offset;
+    fr->offset = end;
+
+    return end - offset;
 }
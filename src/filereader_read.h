@@ -26,6 +26,51 @@
         char*       buffer;           /**<  Pointer to the read Buffer    */
     } Filereader_read;
 
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Get next byte from a filereader. Static inline definition so that map
+     * loops specialized for read may inline it.
+     *
+     * @param   fr[in]               Pointer to the Filereader structure
+     * @param   buffer[out]          Buffer to hold the retrieved byte
+     * @return  0 if a byte was copied into the buffer, -1 if the end of the
+     *          file was reached, or the postion (>0) of the byte in the next
+     *          area.
+     */
+    static inline int _mr_filereader_read_get_byte(Filereader *fr,
+                                                               char *buffer) {
+        long long offset = fr->offset;
+        long long file_size = fr->file_size;
+
+        if (offset < file_size) {
+            long long stop_offset = fr->stop_offset;
+            Filereader_read *ext = fr->ext;
+
+            /* If end of buffer reached, we nead to read again */
+            if (ext->buffer_offset >= ext->buffer_size) {
+                int ret = read(fr->fd, ext->buffer, ext->buffer_size);
+                assert(ret != -1);
+
+                ext->buffer_offset = 0;
+            }
+
+            /* Retrieve byte */
+            char *read_buffer = ext->buffer;
+            char val = read_buffer[ext->buffer_offset++];
+            buffer[0] = val;
+
+            /* Prepare offset for next fonction call */
+            fr->offset++;
+
+            /* End_offset reached */
+            if (offset > stop_offset) return (offset-stop_offset);
+            else return 0;
+        }
+        else return -1; /* End of file reached */
+    }
+
     /* ============================== Prototypes ============================ */
 
     Filereader*  mr_filereader_read_create_first(const char*,
@@ -34,6 +79,7 @@
     void         mr_filereader_read_delete(Filereader*);
 
     int          mr_filereader_read_get_byte(Filereader*, char*);
+    unsigned int mr_filereader_read_get_block(Filereader*, const char**);
     void         mr_filereader_read_set_offsets(Filereader*, long long,
                                                                      long long);
 
@@ -0,0 +1,453 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file filter.c
+ * @brief Token filter with patterns compiled into a DFA at startup.
+ * @author Jean-Yves VET
+ *
+ * Patterns match whole tokens and are made of items, each one optionally
+ * followed by *, + or ?:
+ *   - a literal character (or \c for any character c),
+ *   - . for any character,
+ *   - \d digit, \x hexadecimal digit, \a letter, \w letter or digit,
+ *   - [...] class with ranges (a-f) and escapes, [^...] for its complement.
+ * For instance \d+ matches pure numbers and \x\x\x\x\x\x\x\x+ hexadecimal
+ * identifiers of at least 8 digits.
+ */
+
+#include "filter.h"
+#include "word.h"
+
+/* ============================= Static Elements ============================ */
+
+/* Quantifiers of a pattern item (+ is stored as an item and a starred copy) */
+typedef enum {
+    FILTER_ONE,
+    FILTER_OPTIONAL,
+    FILTER_STAR
+} filter_quantifier;
+
+/* Item of a pattern: set of bytes it matches, and its quantifier */
+typedef struct filter_item_s {
+    uint64_t           bytes[4];
+    filter_quantifier  quantifier;
+} Filter_item;
+
+/* Parsed pattern and the position of its first item in the NFA */
+typedef struct filter_pattern_s {
+    Filter_item*   items;
+    unsigned int   nb_items;
+    unsigned int   first;
+    uint8_t        kind;
+} Filter_pattern;
+
+static int _mr_filter_parse(const char*, Filter_pattern*);
+static int _mr_filter_build(Filter*, Filter_pattern*, const unsigned int,
+                                                            const unsigned int);
+
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Create a token filter. Tokens matching a drop pattern are rejected, and
+ * when keep patterns are given, tokens matching none of them are rejected.
+ *
+ * @param   drops[in]       Drop patterns
+ * @param   nb_drops[in]    Number of drop patterns
+ * @param   keeps[in]       Keep patterns
+ * @param   nb_keeps[in]    Number of keep patterns
+ * @param   min_length[in]  Minimum length of counted tokens
+ * @param   max_length[in]  Maximum length of counted tokens
+ * @param   profiling[in]   Activate the profiling mode
+ * @return  Pointer to the new Filter structure, or NULL if a pattern is
+ *          invalid or if the DFA is too large
+ */
+Filter* mr_filter_create(char **drops, const unsigned int nb_drops,
+                     char **keeps, const unsigned int nb_keeps,
+                     const unsigned int min_length,
+                     const unsigned int max_length, const bool profiling) {
+    unsigned int i, nb_positions = 0;
+    int ret = 0;
+
+    Filter *f = malloc(sizeof(Filter));
+    assert(f != NULL);
+    f->min_length = min_length;
+    f->max_length = max_length;
+    f->nb_patterns = nb_drops + nb_keeps;
+    f->keep = (nb_keeps > 0);
+    f->nb_states = 0;
+    f->transitions = NULL;
+    f->accepts = NULL;
+
+    /* Parse all patterns, positions of the NFA follow each other */
+    Filter_pattern *patterns = calloc(f->nb_patterns ? f->nb_patterns : 1,
+                                                       sizeof(Filter_pattern));
+    assert(patterns != NULL);
+
+    for (i=0; i<f->nb_patterns && !ret; i++) {
+        bool drop = (i < nb_drops);
+
+        ret = _mr_filter_parse(drop ? drops[i] : keeps[i - nb_drops],
+                                                                 &patterns[i]);
+        patterns[i].kind = drop ? MR_FILTER_DROP : MR_FILTER_KEEP;
+        patterns[i].first = nb_positions;
+        nb_positions += patterns[i].nb_items + 1;
+    }
+
+    if (!ret && f->nb_patterns) {
+        ret = _mr_filter_build(f, patterns, f->nb_patterns, nb_positions);
+    }
+
+    for (i=0; i<f->nb_patterns; i++) free(patterns[i].items);
+    free(patterns);
+
+    if (ret) {
+        mr_filter_delete(&f);
+        return NULL;
+    }
+
+    if (profiling) {
+        #if MAPREDUCE_DEFAULT_USECOLORS
+            printf("\e[34m |-[Filter] dfa:\e[1m %u states (%u patterns, "
+                   "length %u-%u)\e[0m\n", f->nb_states, f->nb_patterns,
+                   f->min_length, f->max_length);
+        #else
+            printf(" |-[Filter] dfa: %u states (%u patterns, length %u-%u)\n",
+                   f->nb_states, f->nb_patterns, f->min_length, f->max_length);
+        #endif
+    }
+
+    return f;
+}
+
+
+/**
+ * Delete a Filter structure and set pointer to NULL.
+ *
+ * @param   f_ptr[inout]    Pointer to pointer of a Filter structure
+ */
+void mr_filter_delete(Filter **f_ptr) {
+    assert(f_ptr != NULL);
+    Filter *f = *f_ptr;
+
+    if (f != NULL) {
+        free(f->transitions);
+        free(f->accepts);
+        free(f);
+    }
+
+    *f_ptr = NULL;
+}
+
+
+/* ============================ Private functions =========================== */
+
+/**
+ * Add a range of bytes to an item.
+ *
+ * @param   item[inout]     Pointer to the item
+ * @param   first[in]       First byte of the range
+ * @param   last[in]        Last byte of the range
+ */
+static void _mr_filter_add_range(Filter_item *item, unsigned char first,
+                                                          unsigned char last) {
+    unsigned int c;
+
+    for (c=first; c<=last; c++) item->bytes[c >> 6] |= 1ULL << (c & 63);
+}
+
+
+/**
+ * Add the bytes of an escape sequence to an item.
+ *
+ * @param   item[inout]     Pointer to the item
+ * @param   c[in]           Character following the backslash
+ */
+static void _mr_filter_add_escape(Filter_item *item, char c) {
+    switch (c) {
+        case 'd':
+            _mr_filter_add_range(item, '0', '9');
+            break;
+        case 'x':
+            _mr_filter_add_range(item, '0', '9');
+            _mr_filter_add_range(item, 'a', 'f');
+            _mr_filter_add_range(item, 'A', 'F');
+            break;
+        case 'w':
+            _mr_filter_add_range(item, '0', '9');
+            /* Fall through */
+        case 'a':
+            _mr_filter_add_range(item, 'a', 'z');
+            _mr_filter_add_range(item, 'A', 'Z');
+            break;
+        default:
+            _mr_filter_add_range(item, c, c);
+    }
+}
+
+
+/**
+ * Parse a pattern into items.
+ *
+ * @param   pattern[in]     String of the pattern
+ * @param   pat[out]        Pointer to the parsed pattern
+ * @return  0 if the pattern is valid or 1 otherwise
+ */
+static int _mr_filter_parse(const char *pattern, Filter_pattern *pat) {
+    unsigned int i;
+    const char *p = pattern;
+
+    /* Each character gives at most two items (x+ is x x*) */
+    pat->nb_items = 0;
+    pat->items = malloc(sizeof(Filter_item) * (2 * strlen(pattern) + 1));
+    assert(pat->items != NULL);
+
+    while (*p) {
+        Filter_item *item = &pat->items[pat->nb_items++];
+        memset(item, 0, sizeof(Filter_item));
+        item->quantifier = FILTER_ONE;
+
+        switch (*p) {
+            case '*':
+            case '+':
+            case '?':
+                return 1;
+            case '.':
+                _mr_filter_add_range(item, 0, 255);
+                p++;
+                break;
+            case '\\':
+                if (!p[1]) return 1;
+                _mr_filter_add_escape(item, p[1]);
+                p += 2;
+                break;
+            case '[': {
+                bool negate = (p[1] == '^');
+                p += negate ? 2 : 1;
+
+                /* A leading ] is a member of the class */
+                do {
+                    if (!*p) return 1;
+
+                    if (*p == '\\' && p[1]) {
+                        _mr_filter_add_escape(item, p[1]);
+                        p += 2;
+                    } else if (p[1] == '-' && p[2] && p[2] != ']') {
+                        if ((unsigned char) p[0] > (unsigned char) p[2]) {
+                            return 1;
+                        }
+                        _mr_filter_add_range(item, p[0], p[2]);
+                        p += 3;
+                    } else {
+                        _mr_filter_add_range(item, p[0], p[0]);
+                        p++;
+                    }
+                } while (*p != ']');
+
+                if (negate) {
+                    for (i=0; i<4; i++) item->bytes[i] = ~item->bytes[i];
+                }
+
+                p++;
+                break;
+            }
+            /* Alternations, groups and counted repetitions are not
+               supported (escape them to match the character) */
+            case '|':
+            case '(':
+            case ')':
+            case '{':
+            case '}':
+                return 1;
+            default:
+                _mr_filter_add_range(item, *p, *p);
+                p++;
+        }
+
+        /* Quantifier */
+        if (*p == '*') {
+            item->quantifier = FILTER_STAR;
+            p++;
+        } else if (*p == '?') {
+            item->quantifier = FILTER_OPTIONAL;
+            p++;
+        } else if (*p == '+') {
+            pat->items[pat->nb_items] = *item;
+            pat->items[pat->nb_items++].quantifier = FILTER_STAR;
+            p++;
+        }
+    }
+
+    return pat->nb_items ? 0 : 1;
+}
+
+
+/**
+ * Add positions reachable without consuming a character (items which may
+ * be skipped) to a set of NFA positions.
+ *
+ * @param   set[inout]      Set of positions (one bit per position)
+ * @param   patterns[in]    Parsed patterns
+ * @param   nb_patterns[in] Number of patterns
+ */
+static void _mr_filter_closure(uint64_t *set, const Filter_pattern *patterns,
+                                               const unsigned int nb_patterns) {
+    unsigned int p, i;
+
+    for (p=0; p<nb_patterns; p++) {
+        for (i=0; i<patterns[p].nb_items; i++) {
+            unsigned int pos = patterns[p].first + i;
+
+            if ((set[pos >> 6] >> (pos & 63)) & 1
+                    && patterns[p].items[i].quantifier != FILTER_ONE) {
+                set[(pos+1) >> 6] |= 1ULL << ((pos+1) & 63);
+            }
+        }
+    }
+}
+
+
+/**
+ * Compute the set of NFA positions reached from a set on a byte.
+ *
+ * @param   next[out]       Set of positions reached
+ * @param   set[in]         Set of positions
+ * @param   words[in]       Number of 64-bit words per set
+ * @param   c[in]           Byte consumed
+ * @param   patterns[in]    Parsed patterns
+ * @param   nb_patterns[in] Number of patterns
+ */
+static void _mr_filter_step(uint64_t *next, const uint64_t *set,
+                    const unsigned int words, const unsigned char c,
+                    const Filter_pattern *patterns,
+                    const unsigned int nb_patterns) {
+    unsigned int p, i;
+
+    memset(next, 0, words * sizeof(uint64_t));
+
+    for (p=0; p<nb_patterns; p++) {
+        for (i=0; i<patterns[p].nb_items; i++) {
+            const Filter_item *item = &patterns[p].items[i];
+            unsigned int pos = patterns[p].first + i;
+
+            if (!((set[pos >> 6] >> (pos & 63)) & 1)) continue;
+            if (!((item->bytes[c >> 6] >> (c & 63)) & 1)) continue;
+
+            /* A starred item may match again */
+            if (item->quantifier != FILTER_STAR) pos++;
+            next[pos >> 6] |= 1ULL << (pos & 63);
+        }
+    }
+
+    _mr_filter_closure(next, patterns, nb_patterns);
+}
+
+
+/**
+ * Build the DFA by subset construction. Sets of NFA positions already met
+ * are found back through a hash table.
+ *
+ * @param   f[inout]         Pointer to the Filter structure
+ * @param   patterns[in]     Parsed patterns
+ * @param   nb_patterns[in]  Number of patterns
+ * @param   nb_positions[in] Number of positions of the NFA
+ * @return  0 if the DFA was built or 1 if it has too many states
+ */
+static int _mr_filter_build(Filter *f, Filter_pattern *patterns,
+                 const unsigned int nb_patterns, const unsigned int nb_positions) {
+    unsigned int s, c, p, nb_slots = 1;
+    unsigned int words = (nb_positions + 63) / 64;
+    unsigned int max_states = MAPREDUCE_FILTER_MAX_STATES;
+    int ret = 0;
+
+    while (nb_slots < 2 * max_states) nb_slots <<= 1;
+
+    uint64_t *sets = calloc((size_t) max_states * words, sizeof(uint64_t));
+    uint64_t *next = malloc(words * sizeof(uint64_t));
+    unsigned int *slots = calloc(nb_slots, sizeof(unsigned int));
+    f->transitions = calloc((size_t) max_states << 8, sizeof(uint16_t));
+    f->accepts = calloc(max_states, sizeof(uint8_t));
+    assert(sets != NULL && next != NULL && slots != NULL
+                            && f->transitions != NULL && f->accepts != NULL);
+
+    /* Dead state (empty set), then start state */
+    uint64_t *start = &sets[MR_FILTER_START * words];
+    for (p=0; p<nb_patterns; p++) {
+        start[patterns[p].first >> 6] |= 1ULL << (patterns[p].first & 63);
+    }
+    _mr_filter_closure(start, patterns, nb_patterns);
+    f->nb_states = 2;
+
+    for (s=MR_FILTER_START; s<f->nb_states && !ret; s++) {
+        const uint64_t *set = &sets[s * words];
+
+        /* Patterns matching the tokens which end in this state */
+        for (p=0; p<nb_patterns; p++) {
+            unsigned int end = patterns[p].first + patterns[p].nb_items;
+
+            if ((set[end >> 6] >> (end & 63)) & 1) {
+                f->accepts[s] |= patterns[p].kind;
+            }
+        }
+
+        for (c=0; c<256; c++) {
+            uint64_t hash = MR_WORD_HASH_SEED;
+            unsigned int i, slot, state = MR_FILTER_DEAD;
+
+            _mr_filter_step(next, set, words, c, patterns, nb_patterns);
+
+            for (i=0; i<words; i++) hash = (hash ^ next[i]) * 0x100000001b3ULL;
+
+            for (i=0; i<words && !next[i]; i++);
+            if (i == words) continue;
+
+            /* Find the set or add a new state */
+            for (slot = hash & (nb_slots - 1); slots[slot];
+                                          slot = (slot + 1) & (nb_slots - 1)) {
+                if (!memcmp(&sets[slots[slot] * words], next,
+                                                words * sizeof(uint64_t))) {
+                    state = slots[slot];
+                    break;
+                }
+            }
+
+            if (state == MR_FILTER_DEAD) {
+                if (f->nb_states == max_states) {
+                    ret = 1;
+                    break;
+                }
+
+                state = f->nb_states++;
+                memcpy(&sets[state * words], next, words * sizeof(uint64_t));
+                slots[slot] = state;
+            }
+
+            f->transitions[(s << 8) | c] = state;
+        }
+    }
+
+    free(sets);
+    free(next);
+    free(slots);
+
+    /* Only keep the states in use */
+    if (!ret) {
+        f->transitions = realloc(f->transitions,
+                                 ((size_t) f->nb_states << 8) * sizeof(uint16_t));
+        f->accepts = realloc(f->accepts, f->nb_states);
+        assert(f->transitions != NULL && f->accepts != NULL);
+    }
+
+    return ret;
+}
@@ -0,0 +1,83 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file filter.h
+ * @brief Token filter dropping tokens by length and by shape before counting.
+ * @author Jean-Yves VET
+ */
+
+#ifndef HEADER_MAPREDUCE_FILTER_H
+    #define HEADER_MAPREDUCE_FILTER_H
+
+    #include "common.h"
+
+    #define MR_FILTER_DEAD   0      /* State without any possible match       */
+    #define MR_FILTER_START  1      /* State before the first character       */
+    #define MR_FILTER_DROP   0x1    /* Accepting state of a drop pattern      */
+    #define MR_FILTER_KEEP   0x2    /* Accepting state of a keep pattern      */
+
+    /**
+     * @struct filter_s
+     * @brief  Token filter. All patterns are compiled at startup into a single
+     *         DFA, so a token is classified by one linear scan with a table
+     *         lookup per character. Patterns match whole tokens.
+     */
+    typedef struct filter_s {
+        unsigned int   min_length;     /**<  Shorter tokens are dropped       */
+        unsigned int   max_length;     /**<  Longer tokens are dropped        */
+        unsigned int   nb_patterns;    /**<  Number of drop and keep patterns */
+        bool           keep;           /**<  Only keep patterns are counted   */
+        unsigned int   nb_states;      /**<  Number of states of the DFA      */
+        uint16_t*      transitions;    /**<  Next state per state and byte    */
+        uint8_t*       accepts;        /**<  Patterns matched in each state   */
+    } Filter;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Check if a token is rejected by the filter. Static inline definition to
+     * improve calling performance (called for each token).
+     *
+     * @param   f[in]           Pointer to the Filter structure
+     * @param   word[in]        Spelling of the token
+     * @param   length[in]      Number of characters in the token
+     * @return  true if the token must not be counted
+     */
+    static inline bool mr_filter_reject(const Filter *f, const char *word,
+                                                  const unsigned int length) {
+        unsigned int i, state = MR_FILTER_START;
+        const uint16_t *transitions = f->transitions;
+
+        if (length < f->min_length || length > f->max_length) return true;
+        if (!f->nb_patterns) return false;
+
+        /* Stop as soon as no pattern may match anymore */
+        for (i=0; i<length && state != MR_FILTER_DEAD; i++) {
+            state = transitions[(state << 8) | (unsigned char) word[i]];
+        }
+
+        if (f->accepts[state] & MR_FILTER_DROP) return true;
+
+        return f->keep && !(f->accepts[state] & MR_FILTER_KEEP);
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Filter*  mr_filter_create(char**, const unsigned int, char**,
+                      const unsigned int, const unsigned int,
+                      const unsigned int, const bool);
+    void     mr_filter_delete(Filter**);
+#endif
@@ -20,11 +20,16 @@
 #include "mapreduce.h"
 #include "mapreduce_sequential.h"
 #include "mapreduce_parallel.h"
+#include "mapreduce_pipeline.h"
+#include "output.h"
 #include "tools.h"
+#include <sys/types.h>
+#include <sys/stat.h>
 
 void _stats_total(Mapreduce*);
 Mapreduce* _mr_create(const char*, const int, const mr_type, const ws_type,
-         const fr_type reader_type, const unsigned int, const bool, const bool);
+                          const fr_type reader_type, const unsigned int,
+                                         const dc_type, const bool, const bool);
 
 /* ========================= Constructor / Destructor ======================= */
 
@@ -35,10 +40,74 @@ Mapreduce* _mr_create(const char*, const int, const mr_type, const ws_type,
  * @return  A Mapreduce structure
  */
 Mapreduce* mr_create(Arguments *args) {
+    int i;
     assert(args != NULL);
-    return _mr_create(args->file_path, args->nb_threads, args->type,
+    Mapreduce *mr = _mr_create(args->file_path, args->nb_threads, args->type,
                           args->wstreamer_type, args->freader_type,
-                          args->read_buffer_size, args->quiet, args->profiling);
+                          args->read_buffer_size, args->dictionary_type,
+                          args->quiet, args->profiling);
+
+    /* Set modes which are only used by map and reduce operations */
+    mr->steal = args->steal;
+    mr->ngram = args->ngram;
+    mr->partitions = args->partitions;
+    mr->top = args->top;
+
+    /* Most frequent words only (by decreasing count) with --top */
+    mr->order = (args->top) ? SO_COUNT : args->order;
+
+    /* Ranges always stop on rows in record mode */
+    if (args->columns) {
+        mr->records = mr_records_create(args->delimiter, args->columns);
+        mr->boundaries = mr_boundaries_create_rows(args->file_path,
+                                           args->nb_threads, args->profiling);
+    } else if (args->boundaries) {
+        mr->boundaries = mr_boundaries_create(args->file_path,
+                                           args->nb_threads, args->profiling);
+    }
+
+    if (args->stopwords) {
+        mr->stopwords = mr_stopwords_create(args->stopwords_path,
+                                                              args->profiling);
+    }
+
+    /* Token filter compiled once for all streamers */
+    if (args->nb_drops || args->nb_keeps
+            || args->min_length > MAPREDUCE_DEFAULT_MIN_LENGTH
+            || args->max_length < MAPREDUCE_DEFAULT_MAX_LENGTH) {
+        mr->filter = mr_filter_create(args->drops, args->nb_drops, args->keeps,
+                                 args->nb_keeps, args->min_length,
+                                 args->max_length, args->profiling);
+        if (mr->filter == NULL) mr_error(ERR_PATTERN);
+    }
+
+    /* Binary dictionaries are mapped now to report invalid files early */
+    for (i=0; i<args->nb_merges; i++) {
+        struct stat st;
+
+        if (!stat(args->merges[i], &st) && S_ISDIR(st.st_mode)) {
+            mr->stores[mr->nb_stores] = mr_store_open(args->merges[i], false,
+                                                              args->profiling);
+            if (mr->stores[mr->nb_stores++] == NULL) mr_error(ERR_SEGMENT);
+        } else {
+            mr->segments[mr->nb_segments] = mr_segment_open(args->merges[i]);
+            if (mr->segments[mr->nb_segments++] == NULL) mr_error(ERR_SEGMENT);
+        }
+    }
+
+    if (args->store_path != NULL) {
+        mr->store = mr_store_open(args->store_path, true, args->profiling);
+        if (mr->store == NULL) mr_error(ERR_SEGMENT);
+        mr->full_compaction = args->full_compaction;
+    }
+
+    if (args->save_path != NULL) {
+        mr->save_path = malloc(strlen(args->save_path)+1);
+        assert(mr->save_path != NULL);
+        strcpy(mr->save_path, args->save_path);
+    }
+
+    return mr;
 }
 
 
@@ -49,10 +118,18 @@ Mapreduce* mr_create(Arguments *args) {
  */
 void mr_delete(Mapreduce **mr_ptr) {
     Mapreduce *mr = *mr_ptr;
+    int i;
     assert(mr != NULL);
 
     _timer_stop(&mr->timer_global);
     mr->delete(mr);
+    mr_boundaries_delete(&mr->boundaries);
+    mr_stopwords_delete(&mr->stopwords);
+    mr_records_delete(&mr->records);
+    mr_filter_delete(&mr->filter);
+    for (i=0; i<mr->nb_segments; i++) mr_segment_close(&mr->segments[i]);
+    for (i=0; i<mr->nb_stores; i++) mr_store_close(&mr->stores[i]);
+    mr_store_close(&mr->store);
 
     /* Display profile if requiered */
     _timer_print(&mr->timer_map, "[MapReduce] map");
@@ -62,6 +139,7 @@ void mr_delete(Mapreduce **mr_ptr) {
 
     if (mr != NULL) {
         if (mr->file_path != NULL) free(mr->file_path);
+        if (mr->save_path != NULL) free(mr->save_path);
         free(mr);
     }
     *mr_ptr = NULL;
@@ -79,6 +157,7 @@ void mr_delete(Mapreduce **mr_ptr) {
  * @param  wstreamer_type[in]   Type of wordstreamer to use (see common.h)
  * @param  reader_type[in]      Type of filereader to use (see common.h)
  * @param  read_buffer_size[in] Size in bytes of the read buffer
+ * @param  dictionary_type[in]  Type of dictionary to use (see common.h)
  * @param  quiet[in]        Activate the quiet mode (no output)
  * @param  profiling[in]    Activate the profiling mode
  * @return  A pointer to the new Mapreduce structure
@@ -88,6 +167,7 @@ Mapreduce* _mr_create(const char *file_path, const int nb_threads,
                                        const ws_type wstreamer_type,
                                        const fr_type reader_type,
                                        const unsigned int reader_buffer_size,
+                                       const dc_type dictionary_type,
                                        const bool quiet, const bool profiling) {
     Mapreduce *mr;
 
@@ -95,11 +175,23 @@ Mapreduce* _mr_create(const char *file_path, const int nb_threads,
         default:
         case MR_PARALLEL :
             mr = mr_parallel_create(file_path, nb_threads, wstreamer_type,
-                             reader_type, reader_buffer_size, quiet, profiling);
+                             reader_type, reader_buffer_size, dictionary_type,
+                                                             quiet, profiling);
             break;
         case MR_SEQUENTIAL :
             mr = mr_sequential_create(file_path, wstreamer_type, reader_type,
-                                          reader_buffer_size, quiet, profiling);
+                         reader_buffer_size, dictionary_type, quiet, profiling);
+            break;
+        case MR_PIPELINE :
+            mr = mr_pipeline_create(file_path, nb_threads, wstreamer_type,
+                             reader_type, reader_buffer_size, dictionary_type,
+                                                             quiet, profiling);
+            break;
+        case MR_SHARED :
+            mr = mr_parallel_create(file_path, nb_threads, wstreamer_type,
+                             reader_type, reader_buffer_size, DC_SHARED,
+                                                             quiet, profiling);
+            mr->type = MR_SHARED;
             break;
     }
 
@@ -114,26 +206,48 @@ Mapreduce* _mr_create(const char *file_path, const int nb_threads,
  */
 void _stats_total(Mapreduce *mr) {
     if (mr->profiling) {
-        double fsize = mr_tools_fsize(mr->file_path)/1048576.0;
-        long int words = mr_tools_wc(mr->file_path);
+        /* Counters were summed from the streamers at reduce */
+        Stats *stats = &mr->stats;
+        double fsize = stats->bytes/1048576.0;
+        unsigned long long words = stats->words;
         Timer *timer_global = &mr->timer_global;
         double elapsed = ((double)timer_global->elapsed)/1E6;
+        int i;
 
         if (elapsed > 0.001) {
             #if MAPREDUCE_DEFAULT_USECOLORS
                 printf("\e[33m |---> [File Size: %.3f MB]  -> "
                        "\e[1;33m %.3f MB/s\e[0m\n",
                        fsize, ((double)fsize/elapsed));
-                printf("\e[33m |---> [Words: %ld]  -> "
+                printf("\e[33m |---> [Words: %llu]  -> "
                        "\e[1;33m %.3f MWords/s\e[0m\n",
                        words, ((double)words/1E6)/elapsed);
             #else
-                printf(" |---> [File Size: %ld MB]  ->  %.3f MB/s\n",
+                printf(" |---> [File Size: %.3f MB]  ->  %.3f MB/s\n",
                         fsize, ((double)fsize/elapsed));
-                printf(" |---> [Words: %ld]  ->  %.3f MWords/s\n",
+                printf(" |---> [Words: %llu]  ->  %.3f MWords/s\n",
                         words, ((double)words/1E6)/elapsed);
             #endif
         }
+
+        #if MAPREDUCE_DEFAULT_USECOLORS
+            printf("\e[33m |---> [Lines: %llu]  [Word lengths:",
+                                                                 stats->lines);
+        #else
+            printf(" |---> [Lines: %llu]  [Word lengths:", stats->lines);
+        #endif
+
+        for(i=1; i<=MAPREDUCE_STATS_MAX_LENGTH; i++) {
+            printf(" %d%s=%llu", i,
+                   (i == MAPREDUCE_STATS_MAX_LENGTH) ? "+" : "",
+                   stats->lengths[i]);
+        }
+
+        #if MAPREDUCE_DEFAULT_USECOLORS
+            printf("]\e[0m\n");
+        #else
+            printf("]\n");
+        #endif
     }
 }
 
@@ -166,3 +280,49 @@ void mr_reduce(Mapreduce *mr) {
     mr->reduce(mr);
     _timer_stop(&mr->timer_reduce);
 }
+
+
+/**
+ * Last step of reduce operations: add counts of binary dictionaries, then
+ * display words, write them to a binary dictionary or add them to a store.
+ *
+ * @param   mr[in]          Pointer to a Mapreduce structure
+ * @param   dico[inout]     Pointer to the dictionary holding all results
+ * @param   nb_threads[in]  Threads used to sort records
+ */
+void mr_reduce_output(Mapreduce *mr, Dictionary *dico,
+                                             const unsigned int nb_threads) {
+    int i;
+    assert(mr != NULL && dico != NULL);
+
+    for (i=0; i<mr->nb_segments; i++) {
+        if (mr_segment_merge(dico, mr->segments[i])) {
+            mr_error(ERR_COUNTOVERFLOW);
+        }
+    }
+
+    for (i=0; i<mr->nb_stores; i++) {
+        if (mr_store_merge(dico, mr->stores[i])) mr_error(ERR_COUNTOVERFLOW);
+    }
+
+    /* Results are only a delta, the history stays in the store */
+    if (mr->store != NULL) {
+        Output *output = mr_output_create(dico, nb_threads, mr->profiling);
+
+        if (mr_store_add(mr->store, output)
+            || (mr->full_compaction && mr_store_compact(mr->store, true))) {
+            mr_error(ERR_FILEWRITE);
+        }
+        mr_output_delete(&output);
+    } else if (mr->save_path != NULL) {
+        Output *output = mr_output_create(dico, nb_threads, mr->profiling);
+
+        mr_output_top(output, mr->top);
+        if (mr_segment_save(output, mr->save_path, MAPREDUCE_SEGMENT_INDEX)) {
+            mr_error(ERR_FILEWRITE);
+        }
+        mr_output_delete(&output);
+    } else if (!mr->quiet) {
+        mr_output_print(dico, mr->order, mr->top, nb_threads, mr->profiling);
+    }
+}
@@ -16,6 +16,12 @@
 
     #include "common.h"
     #include "args.h"
+    #include "boundaries.h"
+    #include "stopwords.h"
+    #include "records.h"
+    #include "filter.h"
+    #include "segment.h"
+    #include "store.h"
 
     /**
      * @struct mapreduce_s
@@ -29,7 +35,24 @@
         mr_type       type;         /**<  Type of mapreduce (see common.h)    */
         bool          quiet;        /**<  Display every details               */
         bool          profiling;    /**<  Profiling mode                      */
+        bool          steal;        /**<  Steal work from other streamers     */
         unsigned int  nb_threads;   /**<  Number of thread worker used        */
+        Boundaries*   boundaries;   /**<  Word boundaries index (or NULL)     */
+        unsigned int  ngram;        /**<  Words per counted key (n-grams)     */
+        unsigned int  partitions;   /**<  Dictionary partitions (shuffle)     */
+        unsigned int  top;          /**<  Words displayed (0: all)            */
+        so_type       order;        /**<  Display order (see common.h)        */
+        Stopwords*    stopwords;    /**<  Words to drop (or NULL)             */
+        Records*      records;      /**<  Record mode settings (or NULL)      */
+        Filter*       filter;       /**<  Token filter (or NULL)              */
+        char*         save_path;    /**<  Binary dictionary to write (or NULL)*/
+        Segment*      segments[MAPREDUCE_MAX_SEGMENTS]; /**< Counts to add    */
+        unsigned int  nb_segments;  /**<  Number of segments to add           */
+        Store*        stores[MAPREDUCE_MAX_SEGMENTS];   /**< Counts to add    */
+        unsigned int  nb_stores;    /**<  Number of stores to add             */
+        Store*        store;        /**<  Store to add a delta to (or NULL)   */
+        bool          full_compaction; /**< Merge all segments of the store   */
+        Stats         stats;        /**<  Corpus statistics (after reduce)    */
         Timer         timer_map;    /**<  Timer for map [Profiling mode]      */
         Timer         timer_reduce; /**<  Timer for reduce [Profiling mode]   */
         Timer         timer_global; /**<  Global Timer [Profiling mode]       */
@@ -61,6 +84,21 @@
         mr->nb_threads = nb_threads;
         mr->type = type;
         mr->quiet = quiet;
+        mr->steal = MAPREDUCE_DEFAULT_STEAL;
+        mr->boundaries = NULL;
+        mr->ngram = MAPREDUCE_DEFAULT_NGRAM;
+        mr->partitions = MAPREDUCE_DEFAULT_PARTITIONS;
+        mr->top = MAPREDUCE_DEFAULT_TOP;
+        mr->order = MAPREDUCE_DEFAULT_ORDER;
+        mr->stopwords = NULL;
+        mr->records = NULL;
+        mr->filter = NULL;
+        mr->save_path = NULL;
+        mr->nb_segments = 0;
+        mr->nb_stores = 0;
+        mr->store = NULL;
+        mr->full_compaction = MAPREDUCE_DEFAULT_FULL_COMPACTION;
+        _stats_init(&mr->stats);
 
         /* Initialize variables for profiling */
         mr->profiling = profiling;
@@ -80,4 +118,5 @@
 
     void         mr_map(Mapreduce*);
     void         mr_reduce(Mapreduce*);
+    void         mr_reduce_output(Mapreduce*, Dictionary*, const unsigned int);
 #endif
@@ -20,6 +20,8 @@
 #include "mapreduce.h"
 #include "mapreduce_parallel.h"
 
+static void* (*_mr_parallel_map_loop(const fr_type, const ws_type))(void*);
+
 /* ========================= Constructor / Destructor ======================= */
 
 /**
@@ -30,6 +32,7 @@
  * @param  wstreamer_type[in]   Type of wordstreamer to use
  * @param  reader_type[in]      Type of filereader to use
  * @param  read_buffer_size[in] Size in bytes of the read buffer
+ * @param  dictionary_type[in]  Type of dictionary to use
  * @param  quiet[in]        Activate the quiet mode (no output)
  * @param  profiling[in]    Activate the profiling mode
  * @return  A Mapreduce structure
@@ -37,7 +40,8 @@
 Mapreduce* mr_parallel_create(const char *file_path,
                     const unsigned int nb_threads, const ws_type wstreamer_type,
                      const fr_type reader_type, unsigned int reader_buffer_size,
-                                       const bool quiet, const bool profiling) {
+                 const dc_type dictionary_type, const bool quiet,
+                                                       const bool profiling) {
     int i;
     Mapreduce *mr = _mr_common_create(file_path, nb_threads, MR_PARALLEL,
                                                               quiet, profiling);
@@ -53,17 +57,20 @@ Mapreduce* mr_parallel_create(const char *file_path,
     /* First thread */
     threads[0].wordstreamer = mr_wordstreamer_create_first(file_path,
         nb_threads, wstreamer_type, reader_type, reader_buffer_size, profiling);
-    threads[0].dictionary = mr_dictionary_create(profiling);
+    threads[0].dictionary = mr_dictionary_create(dictionary_type, profiling);
     threads[0].thread = malloc(sizeof(pthread_t));
     assert(threads[0].thread != NULL);
+    threads[0].map = _mr_parallel_map_loop(reader_type, wstreamer_type);
 
     /* Next threads */
     for(i=1; i<nb_threads; i++) {
         threads[i].wordstreamer = mr_wordstreamer_create_another(
                                                     threads[0].wordstreamer, i);
-        threads[i].dictionary = mr_dictionary_create(profiling);
+        threads[i].dictionary = mr_dictionary_create_another(
+                                                       threads[0].dictionary);
         threads[i].thread = malloc(sizeof(pthread_t));
         assert(threads[i].thread != NULL);
+        threads[i].map = threads[0].map;
     }
 
     return mr;
@@ -82,6 +89,25 @@ void mr_parallel_delete(Mapreduce *mr) {
 
         int nb_threads =  mr->nb_threads;
 
+        /* Display work stealing statistics [Profiling mode] */
+        if (mr->profiling && mr->steal) {
+            unsigned int nb_steals = 0;
+            long long stolen_bytes = 0;
+
+            for(i=0; i<nb_threads; i++) {
+                nb_steals += threads[i].wordstreamer->nb_steals;
+                stolen_bytes += threads[i].wordstreamer->stolen_bytes;
+            }
+
+            #if MAPREDUCE_DEFAULT_USECOLORS
+                printf("\e[34m |-[MapReduce] steals:\e[1m %u (%lld bytes)"
+                       "\e[0m\n", nb_steals, stolen_bytes);
+            #else
+                printf(" |-[MapReduce] steals: %u (%lld bytes)\n", nb_steals,
+                                                                 stolen_bytes);
+            #endif
+        }
+
         for(i=0; i<nb_threads; i++) {
             mr_wordstreamer_delete(&threads[i].wordstreamer);
             mr_dictionary_delete(&threads[i].dictionary);
@@ -96,25 +122,167 @@ void mr_parallel_delete(Mapreduce *mr) {
 /* ============================ Private functions =========================== */
 
 /**
- * Thread function which performs map operation.
+ * Get next word from a wordstreamer. With constant types, the switches are
+ * resolved at compile time and the whole stream is inlined in the map loop.
+ * WS_NB (or FR_NB) goes through the vtables.
  *
- * @param   t_struct[inout]     Pointer to a struct dedicated to the thread
+ * @param   ws[inout]            Pointer to the Wordstreamer structure
+ * @param   buffer[out]          Buffer to hold the retrieved word
+ * @param   reader_type[in]      Type of the filereader (or FR_NB)
+ * @param   wstreamer_type[in]   Type of the wordstreamer (or WS_NB)
+ * @return  0 if a word was copied into the buffer or 1 if the end of the
+ *          stream was reached
  */
-void* _thread_map(void *t_struct) {
-    Mapreduce_parallel_thread *t = (Mapreduce_parallel_thread *) t_struct;
+static inline __attribute__((always_inline)) int _mr_parallel_get(
+                 Wordstreamer *ws, char *buffer, const fr_type reader_type,
+                                               const ws_type wstreamer_type) {
+    int ret;
+    _timer_start(&ws->timer_get);
+
+    switch (wstreamer_type) {
+        case WS_SCHUNKS:
+            ret = _mr_wordstreamer_schunks_get(ws, buffer, reader_type);
+            break;
+        case WS_IBLOCKS:
+            ret = _mr_wordstreamer_iblocks_get(ws, buffer, reader_type);
+            break;
+        case WS_DYNAMIC:
+            ret = _mr_wordstreamer_dynamic_get(ws, buffer, reader_type);
+            break;
+        default:
+            ret = ws->get(ws, buffer);
+            break;
+    }
+
+    _timer_stop(&ws->timer_get);
+
+    return ret;
+}
 
+
+/**
+ * Map loop of a thread for a type of filereader and a type of wordstreamer.
+ * Always inlined so that each instance below is specialized.
+ *
+ * @param   t[inout]             Pointer to a struct dedicated to the thread
+ * @param   reader_type[in]      Type of the filereader (or FR_NB)
+ * @param   wstreamer_type[in]   Type of the wordstreamer (or WS_NB)
+ */
+static inline __attribute__((always_inline)) void _mr_parallel_map_loop_as(
+                                 Mapreduce_parallel_thread *t,
+                                 const fr_type reader_type,
+                                 const ws_type wstreamer_type) {
     Dictionary *dico = t->dictionary;
     Wordstreamer *ws = t->wordstreamer;
+    Ngram *ng = t->ngram;
     char word[MAPREDUCE_MAX_WORD_SIZE];
 
-    while (!mr_wordstreamer_get(ws, word)) {
-        mr_dictionary_put_word(dico, word);
+    /* A single call site keeps one inlined copy of the stream. With n-grams,
+       words are retrieved directly in the ring of recent words */
+    do {
+        while (!_mr_parallel_get(ws, (ng == NULL) ? word : mr_ngram_slot(ng),
+                                                reader_type, wstreamer_type)) {
+            if (ng == NULL) {
+                mr_dictionary_put_word_hashed(dico, word, ws->word_length,
+                                                               ws->word_hash);
+            } else if (!mr_ngram_push(ng, ws)) {
+                mr_dictionary_put_parts(dico, ng->parts, ng->part_lengths,
+                                                            ng->n, ng->hash);
+            }
+        }
+    } while (t->steal && !mr_wordstreamer_steal(ws));
+}
+
+
+/**
+ * Thread function which performs map operation through the vtables (used
+ * for types without a specialized loop).
+ *
+ * @param   t_struct[inout]     Pointer to a struct dedicated to the thread
+ */
+void* _thread_map(void *t_struct) {
+    _mr_parallel_map_loop_as(t_struct, FR_NB, WS_NB);
+
+    return NULL;
+}
+
+
+/**
+ * Thread function which merges a pair of dictionaries.
+ *
+ * @param   m_struct[inout]     Pointer to the pair of dictionaries
+ */
+void* _thread_merge(void *m_struct) {
+    Mapreduce_parallel_merge *pair = (Mapreduce_parallel_merge *) m_struct;
+    mr_dictionary_merge(pair->first, pair->second);
+
+    return NULL;
+}
+
+
+/**
+ * Thread function which merges a partition of all dictionaries into the
+ * same partition of the first one.
+ *
+ * @param   s_struct[inout]     Pointer to the partition to reduce
+ */
+void* _thread_shuffle(void *s_struct) {
+    int i;
+    Mapreduce_parallel_shuffle *reducer = (Mapreduce_parallel_shuffle *)
+                                                                     s_struct;
+    unsigned int partition = reducer->partition;
+    Dictionary **dictionaries = reducer->dictionaries;
+    Dictionary *first = mr_dictionary_partitioned_get(dictionaries[0],
+                                                                   partition);
+
+    for (i=1; i<reducer->nb_dictionaries; i++) {
+        mr_dictionary_merge(first, mr_dictionary_partitioned_get(
+                                               dictionaries[i], partition));
     }
 
     return NULL;
 }
 
 
+/* One specialized thread function per filereader and wordstreamer types */
+#define MR_PARALLEL_MAP_LOOPS(X)                                               \
+    X(mmap, schunks, FR_MMAP, WS_SCHUNKS)                                      \
+    X(mmap, iblocks, FR_MMAP, WS_IBLOCKS)                                      \
+    X(mmap, dynamic, FR_MMAP, WS_DYNAMIC)                                      \
+    X(read, schunks, FR_READ, WS_SCHUNKS)                                      \
+    X(read, iblocks, FR_READ, WS_IBLOCKS)                                      \
+    X(read, dynamic, FR_READ, WS_DYNAMIC)
+
+#define MR_PARALLEL_MAP_DEFINE(fr, ws, reader_type, wstreamer_type)            \
+    static void* _thread_map_##fr##_##ws(void *t_struct) {                     \
+        _mr_parallel_map_loop_as(t_struct, reader_type, wstreamer_type);       \
+        return NULL;                                                           \
+    }
+
+MR_PARALLEL_MAP_LOOPS(MR_PARALLEL_MAP_DEFINE)
+
+
+/**
+ * Select the thread function specialized for a type of filereader and a type
+ * of wordstreamer. Done once when creating the Mapreduce structure.
+ *
+ * @param   reader_type[in]      Type of filereader (see common.h)
+ * @param   wstreamer_type[in]   Type of wordstreamer (see common.h)
+ * @return  Thread function performing the map operation
+ */
+static void* (*_mr_parallel_map_loop(const fr_type reader_type,
+                                      const ws_type wstreamer_type))(void*) {
+    #define MR_PARALLEL_MAP_SELECT(fr, ws, r_type, w_type)                     \
+        if (reader_type == r_type && wstreamer_type == w_type)                 \
+            return _thread_map_##fr##_##ws;
+
+    MR_PARALLEL_MAP_LOOPS(MR_PARALLEL_MAP_SELECT)
+    #undef MR_PARALLEL_MAP_SELECT
+
+    return _thread_map;
+}
+
+
 /* ============================= Public functions =========================== */
 
 /**
@@ -130,12 +298,28 @@ void mr_parallel_map(Mapreduce *mr) {
 
     /* Launch all threads */
     for(i=0; i<nb_threads; i++) {
-        pthread_create(threads[i].thread, NULL, _thread_map, &threads[i]);
+        threads[i].steal = mr->steal;
+        threads[i].wordstreamer->boundaries = mr->boundaries;
+        threads[i].wordstreamer->stopwords = mr->stopwords;
+        threads[i].wordstreamer->filter = mr->filter;
+        threads[i].wordstreamer->records = mr->records;
+        threads[i].ngram = NULL;
+        threads[i].dictionary = mr_dictionary_partition(threads[i].dictionary,
+                                                              mr->partitions);
+
+        /* Read n-1 words after each range to complete its last n-grams */
+        if (mr->ngram > 1) {
+            threads[i].ngram = mr_ngram_create(mr->ngram);
+            threads[i].wordstreamer->lookahead = mr->ngram - 1;
+        }
+
+        pthread_create(threads[i].thread, NULL, threads[i].map, &threads[i]);
     }
 
     /* Join all threads */
     for(i=0; i<nb_threads; i++) {
         pthread_join(*threads[i].thread, NULL);
+        mr_ngram_delete(&threads[i].ngram);
     }
 }
 
@@ -150,11 +334,104 @@ void mr_parallel_reduce(Mapreduce *mr) {
     assert(mr != NULL);
     int nb_threads = mr->nb_threads;
     Mapreduce_parallel_thread *threads = (Mapreduce_parallel_thread *) mr->ext;
-    Dictionary *dico = threads[0].dictionary;
+    Dictionary *dictionaries[nb_threads];
 
-    for(i=1; i<nb_threads; i++) {
-        mr_dictionary_merge(dico, threads[i].dictionary);
+    for(i=0; i<nb_threads; i++) {
+        dictionaries[i] = threads[i].dictionary;
+        _stats_merge(&mr->stats, &threads[i].wordstreamer->stats);
+    }
+
+    /* Words of a shared dictionary are already gathered */
+    if (dictionaries[0]->shared) {
+        mr_dictionary_flush(dictionaries[0]);
+    } else {
+        mr_parallel_merge(dictionaries, nb_threads);
+    }
+
+    mr_reduce_output(mr, dictionaries[0], nb_threads);
+}
+
+
+/**
+ * Merge per-thread dictionaries into the first one with a pairwise tree
+ * reduction: each round merges pairs of dictionaries concurrently, so that
+ * only log2(nb_dictionaries) rounds are needed.
+ *
+ * @param   dictionaries[inout]  Array of dictionaries, results in the first
+ * @param   nb_dictionaries[in]  Number of dictionaries
+ */
+void mr_parallel_merge(Dictionary **dictionaries,
+                                        const unsigned int nb_dictionaries) {
+    unsigned int i, stride;
+    assert(nb_dictionaries > 0);
+
+    if (dictionaries[0]->type == DC_PARTITIONED) {
+        mr_parallel_shuffle(dictionaries, nb_dictionaries);
+        return;
+    }
+
+    pthread_t threads[nb_dictionaries/2 + 1];
+    Mapreduce_parallel_merge pairs[nb_dictionaries/2 + 1];
+
+    /* Dictionary i+stride goes into dictionary i (i multiple of 2*stride) */
+    for (stride=1; stride<nb_dictionaries; stride*=2) {
+        unsigned int nb_pairs = 0;
+
+        for (i=0; i+stride<nb_dictionaries; i+=2*stride) {
+            pairs[nb_pairs].first = dictionaries[i];
+            pairs[nb_pairs].second = dictionaries[i+stride];
+            nb_pairs++;
+        }
+
+        /* The calling thread merges the first pair itself */
+        for (i=1; i<nb_pairs; i++) {
+            pthread_create(&threads[i], NULL, _thread_merge, &pairs[i]);
+        }
+
+        _thread_merge(&pairs[0]);
+
+        for (i=1; i<nb_pairs; i++) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+
+/**
+ * Merge partitioned dictionaries into the first one: reducer r merges
+ * partition r of every dictionary, so that reducers run in parallel without
+ * locks, each one on a fraction of the words.
+ *
+ * @param   dictionaries[inout]  Array of partitioned dictionaries, results in
+ *                               the first
+ * @param   nb_dictionaries[in]  Number of dictionaries
+ */
+void mr_parallel_shuffle(Dictionary **dictionaries,
+                                        const unsigned int nb_dictionaries) {
+    unsigned int i;
+    assert(nb_dictionaries > 0);
+    Dictionary_partitioned *ext = dictionaries[0]->ext;
+    unsigned int nb_reducers = ext->nb_partitions;
+    pthread_t threads[nb_reducers];
+    Mapreduce_parallel_shuffle reducers[nb_reducers];
+
+    for (i=0; i<nb_reducers; i++) {
+        reducers[i].dictionaries = dictionaries;
+        reducers[i].nb_dictionaries = nb_dictionaries;
+        reducers[i].partition = i;
+    }
+
+    /* The calling thread reduces the first partition itself */
+    for (i=1; i<nb_reducers; i++) {
+        pthread_create(&threads[i], NULL, _thread_shuffle, &reducers[i]);
+    }
+
+    _thread_shuffle(&reducers[0]);
+
+    for (i=1; i<nb_reducers; i++) {
+        pthread_join(threads[i], NULL);
     }
 
-    if (!mr->quiet) mr_dictionary_display(dico);
+    /* Words were added to partitions directly */
+    mr_dictionary_flush(dictionaries[0]);
 }
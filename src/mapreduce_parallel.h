@@ -18,7 +18,13 @@
     #include "common.h"
     #include "mapreduce.h"
     #include "dictionary.h"
+    #include "output.h"
+    #include "dictionary_partitioned.h"
     #include "wordstreamer.h"
+    #include "wordstreamer_schunks.h"
+    #include "wordstreamer_iblocks.h"
+    #include "wordstreamer_dynamic.h"
+    #include "ngram.h"
 
     /**
      * @struct mapreduce_parallel_thread_s
@@ -26,18 +32,48 @@
      */
     typedef struct mapreduce_parallel_thread_s {
         pthread_t*     thread;         /**<  Pointer to PThread handler       */
+        void*        (*map)(void*);    /**<  Map loop for reader and streamer */
         Dictionary*    dictionary;     /**<  Pointer to a sorted hashtab      */
         Wordstreamer*  wordstreamer;   /**<  Pointer to a streamer of words   */
+        Ngram*         ngram;          /**<  Ring of words (n-grams or NULL)  */
+        bool           steal;          /**<  Steal work once stream is over   */
     } Mapreduce_parallel_thread;
 
 
+    /**
+     * @struct mapreduce_parallel_merge_s
+     * @brief  Pair of dictionaries merged by a thread during reduce
+     */
+    typedef struct mapreduce_parallel_merge_s {
+        Dictionary*    first;          /**<  Dictionary receiving the words   */
+        Dictionary*    second;         /**<  Dictionary merged in the first   */
+    } Mapreduce_parallel_merge;
+
+
+    /**
+     * @struct mapreduce_parallel_shuffle_s
+     * @brief  Partition of all dictionaries merged by a reducer thread
+     */
+    typedef struct mapreduce_parallel_shuffle_s {
+        Dictionary**   dictionaries;   /**<  Partitioned dictionaries         */
+        unsigned int   nb_dictionaries;/**<  Number of dictionaries           */
+        unsigned int   partition;      /**<  Partition merged by the reducer  */
+    } Mapreduce_parallel_shuffle;
+
+
     /* ============================== Prototypes ============================ */
 
     Mapreduce*   mr_parallel_create(const char*, const unsigned int,
                                const ws_type, const fr_type, const unsigned int,
-                                                        const bool, const bool);
+                                         const dc_type, const bool, const bool);
     void         mr_parallel_delete(Mapreduce*);
 
     void         mr_parallel_map(Mapreduce*);
     void         mr_parallel_reduce(Mapreduce*);
+    void         mr_parallel_merge(Dictionary**, const unsigned int);
+    void         mr_parallel_shuffle(Dictionary**, const unsigned int);
+
+    void*        _thread_map(void*);
+    void*        _thread_merge(void*);
+    void*        _thread_shuffle(void*);
 #endif
@@ -0,0 +1,482 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file mapreduce_pipeline.c
+ * @brief Mapreduce pipeline implementation. One or two threads tokenize the
+ *        file and push batches of words in lock-free rings, while all other
+ *        threads only count words in their own dictionary.
+ * @author Jean-Yves VET
+ */
+
+#include <sched.h>
+#include "mapreduce.h"
+#include "mapreduce_pipeline.h"
+#include "mapreduce_parallel.h"
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Constructor for Mapreduce pipeline.
+ *
+ * @param  file_path[in]    String containg the path to the file we want to read
+ * @param  nb_threads[in]   Number of threads to use
+ * @param  wstreamer_type[in]   Type of wordstreamer to use
+ * @param  reader_type[in]      Type of filereader to use
+ * @param  read_buffer_size[in] Size in bytes of the read buffer
+ * @param  dictionary_type[in]  Type of dictionary to use
+ * @param  quiet[in]        Activate the quiet mode (no output)
+ * @param  profiling[in]    Activate the profiling mode
+ * @return  A Mapreduce structure
+ */
+Mapreduce* mr_pipeline_create(const char *file_path,
+                    const unsigned int nb_threads, const ws_type wstreamer_type,
+                     const fr_type reader_type, unsigned int reader_buffer_size,
+                 const dc_type dictionary_type, const bool quiet,
+                                                       const bool profiling) {
+    int p, c, b;
+    Mapreduce *mr = _mr_common_create(file_path, nb_threads, MR_PIPELINE,
+                                                              quiet, profiling);
+    /* Set function pointers */
+    mr->map = mr_pipeline_map;
+    mr->reduce = mr_pipeline_reduce;
+    mr->delete = mr_pipeline_delete;
+
+    Mapreduce_pipeline_ext *ext = malloc(sizeof(Mapreduce_pipeline_ext));
+    assert(ext != NULL);
+    mr->ext = ext;
+
+    /* Split threads between tokenizers and counters */
+    unsigned int nb_producers = nb_threads / MAPREDUCE_PIPELINE_THREADS_PER_PRODUCER;
+    if (nb_producers < 1) nb_producers = 1;
+    if (nb_producers > MAPREDUCE_PIPELINE_MAX_PRODUCERS) {
+        nb_producers = MAPREDUCE_PIPELINE_MAX_PRODUCERS;
+    }
+
+    unsigned int nb_consumers = (nb_threads > nb_producers) ?
+                                                  nb_threads - nb_producers : 1;
+
+    ext->nb_producers = nb_producers;
+    ext->nb_consumers = nb_consumers;
+    ext->producers = malloc(nb_producers*sizeof(Mapreduce_pipeline_producer));
+    ext->consumers = malloc(nb_consumers*sizeof(Mapreduce_pipeline_consumer));
+    assert(ext->producers != NULL && ext->consumers != NULL);
+
+    /* Consumers */
+    for(c=0; c<nb_consumers; c++) {
+        Mapreduce_pipeline_consumer *consumer = &ext->consumers[c];
+
+        consumer->thread = malloc(sizeof(pthread_t));
+        assert(consumer->thread != NULL);
+        consumer->dictionary = mr_dictionary_create(dictionary_type,
+                                                                    profiling);
+        consumer->full_rings = malloc(nb_producers*sizeof(Ringbuffer*));
+        consumer->free_rings = malloc(nb_producers*sizeof(Ringbuffer*));
+        assert(consumer->full_rings != NULL && consumer->free_rings != NULL);
+        consumer->producers = ext->producers;
+        consumer->nb_producers = nb_producers;
+        consumer->stalls = 0;
+    }
+
+    /* Producers */
+    for(p=0; p<nb_producers; p++) {
+        Mapreduce_pipeline_producer *producer = &ext->producers[p];
+
+        if (p == 0) {
+            producer->wordstreamer = mr_wordstreamer_create_first(file_path,
+                                nb_producers, wstreamer_type, reader_type,
+                                reader_buffer_size, profiling);
+        } else {
+            producer->wordstreamer = mr_wordstreamer_create_another(
+                                            ext->producers[0].wordstreamer, p);
+        }
+
+        producer->thread = malloc(sizeof(pthread_t));
+        assert(producer->thread != NULL);
+        producer->full_rings = malloc(nb_consumers*sizeof(Ringbuffer*));
+        producer->free_rings = malloc(nb_consumers*sizeof(Ringbuffer*));
+        assert(producer->full_rings != NULL && producer->free_rings != NULL);
+        producer->spare = NULL;
+        producer->ngram = NULL;
+        producer->nb_consumers = nb_consumers;
+        producer->next_consumer = 0;
+        producer->batch_size = MAPREDUCE_PIPELINE_BATCH_SIZE;
+        producer->nb_batches = 0;
+        producer->occupancy = 0;
+        producer->stalls = 0;
+        producer->done = false;
+
+        /* One pair of rings between each producer and each consumer. Free
+           rings are large enough to hold all batches of the producer. */
+        for(c=0; c<nb_consumers; c++) {
+            Ringbuffer *full = mr_ringbuffer_create(
+                                              MAPREDUCE_PIPELINE_RING_SIZE);
+            Ringbuffer *free = mr_ringbuffer_create(
+                                           MAPREDUCE_PIPELINE_BATCHES);
+
+            producer->full_rings[c] = full;
+            producer->free_rings[c] = free;
+            ext->consumers[c].full_rings[p] = full;
+            ext->consumers[c].free_rings[p] = free;
+        }
+
+        /* Allocate the batches of the producer */
+        for(b=0; b<MAPREDUCE_PIPELINE_BATCHES; b++) {
+            Mapreduce_pipeline_batch *batch =
+                malloc(sizeof(Mapreduce_pipeline_batch) + producer->batch_size);
+            assert(batch != NULL);
+
+            int ret = mr_ringbuffer_push(producer->free_rings[b%nb_consumers],
+                                                                        batch);
+            assert(!ret);
+        }
+    }
+
+    return mr;
+}
+
+
+/**
+ * Delete Mapreduce and associated structures.
+ *
+ * @param   mr[in]     Pointer to a Mapreduce structure
+ */
+void mr_pipeline_delete(Mapreduce *mr) {
+    if (mr != NULL) {
+        int p, c;
+        void *batch;
+        Mapreduce_pipeline_ext *ext = (Mapreduce_pipeline_ext *) mr->ext;
+
+        /* Display ring statistics [Profiling mode] */
+        if (mr->profiling) {
+            for(p=0; p<ext->nb_producers; p++) {
+                Mapreduce_pipeline_producer *producer = &ext->producers[p];
+                double occupancy = (producer->nb_batches) ?
+                  (double)producer->occupancy/producer->nb_batches : 0.0;
+
+                #if MAPREDUCE_DEFAULT_USECOLORS
+                    printf("\e[34m |-[Pipeline producer %d] batches:\e[1m %lld"
+                           "\e[0m\e[34m, ring occupancy:\e[1m %.2f/%d\e[0m"
+                           "\e[34m, stalls:\e[1m %lld\e[0m\n", p,
+                           producer->nb_batches, occupancy,
+                           MAPREDUCE_PIPELINE_RING_SIZE, producer->stalls);
+                #else
+                    printf(" |-[Pipeline producer %d] batches: %lld, ring "
+                           "occupancy: %.2f/%d, stalls: %lld\n", p,
+                           producer->nb_batches, occupancy,
+                           MAPREDUCE_PIPELINE_RING_SIZE, producer->stalls);
+                #endif
+            }
+
+            for(c=0; c<ext->nb_consumers; c++) {
+                #if MAPREDUCE_DEFAULT_USECOLORS
+                    printf("\e[34m |-[Pipeline consumer %d] stalls:\e[1m %lld"
+                           "\e[0m\n", c, ext->consumers[c].stalls);
+                #else
+                    printf(" |-[Pipeline consumer %d] stalls: %lld\n", c,
+                                                     ext->consumers[c].stalls);
+                #endif
+            }
+        }
+
+        /* Delete rings and batches (all of them are back in free rings
+           once the map operation is over) */
+        for(p=0; p<ext->nb_producers; p++) {
+            Mapreduce_pipeline_producer *producer = &ext->producers[p];
+
+            for(c=0; c<ext->nb_consumers; c++) {
+                while (!mr_ringbuffer_pop(producer->full_rings[c], &batch)) {
+                    free(batch);
+                }
+                while (!mr_ringbuffer_pop(producer->free_rings[c], &batch)) {
+                    free(batch);
+                }
+
+                mr_ringbuffer_delete(&producer->full_rings[c]);
+                mr_ringbuffer_delete(&producer->free_rings[c]);
+            }
+
+            if (producer->spare != NULL) free(producer->spare);
+            mr_wordstreamer_delete(&producer->wordstreamer);
+            free(producer->full_rings);
+            free(producer->free_rings);
+            free(producer->thread);
+        }
+
+        for(c=0; c<ext->nb_consumers; c++) {
+            Mapreduce_pipeline_consumer *consumer = &ext->consumers[c];
+
+            mr_dictionary_delete(&consumer->dictionary);
+            free(consumer->full_rings);
+            free(consumer->free_rings);
+            free(consumer->thread);
+        }
+
+        free(ext->producers);
+        free(ext->consumers);
+        free(ext);
+    }
+}
+
+
+/* ============================ Private functions =========================== */
+
+/**
+ * Get an empty batch given back by any consumer. Wait if all batches are in
+ * use.
+ *
+ * @param   producer[inout]  Pointer to the producer structure
+ * @return  Pointer to an empty batch
+ */
+static inline Mapreduce_pipeline_batch* _mr_pipeline_get_batch(
+                                       Mapreduce_pipeline_producer *producer) {
+    int i;
+    void *batch;
+    unsigned int nb_consumers = producer->nb_consumers;
+
+    while (1) {
+        for(i=0; i<nb_consumers; i++) {
+            if (!mr_ringbuffer_pop(producer->free_rings[i], &batch)) {
+                Mapreduce_pipeline_batch *b = batch;
+                b->nb_words = 0;
+                b->size = 0;
+
+                return b;
+            }
+        }
+
+        producer->stalls++;
+        sched_yield();
+    }
+}
+
+
+/**
+ * Push a batch to the next consumer which has room in its ring. Wait if all
+ * rings are full.
+ *
+ * @param   producer[inout]  Pointer to the producer structure
+ * @param   batch[in]        Pointer to the batch to push
+ */
+static inline void _mr_pipeline_push_batch(
+        Mapreduce_pipeline_producer *producer, Mapreduce_pipeline_batch *batch) {
+    int i;
+    unsigned int nb_consumers = producer->nb_consumers;
+
+    while (1) {
+        for(i=0; i<nb_consumers; i++) {
+            unsigned int c = (producer->next_consumer + i) % nb_consumers;
+            Ringbuffer *ring = producer->full_rings[c];
+            unsigned int occupancy = mr_ringbuffer_count(ring);
+
+            if (!mr_ringbuffer_push(ring, batch)) {
+                producer->next_consumer = c + 1;
+                producer->occupancy += occupancy;
+                producer->nb_batches++;
+                return;
+            }
+        }
+
+        producer->stalls++;
+        sched_yield();
+    }
+}
+
+
+/**
+ * Thread function which tokenizes words and pushes them by batches.
+ *
+ * @param   t_struct[inout]     Pointer to the producer structure
+ */
+void* _thread_produce(void *t_struct) {
+    Mapreduce_pipeline_producer *producer = t_struct;
+    Wordstreamer *ws = producer->wordstreamer;
+    Ngram *ng = producer->ngram;
+
+    /* Keep room for a complete key in the batch */
+    unsigned int max_size = (ng == NULL) ? MAPREDUCE_MAX_WORD_SIZE
+                                    : ng->n * (MAPREDUCE_MAX_WORD_SIZE + 1);
+    assert(producer->batch_size > MR_PIPELINE_WORD_SIZE(max_size));
+    unsigned int limit = producer->batch_size - MR_PIPELINE_WORD_SIZE(max_size);
+    Mapreduce_pipeline_batch *batch = _mr_pipeline_get_batch(producer);
+    Mapreduce_pipeline_word *word = (Mapreduce_pipeline_word *) batch->data;
+
+    while (1) {
+        if (ng == NULL) {
+            if (mr_wordstreamer_get(ws, word->name)) break;
+
+            word->hash = ws->word_hash;
+            word->length = ws->word_length;
+        } else {
+            /* N-grams are built by producers so consumers only count them */
+            if (mr_wordstreamer_get(ws, mr_ngram_slot(ng))) break;
+            if (mr_ngram_push(ng, ws)) continue;
+
+            word->hash = ng->hash;
+            word->length = mr_ngram_materialize(ng, word->name);
+        }
+
+        /* Wordstreamers truncate words, so a key always fits in the room */
+        assert(word->length <= max_size);
+        batch->size += MR_PIPELINE_WORD_SIZE(word->length);
+        batch->nb_words++;
+
+        if (batch->size > limit) {
+            _mr_pipeline_push_batch(producer, batch);
+            batch = _mr_pipeline_get_batch(producer);
+        }
+
+        word = (Mapreduce_pipeline_word *) ((char *) batch->data + batch->size);
+    }
+
+    /* Push last words */
+    if (batch->nb_words) {
+        _mr_pipeline_push_batch(producer, batch);
+    } else {
+        producer->spare = batch;
+    }
+
+    __atomic_store_n(&producer->done, true, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+
+/**
+ * Thread function which counts words received from producers.
+ *
+ * @param   t_struct[inout]     Pointer to the consumer structure
+ */
+void* _thread_consume(void *t_struct) {
+    Mapreduce_pipeline_consumer *consumer = t_struct;
+    Dictionary *dico = consumer->dictionary;
+    unsigned int nb_producers = consumer->nb_producers;
+
+    while (1) {
+        int p, i;
+        void *ptr;
+        bool done = true, received = false;
+
+        /* Check producers before draining rings, so that nothing may be
+           pushed after a final empty pass */
+        for(p=0; p<nb_producers; p++) {
+            done &= __atomic_load_n(&consumer->producers[p].done,
+                                                             __ATOMIC_ACQUIRE);
+        }
+
+        for(p=0; p<nb_producers; p++) {
+            while (!mr_ringbuffer_pop(consumer->full_rings[p], &ptr)) {
+                Mapreduce_pipeline_batch *batch = ptr;
+                char *data = (char *) batch->data;
+
+                for(i=0; i<batch->nb_words; i++) {
+                    Mapreduce_pipeline_word *word =
+                                             (Mapreduce_pipeline_word *) data;
+
+                    mr_dictionary_put_word_hashed(dico, word->name,
+                                                     word->length, word->hash);
+                    data += MR_PIPELINE_WORD_SIZE(word->length);
+                }
+
+                /* Give the batch back (free rings never overflow) */
+                int ret = mr_ringbuffer_push(consumer->free_rings[p], batch);
+                assert(!ret);
+                received = true;
+            }
+        }
+
+        if (!received) {
+            if (done) break;
+
+            consumer->stalls++;
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Map operation.
+ *
+ * @param   mr[inout]     Pointer to a Mapreduce structure
+ */
+void mr_pipeline_map(Mapreduce *mr) {
+    int i;
+    assert(mr != NULL);
+    Mapreduce_pipeline_ext *ext = (Mapreduce_pipeline_ext *) mr->ext;
+
+    /* Launch all threads */
+    for(i=0; i<ext->nb_producers; i++) {
+        ext->producers[i].wordstreamer->boundaries = mr->boundaries;
+        ext->producers[i].wordstreamer->stopwords = mr->stopwords;
+        ext->producers[i].wordstreamer->filter = mr->filter;
+        ext->producers[i].wordstreamer->records = mr->records;
+
+        /* Read n-1 words after each range to complete its last n-grams */
+        if (mr->ngram > 1) {
+            ext->producers[i].ngram = mr_ngram_create(mr->ngram);
+            ext->producers[i].wordstreamer->lookahead = mr->ngram - 1;
+        }
+    }
+
+    for(i=0; i<ext->nb_consumers; i++) {
+        ext->consumers[i].dictionary = mr_dictionary_partition(
+                               ext->consumers[i].dictionary, mr->partitions);
+        pthread_create(ext->consumers[i].thread, NULL, _thread_consume,
+                                                          &ext->consumers[i]);
+    }
+
+    for(i=0; i<ext->nb_producers; i++) {
+        pthread_create(ext->producers[i].thread, NULL, _thread_produce,
+                                                          &ext->producers[i]);
+    }
+
+    /* Join all threads */
+    for(i=0; i<ext->nb_producers; i++) {
+        pthread_join(*ext->producers[i].thread, NULL);
+        mr_ngram_delete(&ext->producers[i].ngram);
+    }
+
+    for(i=0; i<ext->nb_consumers; i++) {
+        pthread_join(*ext->consumers[i].thread, NULL);
+    }
+}
+
+
+/**
+ * Reduce operation : Aggregate results, and display them, sorted by word.
+ *
+ * @param   mr[inout]     Pointer to a Mapreduce structure
+ */
+void mr_pipeline_reduce(Mapreduce *mr) {
+    int i;
+    assert(mr != NULL);
+    Mapreduce_pipeline_ext *ext = (Mapreduce_pipeline_ext *) mr->ext;
+    Dictionary *dictionaries[ext->nb_consumers];
+
+    for(i=0; i<ext->nb_consumers; i++) {
+        dictionaries[i] = ext->consumers[i].dictionary;
+    }
+
+    for(i=0; i<ext->nb_producers; i++) {
+        _stats_merge(&mr->stats, &ext->producers[i].wordstreamer->stats);
+    }
+
+    mr_parallel_merge(dictionaries, ext->nb_consumers);
+
+    mr_reduce_output(mr, dictionaries[0], mr->nb_threads);
+}
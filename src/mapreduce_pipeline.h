@@ -0,0 +1,110 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_PIPELINE_H
+    #define HEADER_MAPREDUCE_PIPELINE_H
+
+    #include <pthread.h>
+    #include "common.h"
+    #include "mapreduce.h"
+    #include "dictionary.h"
+    #include "output.h"
+    #include "wordstreamer.h"
+    #include "ringbuffer.h"
+    #include "ngram.h"
+
+    /**
+     * @struct mapreduce_pipeline_word_s
+     * @brief  Word stored in a batch with its length and hash, so that
+     *         consumers never scan it again.
+     */
+    typedef struct mapreduce_pipeline_word_s {
+        uint64_t       hash;           /**<  Hash of the word                 */
+        unsigned int   length;         /**<  Number of characters             */
+        char           name[];         /**<  Null-terminated spelling         */
+    } Mapreduce_pipeline_word;
+
+    /* Words are aligned in batches to access their header directly */
+    #define MR_PIPELINE_WORD_SIZE(length) \
+        ((sizeof(Mapreduce_pipeline_word) + (length) + 1 + 7) & ~7)
+
+
+    /**
+     * @struct mapreduce_pipeline_batch_s
+     * @brief  Batch of words stored consecutively.
+     */
+    typedef struct mapreduce_pipeline_batch_s {
+        unsigned int   nb_words;       /**<  Number of words in the batch     */
+        unsigned int   size;           /**<  Bytes used in data               */
+        uint64_t       data[];         /**<  Words (aligned storage)          */
+    } Mapreduce_pipeline_batch;
+
+
+    /**
+     * @struct mapreduce_pipeline_producer_s
+     * @brief  Structure containing data for a tokenizer thread.
+     */
+    typedef struct mapreduce_pipeline_producer_s {
+        pthread_t*     thread;         /**<  Pointer to PThread handler       */
+        Wordstreamer*  wordstreamer;   /**<  Pointer to a streamer of words   */
+        Ringbuffer**   full_rings;     /**<  Batches sent to each consumer    */
+        Ringbuffer**   free_rings;     /**<  Batches given back by consumers  */
+        Mapreduce_pipeline_batch* spare;  /**<  Batch left unused at the end  */
+        Ngram*         ngram;          /**<  Ring of words (n-grams or NULL)  */
+        unsigned int   nb_consumers;   /**<  Number of consumers              */
+        unsigned int   next_consumer;  /**<  Next consumer to feed            */
+        unsigned int   batch_size;     /**<  Size in bytes of batch data      */
+        long long      nb_batches;     /**<  Batches pushed [Profiling mode]  */
+        long long      occupancy;      /**<  Sum of ring occupancy at push    */
+        long long      stalls;         /**<  Waits for a ring or a batch      */
+        bool           done;           /**<  All batches were pushed          */
+    } Mapreduce_pipeline_producer;
+
+
+    /**
+     * @struct mapreduce_pipeline_consumer_s
+     * @brief  Structure containing data for a counting thread.
+     */
+    typedef struct mapreduce_pipeline_consumer_s {
+        pthread_t*     thread;         /**<  Pointer to PThread handler       */
+        Dictionary*    dictionary;     /**<  Pointer to a sorted hashtab      */
+        Ringbuffer**   full_rings;     /**<  Batches sent by each producer    */
+        Ringbuffer**   free_rings;     /**<  Batches given back to producers  */
+        Mapreduce_pipeline_producer* producers; /**<  Array of producers      */
+        unsigned int   nb_producers;   /**<  Number of producers              */
+        long long      stalls;         /**<  Waits for a batch                */
+    } Mapreduce_pipeline_consumer;
+
+
+    /**
+     * @struct mapreduce_pipeline_ext_s
+     * @brief  Structure containing extra data for mapreduce_pipeline.
+     */
+    typedef struct mapreduce_pipeline_ext_s {
+        Mapreduce_pipeline_producer*  producers;    /**<  Tokenizer threads   */
+        Mapreduce_pipeline_consumer*  consumers;    /**<  Counting threads    */
+        unsigned int                  nb_producers; /**<  Number of producers */
+        unsigned int                  nb_consumers; /**<  Number of consumers */
+    } Mapreduce_pipeline_ext;
+
+
+    /* ============================== Prototypes ============================ */
+
+    Mapreduce*   mr_pipeline_create(const char*, const unsigned int,
+                               const ws_type, const fr_type, const unsigned int,
+                                         const dc_type, const bool, const bool);
+    void         mr_pipeline_delete(Mapreduce*);
+
+    void         mr_pipeline_map(Mapreduce*);
+    void         mr_pipeline_reduce(Mapreduce*);
+#endif
@@ -30,6 +30,7 @@
  * @param  wstreamer_type[in]   Type of wordstreamer to use
  * @param  reader_type[in]      Type of filereader to use
  * @param  read_buffer_size[in] Size in bytes of the read buffer
+ * @param  dictionary_type[in]  Type of dictionary to use
  * @param  quiet[in]        Activate the quiet mode (no output)
  * @param  profiling[in]    Activate the profiling mode
  * @return  A Mapreduce structure
@@ -37,6 +38,7 @@
 Mapreduce* mr_sequential_create(const char *file_path,
                         const ws_type wstreamer_type, const fr_type reader_type,
                                        unsigned int reader_buffer_size,
+                                       const dc_type dictionary_type,
                                        const bool quiet, const bool profiling) {
     Mapreduce *mr = _mr_common_create(file_path, 1, MR_SEQUENTIAL,
                                                               quiet, profiling);
@@ -48,7 +50,7 @@ Mapreduce* mr_sequential_create(const char *file_path,
     Mapreduce_sequential_ext *ext = malloc(sizeof(Mapreduce_sequential_ext));
     ext->wordstreamer = mr_wordstreamer_create_first(file_path, 1,
                     wstreamer_type, reader_type, reader_buffer_size, profiling);
-    ext->dictionary = mr_dictionary_create(profiling);
+    ext->dictionary = mr_dictionary_create(dictionary_type, profiling);
 
     mr->ext = ext;
 
@@ -89,8 +91,30 @@ void mr_sequential_map(Mapreduce *mr) {
 
     char word[MAPREDUCE_MAX_WORD_SIZE];
 
+    ws->boundaries = mr->boundaries;
+    ws->stopwords = mr->stopwords;
+    ws->filter = mr->filter;
+    ws->records = mr->records;
+
+    if (mr->ngram > 1) {
+        /* Read n-1 words after each range to complete its last n-grams */
+        Ngram *ng = mr_ngram_create(mr->ngram);
+        ws->lookahead = mr->ngram - 1;
+
+        while (!mr_wordstreamer_get(ws, mr_ngram_slot(ng))) {
+            if (!mr_ngram_push(ng, ws)) {
+                mr_dictionary_put_parts(dico, ng->parts, ng->part_lengths,
+                                                            ng->n, ng->hash);
+            }
+        }
+
+        mr_ngram_delete(&ng);
+        return;
+    }
+
     while (!mr_wordstreamer_get(ws, word)) {
-        mr_dictionary_put_word(dico, word);
+        mr_dictionary_put_word_hashed(dico, word, ws->word_length,
+                                                               ws->word_hash);
     }
 }
 
@@ -104,5 +128,7 @@ void mr_sequential_reduce(Mapreduce *mr) {
     Mapreduce_sequential_ext *ext = (Mapreduce_sequential_ext *) mr->ext;
     Dictionary *dico = ext->dictionary;
 
-    if (!mr->quiet) mr_dictionary_display(dico);
+    _stats_merge(&mr->stats, &ext->wordstreamer->stats);
+
+    mr_reduce_output(mr, dico, 1);
 }
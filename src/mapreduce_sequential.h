@@ -17,7 +17,9 @@
     #include "common.h"
     #include "mapreduce.h"
     #include "dictionary.h"
+    #include "output.h"
     #include "wordstreamer.h"
+    #include "ngram.h"
 
     /**
      * @struct mapreduce_sequential_ext_s
@@ -32,7 +34,7 @@
     /* ============================== Prototypes ============================ */
 
     Mapreduce*  mr_sequential_create(const char*, const ws_type,  const fr_type,
-                                    const unsigned int, const bool, const bool);
+                     const unsigned int, const dc_type, const bool, const bool);
     void        mr_sequential_delete(Mapreduce*);
 
     void        mr_sequential_map(Mapreduce*);
@@ -11,18 +11,46 @@
 * KIND, either express or implied.                                             *
 *******************************************************************************/
 
-#ifndef HEADER_MAPREDUCE_WORDSTREAMER_IWORDS_H
-    #define HEADER_MAPREDUCE_WORDSTREAMER_IWORDS_H
+/**
+ * @file ngram.c
+ * @brief Ring of recent words to count n-grams.
+ * @author Jean-Yves VET
+ */
 
-    #include "wordstreamer.h"
+#include "ngram.h"
 
-    /* ============================== Prototypes ============================ */
+/* ========================= Constructor / Destructor ======================= */
 
-    Wordstreamer*  mr_wordstreamer_iwords_create_first(const char*,
-                            const int, const fr_type, const unsigned int, bool);
-    Wordstreamer*  mr_wordstreamer_iwords_create_another(const Wordstreamer*,
-                                                                     const int);
-    void           mr_wordstreamer_iwords_delete(Wordstreamer*);
+/**
+ * Create a Ngram structure.
+ *
+ * @param   n[in]      Number of words per n-gram
+ * @return  Pointer to the new Ngram structure
+ */
+Ngram* mr_ngram_create(const unsigned int n) {
+    assert(n > 1 && n <= MAPREDUCE_MAX_NGRAM);
 
-    int            mr_wordstreamer_iwords_get(Wordstreamer*, char*);
-#endif
+    Ngram *ng = malloc(sizeof(Ngram));
+    assert(ng != NULL);
+
+    ng->n = n;
+    ng->nb_words = 0;
+    ng->next = 0;
+    ng->hash = 0;
+
+    return ng;
+}
+
+
+/**
+ * Delete a Ngram structure and set pointer to NULL.
+ *
+ * @param   ng_ptr[inout]   Pointer to pointer of a Ngram structure
+ */
+void mr_ngram_delete(Ngram **ng_ptr) {
+    assert(ng_ptr != NULL);
+
+    if (*ng_ptr != NULL) free(*ng_ptr);
+
+    *ng_ptr = NULL;
+}
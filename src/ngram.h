@@ -0,0 +1,119 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_NGRAM_H
+    #define HEADER_MAPREDUCE_NGRAM_H
+
+    #include "common.h"
+    #include "word.h"
+    #include "wordstreamer.h"
+
+    /**
+     * @struct ngram_s
+     * @brief  Ring of the last words retrieved by a wordstreamer, used to
+     *         count sequences of n words. Keys are only identified by their
+     *         parts and a combined hash, so no string is built per token.
+     */
+    typedef struct ngram_s {
+        unsigned int  n;                 /**<  Words per n-gram               */
+        unsigned int  nb_words;          /**<  Words in the ring (up to n)    */
+        unsigned int  next;              /**<  Slot for the next word         */
+        uint64_t      hash;              /**<  Hash of the current n-gram     */
+        unsigned int  lengths[MAPREDUCE_MAX_NGRAM];   /**<  Word lengths      */
+        uint64_t      hashes[MAPREDUCE_MAX_NGRAM];    /**<  Word hashes       */
+        bool          extra[MAPREDUCE_MAX_NGRAM];     /**<  Word after range  */
+        const char*   parts[MAPREDUCE_MAX_NGRAM];     /**<  Current n-gram    */
+        unsigned int  part_lengths[MAPREDUCE_MAX_NGRAM]; /**<  Part lengths   */
+        char          words[MAPREDUCE_MAX_NGRAM][MAPREDUCE_MAX_WORD_SIZE];
+                                                      /**<  Word spellings    */
+    } Ngram;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Get the buffer where the wordstreamer shall write the next word.
+     *
+     * @param   ng[in]        Pointer to the Ngram structure
+     * @return  Buffer for the next word
+     */
+    static inline char* mr_ngram_slot(Ngram *ng) {
+        return ng->words[ng->next];
+    }
+
+
+    /**
+     * Add the word just retrieved in the slot to the ring. The ring is reset
+     * when a new range starts, and n-grams starting with an extra word (read
+     * after the range) are left to the streamer owning that word.
+     *
+     * @param   ng[inout]     Pointer to the Ngram structure
+     * @param   ws[in]        Pointer to the Wordstreamer which got the word
+     * @return  0 if a new n-gram is available in parts and hash or 1 otherwise
+     */
+    static inline int mr_ngram_push(Ngram *ng, const Wordstreamer *ws) {
+        int i;
+        unsigned int n = ng->n, slot = ng->next;
+
+        if (ws->word_first) ng->nb_words = 0;
+
+        ng->lengths[slot] = ws->word_length;
+        ng->hashes[slot] = ws->word_hash;
+        ng->extra[slot] = ws->word_extra;
+        ng->next = (slot + 1 == n) ? 0 : slot + 1;
+        if (ng->nb_words < n) ng->nb_words++;
+
+        /* The oldest word is the next slot once the ring is full */
+        if (ng->nb_words < n || ng->extra[ng->next]) return 1;
+
+        for (i=0; i<n; i++) {
+            slot = (ng->next + i < n) ? ng->next + i : ng->next + i - n;
+
+            ng->parts[i] = ng->words[slot];
+            ng->part_lengths[i] = ng->lengths[slot];
+            ng->hash = i ? mr_word_hash_combine(ng->hash, ng->hashes[slot])
+                         : ng->hashes[slot];
+        }
+
+        return 0;
+    }
+
+
+    /**
+     * Write the current n-gram with spaces between words.
+     *
+     * @param   ng[in]        Pointer to the Ngram structure
+     * @param   buffer[out]   Buffer to hold the n-gram
+     * @return  Number of characters written
+     */
+    static inline unsigned int mr_ngram_materialize(const Ngram *ng,
+                                                                char *buffer) {
+        int i;
+        char *ptr = buffer;
+
+        for (i=0; i<ng->n; i++) {
+            if (i) *ptr++ = ' ';
+            memcpy(ptr, ng->parts[i], ng->part_lengths[i]);
+            ptr += ng->part_lengths[i];
+        }
+        *ptr = '\0';
+
+        return ptr - buffer;
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Ngram*   mr_ngram_create(const unsigned int);
+    void     mr_ngram_delete(Ngram**);
+#endif
@@ -0,0 +1,559 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file output.c
+ * @brief Output stage: (key, count) records of a dictionary gathered in a
+ *        contiguous array and sorted with a MSD radix sort on key bytes.
+ *        The first passes are shared by all threads: each thread counts and
+ *        moves the records of its slice, then threads claim buckets and sort
+ *        them on their own.
+ * @author Jean-Yves VET
+ */
+
+#include "output.h"
+#include "dictionary_approx.h"
+
+static void _mr_output_parallel_sort(Output*, Output_record*, Output_record*,
+                              const unsigned int, unsigned int, const so_type);
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Gather records of all words in a dictionary. Keys are not copied, the
+ * Output structure shall be deleted before the dictionary.
+ *
+ * @param   dico[in]        Pointer to the Dictionary structure
+ * @param   nb_threads[in]  Threads used to sort records
+ * @param   profiling[in]   Activate the profiling mode
+ * @return  Pointer to the new Output structure
+ */
+Output* mr_output_create(Dictionary *dico, const unsigned int nb_threads,
+                                                        const bool profiling) {
+    int i;
+    assert(dico != NULL);
+    Output *output = malloc(sizeof(Output));
+    assert(output != NULL);
+
+    mr_dictionary_flush(dico);
+    unsigned int nb_records = dico->nb_words;
+    Word **words = malloc((nb_records+1)*sizeof(Word*));
+    assert(words != NULL);
+
+    output->records = malloc((nb_records+1)*sizeof(Output_record));
+    assert(output->records != NULL);
+
+    dico->list(dico, words);
+
+    for (i=0; i<nb_records; i++) {
+        output->records[i].key = words[i]->name;
+        output->records[i].length = words[i]->length;
+        output->records[i].count = words[i]->count;
+    }
+
+    free(words);
+
+    output->buffer = NULL;
+    output->nb_records = nb_records;
+    output->nb_threads = (nb_threads > 0) ? nb_threads : 1;
+    output->alphabetical = dico->ordered;
+    output->approx = dico->approx;
+    _timer_init(&output->timer_sort, profiling);
+
+    return output;
+}
+
+
+/**
+ * Delete Output structure and set pointer to NULL.
+ *
+ * @param   output_ptr[inout]     Pointer to pointer of Output structure
+ */
+void mr_output_delete(Output **output_ptr) {
+    assert(output_ptr != NULL);
+    Output *output = *output_ptr;
+
+    if (output != NULL) {
+        /* Display time info if requiered [Profiling mode] */
+        _timer_print(&output->timer_sort, "[Output] sort");
+
+        free(output->records);
+        if (output->buffer != NULL) free(output->buffer);
+        free(output);
+    }
+
+    *output_ptr = NULL;
+}
+
+
+/* ============================= Private functions ========================== */
+
+/**
+ * Compare two records.
+ *
+ * @param   a[in]         Pointer to the first record
+ * @param   b[in]         Pointer to the second record
+ * @param   order[in]     Sort order (see common.h)
+ * @return  Negative, zero or positive value as for strcmp
+ */
+static inline int _mr_output_compare(const Output_record *a,
+                               const Output_record *b, const so_type order) {
+    if (order == SO_COUNT && a->count != b->count) {
+        return (a->count > b->count) ? -1 : 1;
+    }
+
+    unsigned int min = (a->length < b->length) ? a->length : b->length;
+    int ret = memcmp(a->key, b->key, min);
+
+    if (ret) return ret;
+
+    return (int)a->length - (int)b->length;
+}
+
+
+/**
+ * Sort a range of records on a single thread. Sorted records end up in src.
+ *
+ * @param   src[inout]    Records to sort
+ * @param   buf[inout]    Buffer of the same size
+ * @param   n[in]         Number of records
+ * @param   depth[in]     Byte of the keys to start with (previous are equal)
+ * @param   order[in]     Sort order (see common.h)
+ */
+static void _mr_output_sort_range(Output_record *src, Output_record *buf,
+                   const unsigned int n, unsigned int depth, const so_type order) {
+    int i, j;
+    unsigned int counts[OUTPUT_NB_BUCKETS];
+    unsigned int offsets[OUTPUT_NB_BUCKETS];
+
+    while (n > MAPREDUCE_OUTPUT_INSERTION_SIZE) {
+        unsigned int b, start;
+
+        memset(counts, 0, sizeof(counts));
+        for (i=0; i<n; i++) counts[_mr_output_bucket(&src[i], depth, order)]++;
+
+        /* Same byte for all records, nothing to move */
+        b = _mr_output_bucket(&src[0], depth, order);
+        if (counts[b] == n) {
+            if (b == 0) return;
+            depth++;
+            continue;
+        }
+
+        offsets[0] = 0;
+        for (b=1; b<OUTPUT_NB_BUCKETS; b++) {
+            offsets[b] = offsets[b-1] + counts[b-1];
+        }
+
+        for (i=0; i<n; i++) {
+            buf[offsets[_mr_output_bucket(&src[i], depth, order)]++] = src[i];
+        }
+
+        memcpy(src, buf, n*sizeof(Output_record));
+
+        /* Keys of the first bucket are over */
+        start = counts[0];
+        for (b=1; b<OUTPUT_NB_BUCKETS; b++) {
+            if (counts[b] > 1) {
+                _mr_output_sort_range(src + start, buf + start, counts[b],
+                                                            depth + 1, order);
+            }
+            start += counts[b];
+        }
+
+        return;
+    }
+
+    /* Insertion sort of small ranges */
+    for (i=1; i<n; i++) {
+        Output_record record = src[i];
+
+        for (j=i; j>0 && _mr_output_compare(&record, &src[j-1], order) < 0;
+                                                                         j--) {
+            src[j] = src[j-1];
+        }
+        src[j] = record;
+    }
+}
+
+
+/**
+ * Thread function which counts the records of its slice in each bucket.
+ *
+ * @param   t_struct[inout]     Pointer to the work of the thread
+ */
+static void* _thread_count(void *t_struct) {
+    int i;
+    Output_thread *t = (Output_thread *) t_struct;
+
+    memset(t->counts, 0, sizeof(t->counts));
+    for (i=t->start; i<t->end; i++) {
+        t->counts[_mr_output_bucket(&t->src[i], t->depth, t->order)]++;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Thread function which moves the records of its slice to their bucket.
+ *
+ * @param   t_struct[inout]     Pointer to the work of the thread
+ */
+static void* _thread_scatter(void *t_struct) {
+    int i;
+    Output_thread *t = (Output_thread *) t_struct;
+
+    for (i=t->start; i<t->end; i++) {
+        t->dst[t->offsets[_mr_output_bucket(&t->src[i], t->depth, t->order)]++]
+                                                                  = t->src[i];
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Thread function which claims buckets and sorts them (except the large ones
+ * sorted afterwards by all threads), then moves them back to src.
+ *
+ * @param   t_struct[inout]     Pointer to the work of the thread
+ */
+static void* _thread_sort_buckets(void *t_struct) {
+    Output_thread *t = (Output_thread *) t_struct;
+    unsigned int b;
+
+    while ((b = __atomic_fetch_add(t->next_bucket, 1, __ATOMIC_RELAXED))
+                                                         < OUTPUT_NB_BUCKETS) {
+        unsigned int offset = t->bucket_offsets[b];
+        unsigned int size = t->bucket_sizes[b];
+
+        if (b && size > t->large_size) continue;
+
+        if (b && size > 1) {
+            _mr_output_sort_range(t->dst + offset, t->src + offset, size,
+                                                       t->depth + 1, t->order);
+        }
+
+        memcpy(t->src + offset, t->dst + offset, size*sizeof(Output_record));
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Offer a record to a bounded heap of the best records (more occurrences,
+ * then alphabetical order). The worst kept record is at the root, so that
+ * most records are rejected after a single comparison.
+ *
+ * @param   heap[inout]   Records kept
+ * @param   nb[inout]     Number of records kept
+ * @param   top[in]       Records kept at most
+ * @param   record[in]    Pointer to the record to offer
+ */
+static void _mr_output_heap_push(Output_record *heap, unsigned int *nb,
+                         const unsigned int top, const Output_record *record) {
+    unsigned int i, child;
+
+    if (*nb < top) {
+        /* Room left: move up the record while its parent is better */
+        for (i=(*nb)++; i>0; i=(i-1)/2) {
+            if (_mr_output_compare(&heap[(i-1)/2], record, SO_COUNT) > 0) break;
+            heap[i] = heap[(i-1)/2];
+        }
+        heap[i] = *record;
+        return;
+    }
+
+    if (_mr_output_compare(record, &heap[0], SO_COUNT) >= 0) return;
+
+    /* Replace the root: move down the record while a child is worse */
+    for (i=0; (child = 2*i + 1) < *nb; i=child) {
+        if (child + 1 < *nb && _mr_output_compare(&heap[child+1],
+                                                &heap[child], SO_COUNT) > 0) {
+            child++;
+        }
+        if (_mr_output_compare(&heap[child], record, SO_COUNT) < 0) break;
+        heap[i] = heap[child];
+    }
+    heap[i] = *record;
+}
+
+
+/**
+ * Thread function which keeps the best records of its slice.
+ *
+ * @param   t_struct[inout]     Pointer to the work of the thread
+ */
+static void* _thread_top(void *t_struct) {
+    int i;
+    Output_thread *t = (Output_thread *) t_struct;
+
+    t->nb_heap = 0;
+    for (i=t->start; i<t->end; i++) {
+        _mr_output_heap_push(t->heap, &t->nb_heap, t->top, &t->src[i]);
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Run a function on all threads, the calling thread being the first one.
+ *
+ * @param   threads[inout]  Work of each thread
+ * @param   nb_threads[in]  Number of threads
+ * @param   func[in]        Thread function
+ */
+static void _mr_output_run(Output_thread *threads,
+                      const unsigned int nb_threads, void* (*func)(void*)) {
+    int i;
+    pthread_t handles[nb_threads];
+
+    for (i=1; i<nb_threads; i++) {
+        pthread_create(&handles[i], NULL, func, &threads[i]);
+    }
+
+    func(&threads[0]);
+
+    for (i=1; i<nb_threads; i++) pthread_join(handles[i], NULL);
+}
+
+
+/**
+ * Sort records with all threads. Sorted records end up in src.
+ *
+ * @param   output[in]    Pointer to the Output structure
+ * @param   src[inout]    Records to sort
+ * @param   buf[inout]    Buffer of the same size
+ * @param   n[in]         Number of records
+ * @param   depth[in]     Byte of the keys to start with (previous are equal)
+ * @param   order[in]     Sort order (see common.h)
+ */
+static void _mr_output_parallel_sort(Output *output, Output_record *src,
+                           Output_record *buf, const unsigned int n,
+                                   unsigned int depth, const so_type order) {
+    int t;
+    unsigned int b, offset, next_bucket = 0;
+    unsigned int nb_threads = output->nb_threads;
+    unsigned int bucket_offsets[OUTPUT_NB_BUCKETS];
+    unsigned int bucket_sizes[OUTPUT_NB_BUCKETS];
+
+    if (nb_threads < 2 || n < MAPREDUCE_OUTPUT_PARALLEL_SIZE) {
+        _mr_output_sort_range(src, buf, n, depth, order);
+        return;
+    }
+
+    Output_thread *threads = malloc(nb_threads*sizeof(Output_thread));
+    assert(threads != NULL);
+
+    for (t=0; t<nb_threads; t++) {
+        threads[t].src = src;
+        threads[t].dst = buf;
+        threads[t].start = (uint64_t)n*t/nb_threads;
+        threads[t].end = (uint64_t)n*(t+1)/nb_threads;
+        threads[t].depth = depth;
+        threads[t].large_size = n/nb_threads;
+        threads[t].order = order;
+        threads[t].next_bucket = &next_bucket;
+        threads[t].bucket_offsets = bucket_offsets;
+        threads[t].bucket_sizes = bucket_sizes;
+    }
+
+    _mr_output_run(threads, nb_threads, _thread_count);
+
+    /* Each thread writes its records of a bucket after previous threads */
+    offset = 0;
+    for (b=0; b<OUTPUT_NB_BUCKETS; b++) {
+        bucket_offsets[b] = offset;
+        for (t=0; t<nb_threads; t++) {
+            threads[t].offsets[b] = offset;
+            offset += threads[t].counts[b];
+        }
+        bucket_sizes[b] = offset - bucket_offsets[b];
+    }
+
+    /* Same byte for all records, nothing to move */
+    b = _mr_output_bucket(&src[0], depth, order);
+    if (bucket_sizes[b] == n) {
+        free(threads);
+        if (b) _mr_output_parallel_sort(output, src, buf, n, depth + 1, order);
+        return;
+    }
+
+    _mr_output_run(threads, nb_threads, _thread_scatter);
+    _mr_output_run(threads, nb_threads, _thread_sort_buckets);
+    free(threads);
+
+    /* Large buckets are sorted by all threads, one after the other */
+    for (b=1; b<OUTPUT_NB_BUCKETS; b++) {
+        if (bucket_sizes[b] > n/nb_threads) {
+            offset = bucket_offsets[b];
+            _mr_output_parallel_sort(output, buf + offset, src + offset,
+                                         bucket_sizes[b], depth + 1, order);
+            memcpy(src + offset, buf + offset,
+                                      bucket_sizes[b]*sizeof(Output_record));
+        }
+    }
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Only keep the records with the most occurrences (ties are broken in
+ * alphabetical order). Each thread selects the best records of its slice in
+ * a bounded heap, then heaps of all threads are merged. Records kept are not
+ * sorted (see mr_output_sort).
+ *
+ * @param   output[inout]   Pointer to the Output structure
+ * @param   top[in]         Records to keep (all if 0)
+ */
+void mr_output_top(Output *output, const unsigned int top) {
+    int t;
+    assert(output != NULL);
+
+    if (top == 0 || top >= output->nb_records) return;
+
+    _timer_start(&output->timer_sort);
+
+    unsigned int n = output->nb_records;
+    unsigned int nb_threads = (n < MAPREDUCE_OUTPUT_PARALLEL_SIZE) ? 1
+                                                        : output->nb_threads;
+    Output_thread *threads = malloc(nb_threads*sizeof(Output_thread));
+    assert(threads != NULL);
+
+    for (t=0; t<nb_threads; t++) {
+        threads[t].src = output->records;
+        threads[t].start = (uint64_t)n*t/nb_threads;
+        threads[t].end = (uint64_t)n*(t+1)/nb_threads;
+        threads[t].top = top;
+        threads[t].heap = malloc(top*sizeof(Output_record));
+        assert(threads[t].heap != NULL);
+    }
+
+    _mr_output_run(threads, nb_threads, _thread_top);
+
+    /* Best records of other threads are offered to the first heap */
+    for (t=1; t<nb_threads; t++) {
+        unsigned int i;
+
+        for (i=0; i<threads[t].nb_heap; i++) {
+            _mr_output_heap_push(threads[0].heap, &threads[0].nb_heap, top,
+                                                         &threads[t].heap[i]);
+        }
+        free(threads[t].heap);
+    }
+
+    free(output->records);
+    if (output->buffer != NULL) free(output->buffer);
+    output->records = threads[0].heap;
+    output->buffer = NULL;
+    output->nb_records = threads[0].nb_heap;
+    output->alphabetical = false;
+    free(threads);
+
+    _timer_stop(&output->timer_sort);
+}
+
+
+/**
+ * Sort records.
+ *
+ * @param   output[inout]   Pointer to the Output structure
+ * @param   order[in]       Sort order (see common.h)
+ */
+void mr_output_sort(Output *output, const so_type order) {
+    unsigned int i, depth = 0;
+    assert(output != NULL);
+
+    /* Records of ordered dictionaries are already alphabetical */
+    if (order == SO_ALPHA && output->alphabetical) return;
+
+    _timer_start(&output->timer_sort);
+
+    if (output->nb_records > 1) {
+        if (output->buffer == NULL) {
+            output->buffer = malloc(output->nb_records*sizeof(Output_record));
+            assert(output->buffer != NULL);
+        }
+
+        /* Bytes of counts above the largest one are equal for all records */
+        if (order == SO_COUNT) {
+            uint64_t max = 0;
+
+            for (i=0; i<output->nb_records; i++) {
+                if (output->records[i].count > max) {
+                    max = output->records[i].count;
+                }
+            }
+
+            while (depth < 7 && !(max >> (56 - 8*depth))) depth++;
+        }
+
+        _mr_output_parallel_sort(output, output->records, output->buffer,
+                                              output->nb_records, depth, order);
+    }
+
+    output->alphabetical = (order == SO_ALPHA);
+
+    _timer_stop(&output->timer_sort);
+}
+
+
+/**
+ * Display all records in their current order. Estimated counts are upper
+ * bounds followed by their maximum error.
+ *
+ * @param   output[in]      Pointer to the Output structure
+ */
+void mr_output_display(const Output *output) {
+    int i;
+    assert(output != NULL);
+
+    if (output->approx) {
+        for (i=0; i<output->nb_records; i++) {
+            printf("%s=%llu (error<=%u)\n", output->records[i].key,
+                   (unsigned long long)output->records[i].count,
+                   mr_dictionary_approx_error(output->records[i].key));
+        }
+        return;
+    }
+
+    for (i=0; i<output->nb_records; i++) {
+        printf("%s=%llu\n", output->records[i].key,
+                             (unsigned long long)output->records[i].count);
+    }
+}
+
+
+/**
+ * Display words of a dictionary in a given order.
+ *
+ * @param   dico[in]        Pointer to the Dictionary structure
+ * @param   order[in]       Sort order (see common.h)
+ * @param   top[in]         Only display the most frequent words (all if 0)
+ * @param   nb_threads[in]  Threads used to sort records
+ * @param   profiling[in]   Activate the profiling mode
+ */
+void mr_output_print(Dictionary *dico, const so_type order,
+                       const unsigned int top, const unsigned int nb_threads,
+                                                       const bool profiling) {
+    Output *output = mr_output_create(dico, nb_threads, profiling);
+
+    mr_output_top(output, top);
+    mr_output_sort(output, order);
+    mr_output_display(output);
+    mr_output_delete(&output);
+}
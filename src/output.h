@@ -0,0 +1,115 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file output.h
+ * @brief Output stage: (key, count) records of a dictionary gathered in a
+ *        contiguous array and sorted with a parallel MSD radix sort.
+ * @author Jean-Yves VET
+ */
+
+#ifndef HEADER_MAPREDUCE_OUTPUT_H
+    #define HEADER_MAPREDUCE_OUTPUT_H
+
+    #include <pthread.h>
+    #include "common.h"
+    #include "dictionary.h"
+
+    /* Buckets of a radix pass: end of key, then one per byte value */
+    #define OUTPUT_NB_BUCKETS    257
+
+    /**
+     * @struct output_record_s
+     * @brief  A key and its number of occurrences.
+     */
+    typedef struct output_record_s {
+        const char*   key;           /**<  Spelling of the key (in a Word)    */
+        unsigned int  length;        /**<  Number of characters in the key    */
+        uint64_t      count;         /**<  Occurrences of the key             */
+    } Output_record;
+
+
+    /**
+     * @struct output_s
+     * @brief  Structure containing the records to sort and display.
+     */
+    typedef struct output_s {
+        Output_record* records;      /**<  Records (sorted after sort)        */
+        Output_record* buffer;       /**<  Buffer of radix passes             */
+        unsigned int   nb_records;   /**<  Number of records                  */
+        unsigned int   nb_threads;   /**<  Threads sorting records            */
+        bool           alphabetical; /**<  Records are already alphabetical   */
+        bool           approx;       /**<  Counts are estimated (see below)   */
+        Timer          timer_sort;   /**<  Timer for sort [Profiling mode]    */
+    } Output;
+
+
+    /**
+     * @struct output_thread_s
+     * @brief  Work of a thread during a parallel radix pass or a parallel
+     *         selection of the most frequent records.
+     */
+    typedef struct output_thread_s {
+        Output_record* src;          /**<  Records of the pass                */
+        Output_record* dst;          /**<  Records partitioned by byte        */
+        unsigned int   start;        /**<  First record of the thread         */
+        unsigned int   end;          /**<  Record after the last one          */
+        unsigned int   depth;        /**<  Byte of the keys sorted            */
+        unsigned int   large_size;   /**<  Larger buckets use all threads     */
+        so_type        order;        /**<  Sort order (see common.h)          */
+        unsigned int   counts[OUTPUT_NB_BUCKETS];  /**< Records per bucket    */
+        unsigned int   offsets[OUTPUT_NB_BUCKETS]; /**< Next record per bucket*/
+        unsigned int*  next_bucket;  /**<  Next bucket to claim (shared)      */
+        unsigned int*  bucket_offsets;  /**<  First record of buckets         */
+        unsigned int*  bucket_sizes;    /**<  Records in buckets              */
+        Output_record* heap;         /**<  Best records of the slice          */
+        unsigned int   nb_heap;      /**<  Records in the heap                */
+        unsigned int   top;          /**<  Records kept at most               */
+    } Output_thread;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Get the bucket of a record for a radix pass. Keys are compared byte by
+     * byte as with memcmp, shorter keys first. In count order, the 8 bytes of
+     * the complemented count (most significant first) come before the key.
+     *
+     * @param   record[in]    Pointer to the record
+     * @param   depth[in]     Byte of the key
+     * @param   order[in]     Sort order (see common.h)
+     * @return  Bucket of the record (0 once the key is over)
+     */
+    static inline unsigned int _mr_output_bucket(const Output_record *record,
+                                      unsigned int depth, const so_type order) {
+        if (order == SO_COUNT) {
+            if (depth < 8) return 1 + ((~record->count >> (56 - 8*depth)) & 0xff);
+            depth -= 8;
+        }
+
+        return (depth < record->length) ? 1 + (unsigned char)record->key[depth]
+                                        : 0;
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Output*      mr_output_create(Dictionary*, const unsigned int, const bool);
+    void         mr_output_delete(Output**);
+
+    void         mr_output_top(Output*, const unsigned int);
+    void         mr_output_sort(Output*, const so_type);
+    void         mr_output_display(const Output*);
+    void         mr_output_print(Dictionary*, const so_type, const unsigned int,
+                                             const unsigned int, const bool);
+#endif
@@ -0,0 +1,57 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file records.c
+ * @brief Record mode settings to count values of CSV/TSV columns.
+ * @author Jean-Yves VET
+ */
+
+#include "records.h"
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Create a Records structure.
+ *
+ * @param   delimiter[in]   Field delimiter
+ * @param   columns[in]     Selected columns (bit 0 for the first column)
+ * @return  Pointer to the new Records structure
+ */
+Records* mr_records_create(const char delimiter, const uint64_t columns) {
+    assert(columns != 0 && delimiter != MR_RECORDS_QUOTE
+                        && delimiter != MR_RECORDS_NEWLINE);
+
+    Records *r = malloc(sizeof(Records));
+    assert(r != NULL);
+
+    r->delimiter = delimiter;
+    r->columns = columns;
+    r->last_column = 63 - __builtin_clzll(columns);
+
+    return r;
+}
+
+
+/**
+ * Delete a Records structure and set pointer to NULL.
+ *
+ * @param   r_ptr[inout]    Pointer to pointer of a Records structure
+ */
+void mr_records_delete(Records **r_ptr) {
+    assert(r_ptr != NULL);
+
+    if (*r_ptr != NULL) free(*r_ptr);
+
+    *r_ptr = NULL;
+}
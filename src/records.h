@@ -0,0 +1,328 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file records.h
+ * @brief Parse CSV/TSV records and keep the values of selected columns.
+ * @author Jean-Yves VET
+ */
+
+#ifndef HEADER_MAPREDUCE_RECORDS_H
+    #define HEADER_MAPREDUCE_RECORDS_H
+
+    #include "common.h"
+    #include "filereader.h"
+    #if defined(__AVX2__) || defined(__SSE2__)
+        #include <immintrin.h>
+    #endif
+
+    #define MR_RECORDS_QUOTE    '"'
+    #define MR_RECORDS_NEWLINE  '\n'
+
+    /**
+     * @struct records_s
+     * @brief  Record mode settings shared by all streamers.
+     */
+    typedef struct records_s {
+        char           delimiter;      /**<  Field delimiter (',' or '\t')    */
+        uint64_t       columns;        /**<  Selected columns (bit 0: first)  */
+        unsigned int   last_column;    /**<  Last selected column             */
+    } Records;
+
+
+    /**
+     * @struct records_parser_s
+     * @brief  State of the parser of a streamer. Bytes are processed by blocks
+     *         of 64 with a bit per byte for quotes, delimiters and newlines, so
+     *         fields are found without testing each byte.
+     */
+    typedef struct records_parser_s {
+        const char*    span;           /**<  Bytes given by the filereader    */
+        unsigned int   span_size;      /**<  Number of bytes in the span      */
+        unsigned int   span_offset;    /**<  Offset of the next block in span */
+        const char*    block;          /**<  Current block (span or tail)     */
+        unsigned int   block_size;     /**<  Valid bytes in the block         */
+        unsigned int   position;       /**<  Next byte of the current field   */
+        uint64_t       structurals;    /**<  Field ends left in the block     */
+        uint64_t       newlines;       /**<  Row ends of the block            */
+        unsigned long long rows;       /**<  Row ends seen since the reset    */
+        uint64_t       quoted;         /**<  All ones inside a quoted field   */
+        unsigned int   column;         /**<  Column of the current field      */
+        char           tail[64];       /**<  Zero padded copy of a last block */
+    } Records_parser;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Get a mask with a bit set for each byte of a block of 64 bytes equal to
+     * a character.
+     *
+     * @param   block[in]       Block of 64 bytes
+     * @param   character[in]   Character to look for
+     * @return  Mask of matching bytes
+     */
+    static inline uint64_t mr_records_mask(const char *block, char character) {
+    #if defined(__AVX2__)
+        __m256i c = _mm256_set1_epi8(character);
+        uint32_t lo = _mm256_movemask_epi8(_mm256_cmpeq_epi8(c,
+                                 _mm256_loadu_si256((const __m256i *) block)));
+        uint32_t hi = _mm256_movemask_epi8(_mm256_cmpeq_epi8(c,
+                            _mm256_loadu_si256((const __m256i *) (block+32))));
+
+        return lo | ((uint64_t) hi << 32);
+    #elif defined(__SSE2__)
+        int i;
+        uint64_t mask = 0;
+        __m128i c = _mm_set1_epi8(character);
+
+        for (i=0; i<4; i++) {
+            uint16_t bits = _mm_movemask_epi8(_mm_cmpeq_epi8(c,
+                          _mm_loadu_si128((const __m128i *) (block + 16*i))));
+            mask |= (uint64_t) bits << (16*i);
+        }
+
+        return mask;
+    #else
+        int i;
+        uint64_t mask = 0;
+
+        for (i=0; i<64; i++) {
+            if (block[i] == character) mask |= 1ULL << i;
+        }
+
+        return mask;
+    #endif
+    }
+
+
+    /**
+     * Turn a mask of quotes into a mask of bytes inside quotes (prefix xor):
+     * a bit is set from an opening quote (included) to the closing quote
+     * (excluded).
+     *
+     * @param   quotes[in]      Mask of quotes
+     * @return  Mask of quoted bytes
+     */
+    static inline uint64_t mr_records_prefix_xor(uint64_t quotes) {
+        quotes ^= quotes << 1;
+        quotes ^= quotes << 2;
+        quotes ^= quotes << 4;
+        quotes ^= quotes << 8;
+        quotes ^= quotes << 16;
+        quotes ^= quotes << 32;
+
+        return quotes;
+    }
+
+
+    /**
+     * Reset a parser before a new range. Ranges always start on a row.
+     *
+     * @param   p[out]          Pointer to the Records_parser structure
+     */
+    static inline void mr_records_reset(Records_parser *p) {
+        p->span = NULL;
+        p->span_size = 0;
+        p->span_offset = 0;
+        p->block = NULL;
+        p->block_size = 0;
+        p->position = 0;
+        p->structurals = 0;
+        p->newlines = 0;
+        p->rows = 0;
+        p->quoted = 0;
+        p->column = 0;
+    }
+
+
+    /**
+     * Load the next block of 64 bytes of the range and compute its masks.
+     *
+     * @param   r[in]           Pointer to the Records structure
+     * @param   p[inout]        Pointer to the Records_parser structure
+     * @param   fr[inout]       Filereader set on the range
+     * @return  0 if a block was loaded or 1 if the range is over
+     */
+    static inline int _mr_records_next_block(const Records *r,
+                                         Records_parser *p, Filereader *fr) {
+        if (p->span_offset >= p->span_size) {
+            p->span_size = mr_filereader_get_block(fr, &p->span);
+            p->span_offset = 0;
+
+            if (!p->span_size) return 1;
+        }
+
+        unsigned int size = p->span_size - p->span_offset;
+
+        if (size >= 64) {
+            p->block = p->span + p->span_offset;
+            size = 64;
+        } else {
+            memcpy(p->tail, p->span + p->span_offset, size);
+            memset(p->tail + size, 0, 64 - size);
+            p->block = p->tail;
+        }
+
+        p->span_offset += size;
+        p->block_size = size;
+        p->position = 0;
+
+        /* Bytes inside quotes do not end fields, the carry tells whether the
+           previous block ended inside quotes */
+        uint64_t valid = (size == 64) ? ~0ULL : (1ULL << size) - 1;
+        uint64_t quoted = mr_records_prefix_xor(
+                            mr_records_mask(p->block, MR_RECORDS_QUOTE)) ^ p->quoted;
+        p->quoted = (uint64_t) ((int64_t) quoted >> 63);
+
+        p->newlines = mr_records_mask(p->block, MR_RECORDS_NEWLINE)
+                                                           & ~quoted & valid;
+        p->rows += __builtin_popcountll(p->newlines);
+        p->structurals = (mr_records_mask(p->block, r->delimiter)
+                                            & ~quoted & valid) | p->newlines;
+
+        return 0;
+    }
+
+
+    /**
+     * Append bytes of the current field to a buffer (values longer than the
+     * maximum word size are truncated).
+     *
+     * @param   buffer[inout]   Buffer holding the field
+     * @param   length[inout]   Bytes already in the buffer
+     * @param   bytes[in]       Bytes to append
+     * @param   size[in]        Number of bytes to append
+     */
+    static inline void _mr_records_append(char *buffer, unsigned int *length,
+                                       const char *bytes, unsigned int size) {
+        if (*length + size > MAPREDUCE_MAX_WORD_SIZE - 1) {
+            size = MAPREDUCE_MAX_WORD_SIZE - 1 - *length;
+        }
+
+        memcpy(buffer + *length, bytes, size);
+        *length += size;
+    }
+
+
+    /**
+     * Finish a field: remove the carriage return of CRLF rows, the enclosing
+     * quotes and the escaping of quotes.
+     *
+     * @param   buffer[inout]   Buffer holding the field
+     * @param   length[in]      Bytes in the buffer
+     * @param   row_end[in]     The field ends a row
+     * @return  Length of the value
+     */
+    static inline unsigned int _mr_records_finish(char *buffer,
+                                           unsigned int length, bool row_end) {
+        if (row_end && length && buffer[length-1] == '\r') length--;
+
+        if (length && buffer[0] == MR_RECORDS_QUOTE) {
+            unsigned int i, j = 0;
+
+            for (i=1; i<length; i++) {
+                if (buffer[i] == MR_RECORDS_QUOTE) {
+                    if (i+1 < length && buffer[i+1] == MR_RECORDS_QUOTE) i++;
+                    else continue;
+                }
+
+                buffer[j++] = buffer[i];
+            }
+
+            length = j;
+        }
+
+        buffer[length] = '\0';
+
+        return length;
+    }
+
+
+    /**
+     * Get the next non empty value of a selected column in the range set in
+     * the filereader. Columns after the last selected one are skipped up to
+     * the end of the row with the newline mask only.
+     *
+     * @param   r[in]           Pointer to the Records structure
+     * @param   p[inout]        Pointer to the Records_parser structure
+     * @param   fr[inout]       Filereader set on the range
+     * @param   buffer[out]     Buffer to hold the value
+     * @param   length_ptr[out] Length of the value
+     * @return  0 if a value was copied into the buffer or 1 if the end of the
+     *          range was reached
+     */
+    static inline int mr_records_get(const Records *r, Records_parser *p,
+                   Filereader *fr, char *buffer, unsigned int *length_ptr) {
+        unsigned int length = 0;
+
+        while (1) {
+            unsigned int column = p->column;
+            bool selected = column < 64 && ((r->columns >> column) & 1);
+
+            if (p->position >= p->block_size) {
+                if (_mr_records_next_block(r, p, fr)) {
+                    /* Last row without a newline */
+                    p->column = 0;
+                    if (!selected || !length) return 1;
+
+                    *length_ptr = _mr_records_finish(buffer, length, true);
+                    return *length_ptr ? 0 : 1;
+                }
+            }
+
+            /* Only the end of the row matters after the last selected column */
+            uint64_t ends = (column > r->last_column) ? p->structurals
+                                                         & p->newlines
+                                                       : p->structurals;
+
+            if (!ends) {
+                if (selected) {
+                    _mr_records_append(buffer, &length, p->block + p->position,
+                                                  p->block_size - p->position);
+                }
+
+                p->structurals = 0;
+                p->position = p->block_size;
+                continue;
+            }
+
+            unsigned int end = __builtin_ctzll(ends);
+            bool row_end = (p->newlines >> end) & 1;
+            p->structurals &= ~((2ULL << end) - 1);
+
+            if (selected) {
+                _mr_records_append(buffer, &length, p->block + p->position,
+                                                           end - p->position);
+            }
+
+            p->position = end + 1;
+            p->column = row_end ? 0 : column + 1;
+
+            if (selected && length) {
+                length = _mr_records_finish(buffer, length, row_end);
+
+                if (length) {
+                    *length_ptr = length;
+                    return 0;
+                }
+            }
+        }
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Records*  mr_records_create(const char, const uint64_t);
+    void      mr_records_delete(Records**);
+#endif
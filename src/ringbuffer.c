@@ -0,0 +1,67 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file ringbuffer.c
+ * @brief Lock-free single producer / single consumer ring buffer.
+ * @author Jean-Yves VET
+ */
+
+#include "ringbuffer.h"
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Create a Ringbuffer structure. The number of slots is rounded up to the next
+ * power of two.
+ *
+ * @param   nb_slots[in]  Minimum number of pointers the ring buffer may hold
+ * @return  Pointer to the new Ringbuffer structure
+ */
+Ringbuffer *mr_ringbuffer_create(unsigned int nb_slots) {
+    unsigned int size = 1;
+    assert(nb_slots > 0);
+
+    while (size < nb_slots) size <<= 1;
+
+    Ringbuffer *rb = malloc(sizeof(Ringbuffer));
+    assert(rb != NULL);
+
+    rb->slots = malloc(size*sizeof(void*));
+    assert(rb->slots != NULL);
+
+    rb->mask = size - 1;
+    rb->head = 0;
+    rb->tail = 0;
+
+    return rb;
+}
+
+
+/**
+ * Delete a Ringbuffer structure (pointed data are not freed) and set pointer
+ * to NULL.
+ *
+ * @param   rb_ptr[inout]  Pointer to pointer of a Ringbuffer structure
+ */
+void mr_ringbuffer_delete(Ringbuffer **rb_ptr) {
+    assert(rb_ptr != NULL);
+    Ringbuffer *rb = *rb_ptr;
+
+    if (rb != NULL) {
+        free(rb->slots);
+        free(rb);
+    }
+
+    *rb_ptr = NULL;
+}
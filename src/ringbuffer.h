@@ -0,0 +1,97 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_RINGBUFFER_H
+    #define HEADER_MAPREDUCE_RINGBUFFER_H
+
+    #include "common.h"
+
+    /**
+     * @struct ringbuffer_s
+     * @brief  Lock-free ring buffer of pointers for a single producer and a
+     *         single consumer. Head and tail are kept on separate cache lines
+     *         to avoid false sharing between both sides.
+     */
+    typedef struct ringbuffer_s {
+        void**         slots;      /**<  Array of pointers                    */
+        unsigned int   mask;       /**<  Number of slots minus one            */
+        char           pad0[64];   /**<  Padding                              */
+        unsigned int   head;       /**<  Next slot to pop (consumer side)     */
+        char           pad1[64];   /**<  Padding                              */
+        unsigned int   tail;       /**<  Next slot to push (producer side)    */
+        char           pad2[64];   /**<  Padding                              */
+    } Ringbuffer;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Push a pointer in the ring buffer. Must only be called by the producer.
+     *
+     * @param   rb[inout]     Pointer to the Ringbuffer structure
+     * @param   ptr[in]       Pointer to push
+     * @return  0 if the pointer was pushed or 1 if the ring buffer is full
+     */
+    static inline int mr_ringbuffer_push(Ringbuffer *rb, void *ptr) {
+        unsigned int tail = rb->tail;
+        unsigned int head = __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE);
+
+        if (tail - head > rb->mask) return 1;
+
+        rb->slots[tail & rb->mask] = ptr;
+        __atomic_store_n(&rb->tail, tail + 1, __ATOMIC_RELEASE);
+
+        return 0;
+    }
+
+
+    /**
+     * Pop a pointer from the ring buffer. Must only be called by the consumer.
+     *
+     * @param   rb[inout]     Pointer to the Ringbuffer structure
+     * @param   ptr[out]      Pointer to hold the popped pointer
+     * @return  0 if a pointer was popped or 1 if the ring buffer is empty
+     */
+    static inline int mr_ringbuffer_pop(Ringbuffer *rb, void **ptr) {
+        unsigned int head = rb->head;
+        unsigned int tail = __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE);
+
+        if (head == tail) return 1;
+
+        *ptr = rb->slots[head & rb->mask];
+        __atomic_store_n(&rb->head, head + 1, __ATOMIC_RELEASE);
+
+        return 0;
+    }
+
+
+    /**
+     * Get the number of pointers stored in the ring buffer. The value is only
+     * a snapshot when both sides are running.
+     *
+     * @param   rb[in]        Pointer to the Ringbuffer structure
+     * @return  Number of pointers stored
+     */
+    static inline unsigned int mr_ringbuffer_count(Ringbuffer *rb) {
+        unsigned int tail = __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE);
+        unsigned int head = __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE);
+
+        return tail - head;
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Ringbuffer*   mr_ringbuffer_create(unsigned int);
+    void          mr_ringbuffer_delete(Ringbuffer**);
+#endif
@@ -0,0 +1,438 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file segment.c
+ * @brief Binary dictionary file (segment) written from the records of the
+ *        output stage, and mapped in memory to be queried or merged into a
+ *        dictionary.
+ * @author Jean-Yves VET
+ */
+
+#include "segment.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* ============================ Private functions =========================== */
+
+/**
+ * Round a size up to the next multiple of 8 Bytes.
+ *
+ * @param   size[in]        Size in Bytes
+ * @return  Aligned size
+ */
+static inline uint64_t _mr_segment_align(uint64_t size) {
+    return (size + 7) & ~7ULL;
+}
+
+
+/**
+ * Write a section of the file followed by zeros up to an offset.
+ *
+ * @param   fp[in]          File to write
+ * @param   data[in]        Data of the section
+ * @param   size[in]        Bytes of data
+ * @param   end[in]         Offset where the next section starts
+ * @return  0 on success or 1 if the section could not be written
+ */
+static int _mr_segment_write(FILE *fp, const void *data, uint64_t size,
+                                                               uint64_t end) {
+    static const char zeros[8] = {0};
+
+    if (size && fwrite(data, 1, size, fp) != size) return 1;
+
+    size = end - ftell(fp);
+    if (size && fwrite(zeros, 1, size, fp) != size) return 1;
+
+    return 0;
+}
+
+
+/**
+ * Build the hash index of keys.
+ *
+ * @param   records[in]     Records sorted alphabetically
+ * @param   nb_records[in]  Number of records
+ * @param   index_size[in]  Number of slots (power of 2)
+ * @return  Array of slots (to free)
+ */
+static Segment_slot* _mr_segment_index(const Output_record *records,
+                   const uint64_t nb_records, const uint64_t index_size) {
+    uint64_t i, mask = index_size - 1;
+    Segment_slot *index = calloc(index_size, sizeof(Segment_slot));
+    assert(index != NULL);
+
+    for (i=0; i<nb_records; i++) {
+        const Output_record *record = &records[i];
+        uint64_t hash = mr_word_hash_key(record->key, record->length);
+        uint64_t pos = hash & mask;
+
+        while (index[pos].key) pos = (pos + 1) & mask;
+
+        index[pos].fingerprint = hash >> 32;
+        index[pos].key = i + 1;
+    }
+
+    return index;
+}
+
+
+/**
+ * Check that the sections of a mapped file are consistent, so that queries
+ * never read outside of the file.
+ *
+ * @param   seg[in]         Pointer to the Segment structure
+ * @return  true if the file is valid
+ */
+static bool _mr_segment_check(const Segment *seg) {
+    const Segment_header *header = seg->header;
+    uint64_t i, nb_keys = header->nb_keys, used = 0;
+
+    if (memcmp(header->magic, MAPREDUCE_SEGMENT_MAGIC, sizeof(header->magic))
+        || nb_keys >= seg->size / sizeof(uint64_t)
+        || header->offsets_offset % 8 || header->counts_offset % 8
+        || header->index_offset % 8 || header->keys_offset % 8
+        || header->offsets_offset > seg->size
+        || (nb_keys+1)*sizeof(uint64_t) > seg->size - header->offsets_offset
+        || header->counts_offset > seg->size
+        || nb_keys*sizeof(uint64_t) > seg->size - header->counts_offset
+        || header->keys_offset > seg->size
+        || header->keys_size > seg->size - header->keys_offset) {
+        return false;
+    }
+
+    if (header->index_size) {
+        if ((header->index_size & (header->index_size - 1))
+            || header->index_size <= nb_keys
+            || header->index_offset > seg->size
+            || header->index_size > (seg->size - header->index_offset)
+                                                      / sizeof(Segment_slot)) {
+            return false;
+        }
+    } else if (header->index_offset) {
+        return false;
+    }
+
+    const uint64_t *offsets = (const uint64_t *)((char *)seg->data
+                                                     + header->offsets_offset);
+    const char *keys = (char *)seg->data + header->keys_offset;
+
+    /* Keys follow each other, each one ended by '\0' */
+    if (offsets[0] != 0 || offsets[nb_keys] != header->keys_size) return false;
+
+    for (i=0; i<nb_keys; i++) {
+        if (offsets[i+1] <= offsets[i] || keys[offsets[i+1]-1] != '\0') {
+            return false;
+        }
+    }
+
+    /* One slot per key and at least one free slot to stop probing */
+    if (header->index_size) {
+        const Segment_slot *index = (const Segment_slot *)((char *)seg->data
+                                                       + header->index_offset);
+
+        for (i=0; i<header->index_size; i++) {
+            if (index[i].key > nb_keys) return false;
+            if (index[i].key) used++;
+        }
+
+        if (used != nb_keys) return false;
+    }
+
+    return true;
+}
+
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Map a segment file in memory.
+ *
+ * @param   path[in]        String containing the path to the file
+ * @return  Pointer to the new Segment structure (NULL if the file cannot be
+ *          accessed or is not a valid segment)
+ */
+Segment* mr_segment_open(const char *path) {
+    struct stat st;
+    assert(path != NULL);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    if (fstat(fd, &st) != 0 || st.st_size < sizeof(Segment_header)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) return NULL;
+
+    Segment *seg = malloc(sizeof(Segment));
+    assert(seg != NULL);
+
+    seg->data = data;
+    seg->size = st.st_size;
+    seg->header = (const Segment_header *) data;
+
+    if (!_mr_segment_check(seg)) {
+        mr_segment_close(&seg);
+        return NULL;
+    }
+
+    seg->nb_keys = seg->header->nb_keys;
+    seg->offsets = (const uint64_t *)((char *)data
+                                                + seg->header->offsets_offset);
+    seg->counts = (const uint64_t *)((char *)data + seg->header->counts_offset);
+    seg->index = (seg->header->index_size) ? (const Segment_slot *)((char *)data
+                                            + seg->header->index_offset) : NULL;
+    seg->keys = (const char *)data + seg->header->keys_offset;
+
+    return seg;
+}
+
+
+/**
+ * Unmap a segment file and set pointer to NULL.
+ *
+ * @param   seg_ptr[inout]  Pointer to pointer of a Segment structure
+ */
+void mr_segment_close(Segment **seg_ptr) {
+    assert(seg_ptr != NULL);
+    Segment *seg = *seg_ptr;
+
+    if (seg != NULL) {
+        munmap(seg->data, seg->size);
+        free(seg);
+    }
+
+    *seg_ptr = NULL;
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Write records of the output stage in a segment file. Records are sorted
+ * alphabetically first.
+ *
+ * @param   output[inout]   Pointer to the Output structure
+ * @param   path[in]        String containing the path to the file
+ * @param   index[in]       Add a hash index to the file
+ * @return  0 on success or 1 if the file could not be written
+ */
+int mr_segment_save(Output *output, const char *path, const bool index) {
+    assert(output != NULL);
+
+    mr_output_sort(output, SO_ALPHA);
+
+    return mr_segment_save_records(output->records, output->nb_records, path,
+                                                                       index);
+}
+
+
+/**
+ * Write records in a segment file. The file is written under a temporary
+ * name and renamed so that readers never map a partial file.
+ *
+ * @param   records[in]     Records sorted alphabetically (distinct keys)
+ * @param   nb_keys[in]     Number of records
+ * @param   path[in]        String containing the path to the file
+ * @param   index[in]       Add a hash index to the file
+ * @return  0 on success or 1 if the file could not be written
+ */
+int mr_segment_save_records(const Output_record *records,
+           const uint64_t nb_keys, const char *path, const bool index) {
+    Segment_header header;
+    Segment_slot *slots = NULL;
+    uint64_t i;
+    int ret = 1;
+    assert(path != NULL);
+
+    uint64_t *offsets = malloc((nb_keys+1)*sizeof(uint64_t));
+    uint64_t *counts = malloc((nb_keys+1)*sizeof(uint64_t));
+    assert(offsets != NULL && counts != NULL);
+
+    memset(&header, 0, sizeof(Segment_header));
+    memcpy(header.magic, MAPREDUCE_SEGMENT_MAGIC, sizeof(header.magic));
+    header.nb_keys = nb_keys;
+
+    for (i=0; i<nb_keys; i++) {
+        offsets[i] = header.keys_size;
+        counts[i] = records[i].count;
+        header.keys_size += records[i].length + 1;
+        header.total += counts[i];
+    }
+    offsets[nb_keys] = header.keys_size;
+
+    /* Smallest power of 2 keeping the load of the index under the maximum */
+    if (index) {
+        header.index_size = 1;
+        while (header.index_size*MAPREDUCE_SEGMENT_MAX_LOAD <= nb_keys*100) {
+            header.index_size <<= 1;
+        }
+        slots = _mr_segment_index(records, nb_keys, header.index_size);
+    }
+
+    header.offsets_offset = _mr_segment_align(sizeof(Segment_header));
+    header.counts_offset = header.offsets_offset
+                           + (nb_keys+1)*sizeof(uint64_t);
+    uint64_t end = _mr_segment_align(header.counts_offset
+                                     + nb_keys*sizeof(uint64_t));
+    header.index_offset = (index) ? end : 0;
+    header.keys_offset = end + header.index_size*sizeof(Segment_slot);
+
+    char *tmp_path = malloc(strlen(path) + 5);
+    assert(tmp_path != NULL);
+    strcpy(tmp_path, path);
+    strcat(tmp_path, ".tmp");
+
+    FILE *fp = fopen(tmp_path, "wb");
+
+    if (fp != NULL) {
+        if (!_mr_segment_write(fp, &header, sizeof(header),
+                                                       header.offsets_offset)
+            && !_mr_segment_write(fp, offsets, (nb_keys+1)*sizeof(uint64_t),
+                                                        header.counts_offset)
+            && !_mr_segment_write(fp, counts, nb_keys*sizeof(uint64_t), end)
+            && !_mr_segment_write(fp, slots,
+                                   header.index_size*sizeof(Segment_slot),
+                                                         header.keys_offset)) {
+            ret = 0;
+
+            /* Keys with their '\0' (Word spellings are ended by '\0') */
+            for (i=0; i<nb_keys && !ret; i++) {
+                const Output_record *record = &records[i];
+                if (fwrite(record->key, 1, record->length + 1, fp)
+                                                        != record->length + 1) {
+                    ret = 1;
+                }
+            }
+        }
+
+        if (fclose(fp)) ret = 1;
+
+        if (!ret && rename(tmp_path, path)) ret = 1;
+        if (ret) remove(tmp_path);
+    }
+
+    free(tmp_path);
+    free(slots);
+    free(counts);
+    free(offsets);
+
+    return ret;
+}
+
+
+/**
+ * Find a key in a segment, with the hash index when the file has one or
+ * with a binary search otherwise.
+ *
+ * @param   seg[in]         Pointer to the Segment structure
+ * @param   key[in]         String containing the key
+ * @param   length[in]      Characters in the key
+ * @return  Key number or -1 if the key is not in the segment
+ */
+long long mr_segment_find(const Segment *seg, const char *key,
+                                                        unsigned int length) {
+    assert(seg != NULL);
+
+    if (seg->index != NULL) {
+        uint64_t hash = mr_word_hash_key(key, length);
+        uint64_t mask = seg->header->index_size - 1;
+        uint64_t pos = hash & mask;
+        uint32_t fingerprint = hash >> 32;
+
+        while (seg->index[pos].key) {
+            const Segment_slot *slot = &seg->index[pos];
+            uint64_t i = slot->key - 1;
+
+            if (slot->fingerprint == fingerprint
+                && mr_segment_length(seg, i) == length
+                && !memcmp(mr_segment_key(seg, i), key, length)) {
+                return i;
+            }
+
+            pos = (pos + 1) & mask;
+        }
+
+        return -1;
+    }
+
+    long long first = 0, last = (long long)seg->nb_keys - 1;
+
+    while (first <= last) {
+        long long middle = first + (last - first)/2;
+        int ret = mr_segment_compare(seg, middle, key, length);
+
+        if (!ret) return middle;
+
+        if (ret < 0) {
+            last = middle - 1;
+        } else {
+            first = middle + 1;
+        }
+    }
+
+    return -1;
+}
+
+
+/**
+ * Retrieve occurrences of a key in a segment.
+ *
+ * @param   seg[in]         Pointer to the Segment structure
+ * @param   str[in]         String containing the key
+ * @return  Count (0 if the key is not in the segment)
+ */
+uint64_t mr_segment_count(const Segment *seg, const char *str) {
+    long long i = mr_segment_find(seg, str, strlen(str));
+
+    return (i < 0) ? 0 : seg->counts[i];
+}
+
+
+/**
+ * Add all counts of a segment to a dictionary. Dictionaries count on 32 bits,
+ * so nothing is added if a count of the segment is larger.
+ *
+ * @param   dico[inout]     Pointer to the dictionary (outcome stored here)
+ * @param   seg[in]         Pointer to the Segment structure
+ * @return  0 on success or 1 if a count does not fit in the dictionary
+ */
+int mr_segment_merge(Dictionary *dico, const Segment *seg) {
+    uint64_t i;
+    assert(dico != NULL && seg != NULL);
+
+    for (i=0; i<seg->nb_keys; i++) {
+        if (seg->counts[i] > UINT_MAX) return 1;
+    }
+
+    for (i=0; i<seg->nb_keys; i++) {
+        const char *key = mr_segment_key(seg, i);
+        unsigned int length = mr_segment_length(seg, i);
+
+        dico->add(dico, key, length, mr_word_hash_key(key, length),
+                                                 (unsigned int)seg->counts[i]);
+    }
+
+    mr_dictionary_flush(dico);
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file segment.h
+ * @brief Binary dictionary file (segment): keys sorted alphabetically in a
+ *        blob, arrays of offsets and counts, and an optional hash index, so
+ *        that other tools can mmap it and query it with no parsing.
+ * @author Jean-Yves VET
+ */
+
+#ifndef HEADER_MAPREDUCE_SEGMENT_H
+    #define HEADER_MAPREDUCE_SEGMENT_H
+
+    #include "common.h"
+    #include "dictionary.h"
+    #include "output.h"
+
+    /**
+     * @struct segment_header_s
+     * @brief  Header at the start of a segment file. Sections are located by
+     *         their offset in the file (multiple of 8 Bytes), in this order:
+     *         offsets of keys in the blob (nb_keys+1 uint64_t, the last one is
+     *         the size of the blob), counts (nb_keys uint64_t), index
+     *         (index_size slots) and the blob of keys, each key followed by a
+     *         '\0'. Integers are stored in the byte order of the host.
+     */
+    typedef struct segment_header_s {
+        char           magic[8];       /**<  Magic and version of the format  */
+        uint64_t       nb_keys;        /**<  Number of keys                   */
+        uint64_t       total;          /**<  Sum of all counts                */
+        uint64_t       offsets_offset; /**<  Offsets of keys in the blob      */
+        uint64_t       counts_offset;  /**<  Counts of keys                   */
+        uint64_t       index_offset;   /**<  Hash index (0 without index)     */
+        uint64_t       index_size;     /**<  Slots (power of 2 or 0)          */
+        uint64_t       keys_offset;    /**<  Blob of keys                     */
+        uint64_t       keys_size;      /**<  Bytes in the blob of keys        */
+    } Segment_header;
+
+
+    /**
+     * @struct segment_slot_s
+     * @brief  Slot of the hash index. A key of hash h (see mr_word_hash_key)
+     *         is found by linear probing from slot h & (index_size-1), slots
+     *         with another fingerprint are skipped without reading the key.
+     */
+    typedef struct segment_slot_s {
+        uint32_t       fingerprint;    /**<  High 32 bits of the hash         */
+        uint32_t       key;            /**<  Key number + 1 (0: free slot)    */
+    } Segment_slot;
+
+
+    /**
+     * @struct segment_s
+     * @brief  Segment file mapped in memory (read only).
+     */
+    typedef struct segment_s {
+        void*               data;      /**<  Mapped file                      */
+        size_t              size;      /**<  Size of the file in Bytes        */
+        const Segment_header* header;  /**<  Header of the file               */
+        const uint64_t*     offsets;   /**<  Offsets of keys in the blob      */
+        const uint64_t*     counts;    /**<  Counts of keys                   */
+        const Segment_slot* index;     /**<  Hash index (or NULL)             */
+        const char*         keys;      /**<  Blob of keys                     */
+        uint64_t            nb_keys;   /**<  Number of keys                   */
+    } Segment;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Get a key of a segment.
+     *
+     * @param   seg[in]     Pointer to the Segment structure
+     * @param   i[in]       Key number (keys are sorted alphabetically)
+     * @return  String containing the key (ended by '\0')
+     */
+    static inline const char* mr_segment_key(const Segment *seg, uint64_t i) {
+        return seg->keys + seg->offsets[i];
+    }
+
+
+    /**
+     * Get the number of characters in a key of a segment.
+     *
+     * @param   seg[in]     Pointer to the Segment structure
+     * @param   i[in]       Key number
+     * @return  Characters in the key
+     */
+    static inline unsigned int mr_segment_length(const Segment *seg,
+                                                                 uint64_t i) {
+        return seg->offsets[i+1] - seg->offsets[i] - 1;
+    }
+
+
+    /**
+     * Compare a key with a key of a segment in alphabetical order.
+     *
+     * @param   seg[in]         Pointer to the Segment structure
+     * @param   i[in]           Key number in the segment
+     * @param   key[in]         String containing the key
+     * @param   length[in]      Characters in the key
+     * @return  Negative, zero or positive value as for strcmp
+     */
+    static inline int mr_segment_compare(const Segment *seg, uint64_t i,
+                                         const char *key, unsigned int length) {
+        unsigned int seg_length = mr_segment_length(seg, i);
+        unsigned int min = (length < seg_length) ? length : seg_length;
+        int ret = memcmp(key, mr_segment_key(seg, i), min);
+
+        if (ret) return ret;
+
+        return (int)length - (int)seg_length;
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Segment*      mr_segment_open(const char*);
+    void          mr_segment_close(Segment**);
+
+    int           mr_segment_save(Output*, const char*, const bool);
+    int           mr_segment_save_records(const Output_record*, const uint64_t,
+                                                  const char*, const bool);
+    long long     mr_segment_find(const Segment*, const char*, unsigned int);
+    uint64_t      mr_segment_count(const Segment*, const char*);
+    int           mr_segment_merge(Dictionary*, const Segment*);
+#endif
@@ -0,0 +1,78 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_STATS_H
+    #define HEADER_MAPREDUCE_STATS_H
+
+    #include "common.h"
+
+    /**
+     * @struct stats_s
+     * @brief  Structure containing corpus statistics gathered while streaming
+     *         words (one per streamer, summed at reduce).
+     */
+    typedef struct stats_s {
+        unsigned long long words;  /**<  Words (or values) retrieved          */
+        unsigned long long bytes;  /**<  Bytes of the ranges streamed         */
+        unsigned long long lines;  /**<  Lines (or rows) streamed             */
+        unsigned long long lengths[MAPREDUCE_STATS_MAX_LENGTH+1];
+                                   /**<  Words per length, last is longer     */
+    } Stats;
+
+
+    /* =========================== Static functions ========================= */
+
+    /**
+     * Initialize a stats structure.
+     *
+     * @param   stats[inout]  Pointer to the Stats structure to initialize
+     */
+    static inline void _stats_init(Stats *stats) {
+        memset(stats, 0, sizeof(Stats));
+    }
+
+
+    /**
+     * Account a retrieved word.
+     *
+     * @param   stats[inout]  Pointer to the Stats structure
+     * @param   length[in]    Length of the word
+     */
+    static inline void _stats_word(Stats *stats, unsigned int length) {
+        if (length > MAPREDUCE_STATS_MAX_LENGTH) {
+            length = MAPREDUCE_STATS_MAX_LENGTH;
+        }
+
+        stats->words++;
+        stats->lengths[length]++;
+    }
+
+
+    /**
+     * Add the counters of a stats structure to another one.
+     *
+     * @param   stats[inout]  Pointer to the Stats structure receiving counters
+     * @param   other[in]     Pointer to the Stats structure to add
+     */
+    static inline void _stats_merge(Stats *stats, const Stats *other) {
+        int i;
+
+        stats->words += other->words;
+        stats->bytes += other->bytes;
+        stats->lines += other->lines;
+
+        for(i=0; i<=MAPREDUCE_STATS_MAX_LENGTH; i++) {
+            stats->lengths[i] += other->lengths[i];
+        }
+    }
+#endif
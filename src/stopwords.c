@@ -0,0 +1,267 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file stopwords.c
+ * @brief Set of stop words stored in a minimal perfect hash built at startup.
+ * @author Jean-Yves VET
+ */
+
+#include "stopwords.h"
+
+/* ============================= Static Elements ============================ */
+
+/* Built-in English stop words. Contractions are split by the wordstreamers
+   (don't -> don t), so they only appear through their parts. */
+static const char _mr_stopwords_english[] =
+    "i me my myself we our ours ourselves you your yours yourself yourselves "
+    "he him his himself she her hers herself it its itself they them their "
+    "theirs themselves what which who whom this that these those am is are "
+    "was were be been being have has had having do does did doing a an the "
+    "and but if or because as until while of at by for with about against "
+    "between into through during before after above below to from up down in "
+    "out on off over under again further then once here there when where why "
+    "how all any both each few more most other some such no nor not only own "
+    "same so than too very s t can will just don should now d ll m o re ve y "
+    "ain aren couldn didn doesn hadn hasn haven isn ma mightn mustn needn shan "
+    "shouldn wasn weren won wouldn";
+
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Create a set of stop words from a file, or from the built-in English list.
+ *
+ * @param   file_path[in]   File listing stop words (or NULL for the built-in
+ *                          list)
+ * @param   profiling[in]   Activate the profiling mode
+ * @return  Pointer to the new Stopwords structure
+ */
+Stopwords* mr_stopwords_create(const char *file_path, const bool profiling) {
+    Stopwords *sw;
+
+    if (file_path == NULL) {
+        sw = _mr_stopwords_create_from_text(_mr_stopwords_english);
+    } else {
+        FILE *fp = fopen(file_path, "r");
+        if (fp == NULL) mr_error(ERR_FILEACCESS);
+
+        /* Pipes and other unseekable files have no size */
+        long size = fseek(fp, 0, SEEK_END) ? -1 : ftell(fp);
+        if (size < 0 || fseek(fp, 0, SEEK_SET)) mr_error(ERR_FILEACCESS);
+
+        char *text = malloc(size + 1);
+        assert(text != NULL);
+
+        size = fread(text, 1, size, fp);
+        text[size] = '\0';
+        fclose(fp);
+
+        sw = _mr_stopwords_create_from_text(text);
+        free(text);
+    }
+
+    /* Display set details [Profiling mode] */
+    if (profiling) {
+        #if MAPREDUCE_DEFAULT_USECOLORS
+            printf("\e[34m |-[Stopwords] set:\e[1m %u words (%s)\e[0m\n",
+                   sw->nb_words, file_path == NULL ? "built-in" : file_path);
+        #else
+            printf(" |-[Stopwords] set: %u words (%s)\n", sw->nb_words,
+                                  file_path == NULL ? "built-in" : file_path);
+        #endif
+    }
+
+    return sw;
+}
+
+
+/**
+ * Delete a Stopwords structure and set pointer to NULL.
+ *
+ * @param   sw_ptr[inout]   Pointer to pointer of a Stopwords structure
+ */
+void mr_stopwords_delete(Stopwords **sw_ptr) {
+    assert(sw_ptr != NULL);
+    Stopwords *sw = *sw_ptr;
+
+    if (sw != NULL) {
+        free(sw->displacements);
+        free(sw->hashes);
+        free(sw->lengths);
+        free(sw->words);
+        free(sw->strings);
+        free(sw);
+    }
+
+    *sw_ptr = NULL;
+}
+
+
+/* ============================ Private functions =========================== */
+
+/**
+ * Compare two spellings (qsort callback).
+ */
+static int _mr_stopwords_compare(const void *a, const void *b) {
+    return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+
+/**
+ * Find a displacement for each bucket so that all words land in distinct
+ * slots. The largest buckets are placed first while most slots are free.
+ *
+ * @param   sw[inout]       Pointer to the Stopwords structure
+ * @param   words[in]       Sorted and unique spellings
+ */
+static void _mr_stopwords_build(Stopwords *sw, char **words) {
+    int i, d;
+    unsigned int b, size, max_size = 0;
+    unsigned int n = sw->nb_words, nb_buckets = sw->nb_buckets;
+    uint32_t *slots;
+
+    uint64_t *hashes = malloc(sizeof(uint64_t) * (n ? n : 1));
+    unsigned int *order = malloc(sizeof(unsigned int) * (n ? n : 1));
+    unsigned int *first = calloc(nb_buckets + 1, sizeof(unsigned int));
+    unsigned int *cursor = malloc(sizeof(unsigned int) * nb_buckets);
+    bool *taken = calloc(n ? n : 1, sizeof(bool));
+    assert(hashes != NULL && order != NULL && first != NULL
+                                           && cursor != NULL && taken != NULL);
+
+    /* Group words by bucket (counting sort) */
+    for (i=0; i<n; i++) {
+        hashes[i] = mr_word_hash(words[i], strlen(words[i]));
+        first[_mr_stopwords_range(hashes[i], nb_buckets) + 1]++;
+    }
+
+    for (b=0; b<nb_buckets; b++) {
+        if (first[b+1] > max_size) max_size = first[b+1];
+        first[b+1] += first[b];
+        cursor[b] = first[b];
+    }
+
+    slots = malloc(sizeof(uint32_t) * (max_size ? max_size : 1));
+    assert(slots != NULL);
+
+    for (i=0; i<n; i++) {
+        order[cursor[_mr_stopwords_range(hashes[i], nb_buckets)]++] = i;
+    }
+
+    /* Place buckets by decreasing size */
+    for (size=max_size; size>0; size--) {
+        for (b=0; b<nb_buckets; b++) {
+            if (first[b+1] - first[b] != size) continue;
+
+            for (d=0; ; d++) {
+                assert(d < MAPREDUCE_STOPWORDS_MAX_DISPLACEMENT);
+
+                for (i=0; i<size; i++) {
+                    int j;
+                    slots[i] = _mr_stopwords_slot(sw, hashes[order[first[b]+i]],
+                                                                            d);
+                    if (taken[slots[i]]) break;
+                    for (j=0; j<i && slots[j] != slots[i]; j++);
+                    if (j < i) break;
+                }
+
+                if (i == size) break;
+            }
+
+            sw->displacements[b] = d;
+
+            for (i=0; i<size; i++) {
+                unsigned int w = order[first[b]+i];
+
+                taken[slots[i]] = true;
+                sw->hashes[slots[i]] = hashes[w];
+                sw->lengths[slots[i]] = strlen(words[w]);
+                sw->words[slots[i]] = words[w];
+            }
+        }
+    }
+
+    free(hashes);
+    free(order);
+    free(first);
+    free(cursor);
+    free(taken);
+    free(slots);
+}
+
+
+/**
+ * Create a set of stop words from a text. Words are delimited and their first
+ * character is converted to lower case as the wordstreamers do, so each of
+ * them matches a token.
+ *
+ * @param   text[in]        Text containing the stop words
+ * @return  Pointer to the new Stopwords structure
+ */
+Stopwords* _mr_stopwords_create_from_text(const char *text) {
+    assert(text != NULL);
+    int i;
+    unsigned int n = 0, unique = 0;
+    size_t size = strlen(text);
+
+    Stopwords *sw = malloc(sizeof(Stopwords));
+    char **words = malloc(sizeof(char*) * (size / 2 + 1));
+    sw->strings = malloc(size + 1);
+    assert(sw != NULL && words != NULL && sw->strings != NULL);
+
+    /* Copy words separated by '\0' */
+    char *ptr = sw->strings;
+    bool in_word = false;
+
+    for (i=0; i<size; i++) {
+        char character = text[i];
+
+        if (ispunct(character) || isspace(character)) {
+            if (in_word) *ptr++ = '\0';
+            in_word = false;
+        } else {
+            if (!in_word) {
+                words[n++] = ptr;
+                character = tolower(character);
+            }
+
+            *ptr++ = character;
+            in_word = true;
+        }
+    }
+    *ptr = '\0';
+
+    /* Remove duplicates */
+    qsort(words, n, sizeof(char*), _mr_stopwords_compare);
+
+    for (i=0; i<n; i++) {
+        if (!unique || strcmp(words[unique-1], words[i])) {
+            words[unique++] = words[i];
+        }
+    }
+
+    /* Allocate slots and buckets */
+    sw->nb_words = unique;
+    sw->nb_buckets = unique / MAPREDUCE_STOPWORDS_BUCKET_SIZE + 1;
+    sw->displacements = calloc(sw->nb_buckets, sizeof(uint32_t));
+    sw->hashes = malloc(sizeof(uint64_t) * (unique ? unique : 1));
+    sw->lengths = malloc(sizeof(unsigned int) * (unique ? unique : 1));
+    sw->words = malloc(sizeof(char*) * (unique ? unique : 1));
+    assert(sw->displacements != NULL && sw->hashes != NULL
+                               && sw->lengths != NULL && sw->words != NULL);
+
+    _mr_stopwords_build(sw, words);
+    free(words);
+
+    return sw;
+}
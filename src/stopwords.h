@@ -0,0 +1,101 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file stopwords.h
+ * @brief Set of stop words dropped by wordstreamers before counting.
+ * @author Jean-Yves VET
+ */
+
+#ifndef HEADER_MAPREDUCE_STOPWORDS_H
+    #define HEADER_MAPREDUCE_STOPWORDS_H
+
+    #include "common.h"
+    #include "word.h"
+
+    /**
+     * @struct stopwords_s
+     * @brief  Minimal perfect hash of stop words (hash and displace). The word
+     *         hash selects a bucket, and the displacement of the bucket moves
+     *         all its words to distinct slots, so a lookup reads a single slot.
+     */
+    typedef struct stopwords_s {
+        unsigned int   nb_words;       /**<  Number of stop words (slots)     */
+        unsigned int   nb_buckets;     /**<  Number of buckets                */
+        uint32_t*      displacements;  /**<  Displacement of each bucket      */
+        uint64_t*      hashes;         /**<  Hash of the word in each slot    */
+        unsigned int*  lengths;        /**<  Length of the word in each slot  */
+        char**         words;          /**<  Spelling of the word in each slot*/
+        char*          strings;        /**<  Storage of all spellings         */
+    } Stopwords;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Map a hash to [0, n[ without a division.
+     *
+     * @param   hash[in]     Hash to map
+     * @param   n[in]        Size of the range
+     * @return  Value in [0, n[
+     */
+    static inline uint32_t _mr_stopwords_range(uint64_t hash, uint32_t n) {
+        return ((hash >> 32) * n) >> 32;
+    }
+
+
+    /**
+     * Get the slot of a hash for a given displacement.
+     *
+     * @param   sw[in]              Pointer to the Stopwords structure
+     * @param   hash[in]            Hash of the word (see word.h)
+     * @param   displacement[in]    Displacement of the bucket of the word
+     * @return  Slot of the word
+     */
+    static inline uint32_t _mr_stopwords_slot(const Stopwords *sw,
+                                        uint64_t hash, uint32_t displacement) {
+        hash = mr_word_hash_final(hash ^
+                                  (displacement * 0x9e3779b97f4a7c15ULL));
+
+        return _mr_stopwords_range(hash, sw->nb_words);
+    }
+
+
+    /**
+     * Check if a word is a stop word. Static inline definition to improve
+     * calling performance (called for each token).
+     *
+     * @param   sw[in]          Pointer to the Stopwords structure
+     * @param   word[in]        Spelling of the word
+     * @param   length[in]      Number of characters in the word
+     * @param   hash[in]        Hash of the word (see word.h)
+     * @return  true if the word is a stop word
+     */
+    static inline bool mr_stopwords_contains(const Stopwords *sw,
+                    const char *word, const unsigned int length, uint64_t hash) {
+        if (!sw->nb_words) return false;
+
+        uint32_t bucket = _mr_stopwords_range(hash, sw->nb_buckets);
+        uint32_t slot = _mr_stopwords_slot(sw, hash, sw->displacements[bucket]);
+
+        return sw->hashes[slot] == hash && sw->lengths[slot] == length
+               && !memcmp(sw->words[slot], word, length);
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Stopwords*  mr_stopwords_create(const char*, const bool);
+    Stopwords*  _mr_stopwords_create_from_text(const char*);
+    void        mr_stopwords_delete(Stopwords**);
+#endif
@@ -0,0 +1,419 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file store.c
+ * @brief Store of running counts: delta segments written in a directory and
+ *        compacted with k-way merges of their sorted keys.
+ * @author Jean-Yves VET
+ */
+
+#include "store.h"
+#include <dirent.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* ============================ Private functions =========================== */
+
+/**
+ * Build the path of the file of a segment.
+ *
+ * @param   store[in]       Pointer to the Store structure
+ * @param   level[in]       Level of the segment
+ * @param   first[in]       First delta in the segment
+ * @param   last[in]        Last delta in the segment
+ * @return  String to free once used
+ */
+static char* _mr_store_path(const Store *store, const unsigned int level,
+                                         const uint64_t first, uint64_t last) {
+    size_t size = strlen(store->path) + 64;
+    char *path = malloc(size);
+    assert(path != NULL);
+
+    snprintf(path, size, "%s/L%u-%llu-%llu%s", store->path, level,
+                            (unsigned long long) first,
+                            (unsigned long long) last, MAPREDUCE_STORE_SUFFIX);
+
+    return path;
+}
+
+
+/**
+ * Add a mapped segment to the store.
+ *
+ * @param   store[inout]    Pointer to the Store structure
+ * @param   seg[in]         Pointer to the Segment structure
+ * @param   level[in]       Level of the segment
+ * @param   first[in]       First delta in the segment
+ * @param   last[in]        Last delta in the segment
+ */
+static void _mr_store_append(Store *store, Segment *seg,
+       const unsigned int level, const uint64_t first, const uint64_t last) {
+    if (store->nb_segments == store->size) {
+        store->size = store->size ? 2*store->size : 16;
+        store->segments = realloc(store->segments,
+                                         store->size*sizeof(Store_segment));
+        assert(store->segments != NULL);
+    }
+
+    Store_segment *s = &store->segments[store->nb_segments++];
+    s->segment = seg;
+    s->level = level;
+    s->first = first;
+    s->last = last;
+}
+
+
+/**
+ * Remove a segment from the store (its file is deleted when asked).
+ *
+ * @param   store[inout]    Pointer to the Store structure
+ * @param   i[in]           Position of the segment in the store
+ * @param   delete_file[in] Delete the file of the segment
+ */
+static void _mr_store_remove(Store *store, const unsigned int i,
+                                                   const bool delete_file) {
+    Store_segment *s = &store->segments[i];
+
+    if (delete_file) {
+        char *path = _mr_store_path(store, s->level, s->first, s->last);
+        remove(path);
+        free(path);
+    }
+
+    mr_segment_close(&s->segment);
+    memmove(s, s + 1, (store->nb_segments - i - 1)*sizeof(Store_segment));
+    store->nb_segments--;
+}
+
+
+/**
+ * Merge segments of the store into a new segment with a k-way merge of their
+ * sorted keys (counts of equal keys are added). The new segment is written
+ * before the merged ones are deleted, so that an interrupted compaction
+ * never loses counts (see mr_store_open).
+ *
+ * @param   store[inout]    Pointer to the Store structure
+ * @param   inputs[in]      Positions of the segments to merge (increasing)
+ * @param   nb_inputs[in]   Number of segments to merge
+ * @param   level[in]       Level of the new segment
+ * @return  0 on success or 1 if a count would overflow or the new segment
+ *          could not be written
+ */
+static int _mr_store_merge_segments(Store *store, const unsigned int *inputs,
+                       const unsigned int nb_inputs, const unsigned int level) {
+    Segment *segs[nb_inputs];
+    uint64_t positions[nb_inputs];
+    uint64_t first = UINT64_MAX, last = 0, nb_keys = 0, nb_records = 0;
+    int i, ret;
+
+    for (i=0; i<nb_inputs; i++) {
+        Store_segment *s = &store->segments[inputs[i]];
+        segs[i] = s->segment;
+        positions[i] = 0;
+        nb_keys += segs[i]->nb_keys;
+        if (s->first < first) first = s->first;
+        if (s->last > last) last = s->last;
+    }
+
+    /* Keys are not copied, they stay in the mapped segments */
+    Output_record *records = malloc((nb_keys+1)*sizeof(Output_record));
+    assert(records != NULL);
+
+    while (1) {
+        int min = -1;
+
+        /* Smallest key of the heads of all segments */
+        for (i=0; i<nb_inputs; i++) {
+            if (positions[i] == segs[i]->nb_keys) continue;
+
+            if (min < 0 || mr_segment_compare(segs[min], positions[min],
+                                    mr_segment_key(segs[i], positions[i]),
+                                mr_segment_length(segs[i], positions[i])) < 0) {
+                min = i;
+            }
+        }
+
+        if (min < 0) break;
+
+        Output_record *record = &records[nb_records++];
+        record->key = mr_segment_key(segs[min], positions[min]);
+        record->length = mr_segment_length(segs[min], positions[min]);
+        record->count = 0;
+
+        for (i=0; i<nb_inputs; i++) {
+            if (positions[i] < segs[i]->nb_keys
+                && !mr_segment_compare(segs[i], positions[i], record->key,
+                                                            record->length)) {
+                uint64_t count = segs[i]->counts[positions[i]++];
+
+                /* Inputs are kept rather than a wrapped total written */
+                if (count > UINT64_MAX - record->count) {
+                    free(records);
+                    return 1;
+                }
+                record->count += count;
+            }
+        }
+    }
+
+    char *path = _mr_store_path(store, level, first, last);
+    ret = mr_segment_save_records(records, nb_records, path,
+                                                      MAPREDUCE_SEGMENT_INDEX);
+    free(records);
+
+    Segment *seg = ret ? NULL : mr_segment_open(path);
+    free(path);
+
+    if (seg == NULL) return 1;
+
+    for (i=nb_inputs-1; i>=0; i--) _mr_store_remove(store, inputs[i], true);
+    _mr_store_append(store, seg, level, first, last);
+
+    return 0;
+}
+
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Open a store and map all its segments. Segments left by a compaction which
+ * was interrupted before deleting its inputs are ignored, as their counts
+ * are already in the segment holding a larger range of deltas.
+ *
+ * @param   path[in]        String containing the path to the directory
+ * @param   create[in]      Create the directory if needed and delete the
+ *                          segments left by interrupted compactions
+ * @param   profiling[in]   Activate the profiling mode
+ * @return  Pointer to the new Store structure (NULL if the directory cannot
+ *          be accessed or holds an invalid segment)
+ */
+Store* mr_store_open(const char *path, const bool create,
+                                                       const bool profiling) {
+    struct dirent *entry;
+    unsigned int i, j;
+    assert(path != NULL);
+
+    if (create && mkdir(path, 0777) && errno != EEXIST) return NULL;
+
+    DIR *dir = opendir(path);
+    if (dir == NULL) return NULL;
+
+    Store *store = malloc(sizeof(Store));
+    assert(store != NULL);
+
+    store->path = malloc(strlen(path)+1);
+    assert(store->path != NULL);
+    strcpy(store->path, path);
+    store->segments = NULL;
+    store->nb_segments = 0;
+    store->size = 0;
+    store->next = 0;
+    store->profiling = profiling;
+    _timer_init(&store->timer_compact, profiling);
+
+    while ((entry = readdir(dir)) != NULL) {
+        unsigned int level;
+        unsigned long long first, last;
+        char end;
+
+        /* Temporary files have another suffix */
+        if (sscanf(entry->d_name, "L%u-%llu-%llu" MAPREDUCE_STORE_SUFFIX "%c",
+                                        &level, &first, &last, &end) != 3
+            || first > last) {
+            continue;
+        }
+
+        char *seg_path = _mr_store_path(store, level, first, last);
+        Segment *seg = mr_segment_open(seg_path);
+        free(seg_path);
+
+        if (seg == NULL) {
+            closedir(dir);
+            mr_store_close(&store);
+            return NULL;
+        }
+
+        _mr_store_append(store, seg, level, first, last);
+    }
+
+    closedir(dir);
+
+    /* Deltas are held by a single segment, except after an interruption */
+    for (i=0; i<store->nb_segments; i++) {
+        Store_segment *s = &store->segments[i];
+
+        for (j=0; j<store->nb_segments; j++) {
+            Store_segment *o = &store->segments[j];
+
+            if (j != i && o->first <= s->first && s->last <= o->last
+                && (o->first != s->first || o->last != s->last)) {
+                _mr_store_remove(store, i--, create);
+                break;
+            }
+        }
+    }
+
+    for (i=0; i<store->nb_segments; i++) {
+        if (store->segments[i].last >= store->next) {
+            store->next = store->segments[i].last + 1;
+        }
+    }
+
+    return store;
+}
+
+
+/**
+ * Unmap all segments of a store and set pointer to NULL.
+ *
+ * @param   store_ptr[inout]    Pointer to pointer of a Store structure
+ */
+void mr_store_close(Store **store_ptr) {
+    assert(store_ptr != NULL);
+    Store *store = *store_ptr;
+
+    if (store != NULL) {
+        _timer_print(&store->timer_compact, "[Store] compact");
+
+        while (store->nb_segments) {
+            _mr_store_remove(store, store->nb_segments - 1, false);
+        }
+
+        free(store->segments);
+        free(store->path);
+        free(store);
+    }
+
+    *store_ptr = NULL;
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Write records of the output stage as a new delta segment, then compact the
+ * store when a level is full.
+ *
+ * @param   store[inout]    Pointer to the Store structure
+ * @param   output[inout]   Pointer to the Output structure
+ * @return  0 on success or 1 if a segment could not be written
+ */
+int mr_store_add(Store *store, Output *output) {
+    assert(store != NULL && output != NULL);
+
+    char *path = _mr_store_path(store, 0, store->next, store->next);
+    int ret = mr_segment_save(output, path, MAPREDUCE_SEGMENT_INDEX);
+    Segment *seg = ret ? NULL : mr_segment_open(path);
+    free(path);
+
+    if (seg == NULL) return 1;
+
+    _mr_store_append(store, seg, 0, store->next, store->next);
+    store->next++;
+
+    return mr_store_compact(store, false);
+}
+
+
+/**
+ * Compact segments of a store. Levels holding MAPREDUCE_STORE_FANOUT
+ * segments are merged into one segment of the next level, so that each count
+ * is rewritten once per level. A full compaction merges all segments into a
+ * single one.
+ *
+ * @param   store[inout]    Pointer to the Store structure
+ * @param   full[in]        Merge all segments
+ * @return  0 on success or 1 if a segment could not be written
+ */
+int mr_store_compact(Store *store, const bool full) {
+    unsigned int i, level, max_level = 0, nb_inputs;
+    int ret = 0;
+    assert(store != NULL);
+
+    if (store->nb_segments < 2) return 0;
+
+    _timer_start(&store->timer_compact);
+
+    unsigned int inputs[store->nb_segments];
+
+    for (i=0; i<store->nb_segments; i++) {
+        if (store->segments[i].level > max_level) {
+            max_level = store->segments[i].level;
+        }
+    }
+
+    /* The single segment left is above all levels filled by deltas */
+    if (full) {
+        for (i=0; i<store->nb_segments; i++) inputs[i] = i;
+        ret = _mr_store_merge_segments(store, inputs, store->nb_segments,
+                                                               max_level + 1);
+    } else {
+        /* A merge may fill the next level */
+        for (level=0; level<=max_level+1 && !ret; level++) {
+            nb_inputs = 0;
+            for (i=0; i<store->nb_segments; i++) {
+                if (store->segments[i].level == level) inputs[nb_inputs++] = i;
+            }
+
+            if (nb_inputs >= MAPREDUCE_STORE_FANOUT) {
+                ret = _mr_store_merge_segments(store, inputs, nb_inputs,
+                                                                   level + 1);
+            }
+        }
+    }
+
+    _timer_stop(&store->timer_compact);
+
+    return ret;
+}
+
+
+/**
+ * Retrieve occurrences of a key in all segments of a store.
+ *
+ * @param   store[in]       Pointer to the Store structure
+ * @param   str[in]         String containing the key
+ * @return  Count (0 if the key is in no segment)
+ */
+uint64_t mr_store_count(const Store *store, const char *str) {
+    unsigned int i;
+    uint64_t count = 0;
+    assert(store != NULL);
+
+    for (i=0; i<store->nb_segments; i++) {
+        count += mr_segment_count(store->segments[i].segment, str);
+    }
+
+    return count;
+}
+
+
+/**
+ * Add all counts of a store to a dictionary.
+ *
+ * @param   dico[inout]     Pointer to the dictionary (outcome stored here)
+ * @param   store[in]       Pointer to the Store structure
+ * @return  0 on success or 1 if a count does not fit in the dictionary
+ */
+int mr_store_merge(Dictionary *dico, const Store *store) {
+    unsigned int i;
+    assert(dico != NULL && store != NULL);
+
+    for (i=0; i<store->nb_segments; i++) {
+        if (mr_segment_merge(dico, store->segments[i].segment)) return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file store.h
+ * @brief Store of running counts: a directory of segments. Counts of each new
+ *        input are written as a delta segment, and segments are compacted
+ *        into larger ones (LSM tree with tiered levels), so that adding new
+ *        data does not cost more when the history grows.
+ * @author Jean-Yves VET
+ */
+
+#ifndef HEADER_MAPREDUCE_STORE_H
+    #define HEADER_MAPREDUCE_STORE_H
+
+    #include "common.h"
+    #include "segment.h"
+
+    /**
+     * @struct store_segment_s
+     * @brief  A segment of the store. Its file is named after its level and
+     *         the range of deltas it holds (L<level>-<first>-<last>.mrds).
+     */
+    typedef struct store_segment_s {
+        Segment*       segment;        /**<  Mapped segment                   */
+        unsigned int   level;          /**<  Level (0: delta)                 */
+        uint64_t       first;          /**<  First delta in the segment       */
+        uint64_t       last;           /**<  Last delta in the segment        */
+    } Store_segment;
+
+
+    /**
+     * @struct store_s
+     * @brief  Structure containing the segments of a store. Only one job
+     *         shall add deltas to a store at a time.
+     */
+    typedef struct store_s {
+        char*          path;           /**<  Path to the directory            */
+        Store_segment* segments;       /**<  Segments of the store            */
+        unsigned int   nb_segments;    /**<  Number of segments               */
+        unsigned int   size;           /**<  Allocated segments               */
+        uint64_t       next;           /**<  Number of the next delta         */
+        bool           profiling;      /**<  Profiling mode                   */
+        Timer          timer_compact;  /**<  Timer for compactions [Profiling]*/
+    } Store;
+
+
+    /* ============================== Prototypes ============================ */
+
+    Store*        mr_store_open(const char*, const bool, const bool);
+    void          mr_store_close(Store**);
+
+    int           mr_store_add(Store*, Output*);
+    int           mr_store_compact(Store*, const bool);
+    uint64_t      mr_store_count(const Store*, const char*);
+    int           mr_store_merge(Dictionary*, const Store*);
+#endif
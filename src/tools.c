@@ -36,35 +36,3 @@ long int mr_tools_fsize(const char *file_path) {
 
     return -1;
 }
-
-
-/**
- * Count number of words in a file.
- *
- * @param   file_path[in]   String containing the path to the file
- * @return  Number of words
- */
-long int mr_tools_wc(const char *file_path) {
-    long int nb_words = 0;
-    FILE *fp = fopen(file_path, "r");
-    assert(fp != NULL);
-    char character = getc(fp);
-
-    while (character != EOF) {
-        /* Remove extra spaces and punctuation char */
-        while (ispunct(character) || isspace(character)) {
-            character = getc(fp);
-        }
-
-        /* Retrieve a complete word */
-        while(character != EOF && !ispunct(character) && !isspace(character)) {
-            character = getc(fp);
-        }
-
-        nb_words++;
-    }
-
-    fclose(fp);
-
-    return nb_words;
-}
@@ -19,5 +19,4 @@
     /* ============================== Prototypes ============================ */
 
     long int   mr_tools_fsize(const char *);
-    long int   mr_tools_wc(const char *);
 #endif
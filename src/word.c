@@ -19,7 +19,7 @@
 
 #include "word.h"
 
-void _mr_word_init(Word*, const char *, const int);
+void _mr_word_init(Word*, const char *, const int, const uint64_t);
 
 /* ========================= Constructor / Destructor ======================= */
 
@@ -36,7 +36,8 @@ Word* mr_word_create(const char *src_word) {
     /* Allocate at one the Word structure and the string size */
     Word *word = malloc(sizeof(Word)+length+1);
 
-    _mr_word_init(word, src_word, length);
+    _mr_word_init(word, src_word, length,
+                                           mr_word_hash_key(src_word, length));
 
     return word;
 }
@@ -54,10 +55,32 @@ Word* mr_word_create_buff(const char *src_word, Buffalloc *ba) {
     assert(src_word != NULL);
     int length = strlen(src_word);
 
-    /* Allocate at one the Word structure and the string size */
-    Word *word = mr_buffalloc_malloc(ba, sizeof(Word)+length+1);
+    return mr_word_create_buff_hashed(src_word, length,
+                                     mr_word_hash_key(src_word, length), ba);
+}
 
-    _mr_word_init(word, src_word, length);
+
+/**
+ * Create a Word structure in a buffer when the length and the hash of the
+ * word are already known (computed by a wordstreamer).
+ *
+ * @param   src_word[in]   String containing the spelling of the word
+ * @param   length[in]     Number of characters in the word
+ * @param   hash[in]       Hash of the word (see mr_word_hash)
+ * @param   ba[inout]      Pointer to a buffer structure to manage allocation
+ * @return  Pointer to the new Word structure
+ */
+Word* mr_word_create_buff_hashed(const char *src_word, const unsigned int length,
+                                          const uint64_t hash, Buffalloc *ba) {
+    assert(src_word != NULL);
+
+    /* Allocate at one the Word structure and the string size. Keep the next
+       word aligned: atomic counts shall not cross a cache line */
+    size_t size = (sizeof(Word) + length + __alignof__(Word))
+                                             & ~(size_t)(__alignof__(Word) - 1);
+    Word *word = mr_buffalloc_malloc(ba, size);
+
+    _mr_word_init(word, src_word, length, hash);
 
     return word;
 }
@@ -87,16 +110,17 @@ void mr_word_delete(Word **word_ptr) {
  * @param   word[inout]     Pointer to the Word structure to initialize
  * @param   src_word[in]    String containing the spelling of the word
  * @param   length[in]      Number of characters in the word
+ * @param   hash[in]        Hash of the word
  */
-void _mr_word_init(Word* word, const char *src_word, const int length) {
-    /* Map the pointer of the string just after the structure */
-    word->name = (char*)(word+1);
-
+void _mr_word_init(Word* word, const char *src_word, const int length,
+                                                        const uint64_t hash) {
     /* Copy the word spelling in the structure */
-    strcpy(word->name, src_word);
+    memcpy(word->name, src_word, length);
+    word->name[length] = '\0';
 
     /* Initialize other elements */
     word->count = 1;
     word->next = NULL;
     word->length = length;
+    word->hash = hash;
 }
@@ -24,19 +24,180 @@
      *         Words may be chained together by using a singly linked list.
      */
     typedef struct word_s {
-        char*          name;       /**<  Pointer to the spelling of the word  */
         struct word_s* next;       /**<  Pointer a next word                  */
         unsigned int   count;      /**<  Word occurrences in a text           */
         unsigned int   length;     /**<  Number of characters in the word     */
-        /* /!\ Keep the last element at the end of the structure it is used
-               to avoid handling muitple malloc for the structure and the string
-               containing the spelling of the word. */
+        uint64_t       hash;       /**<  Hash of the spelling (see below)     */
+        char           name[];     /**<  Spelling of the word                 */
+        /* /!\ Keep the last element at the end of the structure: the spelling
+               is stored inline in the same allocation, right after the other
+               members, so no pointer is followed to compare words. */
     } Word;
 
 
+    #define MR_WORD_HASH_SEED 0xcbf29ce484222325ULL
+
+
+    /* =========================== Static Elements ========================== */
+
+    /**
+     * Add a character to a word hash (FNV-1a). Allow streamers to hash words
+     * while retrieving them. Start with MR_WORD_HASH_SEED and end with
+     * mr_word_hash_final().
+     *
+     * @param   hash[in]        Current hash
+     * @param   character[in]   Next character of the word
+     * @return  Updated hash
+     */
+    static inline uint64_t mr_word_hash_step(uint64_t hash, char character) {
+        return (hash ^ (unsigned char) character) * 0x100000001b3ULL;
+    }
+
+
+    /**
+     * Finalize a word hash so that all bits depend on every character.
+     *
+     * @param   hash[in]        Hash after the last character
+     * @return  Final hash
+     */
+    static inline uint64_t mr_word_hash_final(uint64_t hash) {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+
+        return hash;
+    }
+
+
+    /**
+     * Combine the hash of a key with the hash of its next word. Used to build
+     * keys made of several words (n-grams) without hashing them again.
+     *
+     * @param   hash[in]        Hash of the first words of the key
+     * @param   next[in]        Hash of the next word
+     * @return  Combined hash
+     */
+    static inline uint64_t mr_word_hash_combine(uint64_t hash, uint64_t next) {
+        return mr_word_hash_final(hash ^ (next + 0x9e3779b97f4a7c15ULL
+                                             + (hash << 6) + (hash >> 2)));
+    }
+
+
+    /**
+     * Compute the hash of a word in one go.
+     *
+     * @param   str[in]         Spelling of the word
+     * @param   length[in]      Number of characters in the word
+     * @return  Final hash
+     */
+    static inline uint64_t mr_word_hash(const char *str, unsigned int length) {
+        int i;
+        uint64_t hash = MR_WORD_HASH_SEED;
+
+        for (i=0; i<length; i++) {
+            hash = mr_word_hash_step(hash, str[i]);
+        }
+
+        return mr_word_hash_final(hash);
+    }
+
+
+    /**
+     * Compute the hash of a key which may contain several words separated by
+     * a space (n-grams). Same value as mr_word_hash() for a single word.
+     *
+     * @param   str[in]         Spelling of the key
+     * @param   length[in]      Number of characters in the key
+     * @return  Final hash
+     */
+    static inline uint64_t mr_word_hash_key(const char *str,
+                                                        unsigned int length) {
+        int i;
+        bool first = true;
+        uint64_t hash = MR_WORD_HASH_SEED, key = 0;
+
+        for (i=0; i<length; i++) {
+            if (str[i] == ' ') {
+                uint64_t part = mr_word_hash_final(hash);
+                key = first ? part : mr_word_hash_combine(key, part);
+                first = false;
+                hash = MR_WORD_HASH_SEED;
+            } else {
+                hash = mr_word_hash_step(hash, str[i]);
+            }
+        }
+
+        hash = mr_word_hash_final(hash);
+
+        return first ? hash : mr_word_hash_combine(key, hash);
+    }
+
+
+    /**
+     * Check if two spellings of the same length are equal. Keys up to 16
+     * bytes are compared with two overlapping loads on each side (no byte
+     * loop and no read past the keys), longer keys with memcmp.
+     *
+     * @param   name[in]        First spelling
+     * @param   str[in]         Spelling to compare with
+     * @param   length[in]      Number of characters in both spellings
+     * @return  true if spellings are equal
+     */
+    static inline bool mr_word_equal_spelling(const char *name,
+                                   const char *str, unsigned int length) {
+        if (length >= 8) {
+            uint64_t a, b, c, d;
+
+            if (length > 16) return !memcmp(name, str, length);
+
+            memcpy(&a, name, 8);
+            memcpy(&b, str, 8);
+            memcpy(&c, name + length - 8, 8);
+            memcpy(&d, str + length - 8, 8);
+
+            return ((a ^ b) | (c ^ d)) == 0;
+        }
+
+        if (length >= 4) {
+            uint32_t a, b, c, d;
+
+            memcpy(&a, name, 4);
+            memcpy(&b, str, 4);
+            memcpy(&c, name + length - 4, 4);
+            memcpy(&d, str + length - 4, 4);
+
+            return ((a ^ b) | (c ^ d)) == 0;
+        }
+
+        /* Up to 3 characters */
+        return length == 0 || (name[0] == str[0]
+                               && name[length>>1] == str[length>>1]
+                               && name[length-1] == str[length-1]);
+    }
+
+
+    /**
+     * Check if a Word structure has a given spelling.
+     *
+     * @param   word[in]        Pointer to the Word structure
+     * @param   str[in]         Spelling to compare with
+     * @param   length[in]      Number of characters in the spelling
+     * @return  true if spellings are equal
+     */
+    static inline bool mr_word_equal(const Word *word, const char *str,
+                                                        unsigned int length) {
+        return word->length == length
+               && mr_word_equal_spelling(word->name, str, length);
+    }
+
+
     /* ============================== Prototypes ============================ */
 
     Word*   mr_word_create(const char*);
     Word*   mr_word_create_buff(const char *, Buffalloc*);
+    Word*   mr_word_create_buff_hashed(const char *, const unsigned int,
+                                                  const uint64_t, Buffalloc*);
     void    mr_word_delete(Word**);
 #endif
@@ -19,7 +19,8 @@
 
 #include "wordstreamer.h"
 #include "wordstreamer_schunks.h"
-#include "wordstreamer_iwords.h"
+#include "wordstreamer_iblocks.h"
+#include "wordstreamer_dynamic.h"
 
 /* ========================= Constructor / Destructor ======================= */
 
@@ -41,14 +42,18 @@ Wordstreamer* mr_wordstreamer_create_first(const char* file_path,
 
     switch(type) {
         default:
-        case WS_IWORDS :
-            ws = mr_wordstreamer_iwords_create_first(file_path, nb_streamers,
+        case WS_IBLOCKS :
+            ws = mr_wordstreamer_iblocks_create_first(file_path, nb_streamers,
                                       reader_type, read_buffer_size, profiling);
             break;
         case WS_SCHUNKS :
             ws = mr_wordstreamer_schunks_create_first(file_path, nb_streamers,
                                       reader_type, read_buffer_size, profiling);
             break;
+        case WS_DYNAMIC :
+            ws = mr_wordstreamer_dynamic_create_first(file_path, nb_streamers,
+                                      reader_type, read_buffer_size, profiling);
+            break;
     }
 
     return ws;
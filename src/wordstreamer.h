@@ -17,6 +17,13 @@
     #include "common.h"
     #include "tools.h"
     #include "filereader.h"
+    #include "filereader_mmap.h"
+    #include "filereader_read.h"
+    #include "boundaries.h"
+    #include "stopwords.h"
+    #include "records.h"
+    #include "filter.h"
+    #include "word.h"
     #include <fcntl.h>
     #include <sys/types.h>
     #include <sys/stat.h>
@@ -32,15 +39,33 @@
      */
     struct wordstreamer_s {
         int          (*get)();              /**<  Pointer to impl. of get     */
+        int          (*steal)();            /**<  Pointer to impl. of steal   */
         void         (*delete)();           /**<  Pointer to impl. of delete  */
         Wordstreamer* (*create_another)();  /**<  Pointer to impl.            */
         Filereader*  filereader;   /**<  Pointer to a filereader              */
+        const Boundaries* boundaries; /**<  Word boundaries index (or NULL)   */
+        const Stopwords* stopwords; /**<  Words to drop (or NULL)             */
+        const Records* records;    /**<  Record mode settings (or NULL)       */
+        const Filter* filter;      /**<  Token filter (or NULL)               */
+        Records_parser parser;     /**<  Parser state in record mode          */
         fr_type      reader_type;  /**<  Type of filereader (see common.h)    */
         unsigned int streamer_id;  /**<  Id of the current Wordstreamer       */
         unsigned int nb_streamers; /**<  Total number of streamers            */
+        unsigned int nb_steals;    /**<  Ranges stolen from other streamers   */
+        long long    stolen_bytes; /**<  Bytes stolen from other streamers    */
+        unsigned int word_length;  /**<  Length of the last retrieved word    */
+        uint64_t     word_hash;    /**<  Hash of the last retrieved word      */
+        bool         word_first;   /**<  Last word is the first of its range  */
+        bool         word_extra;   /**<  Last word follows the range          */
+        bool         range_fresh;  /**<  No word retrieved from the range yet */
+        unsigned int lookahead;    /**<  Extra words to get after each range  */
+        unsigned int lookahead_left; /**<  Extra words left for this range    */
+        unsigned long long range_lines; /**<  Newlines seen in the range      */
+        Stats        stats;        /**<  Words, bytes and lines streamed      */
         Timer        timer_get;    /**<  Timer for get func. [Profiling mode] */
         bool         end;          /**<  End of all chunks reached            */
         bool         profiling;    /**<  Profiling mode                       */
+        void*        ext;          /**<  Pointer to additional data           */
     };
 
 
@@ -82,6 +107,24 @@
         ws->streamer_id = streamer_id;
         ws->nb_streamers = nb_streamers;
         ws->end = false;
+        ws->ext = NULL;
+        ws->boundaries = NULL;
+        ws->stopwords = NULL;
+        ws->records = NULL;
+        ws->filter = NULL;
+        mr_records_reset(&ws->parser);
+        ws->steal = NULL;
+        ws->nb_steals = 0;
+        ws->stolen_bytes = 0;
+        ws->word_length = 0;
+        ws->word_hash = 0;
+        ws->word_first = false;
+        ws->word_extra = false;
+        ws->range_fresh = false;
+        ws->lookahead = 0;
+        ws->lookahead_left = 0;
+        ws->range_lines = 0;
+        _stats_init(&ws->stats);
 
         /* If streamer_id = 0, create first filereader */
         if (streamer_id == 0) {
@@ -122,9 +165,312 @@
     }
 
 
+    /**
+     * Get next byte from the filereader of a streamer. A map loop specialized
+     * for a type of filereader passes it as a constant, so that the switch is
+     * resolved at compile time and the access is inlined. FR_NB goes through
+     * the vtable of the filereader.
+     *
+     * @param   fr[in]               Pointer to the Filereader structure
+     * @param   buffer[out]          Buffer to hold the retrieved byte
+     * @param   reader_type[in]      Type of the filereader (or FR_NB)
+     * @return  Same as mr_filereader_get_byte
+     */
+    static inline __attribute__((always_inline)) int
+    _mr_wordstreamer_get_byte(Filereader *fr, char *buffer,
+                                                 const fr_type reader_type) {
+        switch (reader_type) {
+            case FR_MMAP:
+                return _mr_filereader_mmap_get_byte(fr, buffer);
+            case FR_READ:
+                return _mr_filereader_read_get_byte(fr, buffer);
+            default:
+                return mr_filereader_get_byte(fr, buffer);
+        }
+    }
+
+
+    /**
+     * Retrieve a word starting with the last character retrieved. The length
+     * and the hash of the word are computed in the same pass. Longer words
+     * are truncated to MAPREDUCE_MAX_WORD_SIZE-1 characters (as values in
+     * record mode), their remaining characters are skipped.
+     *
+     * @param   ws[inout]            Pointer to the Wordstreamer structure
+     * @param   character_ptr[in]    Pointer to the last character retrieved
+     * @param   ret_ptr[in]          Pointer to the last returned value
+     * @param   buffer[out]          Buffer to hold the retrieved word
+     * @param   reader_type[in]      Type of the filereader (or FR_NB)
+     */
+    static inline __attribute__((always_inline)) void
+    _mr_wordstreamer_retrieve_word(Wordstreamer *ws, char *character_ptr,
+                     int *ret_ptr, char *buffer, const fr_type reader_type) {
+
+        int i=0, ret = *ret_ptr;
+        char character = *character_ptr;
+        uint64_t hash = MR_WORD_HASH_SEED;
+        Filereader *fr = ws->filereader;
+
+        /* First char to lower case */
+        if (!ispunct(character) && !isspace(character) && ret >= 0) {
+            character = tolower(character);
+        }
+
+        /* Retrieve all characters */
+        while(!ispunct(character) && !isspace(character) && ret >= 0) {
+            if (i < MAPREDUCE_MAX_WORD_SIZE - 1) {
+                buffer[i++] = character;
+                hash = mr_word_hash_step(hash, character);
+            }
+            ret = _mr_wordstreamer_get_byte(fr, character_ptr, reader_type);
+            character = *character_ptr;
+        }
+
+        /* Terminate string */
+        buffer[i] = '\0';
+
+        /* The separator is not seen again, count it if it ends a line */
+        if (!ret && character == '\n') ws->range_lines++;
+
+        /* Save length, hash and return value */
+        ws->word_length = i;
+        ws->word_hash = mr_word_hash_final(hash);
+        *ret_ptr = ret;
+    }
+
+
+    /**
+     * Set the range of the filereader. With an index of word boundaries, both
+     * ends are moved to boundaries so that no word crosses the range.
+     *
+     * @param   ws[inout]            Pointer to the Wordstreamer structure
+     * @param   start_offset[in]     First byte of the range
+     * @param   stop_offset[in]      Last byte of the range
+     * @return  0 if the range was set or 1 if it is empty once aligned
+     */
+    static inline int _mr_wordstreamer_set_range(Wordstreamer *ws,
+                                  long long start_offset, long long stop_offset) {
+        if (ws->boundaries != NULL) {
+            start_offset = mr_boundaries_snap(ws->boundaries, start_offset);
+            stop_offset = mr_boundaries_snap(ws->boundaries, stop_offset+1) - 1;
+
+            if (start_offset > stop_offset) return 1;
+        }
+
+        mr_filereader_set_offsets(ws->filereader, start_offset, stop_offset);
+        mr_records_reset(&ws->parser);
+        ws->range_fresh = true;
+        ws->range_lines = 0;
+        ws->stats.bytes += stop_offset - start_offset + 1;
+
+        return 0;
+    }
+
+
+    /**
+     * Read next token from the range set in the filereader. A word starting in
+     * a range belongs to it even if it ends in the next one, so the incomplete
+     * word found at the beginning of a range is skipped.
+     *
+     * @param   ws[inout]            Pointer to the Wordstreamer structure
+     * @param   buffer[out]          Buffer to hold the retrieved word
+     * @param   range_end[out]       Set once the end of the range is reached
+     * @param   reader_type[in]      Type of the filereader (or FR_NB)
+     * @return  0 if a word was copied into the buffer or 1 if the end of the
+     *          range was reached
+     */
+    static inline __attribute__((always_inline)) int
+    _mr_wordstreamer_read_token(Wordstreamer *ws, char *buffer,
+                                bool *range_end, const fr_type reader_type) {
+        char character;
+        Filereader *fr = ws->filereader;
+
+        /* Get next byte */
+        int ret = _mr_wordstreamer_get_byte(fr, &character, reader_type);
+
+        /* Remove incomplete word owned by the previous range */
+        if (fr->start_offset && fr->offset - 1 == fr->start_offset) {
+            while (!ispunct(character) && !isspace(character) && !ret) {
+                ret = _mr_wordstreamer_get_byte(fr, &character, reader_type);
+            }
+
+            /* The incomplete word covers the whole range */
+            if (ret) {
+                *range_end = true;
+                return 1;
+            }
+        }
+
+        /* Remove extra spaces and punctuation char */
+        while ((ispunct(character) || isspace(character)) && !ret) {
+            ws->range_lines += (character == '\n');
+            ret = _mr_wordstreamer_get_byte(fr, &character, reader_type);
+        }
+
+        /* Retrieve a complete word, or the last word starting right after the
+           end of the range */
+        if (!ret || (ret == 1 && !ispunct(character) && !isspace(character))) {
+            _mr_wordstreamer_retrieve_word(ws, &character, &ret, buffer,
+                                                                 reader_type);
+
+            if (ret) *range_end = true;
+
+            return 0;
+        }
+
+        *range_end = true;
+
+        return 1;
+    }
+
+
+    /**
+     * Read next value of a selected column from the range set in the
+     * filereader (record mode). Ranges start and stop on rows.
+     *
+     * @param   ws[inout]            Pointer to the Wordstreamer structure
+     * @param   buffer[out]          Buffer to hold the retrieved value
+     * @param   range_end[out]       Set once the end of the range is reached
+     * @return  0 if a value was copied into the buffer or 1 if the end of the
+     *          range was reached
+     */
+    static inline int _mr_wordstreamer_read_field(Wordstreamer *ws,
+                                              char *buffer, bool *range_end) {
+        unsigned int length;
+
+        if (mr_records_get(ws->records, &ws->parser, ws->filereader, buffer,
+                                                                   &length)) {
+            *range_end = true;
+            return 1;
+        }
+
+        /* Values may contain spaces, so hash them as dictionary keys */
+        ws->word_length = length;
+        ws->word_hash = mr_word_hash_key(buffer, length);
+
+        return 0;
+    }
+
+
+    /**
+     * Read next word (or value in record mode) from the range set in the
+     * filereader. Stop words and tokens rejected by the filter are dropped
+     * here, before they reach the map loops (and the dictionary), so that
+     * lookahead words and n-grams only see kept words.
+     *
+     * @param   ws[inout]            Pointer to the Wordstreamer structure
+     * @param   buffer[out]          Buffer to hold the retrieved word
+     * @param   range_end[out]       Set once the end of the range is reached
+     * @param   reader_type[in]      Type of the filereader (or FR_NB)
+     * @return  0 if a word was copied into the buffer or 1 if the end of the
+     *          range was reached
+     */
+    static inline __attribute__((always_inline)) int
+    _mr_wordstreamer_read_word(Wordstreamer *ws, char *buffer,
+                                bool *range_end, const fr_type reader_type) {
+        int ret;
+
+        while (1) {
+            ret = (ws->records == NULL)
+                  ? _mr_wordstreamer_read_token(ws, buffer, range_end,
+                                                                   reader_type)
+                  : _mr_wordstreamer_read_field(ws, buffer, range_end);
+
+            /* Extra words belong to the next range */
+            if (!ret && !ws->lookahead_left) {
+                _stats_word(&ws->stats, ws->word_length);
+            }
+
+            if (ret) return ret;
+
+            /* Keep words which are neither stop words nor filtered out */
+            if ((ws->stopwords == NULL
+                    || !mr_stopwords_contains(ws->stopwords, buffer,
+                                           ws->word_length, ws->word_hash))
+                && (ws->filter == NULL
+                    || !mr_filter_reject(ws->filter, buffer,
+                                                        ws->word_length))) {
+                return 0;
+            }
+
+            if (*range_end) return 1;
+        }
+    }
+
+
+    /**
+     * Get next word from the range set in the filereader. With a lookahead,
+     * the words following the range are then retrieved as extra words (they
+     * complete n-grams starting in the range but do not belong to it).
+     *
+     * @param   ws[inout]            Pointer to the Wordstreamer structure
+     * @param   buffer[out]          Buffer to hold the retrieved word
+     * @param   range_end[out]       Set once the end of the range is reached
+     * @param   reader_type[in]      Type of the filereader (or FR_NB)
+     * @return  0 if a word was copied into the buffer or 1 if the end of the
+     *          range was reached
+     */
+    static inline __attribute__((always_inline)) int
+    _mr_wordstreamer_range_get(Wordstreamer *ws, char *buffer,
+                                bool *range_end, const fr_type reader_type) {
+        Filereader *fr = ws->filereader;
+        bool end = false;
+        int ret;
+
+        if (!ws->lookahead_left) {
+            ret = _mr_wordstreamer_read_word(ws, buffer, &end, reader_type);
+
+            if (!ret) {
+                ws->word_first = ws->range_fresh;
+                ws->word_extra = false;
+                ws->range_fresh = false;
+            }
+
+            if (!end) return ret;
+
+            /* Lines of the range (extra words may read further) */
+            ws->stats.lines += (ws->records == NULL) ? ws->range_lines
+                                                     : ws->parser.rows;
+
+            /* Continue after the range (the word crossing its end is skipped
+               as an incomplete word) */
+            if (!ws->lookahead || fr->stop_offset + 1 >= fr->file_size) {
+                *range_end = true;
+                return ret;
+            }
+
+            ws->lookahead_left = ws->lookahead;
+            mr_filereader_set_offsets(fr, fr->stop_offset + 1,
+                                                           fr->file_size - 1);
+            mr_records_reset(&ws->parser);
+            if (!ret) return 0;
+        }
+
+        /* Extra words */
+        end = false;
+        ret = _mr_wordstreamer_read_word(ws, buffer, &end, reader_type);
+
+        /* An extra word is still the first one of a range without words, so
+           that n-grams never span two ranges */
+        if (!ret) {
+            ws->word_first = ws->range_fresh;
+            ws->word_extra = true;
+            ws->range_fresh = false;
+        }
+
+        if (ret || end || !--ws->lookahead_left) {
+            ws->lookahead_left = 0;
+            *range_end = true;
+        }
+
+        return ret;
+    }
+
+
     /**
      * Get next word from a wordstreamer. Return 1 if end of stream reached.
-     * Static inline definition to improve calling performance.
+     * Length and hash of the word are then available in word_length and
+     * word_hash. Static inline definition to improve calling performance.
      *
      * @param   ws[in]               Pointer to the Wordstreamer structure
      * @param   buffer[inout]        Buffer to hold the retrieved word
@@ -140,6 +486,24 @@
     }
 
 
+    /**
+     * Steal part of the remaining work of another streamer once the current
+     * stream is over. Return 1 if nothing could be stolen (or if stealing is
+     * not supported by the implementation).
+     *
+     * @param   ws[inout]            Pointer to the Wordstreamer structure
+     * @return  0 if new data is available in the stream or 1 otherwise
+     */
+    static inline int mr_wordstreamer_steal(Wordstreamer *ws) {
+        if (ws->steal == NULL) return 1;
+
+        int ret = ws->steal(ws);
+        if (!ret) ws->end = false;
+
+        return ret;
+    }
+
+
     /* ============================== Prototypes ============================ */
 
     Wordstreamer*  mr_wordstreamer_create_first(const char*, const int,
@@ -0,0 +1,199 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file wordstreamer_dynamic.c
+ * @brief Streamer to retrieve words from a file. With multiple streams, each
+          streamer repeatedly claims the next fixed-size chunk of the file from
+          a shared cursor, so faster streamers simply process more chunks.
+ * @author Jean-Yves VET
+ */
+
+#include "wordstreamer_dynamic.h"
+#include "filereader_read.h"
+
+/* ========================= Constructor / Destructor ======================= */
+
+/**
+ * Constructor for the first streamer.
+ *
+ * @param   file_path[in]     String containing the path to the file to read
+ * @param   nb_streamers[in]  Total number of streamers
+ * @param   reader_type[in]   Type of filereader to use (see common.h)
+ * @param   read_buffer_size[in] Size in bytes of the read buffer
+ * @param   profiling[in]     Activate the profiling mode
+ * @return  Pointer to the new Wordstreamer structure
+ */
+Wordstreamer* mr_wordstreamer_dynamic_create_first(const char* file_path,
+                          const int nb_streamers, const fr_type reader_type,
+                          const unsigned int read_buffer_size, bool profiling) {
+
+    return _mr_wordstreamer_dynamic_create(file_path, reader_type, NULL,
+                                 read_buffer_size, 0, nb_streamers, NULL,
+                                 MAPREDUCE_WS_DYNAMIC_CHUNK_SIZE, profiling);
+}
+
+
+/**
+ * Constructor for each other streamer.
+ *
+ * @param   first[in]        Pointer to the first Wordstreamer structure
+ * @param   streamer_id[in]  Id of the current wordstreamer
+ * @return  Pointer to the new Wordstreamer structure
+ */
+Wordstreamer* mr_wordstreamer_dynamic_create_another(const Wordstreamer* first,
+                                                        const int streamer_id) {
+    unsigned int read_buffer_size = 0;
+    assert(first != NULL);
+    Filereader *fr = first->filereader;
+    Wordstreamer_dynamic *first_ext = first->ext;
+
+    if (fr->type == FR_READ) {
+        Filereader_read *ext = fr->ext;
+        assert(ext);
+
+        read_buffer_size = ext->buffer_size;
+    }
+
+    /* Share the chunk cursor of the first streamer */
+    return _mr_wordstreamer_dynamic_create("", first->reader_type,
+                            first->filereader, read_buffer_size, streamer_id,
+                            first->nb_streamers, first_ext->cursor,
+                            first_ext->chunk_size, first->profiling);
+}
+
+
+/**
+ * Delete a Wordstreamer structure.
+ *
+ * @param   ws[in]   Pointer to the Wordstreamer structure
+ */
+void  mr_wordstreamer_dynamic_delete(Wordstreamer* ws) {
+    Wordstreamer_dynamic *ext = ws->ext;
+    assert(ext != NULL);
+
+    /* Display number of claimed chunks [Profiling mode] */
+    if (ws->profiling) {
+        #if MAPREDUCE_DEFAULT_USECOLORS
+            printf("\e[34m |-[WordStreamer %d] chunks:\e[1m %u\e[0m\n",
+                                              ws->streamer_id, ext->nb_chunks);
+        #else
+            printf(" |-[WordStreamer %d] chunks: %u\n", ws->streamer_id,
+                                                               ext->nb_chunks);
+        #endif
+    }
+
+    /* The first streamer owns the shared cursor */
+    if (ws->streamer_id == 0) free(ext->cursor);
+    free(ext);
+
+    _mr_wordstreamer_common_delete(ws);
+}
+
+
+/* ============================= Private functions ========================== */
+
+/**
+ * Internal constructor for Wordstreamer_dynamic.
+ *
+ * @param   file_path[in]     String containing the path to the file to read
+ * @param   reader_type[in]   Type of filereader to use (see common.h)
+ * @param   first_reader[in]  Pointer to the first reader
+ * @param   read_buffer_size[in] Size in bytes of the read buffer
+ * @param   streamer_id[in]   Id of the current wordstreamer
+ * @param   nb_streamers[in]  Total number of streamers
+ * @param   cursor[in]        Shared cursor (NULL to allocate a new one)
+ * @param   chunk_size[in]    Size in bytes of each chunk
+ * @param   profiling[in]     Activate the profiling mode
+ * @return  Pointer to the new Wordstreamer structure
+ */
+Wordstreamer* _mr_wordstreamer_dynamic_create(const char* file_path,
+                     const fr_type reader_type, Filereader *first_reader,
+                     const unsigned int read_buffer_size, const int streamer_id,
+                     const int nb_streamers, long long *cursor,
+                     const long long chunk_size, const bool profiling) {
+    assert(chunk_size > 0);
+
+    Wordstreamer *ws = _mr_wordstreamer_common_create(file_path, reader_type,
+                                          first_reader, read_buffer_size,
+                                          streamer_id, nb_streamers, profiling);
+
+    /* Set function pointers */
+    ws->get = mr_wordstreamer_dynamic_get;
+    ws->delete = mr_wordstreamer_dynamic_delete;
+    ws->create_another = mr_wordstreamer_dynamic_create_another;
+
+    /* Alloc and initialize dynamic extra data */
+    Wordstreamer_dynamic *ext = malloc(sizeof(Wordstreamer_dynamic));
+    assert(ext != NULL);
+    ws->ext = ext;
+
+    if (cursor == NULL) {
+        cursor = malloc(sizeof(long long));
+        assert(cursor != NULL);
+        *cursor = 0;
+    }
+
+    ext->cursor = cursor;
+    ext->chunk_size = chunk_size;
+    ext->nb_chunks = 0;
+
+    /* No chunk claimed yet */
+    ext->chunk_end = true;
+
+    return ws;
+}
+
+
+/**
+ * Claim the next chunk from the shared cursor and set filereader offsets.
+ *
+ * @param   ws[inout]        Pointer to the Wordstreamer structure
+ * @return  0 if a chunk was claimed or 1 if the whole file was distributed
+ */
+int _mr_wordstreamer_dynamic_claim(Wordstreamer *ws) {
+    Wordstreamer_dynamic *ext = ws->ext;
+    Filereader *fr = ws->filereader;
+    long long chunk_size = ext->chunk_size;
+
+    long long start_offset, stop_offset;
+
+    /* Chunks may be empty once aligned on word boundaries */
+    do {
+        start_offset = __sync_fetch_and_add(ext->cursor, chunk_size);
+        if (start_offset >= fr->file_size) return 1;
+
+        stop_offset = start_offset + chunk_size - 1;
+        if (stop_offset >= fr->file_size) stop_offset = fr->file_size - 1;
+    } while (_mr_wordstreamer_set_range(ws, start_offset, stop_offset));
+
+    ext->chunk_end = false;
+    ext->nb_chunks++;
+
+    return 0;
+}
+
+
+/* ============================= Public functions =========================== */
+
+/**
+ * Get next word from a wordstreamer. Return 1 if end of stream reached.
+ *
+ * @param   ws[in]           Pointer to the Wordstreamer structure
+ * @param   buffer[out]      Buffer to hold the retrieved word
+ * @return  0 if a word was copied into the buffer or 1 if the end of the stream
+ *          was reached
+ */
+int mr_wordstreamer_dynamic_get(Wordstreamer *ws, char *buffer) {
+    return _mr_wordstreamer_dynamic_get(ws, buffer, FR_NB);
+}
@@ -0,0 +1,79 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#ifndef HEADER_MAPREDUCE_WORDSTREAMER_DYNAMIC_H
+    #define HEADER_MAPREDUCE_WORDSTREAMER_DYNAMIC_H
+
+    #include "wordstreamer.h"
+
+    /**
+     * @struct wordstreamer_dynamic_s
+     * @brief  Structure containing extra data for wordstreamer_dynamic.
+     */
+    typedef struct wordstreamer_dynamic_s {
+        long long*    cursor;       /**<  Shared offset of the next chunk     */
+        long long     chunk_size;   /**<  Size in Bytes of each chunk         */
+        unsigned int  nb_chunks;    /**<  Chunks claimed by this streamer     */
+        bool          chunk_end;    /**<  End of the current chunk reached    */
+    } Wordstreamer_dynamic;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /* Set the next range of the streamer (once per range, not inlined) */
+    int  _mr_wordstreamer_dynamic_claim(Wordstreamer*);
+
+    /**
+     * Get next word from a wordstreamer. Static inline definition so that map
+     * loops specialized for a type of filereader may inline the whole stream.
+     *
+     * @param   ws[in]           Pointer to the Wordstreamer structure
+     * @param   buffer[out]      Buffer to hold the retrieved word
+     * @param   reader_type[in]  Type of the filereader (or FR_NB)
+     * @return  0 if a word was copied into the buffer or 1 if the end of the
+     *          stream was reached
+     */
+    static inline __attribute__((always_inline)) int
+    _mr_wordstreamer_dynamic_get(Wordstreamer *ws, char *buffer,
+                                                 const fr_type reader_type) {
+        Wordstreamer_dynamic *ext = ws->ext;
+
+        while (!ws->end) {
+            /* Claim a new chunk when the current one is exhausted */
+            if (ext->chunk_end && _mr_wordstreamer_dynamic_claim(ws)) {
+                ws->end = true;
+                break;
+            }
+
+            if (!_mr_wordstreamer_range_get(ws, buffer, &ext->chunk_end,
+                                                     reader_type)) return 0;
+        }
+
+        return 1;
+    }
+
+
+    /* ============================== Prototypes ============================ */
+
+    Wordstreamer*  mr_wordstreamer_dynamic_create_first(const char*, const int,
+                                       const fr_type, const unsigned int, bool);
+    Wordstreamer*  mr_wordstreamer_dynamic_create_another(const Wordstreamer*,
+                                                                     const int);
+    void           mr_wordstreamer_dynamic_delete(Wordstreamer*);
+
+    int            mr_wordstreamer_dynamic_get(Wordstreamer*, char*);
+
+    Wordstreamer*  _mr_wordstreamer_dynamic_create(const char*, const fr_type,
+                             Filereader*, const unsigned int, const int,
+                             const int, long long*, const long long, const bool);
+#endif
@@ -12,18 +12,16 @@
 *******************************************************************************/
 
 /**
- * @file wordstreamer_iwords.c
+ * @file wordstreamer_iblocks.c
  * @brief Streamer to retrieve words from a file. With multiple streams, file is
-          accessed in words interleaved fashion.
+          split in fixed-size blocks accessed in interleaved fashion: streamer i
+          reads blocks i, i+N, i+2N... so that every byte is read only once.
  * @author Jean-Yves VET
  */
 
-#include "wordstreamer_iwords.h"
+#include "wordstreamer_iblocks.h"
 #include "filereader_read.h"
 
-Wordstreamer* _mr_wordstreamer_iwords_create(const char*, const fr_type,
-             Filereader*, const unsigned int, const int, const int, const bool);
-
 /* ========================= Constructor / Destructor ======================= */
 
 /**
@@ -36,12 +34,13 @@ Wordstreamer* _mr_wordstreamer_iwords_create(const char*, const fr_type,
  * @param   profiling[in]     Activate the profiling mode
  * @return  Pointer to the new Wordstreamer structure
  */
-Wordstreamer* mr_wordstreamer_iwords_create_first(const char* file_path,
+Wordstreamer* mr_wordstreamer_iblocks_create_first(const char* file_path,
                           const int nb_streamers, const fr_type reader_type,
                           const unsigned int read_buffer_size, bool profiling) {
 
-    return _mr_wordstreamer_iwords_create(file_path, reader_type, NULL,
-                                  read_buffer_size, 0, nb_streamers, profiling);
+    return _mr_wordstreamer_iblocks_create(file_path, reader_type, NULL,
+                                 read_buffer_size, 0, nb_streamers,
+                                 MAPREDUCE_WS_IBLOCKS_BLOCK_SIZE, profiling);
 }
 
 
@@ -52,11 +51,12 @@ Wordstreamer* mr_wordstreamer_iwords_create_first(const char* file_path,
  * @param   streamer_id[in]  Id of the current wordstreamer
  * @return  Pointer to the new Wordstreamer structure
  */
-Wordstreamer* mr_wordstreamer_iwords_create_another(const Wordstreamer* first,
+Wordstreamer* mr_wordstreamer_iblocks_create_another(const Wordstreamer* first,
                                                         const int streamer_id) {
     unsigned int read_buffer_size = 0;
     assert(first != NULL);
     Filereader *fr = first->filereader;
+    Wordstreamer_iblocks *first_ext = first->ext;
 
     if (fr->type == FR_READ) {
         Filereader_read *ext = fr->ext;
@@ -65,9 +65,10 @@ Wordstreamer* mr_wordstreamer_iwords_create_another(const Wordstreamer* first,
         read_buffer_size = ext->buffer_size;
     }
 
-    return _mr_wordstreamer_iwords_create("", first->reader_type,
-                            first->filereader, read_buffer_size,
-                            streamer_id, first->nb_streamers, first->profiling);
+    return _mr_wordstreamer_iblocks_create("", first->reader_type,
+                            first->filereader, read_buffer_size, streamer_id,
+                            first->nb_streamers, first_ext->block_size,
+                            first->profiling);
 }
 
 
@@ -76,7 +77,10 @@ Wordstreamer* mr_wordstreamer_iwords_create_another(const Wordstreamer* first,
  *
  * @param   ws[in]   Pointer to the Wordstreamer structure
  */
-void  mr_wordstreamer_iwords_delete(Wordstreamer* ws) {
+void  mr_wordstreamer_iblocks_delete(Wordstreamer* ws) {
+    assert(ws->ext != NULL);
+    free(ws->ext);
+
     _mr_wordstreamer_common_delete(ws);
 }
 
@@ -84,7 +88,7 @@ void  mr_wordstreamer_iwords_delete(Wordstreamer* ws) {
 /* ============================= Private functions ========================== */
 
 /**
- * Internal constructor for Wordstreamer_iwords.
+ * Internal constructor for Wordstreamer_iblocks.
  *
  * @param   file_path[in]     String containing the path to the file to read
  * @param   reader_type[in]   Type of filereader to use (see common.h)
@@ -92,85 +96,65 @@ void  mr_wordstreamer_iwords_delete(Wordstreamer* ws) {
  * @param   read_buffer_size[in] Size in bytes of the read buffer
  * @param   streamer_id[in]   Id of the current wordstreamer
  * @param   nb_streamers[in]  Total number of streamers
+ * @param   block_size[in]    Size in bytes of each block
  * @param   profiling[in]     Activate the profiling mode
  * @return  Pointer to the new Wordstreamer structure
  */
-Wordstreamer* _mr_wordstreamer_iwords_create(const char* file_path,
+Wordstreamer* _mr_wordstreamer_iblocks_create(const char* file_path,
                     const fr_type reader_type, Filereader* first_reader,
                     const unsigned int read_buffer_size, const int streamer_id,
-                    const int nb_streamers, const bool profiling) {
+                    const int nb_streamers, const long long block_size,
+                    const bool profiling) {
+    assert(block_size > 0);
 
     Wordstreamer *ws = _mr_wordstreamer_common_create(file_path, reader_type,
                                           first_reader, read_buffer_size,
                                           streamer_id, nb_streamers, profiling);
 
     /* Set function pointers */
-    ws->get = mr_wordstreamer_iwords_get;
-    ws->delete = mr_wordstreamer_iwords_delete;
-    ws->create_another = mr_wordstreamer_iwords_create_another;
-
-    /* Initialize offsets for filereader */
-    Filereader *fr = ws->filereader;
-    mr_filereader_set_offsets(fr, 0, fr->file_size - 1);
+    ws->get = mr_wordstreamer_iblocks_get;
+    ws->delete = mr_wordstreamer_iblocks_delete;
+    ws->create_another = mr_wordstreamer_iblocks_create_another;
+
+    /* Alloc and initialize iblocks extra data */
+    Wordstreamer_iblocks *ext = malloc(sizeof(Wordstreamer_iblocks));
+    assert(ext != NULL);
+    ws->ext = ext;
+    ext->next_block = streamer_id;
+    ext->block_size = block_size;
+    ext->block_end = true;
 
     return ws;
 }
 
 
 /**
- * Remove non-word characters to the stream.
+ * Move to the next block owned by the streamer and set filereader offsets.
  *
- * @param   fr[inout]            Pointer to the filereader
- * @param   character_ptr[in]    Pointer to the last character retrieved
- * @param   ret_ptr[in]          Pointer to the last returned value
+ * @param   ws[inout]        Pointer to the Wordstreamer structure
+ * @return  0 if a block is available or 1 if the end of the file was reached
  */
-static inline void _mr_wordstreamer_iwords_remove_nonwords(Filereader *fr,
-                                            char *character_ptr, int *ret_ptr) {
-    int ret = *ret_ptr;
-    char character = *character_ptr;
-
-    /* Remove extra spaces and punctuation char */
-    while ((ispunct(character) || isspace(character)) && !ret) {
-        ret = mr_filereader_get_byte(fr, character_ptr);
-        character = *character_ptr;
-    }
-
-    /* Save return value */
-    *ret_ptr = ret;
-}
-
+int _mr_wordstreamer_iblocks_next(Wordstreamer *ws) {
+    Wordstreamer_iblocks *ext = ws->ext;
+    Filereader *fr = ws->filereader;
 
-/**
- * Retrieve a word.
- *
- * @param   fr[inout]            Pointer to the filereader
- * @param   character_ptr[in]    Pointer to the last character retrieved
- * @param   ret_ptr[in]          Pointer to the last returned value
- * @param   streamer_id[in]      Id of the current wordstreamer
- * @param   buffer[out]          Buffer to hold the retrieved word
- */
- static inline void _mr_wordstreamer_iwords_retrieve_word(Filereader *fr,
-             char *character_ptr, int *ret_ptr, int streamer_id, char *buffer) {
+    long long start_offset, stop_offset;
 
-     int i=0, ret = *ret_ptr;
-     char character = *character_ptr;
+    /* Blocks may be empty once aligned on word boundaries */
+    do {
+        start_offset = ext->next_block * ext->block_size;
+        if (start_offset >= fr->file_size) return 1;
 
-     /* Retrieve all characters */
-     while(!ispunct(character) && !isspace(character) && ret >= 0) {
-         buffer[i++] = character;
-         ret = mr_filereader_get_byte(fr, character_ptr);
-         character = *character_ptr;
-     }
+        stop_offset = start_offset + ext->block_size - 1;
+        if (stop_offset >= fr->file_size) stop_offset = fr->file_size - 1;
 
-     /* Terminate string */
-     buffer[i] = '\0';
+        ext->next_block += ws->nb_streamers;
+    } while (_mr_wordstreamer_set_range(ws, start_offset, stop_offset));
 
-     /* First char to lower case */
-     buffer[0] = tolower(buffer[0]);
+    ext->block_end = false;
 
-     /* Save return value */
-     *ret_ptr = ret;
- }
+    return 0;
+}
 
 
 /* ============================= Public functions =========================== */
@@ -183,38 +167,6 @@ static inline void _mr_wordstreamer_iwords_remove_nonwords(Filereader *fr,
  * @return  0 if a word was copied into the buffer or 1 if the end of the stream
  *          was reached
  */
-int mr_wordstreamer_iwords_get(Wordstreamer *ws, char *buffer) {
-    int ret, streamer_id = ws->streamer_id, nb_streamers = ws->nb_streamers;
-    Filereader *fr = ws->filereader;
-    char character, word[MAPREDUCE_MAX_WORD_SIZE];
-    int word_count = 0;
-
-    /* Return because end of stream already reached */
-    if(ws->end) return 1;
-
-    /* Get next byte */
-    ret = mr_filereader_get_byte(fr, &character);
-
-    /* Find the next word associated with the streamer id */
-    while (word_count < nb_streamers && !ret) {
-        /* Remove incomplete words, spaces and punctuation */
-        _mr_wordstreamer_iwords_remove_nonwords(fr, &character, &ret);
-
-        if (!ret) {
-            /* Retrieve a complete word */
-            _mr_wordstreamer_iwords_retrieve_word(fr, &character, &ret,
-                                                             streamer_id, word);
-
-            if (word_count == streamer_id) {
-                strcpy(buffer, word);
-            }
-
-            word_count++;
-        } else {
-            ws->end = true;
-            break;
-        }
-    }
-
-    return (word_count <= streamer_id);
+int mr_wordstreamer_iblocks_get(Wordstreamer *ws, char *buffer) {
+    return _mr_wordstreamer_iblocks_get(ws, buffer, FR_NB);
 }
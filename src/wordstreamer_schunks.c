@@ -22,7 +22,8 @@
 #include "filereader_read.h"
 
 Wordstreamer* _mr_wordstreamer_schunks_create(const char*, const fr_type,
-             Filereader*, const unsigned int, const int, const int, const bool);
+                          Filereader*, const unsigned int, const int, const int,
+                                  Wordstreamer_schunks_range*, const bool);
 
 /* ========================= Constructor / Destructor ======================= */
 
@@ -41,7 +42,7 @@ Wordstreamer* mr_wordstreamer_schunks_create_first(const char* file_path,
                           const unsigned int read_buffer_size, bool profiling) {
 
     return _mr_wordstreamer_schunks_create(file_path, reader_type, NULL,
-                                  read_buffer_size, 0, nb_streamers, profiling);
+                            read_buffer_size, 0, nb_streamers, NULL, profiling);
 }
 
 
@@ -57,6 +58,7 @@ Wordstreamer* mr_wordstreamer_schunks_create_another(const Wordstreamer* first,
     unsigned int read_buffer_size = 0;
     assert(first != NULL);
     Filereader *fr = first->filereader;
+    Wordstreamer_schunks *first_ext = first->ext;
 
     if (fr->type == FR_READ) {
         Filereader_read *ext = fr->ext;
@@ -66,8 +68,9 @@ Wordstreamer* mr_wordstreamer_schunks_create_another(const Wordstreamer* first,
     }
 
     return _mr_wordstreamer_schunks_create("", first->reader_type,
-                            first->filereader, read_buffer_size,
-                            streamer_id, first->nb_streamers, first->profiling);
+                            first->filereader, read_buffer_size, streamer_id,
+                            first->nb_streamers, first_ext->ranges,
+                            first->profiling);
 }
 
 
@@ -77,6 +80,22 @@ Wordstreamer* mr_wordstreamer_schunks_create_another(const Wordstreamer* first,
  * @param   ws[in]   Pointer to the Wordstreamer structure
  */
 void  mr_wordstreamer_schunks_delete(Wordstreamer* ws) {
+    Wordstreamer_schunks *ext = ws->ext;
+    assert(ext != NULL);
+
+    /* The first streamer owns the shared ranges */
+    if (ws->streamer_id == 0) {
+        int i;
+
+        for (i=0; i<ws->nb_streamers; i++) {
+            pthread_mutex_destroy(&ext->ranges[i].lock);
+        }
+
+        free(ext->ranges);
+    }
+
+    free(ext);
+
     _mr_wordstreamer_common_delete(ws);
 }
 
@@ -92,13 +111,15 @@ void  mr_wordstreamer_schunks_delete(Wordstreamer* ws) {
  * @param   read_buffer_size[in] Size in bytes of the read buffer
  * @param   streamer_id[in]   Id of the current wordstreamer
  * @param   nb_streamers[in]  Total number of streamers
+ * @param   ranges[in]        Shared ranges (NULL to allocate new ones)
  * @param   profiling[in]     Activate the profiling mode
  * @return  Pointer to the new Wordstreamer structure
  */
 Wordstreamer* _mr_wordstreamer_schunks_create(const char* file_path,
                      const fr_type reader_type, Filereader *first_reader,
                      const unsigned int read_buffer_size, const int streamer_id,
-                                 const int nb_streamers, const bool profiling) {
+                     const int nb_streamers, Wordstreamer_schunks_range *ranges,
+                                                        const bool profiling) {
 
     Wordstreamer *ws = _mr_wordstreamer_common_create(file_path, reader_type,
                                           first_reader, read_buffer_size,
@@ -106,9 +127,30 @@ Wordstreamer* _mr_wordstreamer_schunks_create(const char* file_path,
 
     /* Set function pointers */
     ws->get = mr_wordstreamer_schunks_get;
+    ws->steal = mr_wordstreamer_schunks_steal;
     ws->delete = mr_wordstreamer_schunks_delete;
     ws->create_another = mr_wordstreamer_schunks_create_another;
 
+    /* Allocate ranges of all streamers */
+    if (ranges == NULL) {
+        int i;
+
+        ranges = malloc(nb_streamers*sizeof(Wordstreamer_schunks_range));
+        assert(ranges != NULL);
+
+        for (i=0; i<nb_streamers; i++) {
+            pthread_mutex_init(&ranges[i].lock, NULL);
+        }
+    }
+
+    /* Alloc and initialize schunks extra data */
+    Wordstreamer_schunks *ext = malloc(sizeof(Wordstreamer_schunks));
+    assert(ext != NULL);
+    ws->ext = ext;
+    ext->ranges = ranges;
+    ext->block_size = MAPREDUCE_WS_SCHUNKS_BLOCK_SIZE;
+    ext->block_end = true;
+
     /* Compute offsets */
     Filereader *fr = ws->filereader;
     long long chunk_size = fr->file_size / nb_streamers;
@@ -120,78 +162,47 @@ Wordstreamer* _mr_wordstreamer_schunks_create(const char* file_path,
         stop_offset += fr->file_size % nb_streamers;
     }
 
-    /* Initialize offsets for filereader */
-    mr_filereader_set_offsets(fr, start_offset, stop_offset);
+    /* Initialize the range of the streamer */
+    Wordstreamer_schunks_range *range = &ranges[streamer_id];
+    pthread_mutex_lock(&range->lock);
+    range->next = start_offset;
+    range->stop = stop_offset;
+    pthread_mutex_unlock(&range->lock);
 
     return ws;
 }
 
 
 /**
- * Remove non-word characters to the stream.
+ * Claim the next block of the range and set filereader offsets. Blocks are
+ * claimed one after the other so that the unclaimed part of the range may be
+ * safely stolen.
  *
- * @param   fr[inout]            Pointer to the filereader
- * @param   character_ptr[in]    Pointer to the last character retrieved
- * @param   ret_ptr[in]          Pointer to the last returned value
-  * @param  streamer_id[in]      Id of the current streamer
+ * @param   ws[inout]        Pointer to the Wordstreamer structure
+ * @return  0 if a block was claimed or 1 if the range is over
  */
-static inline void _mr_wordstreamer_schunks_remove_nonwords(Filereader *fr,
-                           char *character_ptr, int *ret_ptr, int streamer_id) {
-
-    int ret = *ret_ptr;
-    char character = *character_ptr;
-
-    /* Remove incomplete words */
-    if (streamer_id && fr->offset - 1 == fr->start_offset) {
-        while (!ispunct(character)
-               && !isspace(character)
-               && !ret) {
-            ret = mr_filereader_get_byte(fr, character_ptr);
-            character = *character_ptr;
-        }
-    }
+int _mr_wordstreamer_schunks_claim(Wordstreamer *ws) {
+    Wordstreamer_schunks *ext = ws->ext;
+    Wordstreamer_schunks_range *range = &ext->ranges[ws->streamer_id];
+    long long start_offset, stop_offset;
 
-    /* Remove extra spaces and punctuation char */
-    while ((ispunct(character) || isspace(character)) && !ret) {
-        ret = mr_filereader_get_byte(fr, character_ptr);
-        character = *character_ptr;
-    }
+    /* Blocks may be empty once aligned on word boundaries */
+    do {
+        pthread_mutex_lock(&range->lock);
 
-    /* Save return value */
-    *ret_ptr = ret;
-}
+        start_offset = range->next;
+        stop_offset = start_offset + ext->block_size - 1;
+        if (stop_offset > range->stop) stop_offset = range->stop;
+        range->next = stop_offset + 1;
 
+        pthread_mutex_unlock(&range->lock);
 
-/**
- * Retrieve a word.
- *
- * @param   fr[inout]            Pointer to the filereader
- * @param   character_ptr[in]    Pointer to the last character retrieved
- * @param   ret_ptr[in]          Pointer to the last returned value
- * @param   streamer_id[in]      Id of the current wordstreamer
- * @param   buffer[out]          Buffer to hold the retrieved word
- */
-static inline void _mr_wordstreamer_schunks_retrieve_word(Filereader *fr,
-             char *character_ptr, int *ret_ptr, int streamer_id, char *buffer) {
-
-    int i=0, ret = *ret_ptr;
-    char character = *character_ptr;
-
-    /* Retrieve all characters */
-    while(!ispunct(character) && !isspace(character) && ret >= 0) {
-        buffer[i++] = character;
-        ret = mr_filereader_get_byte(fr, character_ptr);
-        character = *character_ptr;
-    }
+        if (start_offset > stop_offset) return 1;
+    } while (_mr_wordstreamer_set_range(ws, start_offset, stop_offset));
 
-    /* Terminate string */
-    buffer[i] = '\0';
+    ext->block_end = false;
 
-    /* First char to lower case */
-    buffer[0] = tolower(buffer[0]);
-
-    /* Save return value */
-    *ret_ptr = ret;
+    return 0;
 }
 
 
@@ -206,44 +217,70 @@ static inline void _mr_wordstreamer_schunks_retrieve_word(Filereader *fr,
  *          was reached
  */
 int mr_wordstreamer_schunks_get(Wordstreamer *ws, char *buffer) {
-    int ret, streamer_id = ws->streamer_id;
-    Filereader *fr = ws->filereader;
-    char character;
+    return _mr_wordstreamer_schunks_get(ws, buffer, FR_NB);
+}
 
-    /* Return because end of stream already reached */
-    if(ws->end) return 1;
 
-    /* Get next byte */
-    ret = mr_filereader_get_byte(fr, &character);
+/**
+ * Steal the second half of the largest remaining range among all other
+ * streamers. The victim's range is shortened under its lock, and the word
+ * crossing the split belongs to the victim as for any other block boundary.
+ *
+ * @param   ws[inout]        Pointer to the Wordstreamer structure
+ * @return  0 if a range was stolen or 1 if there was nothing worth stealing
+ */
+int mr_wordstreamer_schunks_steal(Wordstreamer *ws) {
+    Wordstreamer_schunks *ext = ws->ext;
+    Wordstreamer_schunks_range *ranges = ext->ranges;
+    long long min_size = 2 * ext->block_size;
+
+    while (1) {
+        int i, victim = -1;
+        long long largest = 0;
+
+        /* Look for the largest remaining range */
+        for (i=0; i<ws->nb_streamers; i++) {
+            if (i == ws->streamer_id) continue;
+
+            pthread_mutex_lock(&ranges[i].lock);
+            long long remaining = ranges[i].stop - ranges[i].next + 1;
+            pthread_mutex_unlock(&ranges[i].lock);
+
+            if (remaining >= min_size && remaining > largest) {
+                largest = remaining;
+                victim = i;
+            }
+        }
+
+        if (victim < 0) return 1;
 
-    /* Remove incomplete words, spaces and punctuation */
-    _mr_wordstreamer_schunks_remove_nonwords(fr, &character, &ret, streamer_id);
+        /* Split the victim's range (it may have shrunk in the meantime) */
+        Wordstreamer_schunks_range *range = &ranges[victim];
+        long long start_offset, stop_offset;
 
-    if (!ret) {
-        /* Retrieve a complete word */
-        _mr_wordstreamer_schunks_retrieve_word(fr, &character, &ret,
-                                                           streamer_id, buffer);
+        pthread_mutex_lock(&range->lock);
+        long long remaining = range->stop - range->next + 1;
+        if (remaining < min_size) {
+            pthread_mutex_unlock(&range->lock);
+            continue;
+        }
+
+        start_offset = range->next + remaining / 2;
+        stop_offset = range->stop;
+        range->stop = start_offset - 1;
+        pthread_mutex_unlock(&range->lock);
 
-        if (ret) ws->end = true;
+        /* Install the stolen part as the new range of the thief */
+        range = &ranges[ws->streamer_id];
+        pthread_mutex_lock(&range->lock);
+        range->next = start_offset;
+        range->stop = stop_offset;
+        pthread_mutex_unlock(&range->lock);
+
+        ws->nb_steals++;
+        ws->stolen_bytes += stop_offset - start_offset + 1;
+        ext->block_end = true;
 
         return 0;
-    } else {
-        /* Retrieve one more word (last word between this chunk and the next
-           one) */
-        if(ret == 1
-           && !ispunct(character)
-           && !isspace(character)) {
-
-            _mr_wordstreamer_schunks_retrieve_word(fr, &character, &ret,
-                                                           streamer_id, buffer);
-            ws->end = true;
-
-            return 0;
-        } else {
-            /* Return because end of stream reached */
-            ws->end = true;
-
-            return 1;
-        }
     }
 }
@@ -14,8 +14,68 @@
 #ifndef HEADER_MAPREDUCE_WORDSTREAMER_SCHUNKS_H
     #define HEADER_MAPREDUCE_WORDSTREAMER_SCHUNKS_H
 
+    #include <pthread.h>
     #include "wordstreamer.h"
 
+    /**
+     * @struct wordstreamer_schunks_range_s
+     * @brief  Structure containing the part of a chunk which has not been
+     *         processed yet. It is shared to allow other streamers to steal
+     *         its second half.
+     */
+    typedef struct wordstreamer_schunks_range_s {
+        pthread_mutex_t  lock;      /**<  Protect offsets against stealing    */
+        long long        next;      /**<  Offset of the next unclaimed byte   */
+        long long        stop;      /**<  Offset of the last byte             */
+    } Wordstreamer_schunks_range;
+
+
+    /**
+     * @struct wordstreamer_schunks_s
+     * @brief  Structure containing extra data for wordstreamer_schunks.
+     */
+    typedef struct wordstreamer_schunks_s {
+        Wordstreamer_schunks_range* ranges;  /**<  Ranges of all streamers    */
+        long long    block_size;  /**<  Bytes claimed at once from the range  */
+        bool         block_end;   /**<  End of the current block reached      */
+    } Wordstreamer_schunks;
+
+
+    /* =========================== Static Elements ========================== */
+
+    /* Set the next range of the streamer (once per range, not inlined) */
+    int  _mr_wordstreamer_schunks_claim(Wordstreamer*);
+
+    /**
+     * Get next word from a wordstreamer. Static inline definition so that map
+     * loops specialized for a type of filereader may inline the whole stream.
+     *
+     * @param   ws[in]           Pointer to the Wordstreamer structure
+     * @param   buffer[out]      Buffer to hold the retrieved word
+     * @param   reader_type[in]  Type of the filereader (or FR_NB)
+     * @return  0 if a word was copied into the buffer or 1 if the end of the
+     *          stream was reached
+     */
+    static inline __attribute__((always_inline)) int
+    _mr_wordstreamer_schunks_get(Wordstreamer *ws, char *buffer,
+                                                 const fr_type reader_type) {
+        Wordstreamer_schunks *ext = ws->ext;
+
+        while (!ws->end) {
+            /* Claim a new block when the current one is exhausted */
+            if (ext->block_end && _mr_wordstreamer_schunks_claim(ws)) {
+                ws->end = true;
+                break;
+            }
+
+            if (!_mr_wordstreamer_range_get(ws, buffer, &ext->block_end,
+                                                     reader_type)) return 0;
+        }
+
+        return 1;
+    }
+
+
     /* ============================== Prototypes ============================ */
 
     Wordstreamer*  mr_wordstreamer_schunks_create_first(const char*, const int,
@@ -25,4 +85,5 @@
     void           mr_wordstreamer_schunks_delete(Wordstreamer*);
 
     int            mr_wordstreamer_schunks_get(Wordstreamer*, char*);
+    int            mr_wordstreamer_schunks_steal(Wordstreamer*);
 #endif
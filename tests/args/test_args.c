@@ -50,6 +50,59 @@ START_TEST (test_parse)
 END_TEST
 
 
+START_TEST (test_parse_sort)
+{
+    char *argv[4] = {"", "file", "2", "--sort=count"};
+    Arguments *args = mr_args_create(4, argv);
+    ck_assert_int_eq(args->order, SO_ALPHA);
+
+    _parse_arguments(4, argv, args);
+    ck_assert_int_eq(args->order, SO_COUNT);
+    ck_assert_int_eq(args->nb_threads, 2);
+
+    mr_args_delete(&args);
+}
+END_TEST
+
+
+START_TEST (test_parse_ngram)
+{
+    char *argv[4] = {"", "file", "2", "--ngram=2"};
+    Arguments *args = mr_args_create(4, argv);
+    ck_assert_int_eq(args->dictionary_type, MAPREDUCE_DC_DEFAULT_TYPE);
+
+    /* N-grams are counted with a hash dictionary by default */
+    _parse_arguments(4, argv, args);
+    ck_assert_int_eq(args->ngram, 2);
+    ck_assert_int_eq(args->dictionary_type, MAPREDUCE_DC_NGRAM_TYPE);
+    mr_args_delete(&args);
+
+    /* Unless another dictionary is chosen */
+    char *argv_swiss[5] = {"", "file", "2", "--ngram=2", "--swiss"};
+    args = mr_args_create(5, argv_swiss);
+    _parse_arguments(5, argv_swiss, args);
+    ck_assert_int_eq(args->dictionary_type, DC_SWISS);
+    mr_args_delete(&args);
+}
+END_TEST
+
+
+START_TEST (test_parse_lengths)
+{
+    char *argv[5] = {"", "file", "2", "--min-length=3", "--max-length=7"};
+    Arguments *args = mr_args_create(5, argv);
+    ck_assert_int_eq(args->min_length, MAPREDUCE_DEFAULT_MIN_LENGTH);
+    ck_assert_int_eq(args->max_length, MAPREDUCE_DEFAULT_MAX_LENGTH);
+
+    _parse_arguments(5, argv, args);
+    ck_assert_int_eq(args->min_length, 3);
+    ck_assert_int_eq(args->max_length, 7);
+
+    mr_args_delete(&args);
+}
+END_TEST
+
+
 Suite *args_suite(void) {
     Suite *suite = suite_create("Arguments");
     TCase *tcase1 = tcase_create("Create");
@@ -59,6 +112,9 @@ Suite *args_suite(void) {
     tcase_add_test(tcase1, test_create);
     tcase_add_test(tcase2, test_delete);
     tcase_add_test(tcase3, test_parse);
+    tcase_add_test(tcase3, test_parse_sort);
+    tcase_add_test(tcase3, test_parse_ngram);
+    tcase_add_test(tcase3, test_parse_lengths);
 
     suite_add_tcase(suite, tcase1);
     suite_add_tcase(suite, tcase2);
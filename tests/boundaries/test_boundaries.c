@@ -0,0 +1,260 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "boundaries.h"
+#include <check.h>
+
+#define MAX_THREADS 11
+#define MAX_GRANULARITY 17
+
+void create_file(const char *filename, const char *content) {
+    FILE *fp;
+    fp = fopen (filename,"w");
+    if (fp!=NULL) {
+        fprintf(fp, "%s", content);
+        fclose (fp);
+    }
+}
+
+
+START_TEST (test_build)
+{
+    int i, g;
+    long long k;
+    /* Create test file */
+    char *filename = "bd_test.txt";
+    char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
+                    "Donec a diam lectus. Sed sit amet ipsum mauris. Maecenas "
+                    "congue ligula ac quam viverra nec consectetur ante "
+                    "hendrerit. Donec et mollis dolor. Praesent et diam eget "
+                    "libero egestas mattis sit amet vitae augue. Nam tincidunt "
+                    "congue enim, ut porta lorem lacinia consectetur.";
+    long long size = strlen(content);
+    create_file(filename, content);
+
+    for (i=1; i<=MAX_THREADS; i++) {
+        for (g=1; g<=MAX_GRANULARITY; g++) {
+            Boundaries *b = _mr_boundaries_build(filename, g, i);
+            ck_assert(b != NULL);
+
+            ck_assert_int_eq(b->file_size, size);
+            ck_assert_int_eq(b->nb_offsets, size / g + 1);
+            ck_assert_int_eq(b->offsets[0], 0);
+
+            /* Each entry is the first delimiter after its nominal offset */
+            for (k=1; k<b->nb_offsets; k++) {
+                long long o;
+                ck_assert(b->offsets[k] >= k*g);
+                ck_assert(b->offsets[k] >= b->offsets[k-1]);
+
+                for (o=k*g; o<b->offsets[k]; o++) {
+                    ck_assert(!ispunct(content[o]) && !isspace(content[o]));
+                }
+
+                if (b->offsets[k] < size) {
+                    char c = content[b->offsets[k]];
+                    ck_assert(ispunct(c) || isspace(c));
+                }
+            }
+
+            /* Snapped offsets are boundaries or the file size */
+            ck_assert_int_eq(mr_boundaries_snap(b, 0), 0);
+            ck_assert_int_eq(mr_boundaries_snap(b, size), size);
+            ck_assert_int_eq(mr_boundaries_snap(b, size + g), size);
+
+            mr_boundaries_delete(&b);
+            ck_assert(b == NULL);
+        }
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_build_rows)
+{
+    int i, g;
+    long long k, o;
+    /* Create test file with quoted newlines */
+    char *filename = "bd_test.csv";
+    char *content = "id,method,path,comment\n"
+                    "1,GET,/index.html,\"first\nline\"\n"
+                    "2,POST,/form,\"with \"\"quotes\"\" and\n\n newlines\"\n"
+                    "3,GET,\"/a,b\",plain\r\n"
+                    "4,GET,/,\"a very long comment which spans several blocks "
+                    "of sixty four bytes,\nwith a newline, a comma and more "
+                    "text until the end of the quoted field\"\n"
+                    "5,PUT,/x,\n"
+                    "6,GET,/y,\"\"";
+    long long size = strlen(content);
+    bool starts[size+1];
+    create_file(filename, content);
+
+    /* Row starts found sequentially */
+    bool quoted = false;
+    memset(starts, 0, sizeof(starts));
+    starts[0] = true;
+    starts[size] = true;
+
+    for (o=0; o<size; o++) {
+        if (content[o] == '"') quoted = !quoted;
+        if (content[o] == '\n' && !quoted) starts[o+1] = true;
+    }
+
+    for (i=1; i<=MAX_THREADS; i++) {
+        for (g=1; g<=MAX_GRANULARITY; g++) {
+            Boundaries *b = _mr_boundaries_build_rows(filename, g, i);
+            ck_assert(b != NULL);
+            ck_assert(b->rows);
+
+            ck_assert_int_eq(b->file_size, size);
+            ck_assert_int_eq(b->nb_offsets, size / g + 1);
+            ck_assert_int_eq(b->offsets[0], 0);
+
+            /* Each entry is the first row start after its nominal offset */
+            for (k=1; k<b->nb_offsets; k++) {
+                ck_assert(b->offsets[k] > k*g || b->offsets[k] == size);
+                ck_assert(starts[b->offsets[k]]);
+
+                for (o=k*g+1; o<b->offsets[k]; o++) ck_assert(!starts[o]);
+            }
+
+            mr_boundaries_delete(&b);
+        }
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_save_load)
+{
+    long long k;
+    /* Create test file */
+    char *filename = "bd_test.txt";
+    char *sidecar = "bd_test.txt" MAPREDUCE_BOUNDARIES_SUFFIX;
+    create_file(filename, "Donec viverra mi quis quam pulvinar at malesuada.");
+    remove(sidecar);
+
+    /* No index yet */
+    ck_assert(_mr_boundaries_load(filename, false) == NULL);
+
+    Boundaries *b = _mr_boundaries_build(filename, 4, 3);
+    ck_assert(!b->loaded);
+    ck_assert_int_eq(_mr_boundaries_save(b, filename), 0);
+
+    /* Reload the same index */
+    Boundaries *l = _mr_boundaries_load(filename, false);
+    ck_assert(l != NULL);
+    ck_assert(l->loaded);
+    ck_assert_int_eq(l->nb_offsets, b->nb_offsets);
+    ck_assert_int_eq(l->granularity, b->granularity);
+    ck_assert_int_eq(l->file_size, b->file_size);
+
+    for (k=0; k<b->nb_offsets; k++) {
+        ck_assert_int_eq(l->offsets[k], b->offsets[k]);
+    }
+
+    mr_boundaries_delete(&l);
+    mr_boundaries_delete(&b);
+
+    /* The index is dropped once the file changes */
+    create_file(filename, "Cum sociis natoque penatibus et magnis dis montes.");
+    ck_assert(_mr_boundaries_load(filename, false) == NULL);
+
+    /* Create rebuilds and saves a valid index */
+    b = mr_boundaries_create(filename, 2, false);
+    ck_assert(b != NULL);
+    ck_assert(!b->loaded);
+    mr_boundaries_delete(&b);
+
+    b = mr_boundaries_create(filename, 2, false);
+    ck_assert(b != NULL);
+    ck_assert(b->loaded);
+    mr_boundaries_delete(&b);
+
+    /* Indexes of rows have their own sidecar */
+    ck_assert(_mr_boundaries_load(filename, true) == NULL);
+    b = mr_boundaries_create_rows(filename, 2, false);
+    ck_assert(b->rows && !b->loaded);
+    mr_boundaries_delete(&b);
+
+    b = mr_boundaries_create_rows(filename, 2, false);
+    ck_assert(b->rows && b->loaded);
+    mr_boundaries_delete(&b);
+
+    b = mr_boundaries_create(filename, 2, false);
+    ck_assert(!b->rows && b->loaded);
+    mr_boundaries_delete(&b);
+
+    /* Offsets decreasing or past the end of the file are not trusted */
+    long long corrupted[2] = {40, 1000};
+
+    for (k=0; k<2; k++) {
+        b = _mr_boundaries_build(filename, 4, 3);
+        ck_assert_int_eq(_mr_boundaries_save(b, filename), 0);
+        mr_boundaries_delete(&b);
+
+        FILE *fp = fopen(sidecar, "r+b");
+        fseek(fp, sizeof(Boundaries_header) + sizeof(long long), SEEK_SET);
+        fwrite(&corrupted[k], sizeof(long long), 1, fp);
+        fclose(fp);
+        ck_assert(_mr_boundaries_load(filename, false) == NULL);
+
+        /* The index is rebuilt and saved again */
+        b = mr_boundaries_create(filename, 2, false);
+        ck_assert(!b->loaded);
+        mr_boundaries_delete(&b);
+
+        b = mr_boundaries_create(filename, 2, false);
+        ck_assert(b->loaded);
+        mr_boundaries_delete(&b);
+    }
+
+    remove("bd_test.txt" MAPREDUCE_RECORDS_SUFFIX);
+    remove(sidecar);
+    remove(filename);
+}
+END_TEST
+
+
+Suite *boundaries_suite(void) {
+    Suite *suite = suite_create("Boundaries");
+    TCase *tcase1 = tcase_create("Case Build");
+    TCase *tcase2 = tcase_create("Case Save Load");
+    TCase *tcase3 = tcase_create("Case Build Rows");
+
+    tcase_add_test(tcase1, test_build);
+    tcase_add_test(tcase2, test_save_load);
+    tcase_add_test(tcase3, test_build_rows);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = boundaries_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
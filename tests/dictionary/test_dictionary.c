@@ -11,103 +11,215 @@
 * KIND, either express or implied.                                             *
 *******************************************************************************/
 
-#include "dictionary.h"
+#include "dictionary_buckets.h"
 #include <check.h>
 
 #define NB_TESTS 10000
 #define MAX_CHAR 15
 
 
+/* Generate a random word of up to MAX_CHAR characters */
+static void random_word(char *buffer) {
+    int j;
+    int nb_char = rand()%MAX_CHAR + 1;
+
+    for (j=0; j<nb_char; j++) {
+        unsigned char character = rand()%70+50;
+        buffer[j] = (char)character;
+    }
+    buffer[j] = '\0';
+}
+
+
 START_TEST (test_create)
 {
-    Dictionary *dico = mr_dictionary_create(0);
-    ck_assert_int_eq(dico->hash_size, 256*256);
+    Dictionary *dico = mr_dictionary_create(DC_BUCKETS, 0);
+    Dictionary_buckets *ext = dico->ext;
+    ck_assert_int_eq(dico->type, DC_BUCKETS);
+    ck_assert_int_eq(ext->hash_size, 256*256);
 
     mr_dictionary_delete(&dico);
 }
 END_TEST
 
 
-START_TEST (test_delete)
+START_TEST (test_put_hashed)
 {
-    Dictionary *dico = mr_dictionary_create(0);
+    Dictionary *dico = mr_dictionary_create(DC_BUCKETS, 0);
+
+    mr_dictionary_put_word(dico, "sam");
+    mr_dictionary_put_word_hashed(dico, "sam", 3, mr_word_hash("sam", 3));
+    mr_dictionary_put_word_hashed(dico, "samm", 4, mr_word_hash("samm", 4));
+    mr_dictionary_put_word_hashed(dico, "sa", 2, mr_word_hash("sa", 2));
+
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "sam"), 2);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "samm"), 1);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "sa"), 1);
+
+    /* Words of a bucket stay alphabetically sorted */
+    Dictionary_buckets *ext = dico->ext;
+    Word *word = ext->hash_tab['s'*256+'a'].word;
+    ck_assert_str_eq(word->name, "sa");
+    ck_assert_str_eq(word->next->name, "sam");
+    ck_assert_str_eq(word->next->next->name, "samm");
+    ck_assert(word->next->next->next == NULL);
 
     mr_dictionary_delete(&dico);
-    ck_assert(dico == NULL);
 }
 END_TEST
 
 
-START_TEST (test_put)
+/* ======================= Contract of all dictionaries ===================== */
+
+START_TEST (test_backends_create_delete)
 {
-    Dictionary *dico = mr_dictionary_create(0);
+    dc_type type;
 
-    mr_dictionary_put_word(dico, "max");
-    mr_dictionary_put_word(dico, "sam");
-    mr_dictionary_put_word(dico, "lechuck");
-    mr_dictionary_put_word(dico, "guybrush");
-    mr_dictionary_put_word(dico, "fred");
-    mr_dictionary_put_word(dico, "sam");
-    mr_dictionary_put_word(dico, "samandmax");
-    mr_dictionary_put_word(dico, "bernard");
-    mr_dictionary_put_word(dico, "sam");
-    mr_dictionary_put_word(dico, "samm");
+    for (type=0; type<DC_NB; type++) {
+        Dictionary *dico = mr_dictionary_create(type, 0);
 
-    ck_assert_int_eq(mr_dictionary_count_word(dico, "max"), 1);
-    ck_assert_int_eq(mr_dictionary_count_word(dico, "sam"), 3);
+        ck_assert_int_eq(dico->type, type);
+        ck_assert_int_eq(dico->nb_words, 0);
+        ck_assert(dico->approx == (type == DC_APPROX));
 
-    mr_dictionary_delete(&dico);
+        mr_dictionary_delete(&dico);
+        ck_assert(dico == NULL);
+    }
 }
 END_TEST
 
 
-START_TEST (test_massive_put)
+START_TEST (test_backends_put)
+{
+    dc_type type;
+
+    for (type=0; type<DC_NB; type++) {
+        Dictionary *dico = mr_dictionary_create(type, 0);
+
+        mr_dictionary_put_word(dico, "max");
+        mr_dictionary_put_word(dico, "sam");
+        mr_dictionary_put_word(dico, "lechuck");
+        mr_dictionary_put_word(dico, "sam");
+        mr_dictionary_put_word_hashed(dico, "samm", 4, mr_word_hash("samm", 4));
+        mr_dictionary_put_word_hashed(dico, "sam", 3, mr_word_hash("sam", 3));
+
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "max"), 1);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "sam"), 3);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "samm"), 1);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "sa"), 0);
+        ck_assert_int_eq(dico->nb_words, 4);
+
+        /* Words are listed in alphabetical order */
+        Word **words = mr_dictionary_words(dico);
+        ck_assert_str_eq(words[0]->name, "lechuck");
+        ck_assert_str_eq(words[1]->name, "max");
+        ck_assert_str_eq(words[2]->name, "sam");
+        ck_assert_str_eq(words[3]->name, "samm");
+        free(words);
+
+        mr_dictionary_delete(&dico);
+    }
+}
+END_TEST
+
+
+START_TEST (test_backends_massive_put)
 {
     int i;
+    dc_type type;
     char buffer[MAX_CHAR+1];
-    srand(1);
 
-    Dictionary *dico = mr_dictionary_create(0);
+    /* Approximate counts are bounded in their own suite */
+    for (type=DC_HASH; type<DC_NB; type++) {
+        if (type == DC_APPROX) continue;
 
-    for (i=0; i<NB_TESTS; i++) {
-        int nb_char = rand()%MAX_CHAR + 1;
-        int j;
+        /* Same words in both dictionaries */
+        Dictionary *dico = mr_dictionary_create(type, 0);
+        Dictionary *ref = mr_dictionary_create(DC_BUCKETS, 0);
+        srand(1);
 
-        /* Generate a random word */
-        for (j=0; j<nb_char; j++) {
-            unsigned char character = rand()%70+50;
-            buffer[j] = (char)character;
+        for (i=0; i<NB_TESTS; i++) {
+            random_word(buffer);
+            mr_dictionary_put_word(dico, buffer);
+            mr_dictionary_put_word(ref, buffer);
         }
-        buffer[j] = '\0';
 
-        /* Put word in dictionnary  */
-        mr_dictionary_put_word(dico, buffer);
+        mr_dictionary_flush(dico);
+        ck_assert_int_eq(dico->nb_words, ref->nb_words);
+
+        /* Words come out in the same alphabetical order */
+        Word **words = mr_dictionary_words(dico);
+        Word **ref_words = mr_dictionary_words(ref);
 
-        int count = mr_dictionary_count_word(dico, buffer);
-        ck_assert(count >= 1);
+        for (i=0; i<dico->nb_words; i++) {
+            ck_assert_str_eq(words[i]->name, ref_words[i]->name);
+            ck_assert_int_eq(words[i]->count, ref_words[i]->count);
+        }
+
+        free(words);
+        free(ref_words);
+        mr_dictionary_delete(&dico);
+        mr_dictionary_delete(&ref);
     }
+}
+END_TEST
 
-    mr_dictionary_delete(&dico);
+
+START_TEST (test_backends_merge)
+{
+    dc_type type;
+
+    for (type=0; type<DC_NB; type++) {
+        Dictionary *dico1 = mr_dictionary_create(type, 0);
+        Dictionary *dico2 = mr_dictionary_create(type, 0);
+
+        mr_dictionary_put_word(dico1, "Lorem");
+        mr_dictionary_put_word(dico1, "Lorem");
+        mr_dictionary_put_word(dico2, "Lorem");
+        mr_dictionary_put_word(dico2, "Ipsum");
+
+        mr_dictionary_merge(dico1, dico2);
+        ck_assert_int_eq(mr_dictionary_count_word(dico1, "Lorem"), 3);
+        ck_assert_int_eq(mr_dictionary_count_word(dico1, "Ipsum"), 1);
+        ck_assert_int_eq(dico1->nb_words, 2);
+
+        mr_dictionary_delete(&dico1);
+        mr_dictionary_delete(&dico2);
+    }
 }
 END_TEST
 
 
-START_TEST (test_merge)
+START_TEST (test_backends_put_parts)
 {
-    Dictionary *dico1 = mr_dictionary_create(0);
-    Dictionary *dico2 = mr_dictionary_create(0);
+    int i;
+    dc_type type;
+    const char *parts[] = {"sam", "and", "max"};
+    const unsigned int lengths[] = {3, 3, 3};
+    uint64_t hash = mr_word_hash_combine(mr_word_hash_combine(
+                                 mr_word_hash("sam", 3), mr_word_hash("and", 3)),
+                                 mr_word_hash("max", 3));
+
+    for (type=0; type<DC_NB; type++) {
+        Dictionary *dico = mr_dictionary_create(type, 0);
+
+        for (i=0; i<3; i++) {
+            mr_dictionary_put_parts(dico, parts, lengths, 3, hash);
+        }
+        mr_dictionary_put_word(dico, "sam and");
 
-    mr_dictionary_put_word(dico1, "Lorem");
-    mr_dictionary_put_word(dico1, "Lorem");
-    mr_dictionary_put_word(dico2, "Lorem");
-    mr_dictionary_put_word(dico2, "Ipsum");
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "sam and max"), 3);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "sam and"), 1);
+        ck_assert_int_eq(dico->nb_words, 2);
 
-    mr_dictionary_merge(dico1, dico2);
-    ck_assert_int_eq(mr_dictionary_count_word(dico1, "Lorem"), 3);
-    ck_assert_int_eq(mr_dictionary_count_word(dico2, "Ipsum"), 1);
+        /* Keys are sorted when listed */
+        Word **words = mr_dictionary_words(dico);
+        ck_assert_str_eq(words[0]->name, "sam and");
+        ck_assert_str_eq(words[1]->name, "sam and max");
+        free(words);
 
-    mr_dictionary_delete(&dico1);
-    mr_dictionary_delete(&dico2);
+        mr_dictionary_delete(&dico);
+    }
 }
 END_TEST
 
@@ -115,22 +227,28 @@ END_TEST
 Suite *dictionary_suite(void) {
     Suite *suite = suite_create("Dictionary");
     TCase *tcase1 = tcase_create("Case Create");
-    TCase *tcase2 = tcase_create("Case Delete");
-    TCase *tcase3 = tcase_create("Case Put");
-    TCase *tcase4 = tcase_create("Case Massive Put");
-    TCase *tcase5 = tcase_create("Case Merge");
+    TCase *tcase2 = tcase_create("Case Put Hashed");
+    TCase *tcase3 = tcase_create("Case Backends Create Delete");
+    TCase *tcase4 = tcase_create("Case Backends Put");
+    TCase *tcase5 = tcase_create("Case Backends Massive Put");
+    TCase *tcase6 = tcase_create("Case Backends Merge");
+    TCase *tcase7 = tcase_create("Case Backends Put Parts");
 
     tcase_add_test(tcase1, test_create);
-    tcase_add_test(tcase2, test_delete);
-    tcase_add_test(tcase3, test_put);
-    tcase_add_test(tcase4, test_massive_put);
-    tcase_add_test(tcase5, test_merge);
+    tcase_add_test(tcase2, test_put_hashed);
+    tcase_add_test(tcase3, test_backends_create_delete);
+    tcase_add_test(tcase4, test_backends_put);
+    tcase_add_test(tcase5, test_backends_massive_put);
+    tcase_add_test(tcase6, test_backends_merge);
+    tcase_add_test(tcase7, test_backends_put_parts);
 
     suite_add_tcase(suite, tcase1);
     suite_add_tcase(suite, tcase2);
     suite_add_tcase(suite, tcase3);
     suite_add_tcase(suite, tcase4);
     suite_add_tcase(suite, tcase5);
+    suite_add_tcase(suite, tcase6);
+    suite_add_tcase(suite, tcase7);
 
     return suite;
 }
@@ -0,0 +1,198 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "dictionary_approx.h"
+#include <check.h>
+
+#define NB_WORDS 5000
+#define MAX_COUNT 20000
+#define NB_FREQUENT 100
+
+
+/* Occurrences of the word i (Zipf distribution) */
+static unsigned int frequency(int i) {
+    return MAX_COUNT/(i+1);
+}
+
+
+/* Put occurrences of words in passes, frequent words appear in every pass */
+static void put_words(Dictionary *dico, int first_pass, int step) {
+    int i, pass;
+    char buffer[16];
+
+    for (pass=first_pass; pass<MAX_COUNT; pass+=step) {
+        for (i=0; i<NB_WORDS && frequency(i) > pass; i++) {
+            sprintf(buffer, "w%d", i);
+            mr_dictionary_put_word(dico, buffer);
+        }
+    }
+}
+
+
+/* Counts are upper bounds, count - error are lower bounds */
+static void check_bounds(Dictionary *dico) {
+    int i;
+    char buffer[16];
+    Word **words = mr_dictionary_words(dico);
+
+    ck_assert_int_eq(dico->nb_words, MAPREDUCE_DC_APPROX_TOPK);
+
+    for (i=0; i<dico->nb_words; i++) {
+        unsigned int count = frequency(atoi(words[i]->name + 1));
+        unsigned int error = mr_dictionary_approx_error(words[i]->name);
+
+        ck_assert(words[i]->count >= count);
+        ck_assert(words[i]->count - error <= count);
+    }
+
+    /* Most frequent words are all monitored */
+    for (i=0; i<NB_FREQUENT; i++) {
+        sprintf(buffer, "w%d", i);
+        ck_assert(mr_dictionary_count_word(dico, buffer) >= frequency(i));
+        ck_assert(mr_dictionary_approx_estimate(dico, mr_word_hash(buffer,
+                                           strlen(buffer))) >= frequency(i));
+    }
+
+    free(words);
+}
+
+
+START_TEST (test_create_delete)
+{
+    Dictionary *dico = mr_dictionary_create(DC_APPROX, 0);
+    Dictionary_approx *ext = dico->ext;
+
+    ck_assert_int_eq(dico->type, DC_APPROX);
+    ck_assert_int_eq(dico->nb_words, 0);
+    ck_assert(dico->approx);
+    ck_assert(ext->mask + 1 >= 2*MAPREDUCE_DC_APPROX_TOPK);
+
+    mr_dictionary_delete(&dico);
+    ck_assert(dico == NULL);
+}
+END_TEST
+
+
+START_TEST (test_put)
+{
+    int i;
+    Dictionary *dico = mr_dictionary_create(DC_APPROX, 0);
+
+    mr_dictionary_put_word(dico, "max");
+    mr_dictionary_put_word(dico, "sam");
+    mr_dictionary_put_word(dico, "lechuck");
+    mr_dictionary_put_word(dico, "sam");
+
+    /* Counts are exact while there is room for all words */
+    Word **words = mr_dictionary_words(dico);
+    for (i=0; i<dico->nb_words; i++) {
+        ck_assert_int_eq(mr_dictionary_approx_error(words[i]->name), 0);
+    }
+    free(words);
+
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+START_TEST (test_massive_put)
+{
+    Dictionary *dico = mr_dictionary_create(DC_APPROX, 0);
+    Dictionary_approx *ext = dico->ext;
+
+    put_words(dico, 0, 1);
+
+    /* Some words were evicted or never monitored */
+    ck_assert(ext->floor > 0);
+    ck_assert(ext->floor < frequency(NB_FREQUENT));
+    check_bounds(dico);
+
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+START_TEST (test_merge)
+{
+    Dictionary *dico1 = mr_dictionary_create(DC_APPROX, 0);
+    Dictionary *dico2 = mr_dictionary_create(DC_APPROX, 0);
+    Dictionary_approx *ext1 = dico1->ext, *ext2 = dico2->ext;
+
+    put_words(dico1, 0, 2);
+    put_words(dico2, 1, 2);
+    unsigned long long total = ext1->total + ext2->total;
+
+    mr_dictionary_merge(dico1, dico2);
+    ck_assert(ext1->total == total);
+    check_bounds(dico1);
+
+    mr_dictionary_delete(&dico1);
+    mr_dictionary_delete(&dico2);
+}
+END_TEST
+
+
+START_TEST (test_put_parts)
+{
+    int i;
+    const char *parts[] = {"sam", "and", "max"};
+    const unsigned int lengths[] = {3, 3, 3};
+    uint64_t hash = mr_word_hash_combine(mr_word_hash_combine(
+                                 mr_word_hash("sam", 3), mr_word_hash("and", 3)),
+                                 mr_word_hash("max", 3));
+    Dictionary *dico = mr_dictionary_create(DC_APPROX, 0);
+
+    for (i=0; i<3; i++) mr_dictionary_put_parts(dico, parts, lengths, 3, hash);
+
+    /* All occurrences went through the sketch */
+    ck_assert_int_eq(mr_dictionary_approx_estimate(dico, hash), 3);
+
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+Suite *dictionary_approx_suite(void) {
+    Suite *suite = suite_create("Dictionary Approx");
+    TCase *tcase1 = tcase_create("Case Create Delete");
+    TCase *tcase2 = tcase_create("Case Put");
+    TCase *tcase3 = tcase_create("Case Massive Put");
+    TCase *tcase4 = tcase_create("Case Merge");
+    TCase *tcase5 = tcase_create("Case Put Parts");
+
+    tcase_add_test(tcase1, test_create_delete);
+    tcase_add_test(tcase2, test_put);
+    tcase_add_test(tcase3, test_massive_put);
+    tcase_add_test(tcase4, test_merge);
+    tcase_add_test(tcase5, test_put_parts);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+    suite_add_tcase(suite, tcase4);
+    suite_add_tcase(suite, tcase5);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = dictionary_approx_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,145 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "dictionary_compact.h"
+#include <check.h>
+
+#define NB_TESTS 10000
+#define MAX_CHAR 15
+
+
+START_TEST (test_create_delete)
+{
+    Dictionary *dico = mr_dictionary_create(DC_COMPACT, 0);
+    Dictionary_compact *ext = dico->ext;
+
+    ck_assert_int_eq(dico->type, DC_COMPACT);
+    ck_assert_int_eq(dico->nb_words, 0);
+    ck_assert_int_eq(ext->mask + 1, MAPREDUCE_DC_COMPACT_INITIAL_SIZE);
+
+    mr_dictionary_delete(&dico);
+    ck_assert(dico == NULL);
+}
+END_TEST
+
+
+START_TEST (test_massive_put)
+{
+    int i, j;
+    char buffer[MAX_CHAR+1];
+    srand(1);
+
+    /* The hash table has to grow */
+    Dictionary *dico = mr_dictionary_create(DC_COMPACT, 0);
+    Dictionary_compact *ext = dico->ext;
+
+    for (i=0; i<NB_TESTS; i++) {
+        int nb_char = rand()%MAX_CHAR + 1;
+
+        /* Generate a random word */
+        for (j=0; j<nb_char; j++) {
+            unsigned char character = rand()%70+50;
+            buffer[j] = (char)character;
+        }
+        buffer[j] = '\0';
+
+        mr_dictionary_put_word(dico, buffer);
+    }
+
+    ck_assert(ext->nb_resizes > 0);
+    ck_assert(dico->nb_words <= (ext->mask + 1)
+                                         * MAPREDUCE_DC_COMPACT_MAX_LOAD / 100);
+
+    /* Entries grew the arena and take less room than Word structures */
+    ck_assert(ext->arena_used > MAPREDUCE_DC_COMPACT_ARENA_SIZE);
+    ck_assert(ext->arena_used < ext->words_size);
+
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+START_TEST (test_long_words)
+{
+    int i;
+    char buffer[MAPREDUCE_MAX_WORD_SIZE];
+    const unsigned int lengths[] = {127, 128, MAPREDUCE_MAX_WORD_SIZE - 1};
+    Dictionary *dico = mr_dictionary_create(DC_COMPACT, 0);
+    Dictionary_compact *ext = dico->ext;
+
+    /* Lengths up to 127 are encoded on one byte, longer ones on two */
+    for (i=0; i<3; i++) {
+        unsigned int length;
+        uint32_t offset = ext->arena_used / DICTIONARY_COMPACT_ALIGN;
+
+        memset(buffer, 'a' + i, lengths[i]);
+        buffer[lengths[i]] = '\0';
+        mr_dictionary_put_word(dico, buffer);
+        mr_dictionary_put_word(dico, buffer);
+
+        unsigned int *count = _mr_dictionary_compact_entry(ext, offset);
+        const char *spelling = _mr_dictionary_compact_spelling(count, &length);
+        ck_assert_int_eq(*count, 2);
+        ck_assert_int_eq(length, lengths[i]);
+        ck_assert_int_eq(spelling - (const char*)(count + 1),
+                                                   (lengths[i] < 128) ? 1 : 2);
+    }
+
+    ck_assert_int_eq(dico->nb_words, 3);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, buffer), 2);
+
+    /* Listed words get their spelling and full hash back */
+    Word **words = mr_dictionary_words(dico);
+
+    for (i=0; i<3; i++) {
+        ck_assert_int_eq(words[i]->length, lengths[i]);
+        ck_assert_int_eq(strlen(words[i]->name), words[i]->length);
+        ck_assert_int_eq(words[i]->count, 2);
+        ck_assert(words[i]->hash == mr_word_hash(words[i]->name,
+                                                       words[i]->length));
+    }
+
+    free(words);
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+Suite *dictionary_compact_suite(void) {
+    Suite *suite = suite_create("Dictionary Compact");
+    TCase *tcase1 = tcase_create("Case Create Delete");
+    TCase *tcase2 = tcase_create("Case Massive Put");
+    TCase *tcase3 = tcase_create("Case Long Words");
+
+    tcase_add_test(tcase1, test_create_delete);
+    tcase_add_test(tcase2, test_massive_put);
+    tcase_add_test(tcase3, test_long_words);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = dictionary_compact_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,91 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "dictionary_hash.h"
+#include <check.h>
+
+#define NB_TESTS 10000
+#define MAX_CHAR 15
+
+
+START_TEST (test_create_delete)
+{
+    Dictionary *dico = mr_dictionary_create(DC_HASH, 0);
+    Dictionary_hash *ext = dico->ext;
+
+    ck_assert_int_eq(dico->type, DC_HASH);
+    ck_assert_int_eq(dico->nb_words, 0);
+    ck_assert_int_eq(ext->mask + 1, MAPREDUCE_DC_HASH_INITIAL_SIZE);
+
+    mr_dictionary_delete(&dico);
+    ck_assert(dico == NULL);
+}
+END_TEST
+
+
+START_TEST (test_massive_put)
+{
+    int i, j;
+    char buffer[MAX_CHAR+1];
+    srand(1);
+
+    /* The hash table has to grow */
+    Dictionary *dico = mr_dictionary_create(DC_HASH, 0);
+    Dictionary_hash *ext = dico->ext;
+
+    for (i=0; i<NB_TESTS; i++) {
+        int nb_char = rand()%MAX_CHAR + 1;
+
+        /* Generate a random word */
+        for (j=0; j<nb_char; j++) {
+            unsigned char character = rand()%70+50;
+            buffer[j] = (char)character;
+        }
+        buffer[j] = '\0';
+
+        mr_dictionary_put_word(dico, buffer);
+    }
+
+    ck_assert(ext->nb_resizes > 0);
+    ck_assert(dico->nb_words <= (ext->mask + 1)*MAPREDUCE_DC_HASH_MAX_LOAD/100);
+
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+Suite *dictionary_hash_suite(void) {
+    Suite *suite = suite_create("Dictionary Hash");
+    TCase *tcase1 = tcase_create("Case Create Delete");
+    TCase *tcase2 = tcase_create("Case Massive Put");
+
+    tcase_add_test(tcase1, test_create_delete);
+    tcase_add_test(tcase2, test_massive_put);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = dictionary_hash_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
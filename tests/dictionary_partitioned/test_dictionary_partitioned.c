@@ -0,0 +1,150 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "dictionary_partitioned.h"
+#include <check.h>
+
+#define NB_TESTS 10000
+#define MAX_CHAR 15
+#define NB_PARTITIONS 5
+
+
+START_TEST (test_create_delete)
+{
+    int i;
+    Dictionary *dico = mr_dictionary_create(DC_PARTITIONED, 0);
+    Dictionary_partitioned *ext = dico->ext;
+
+    ck_assert_int_eq(dico->type, DC_PARTITIONED);
+    ck_assert_int_eq(dico->nb_words, 0);
+    ck_assert_int_eq(ext->nb_partitions, MAPREDUCE_DC_PARTITIONS);
+
+    for (i=0; i<ext->nb_partitions; i++) {
+        ck_assert_int_eq(mr_dictionary_partitioned_get(dico, i)->type, DC_HASH);
+    }
+
+    mr_dictionary_delete(&dico);
+    ck_assert(dico == NULL);
+
+    /* Other dictionaries are kept as they are with a single partition */
+    dico = mr_dictionary_create(DC_SWISS, 0);
+    ck_assert(mr_dictionary_partition(dico, 1) == dico);
+
+    dico = mr_dictionary_partition(dico, NB_PARTITIONS);
+    ext = dico->ext;
+    ck_assert_int_eq(dico->type, DC_PARTITIONED);
+    ck_assert_int_eq(ext->nb_partitions, NB_PARTITIONS);
+    ck_assert_int_eq(mr_dictionary_partitioned_get(dico, 4)->type, DC_SWISS);
+    ck_assert(mr_dictionary_partition(dico, NB_PARTITIONS) == dico);
+
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+START_TEST (test_put)
+{
+    Dictionary *dico = mr_dictionary_partition(
+                    mr_dictionary_create(DC_BUCKETS, 0), NB_PARTITIONS);
+
+    mr_dictionary_put_word(dico, "max");
+    mr_dictionary_put_word(dico, "sam");
+    mr_dictionary_put_word(dico, "lechuck");
+    mr_dictionary_put_word(dico, "sam");
+    mr_dictionary_put_word_hashed(dico, "samm", 4, mr_word_hash("samm", 4));
+    mr_dictionary_put_word_hashed(dico, "sam", 3, mr_word_hash("sam", 3));
+
+    ck_assert_int_eq(dico->nb_words, 4);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "max"), 1);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "sam"), 3);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "samm"), 1);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "sa"), 0);
+
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+START_TEST (test_massive_put)
+{
+    int i, j;
+    char buffer[MAX_CHAR+1];
+    srand(1);
+
+    Dictionary *dico = mr_dictionary_partition(
+                    mr_dictionary_create(DC_HASH, 0), NB_PARTITIONS);
+    unsigned int nb_words = 0;
+
+    for (i=0; i<NB_TESTS; i++) {
+        int nb_char = rand()%MAX_CHAR + 1;
+
+        /* Generate a random word */
+        for (j=0; j<nb_char; j++) {
+            unsigned char character = rand()%70+50;
+            buffer[j] = (char)character;
+        }
+        buffer[j] = '\0';
+
+        mr_dictionary_put_word(dico, buffer);
+    }
+
+    /* Every partition got words, only with their range of hashes */
+    for (i=0; i<NB_PARTITIONS; i++) {
+        Dictionary *partition = mr_dictionary_partitioned_get(dico, i);
+        Word **words = mr_dictionary_words(partition);
+
+        ck_assert(partition->nb_words > 0);
+        for (j=0; j<partition->nb_words; j++) {
+            ck_assert_int_eq(mr_dictionary_partitioned_index(words[j]->hash,
+                                                          NB_PARTITIONS), i);
+        }
+
+        nb_words += partition->nb_words;
+        free(words);
+    }
+
+    ck_assert_int_eq(nb_words, dico->nb_words);
+
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+Suite *dictionary_partitioned_suite(void) {
+    Suite *suite = suite_create("Dictionary Partitioned");
+    TCase *tcase1 = tcase_create("Case Create Delete");
+    TCase *tcase2 = tcase_create("Case Put");
+    TCase *tcase3 = tcase_create("Case Massive Put");
+
+    tcase_add_test(tcase1, test_create_delete);
+    tcase_add_test(tcase2, test_put);
+    tcase_add_test(tcase3, test_massive_put);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = dictionary_partitioned_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
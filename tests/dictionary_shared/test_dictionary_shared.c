@@ -0,0 +1,181 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "dictionary_shared.h"
+#include <check.h>
+#include <pthread.h>
+
+#define NB_TESTS 200000
+#define NB_THREADS 4
+#define MAX_CHAR 15
+
+typedef struct {
+    Dictionary *dico;
+    unsigned int seed;
+} Put_args;
+
+
+/* Put random words, threads with the same seed put the same words */
+void* put_words(void *arg) {
+    int i, j;
+    char buffer[MAX_CHAR+1];
+    Put_args *args = arg;
+    unsigned int seed = args->seed;
+
+    for (i=0; i<NB_TESTS/NB_THREADS; i++) {
+        int nb_char = rand_r(&seed)%MAX_CHAR + 1;
+
+        /* Generate a random word */
+        for (j=0; j<nb_char; j++) {
+            unsigned char character = rand_r(&seed)%70+50;
+            buffer[j] = (char)character;
+        }
+        buffer[j] = '\0';
+
+        mr_dictionary_put_word(args->dico, buffer);
+    }
+
+    return NULL;
+}
+
+
+START_TEST (test_create_delete)
+{
+    Dictionary *dico = mr_dictionary_create(DC_SHARED, 0);
+    Dictionary *other = mr_dictionary_create_another(dico);
+    Dictionary_shared *ext = dico->ext;
+    Dictionary_shared *other_ext = other->ext;
+
+    ck_assert_int_eq(dico->type, DC_SHARED);
+    ck_assert_int_eq(other->type, DC_SHARED);
+    ck_assert(dico->shared);
+    ck_assert_int_eq(dico->nb_words, 0);
+    ck_assert(ext->table == other_ext->table);
+    ck_assert_int_eq(ext->table->nb_handles, 2);
+    ck_assert_int_eq(ext->table->first->mask + 1,
+                                             MAPREDUCE_DC_SHARED_INITIAL_SIZE);
+
+    mr_dictionary_delete(&dico);
+    ck_assert(dico == NULL);
+    ck_assert_int_eq(other_ext->table->nb_handles, 1);
+
+    mr_dictionary_delete(&other);
+    ck_assert(other == NULL);
+}
+END_TEST
+
+
+START_TEST (test_put)
+{
+    Dictionary *dico = mr_dictionary_create(DC_SHARED, 0);
+    Dictionary *other = mr_dictionary_create_another(dico);
+
+    mr_dictionary_put_word(dico, "max");
+    mr_dictionary_put_word(dico, "sam");
+    mr_dictionary_put_word(other, "lechuck");
+    mr_dictionary_put_word(other, "sam");
+    mr_dictionary_put_word_hashed(dico, "samm", 4, mr_word_hash("samm", 4));
+    mr_dictionary_put_word_hashed(other, "sam", 3, mr_word_hash("sam", 3));
+
+    /* Counts cached by both handles are gathered when flushing */
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "max"), 1);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "sam"), 3);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "samm"), 1);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "lechuck"), 1);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "sa"), 0);
+    ck_assert_int_eq(dico->nb_words, 4);
+
+    mr_dictionary_delete(&other);
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+START_TEST (test_threads_put)
+{
+    int i;
+    pthread_t threads[NB_THREADS];
+    Put_args args[NB_THREADS];
+
+    /* Same words in both dictionaries, the shared one has to grow */
+    Dictionary *dico = mr_dictionary_create(DC_SHARED, 0);
+    Dictionary *ref = mr_dictionary_create(DC_BUCKETS, 0);
+    Dictionary_shared *ext = dico->ext;
+
+    for (i=0; i<NB_THREADS; i++) {
+        args[i].dico = (i == 0) ? dico : mr_dictionary_create_another(dico);
+        args[i].seed = i%2;
+    }
+
+    for (i=0; i<NB_THREADS; i++) {
+        pthread_create(&threads[i], NULL, put_words, &args[i]);
+    }
+
+    for (i=0; i<NB_THREADS; i++) {
+        Put_args ref_args = {ref, args[i].seed};
+        pthread_join(threads[i], NULL);
+        put_words(&ref_args);
+    }
+
+    /* Words of all levels are moved to a single one */
+    ck_assert(ext->table->nb_levels > 1);
+    mr_dictionary_flush(dico);
+    ck_assert(ext->table->first->next == NULL);
+    ck_assert_int_eq(dico->nb_words, ref->nb_words);
+
+    /* Words come out in the same alphabetical order */
+    Word **words = mr_dictionary_words(dico);
+    Word **ref_words = mr_dictionary_words(ref);
+
+    for (i=0; i<dico->nb_words; i++) {
+        ck_assert_str_eq(words[i]->name, ref_words[i]->name);
+        ck_assert_int_eq(words[i]->count, ref_words[i]->count);
+    }
+
+    free(words);
+    free(ref_words);
+
+    for (i=0; i<NB_THREADS; i++) mr_dictionary_delete(&args[i].dico);
+    mr_dictionary_delete(&ref);
+}
+END_TEST
+
+
+Suite *dictionary_shared_suite(void) {
+    Suite *suite = suite_create("Dictionary Shared");
+    TCase *tcase1 = tcase_create("Case Create Delete");
+    TCase *tcase2 = tcase_create("Case Put");
+    TCase *tcase3 = tcase_create("Case Threads Put");
+
+    tcase_add_test(tcase1, test_create_delete);
+    tcase_add_test(tcase2, test_put);
+    tcase_add_test(tcase3, test_threads_put);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = dictionary_shared_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
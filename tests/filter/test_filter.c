@@ -0,0 +1,156 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "filter.h"
+#include <check.h>
+
+bool reject(Filter *f, const char *word) {
+    return mr_filter_reject(f, word, strlen(word));
+}
+
+
+START_TEST (test_create_delete)
+{
+    char *drops[] = {"\\d+", "[0-9a-f]+"};
+    char *invalid[] = {"", "+a", "a**", "[abc", "[z-a]", "ab\\", "cat|dog",
+                       "a.*|d.*", "(", "(ab)+", "a{2}", "}"};
+    int i;
+
+    Filter *f = mr_filter_create(drops, 2, NULL, 0, 1, 100, false);
+    ck_assert(f != NULL);
+    ck_assert_int_eq(f->nb_patterns, 2);
+    ck_assert(f->nb_states > 2);
+    ck_assert(!f->keep);
+
+    mr_filter_delete(&f);
+    ck_assert(f == NULL);
+
+    /* Invalid patterns */
+    for (i=0; i<12; i++) {
+        f = mr_filter_create(&invalid[i], 1, NULL, 0, 1, 100, false);
+        ck_assert(f == NULL);
+    }
+
+    /* Escaped, or in a class, they are characters */
+    char *escaped[] = {"a\\|b", "[(){}|]"};
+    f = mr_filter_create(escaped, 2, NULL, 0, 1, 100, false);
+    ck_assert(f != NULL);
+    ck_assert(reject(f, "a|b"));
+    ck_assert(reject(f, "{"));
+    ck_assert(!reject(f, "ab"));
+    mr_filter_delete(&f);
+
+    /* Lengths only */
+    f = mr_filter_create(NULL, 0, NULL, 0, 3, 5, false);
+    ck_assert(f != NULL);
+    ck_assert(reject(f, "ab"));
+    ck_assert(!reject(f, "abc"));
+    ck_assert(!reject(f, "abcde"));
+    ck_assert(reject(f, "abcdef"));
+    mr_filter_delete(&f);
+}
+END_TEST
+
+
+START_TEST (test_drop)
+{
+    char *drops[] = {"\\d+", "\\x\\x\\x\\x\\x\\x\\x\\x+", "ab?c*d", "[^a-z]x.",
+                     "\\*"};
+
+    Filter *f = mr_filter_create(drops, 5, NULL, 0, 1, 100, false);
+    ck_assert(f != NULL);
+
+    /* Numbers */
+    ck_assert(reject(f, "0"));
+    ck_assert(reject(f, "2015"));
+    ck_assert(!reject(f, "2015a"));
+
+    /* Hexadecimal identifiers of at least 8 digits */
+    ck_assert(reject(f, "deadbeef"));
+    ck_assert(reject(f, "0a1B2c3D4e"));
+    ck_assert(!reject(f, "beef"));
+    ck_assert(!reject(f, "deadbeefg"));
+
+    /* Optional and repeated items */
+    ck_assert(reject(f, "ad"));
+    ck_assert(reject(f, "abd"));
+    ck_assert(reject(f, "acccd"));
+    ck_assert(reject(f, "abccd"));
+    ck_assert(!reject(f, "abbd"));
+    ck_assert(!reject(f, "abc"));
+
+    /* Negated class, any character and escaped literal */
+    ck_assert(reject(f, "Xxy"));
+    ck_assert(reject(f, "9x!"));
+    ck_assert(!reject(f, "axy"));
+    ck_assert(!reject(f, "Xx"));
+    ck_assert(reject(f, "*"));
+    ck_assert(!reject(f, "lorem"));
+
+    mr_filter_delete(&f);
+}
+END_TEST
+
+
+START_TEST (test_keep)
+{
+    char *drops[] = {"\\a"};
+    char *keeps[] = {"\\a+", "[a-z]+\\d"};
+
+    Filter *f = mr_filter_create(drops, 1, keeps, 2, 1, 6, false);
+    ck_assert(f != NULL);
+    ck_assert(f->keep);
+
+    ck_assert(!reject(f, "lorem"));
+    ck_assert(!reject(f, "Lorem"));
+    ck_assert(!reject(f, "abc1"));
+    ck_assert(reject(f, "abc12"));
+    ck_assert(reject(f, "12"));
+
+    /* Drop patterns and lengths win over keep patterns */
+    ck_assert(reject(f, "a"));
+    ck_assert(reject(f, "consectetur"));
+
+    mr_filter_delete(&f);
+}
+END_TEST
+
+
+Suite *filter_suite(void) {
+    Suite *suite = suite_create("Filter");
+    TCase *tcase1 = tcase_create("Case Create Delete");
+    TCase *tcase2 = tcase_create("Case Drop patterns");
+    TCase *tcase3 = tcase_create("Case Keep patterns");
+
+    tcase_add_test(tcase1, test_create_delete);
+    tcase_add_test(tcase2, test_drop);
+    tcase_add_test(tcase3, test_keep);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = filter_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
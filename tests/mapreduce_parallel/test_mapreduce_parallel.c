@@ -13,8 +13,12 @@
 
 #include <check.h>
 #include "mapreduce_parallel.h"
+#include "wordstreamer_schunks.h"
+#include "wordstreamer_iblocks.h"
+#include "wordstreamer_dynamic.h"
 
 #define MAX_THREADS 11
+#define NB_WS_TYPES 3
 
 void create_file(const char *filename, const char *content) {
     FILE *fp;
@@ -34,7 +38,7 @@ START_TEST (test_create_delete)
     create_file(filename, content);
 
     Mapreduce *mr = mr_parallel_create(filename, 1, WS_SCHUNKS, FR_MMAP, 4096,
-                                                                   true, false);
+                                                       DC_BUCKETS, true, false);
 
     ck_assert(mr != NULL);
 
@@ -48,7 +52,8 @@ END_TEST
 
 START_TEST (test_multiple_mapreduce)
 {
-    int i;
+    int i, t, c, s;
+    ws_type ws_types[NB_WS_TYPES] = {WS_SCHUNKS, WS_IBLOCKS, WS_DYNAMIC};
     /* Create test file */
     char *filename = "ws_test.txt";
     char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
@@ -72,20 +77,95 @@ START_TEST (test_multiple_mapreduce)
 
     create_file(filename, content);
 
-    /* Check several streamers combination */
+    /* Check several streamers combination, with specialized map loops and
+       with the generic one, for each type of dictionary */
+    for (c=0; c<4*DC_NB; c++) {
+        fr_type reader_type = (c & 1) ? FR_READ : FR_MMAP;
+        bool generic = c & 2;
+        dc_type dictionary_type = c / 4;
+
+        for (t=0; t<NB_WS_TYPES; t++) {
+            for (i=1; i<=MAX_THREADS; i++) {
+                Mapreduce *mr = mr_parallel_create(filename, i, ws_types[t],
+                               reader_type, 16, dictionary_type, true, false);
+
+                ck_assert(mr != NULL);
+
+                ck_assert(mr->ext != NULL);
+                Mapreduce_parallel_thread *ext =
+                                         (Mapreduce_parallel_thread *) mr->ext;
+
+                ck_assert(ext->dictionary != NULL);
+                Dictionary *dico = ext->dictionary;
+
+                ck_assert(ext->map != NULL);
+                for (s=0; generic && s<i; s++) ext[s].map = _thread_map;
+
+                /* Perform map and reduce */
+                mr_parallel_map(mr);
+                mr_parallel_reduce(mr);
+
+                /* Check some occurences */
+                ck_assert_int_eq(mr_dictionary_count_word(dico, "adipiscing"),
+                                                                            3);
+                ck_assert_int_eq(mr_dictionary_count_word(dico, "consectetur"),
+                                                                            4);
+                ck_assert_int_eq(mr_dictionary_count_word(dico, "amet"), 5);
+                ck_assert_int_eq(mr_dictionary_count_word(dico, "pharetra"), 1);
+                ck_assert_int_eq(mr_dictionary_count_word(dico, "sit"), 5);
+                ck_assert_int_eq(mr_dictionary_count_word(dico, "viverra"), 2);
+
+                mr_parallel_delete(mr);
+            }
+        }
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_steal_mapreduce)
+{
+    int i, s;
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
+                    "Donec a diam lectus. Sed sit amet ipsum mauris. Maecenas "
+                    "congue ligula ac quam viverra nec consectetur ante "
+                    "hendrerit. Donec et mollis dolor. Praesent et diam eget "
+                    "libero egestas mattis sit amet vitae augue. Nam tincidunt "
+                    "congue enim, ut porta lorem lacinia consectetur. Donec ut "
+                    "libero sed arcu vehicula ultricies a non tortor. Lorem "
+                    "ipsum dolor sit amet, consectetur adipiscing elit. Aenean "
+                    "ut gravida lorem. Ut turpis felis, pulvinar a semper sed, "
+                    "adipiscing id dolor. Pellentesque auctor nisi id magna "
+                    "consequat sagittis. Curabitur dapibus enim sit amet elit "
+                    "pharetra tincidunt feugiat nisl imperdiet. Ut convallis "
+                    "libero in urna ultrices accumsan. Donec sed odio eros. "
+                    "Donec viverra mi quis quam pulvinar at malesuada arcu "
+                    "rhoncus. Cum sociis natoque penatibus et magnis dis "
+                    "parturient montes, nascetur ridiculus mus. In rutrum "
+                    "accumsan ultricies. Mauris vitae nisi at sem facilisis "
+                    "semper ac in est.";
+
+    create_file(filename, content);
 
     for (i=1; i<=MAX_THREADS; i++) {
         Mapreduce *mr = mr_parallel_create(filename, i, WS_SCHUNKS, FR_MMAP,
-                                                             4096, true, false);
-
+                                                 4096, DC_BUCKETS, true, false);
         ck_assert(mr != NULL);
+        mr->steal = true;
 
-        ck_assert(mr->ext != NULL);
         Mapreduce_parallel_thread *ext = (Mapreduce_parallel_thread *) mr->ext;
-
-        ck_assert(ext->dictionary != NULL);
         Dictionary *dico = ext->dictionary;
 
+        /* Use small blocks to steal within the test file */
+        for (s=0; s<i; s++) {
+            Wordstreamer_schunks *ws_ext = ext[s].wordstreamer->ext;
+            ws_ext->block_size = 8;
+        }
+
         /* Perform map and reduce */
         mr_parallel_map(mr);
         mr_parallel_reduce(mr);
@@ -106,16 +186,524 @@ START_TEST (test_multiple_mapreduce)
 END_TEST
 
 
+START_TEST (test_boundaries_mapreduce)
+{
+    int i, t;
+    ws_type ws_types[NB_WS_TYPES] = {WS_SCHUNKS, WS_IBLOCKS, WS_DYNAMIC};
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
+                    "Donec a diam lectus. Sed sit amet ipsum mauris. Maecenas "
+                    "congue ligula ac quam viverra nec consectetur ante "
+                    "hendrerit. Donec et mollis dolor. Praesent et diam eget "
+                    "libero egestas mattis sit amet vitae augue. Nam tincidunt "
+                    "congue enim, ut porta lorem lacinia consectetur. Donec ut "
+                    "libero sed arcu vehicula ultricies a non tortor. Lorem "
+                    "ipsum dolor sit amet, consectetur adipiscing elit. Aenean "
+                    "ut gravida lorem. Ut turpis felis, pulvinar a semper sed, "
+                    "adipiscing id dolor. Pellentesque auctor nisi id magna "
+                    "consequat sagittis. Curabitur dapibus enim sit amet elit "
+                    "pharetra tincidunt feugiat nisl imperdiet. Ut convallis "
+                    "libero in urna ultrices accumsan. Donec sed odio eros. "
+                    "Donec viverra mi quis quam pulvinar at malesuada arcu "
+                    "rhoncus. Cum sociis natoque penatibus et magnis dis "
+                    "parturient montes, nascetur ridiculus mus. In rutrum "
+                    "accumsan ultricies. Mauris vitae nisi at sem facilisis "
+                    "semper ac in est.";
+
+    create_file(filename, content);
+
+    /* Align ranges on a fine grained index of word boundaries */
+    for (t=0; t<NB_WS_TYPES; t++) {
+        for (i=1; i<=MAX_THREADS; i++) {
+            Mapreduce *mr = mr_parallel_create(filename, i, ws_types[t],
+                                        FR_MMAP, 4096, DC_BUCKETS, true, false);
+            ck_assert(mr != NULL);
+            mr->boundaries = _mr_boundaries_build(filename, 5, i);
+
+            Mapreduce_parallel_thread *ext =
+                                         (Mapreduce_parallel_thread *) mr->ext;
+            Dictionary *dico = ext->dictionary;
+
+            /* Perform map and reduce */
+            mr_parallel_map(mr);
+            mr_parallel_reduce(mr);
+
+            /* Check some occurences */
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "adipiscing"), 3);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "consectetur"), 4);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "amet"), 5);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "pharetra"), 1);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "sit"), 5);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "viverra"), 2);
+
+            mr_boundaries_delete(&mr->boundaries);
+            mr_parallel_delete(mr);
+        }
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+unsigned int total_count(Dictionary *dico) {
+    int i;
+    unsigned int total = 0;
+    Word **words = mr_dictionary_words(dico);
+
+    for (i=0; i<dico->nb_words; i++) total += words[i]->count;
+
+    free(words);
+
+    return total;
+}
+
+
+START_TEST (test_ngram_mapreduce)
+{
+    int i, t, s, n;
+    ws_type ws_types[NB_WS_TYPES] = {WS_SCHUNKS, WS_IBLOCKS, WS_DYNAMIC};
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
+                    "Donec a diam lectus. Sed sit amet ipsum mauris. Maecenas "
+                    "congue ligula ac quam viverra nec consectetur ante "
+                    "hendrerit. Donec et mollis dolor. Praesent et diam eget "
+                    "libero egestas mattis sit amet vitae augue. Nam tincidunt "
+                    "congue enim, ut porta lorem lacinia consectetur. Donec ut "
+                    "libero sed arcu vehicula ultricies a non tortor. Lorem "
+                    "ipsum dolor sit amet, consectetur adipiscing elit. Aenean "
+                    "ut gravida lorem. Ut turpis felis, pulvinar a semper sed, "
+                    "adipiscing id dolor. Pellentesque auctor nisi id magna "
+                    "consequat sagittis. Curabitur dapibus enim sit amet elit "
+                    "pharetra tincidunt feugiat nisl imperdiet. Ut convallis "
+                    "libero in urna ultrices accumsan. Donec sed odio eros. "
+                    "Donec viverra mi quis quam pulvinar at malesuada arcu "
+                    "rhoncus. Cum sociis natoque penatibus et magnis dis "
+                    "parturient montes, nascetur ridiculus mus. In rutrum "
+                    "accumsan ultricies. Mauris vitae nisi at sem facilisis "
+                    "semper ac in est.";
+
+    create_file(filename, content);
+
+    /* Tiny ranges so that many n-grams cross range edges */
+    for (n=2; n<=3; n++) {
+        for (t=0; t<NB_WS_TYPES; t++) {
+            for (i=1; i<=MAX_THREADS; i++) {
+                /* Each type of dictionary in turn */
+                dc_type dictionary_type = i % DC_NB;
+                Mapreduce *mr = mr_parallel_create(filename, i, ws_types[t],
+                                   FR_MMAP, 4096, dictionary_type, true, false);
+                ck_assert(mr != NULL);
+                mr->ngram = n;
+                mr->steal = true;
+
+                Mapreduce_parallel_thread *ext =
+                                         (Mapreduce_parallel_thread *) mr->ext;
+                Dictionary *dico = ext->dictionary;
+
+                for (s=0; s<i; s++) {
+                    Wordstreamer *ws = ext[s].wordstreamer;
+
+                    if (ws_types[t] == WS_SCHUNKS) {
+                        ((Wordstreamer_schunks *) ws->ext)->block_size = 8;
+                    } else if (ws_types[t] == WS_IBLOCKS) {
+                        ((Wordstreamer_iblocks *) ws->ext)->block_size = 7;
+                    } else {
+                        ((Wordstreamer_dynamic *) ws->ext)->chunk_size = 5;
+                    }
+                }
+
+                /* Perform map and reduce */
+                mr_parallel_map(mr);
+                mr_parallel_reduce(mr);
+
+                /* One n-gram per word, except the last n-1 words */
+                ck_assert_int_eq(total_count(dico), 149 - n);
+
+                if (n == 2) {
+                    ck_assert_int_eq(mr_dictionary_count_word(dico,
+                                                             "lorem ipsum"), 2);
+                    ck_assert_int_eq(mr_dictionary_count_word(dico,
+                                                                "sit amet"), 5);
+                    ck_assert_int_eq(mr_dictionary_count_word(dico,
+                                                                  "in est"), 1);
+                } else {
+                    ck_assert_int_eq(mr_dictionary_count_word(dico,
+                                                      "sit amet consectetur"), 2);
+                    ck_assert_int_eq(mr_dictionary_count_word(dico,
+                                                           "ac in est"), 1);
+                }
+
+                mr_parallel_delete(mr);
+            }
+        }
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_stopwords_mapreduce)
+{
+    int i, t, s, n;
+    ws_type ws_types[NB_WS_TYPES] = {WS_SCHUNKS, WS_IBLOCKS, WS_DYNAMIC};
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
+                    "Donec a diam lectus. Sed sit amet ipsum mauris. Maecenas "
+                    "congue ligula ac quam viverra nec consectetur ante "
+                    "hendrerit. Donec et mollis dolor. Praesent et diam eget "
+                    "libero egestas mattis sit amet vitae augue. Nam tincidunt "
+                    "congue enim, ut porta lorem lacinia consectetur. Donec ut "
+                    "libero sed arcu vehicula ultricies a non tortor. Lorem "
+                    "ipsum dolor sit amet, consectetur adipiscing elit. Aenean "
+                    "ut gravida lorem. Ut turpis felis, pulvinar a semper sed, "
+                    "adipiscing id dolor. Pellentesque auctor nisi id magna "
+                    "consequat sagittis. Curabitur dapibus enim sit amet elit "
+                    "pharetra tincidunt feugiat nisl imperdiet. Ut convallis "
+                    "libero in urna ultrices accumsan. Donec sed odio eros. "
+                    "Donec viverra mi quis quam pulvinar at malesuada arcu "
+                    "rhoncus. Cum sociis natoque penatibus et magnis dis "
+                    "parturient montes, nascetur ridiculus mus. In rutrum "
+                    "accumsan ultricies. Mauris vitae nisi at sem facilisis "
+                    "semper ac in est.";
+
+    create_file(filename, content);
+
+    /* Tiny ranges so that many n-grams cross range edges */
+    Stopwords *sw = _mr_stopwords_create_from_text("sit amet");
+
+    for (n=1; n<=2; n++) {
+        for (t=0; t<NB_WS_TYPES; t++) {
+            for (i=1; i<=MAX_THREADS; i++) {
+                Mapreduce *mr = mr_parallel_create(filename, i, ws_types[t],
+                                        FR_MMAP, 4096, DC_BUCKETS, true, false);
+                ck_assert(mr != NULL);
+                mr->ngram = n;
+                mr->stopwords = sw;
+                mr->steal = true;
+
+                Mapreduce_parallel_thread *ext =
+                                         (Mapreduce_parallel_thread *) mr->ext;
+                Dictionary *dico = ext->dictionary;
+
+                for (s=0; s<i; s++) {
+                    Wordstreamer *ws = ext[s].wordstreamer;
+
+                    if (ws_types[t] == WS_SCHUNKS) {
+                        ((Wordstreamer_schunks *) ws->ext)->block_size = 8;
+                    } else if (ws_types[t] == WS_IBLOCKS) {
+                        ((Wordstreamer_iblocks *) ws->ext)->block_size = 7;
+                    } else {
+                        ((Wordstreamer_dynamic *) ws->ext)->chunk_size = 5;
+                    }
+
+                    ws->stopwords = sw;
+                }
+
+                /* Perform map and reduce */
+                mr_parallel_map(mr);
+                mr_parallel_reduce(mr);
+
+                /* 138 words are kept */
+                ck_assert_int_eq(total_count(dico), 139 - n);
+
+                if (n == 1) {
+                    ck_assert_int_eq(mr_dictionary_count_word(dico, "sit"), 0);
+                    ck_assert_int_eq(mr_dictionary_count_word(dico, "amet"), 0);
+                    ck_assert_int_eq(mr_dictionary_count_word(dico, "dolor"), 4);
+                } else {
+                    ck_assert_int_eq(mr_dictionary_count_word(dico,
+                                                     "dolor consectetur"), 2);
+                    ck_assert_int_eq(mr_dictionary_count_word(dico,
+                                                            "enim elit"), 1);
+                }
+
+                mr_parallel_delete(mr);
+            }
+        }
+    }
+
+    mr_stopwords_delete(&sw);
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_records_mapreduce)
+{
+    int i, t, s;
+    ws_type ws_types[NB_WS_TYPES] = {WS_SCHUNKS, WS_IBLOCKS, WS_DYNAMIC};
+    /* Create test file */
+    char *filename = "ws_test.csv";
+    char *content = "id,method,path,comment\n"
+                    "1,GET,/index.html,\"first\nline, GET\"\n"
+                    "2,POST,/form,\"with \"\"quotes\"\" and\n\n newlines\"\n"
+                    "3,GET,\"/a,b\",plain\r\n"
+                    "4,,/,\"a comment which spans several blocks,\nwith a "
+                    "newline, a comma and more text\"\n"
+                    "5,PUT,/index.html\n"
+                    "6,GET,/index.html,\"\"";
+
+    create_file(filename, content);
+
+    /* Second and third columns */
+    for (t=0; t<NB_WS_TYPES; t++) {
+        for (i=1; i<=MAX_THREADS; i++) {
+            Mapreduce *mr = mr_parallel_create(filename, i, ws_types[t],
+                                        FR_MMAP, 4096, DC_BUCKETS, true, false);
+            ck_assert(mr != NULL);
+            mr->records = mr_records_create(',', 0x6);
+            mr->boundaries = _mr_boundaries_build_rows(filename, 5, i);
+            mr->steal = true;
+
+            Mapreduce_parallel_thread *ext =
+                                         (Mapreduce_parallel_thread *) mr->ext;
+            Dictionary *dico = ext->dictionary;
+
+            for (s=0; s<i; s++) {
+                Wordstreamer *ws = ext[s].wordstreamer;
+
+                if (ws_types[t] == WS_SCHUNKS) {
+                    ((Wordstreamer_schunks *) ws->ext)->block_size = 8;
+                } else if (ws_types[t] == WS_IBLOCKS) {
+                    ((Wordstreamer_iblocks *) ws->ext)->block_size = 7;
+                } else {
+                    ((Wordstreamer_dynamic *) ws->ext)->chunk_size = 5;
+                }
+            }
+
+            /* Perform map and reduce */
+            mr_parallel_map(mr);
+            mr_parallel_reduce(mr);
+
+            /* Check values */
+            ck_assert_int_eq(total_count(dico), 13);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "GET"), 3);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "/index.html"), 3);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "/a,b"), 1);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "method"), 1);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "plain"), 0);
+            ck_assert_int_eq(mr->stats.words, 13);
+            ck_assert_int_eq(mr->stats.lines, 6);
+
+            mr_records_delete(&mr->records);
+            mr_boundaries_delete(&mr->boundaries);
+            mr_parallel_delete(mr);
+        }
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_stats_mapreduce)
+{
+    int i, t, s, n;
+    ws_type ws_types[NB_WS_TYPES] = {WS_SCHUNKS, WS_IBLOCKS, WS_DYNAMIC};
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "Lorem ipsum\ndolor, sit amet.\n\nconsectetur adipiscing "
+                    "elit\nDonec\n";
+
+    create_file(filename, content);
+
+    /* Counters must not depend on ranges nor on lookahead words */
+    for (n=1; n<=3; n+=2) {
+        for (t=0; t<NB_WS_TYPES; t++) {
+            for (i=1; i<=MAX_THREADS; i++) {
+                Mapreduce *mr = mr_parallel_create(filename, i, ws_types[t],
+                                        FR_MMAP, 4096, DC_BUCKETS, true, false);
+                ck_assert(mr != NULL);
+                mr->ngram = n;
+                mr->steal = true;
+
+                Mapreduce_parallel_thread *ext =
+                                         (Mapreduce_parallel_thread *) mr->ext;
+
+                for (s=0; s<i; s++) {
+                    Wordstreamer *ws = ext[s].wordstreamer;
+
+                    if (ws_types[t] == WS_SCHUNKS) {
+                        ((Wordstreamer_schunks *) ws->ext)->block_size = 8;
+                    } else if (ws_types[t] == WS_IBLOCKS) {
+                        ((Wordstreamer_iblocks *) ws->ext)->block_size = 7;
+                    } else {
+                        ((Wordstreamer_dynamic *) ws->ext)->chunk_size = 5;
+                    }
+                }
+
+                /* Perform map and reduce */
+                mr_parallel_map(mr);
+                mr_parallel_reduce(mr);
+
+                /* Check values */
+                ck_assert_int_eq(mr->stats.words, 9);
+                ck_assert_int_eq(mr->stats.bytes, strlen(content));
+                ck_assert_int_eq(mr->stats.lines, 5);
+                ck_assert_int_eq(mr->stats.lengths[3], 1);
+                ck_assert_int_eq(mr->stats.lengths[4], 2);
+                ck_assert_int_eq(mr->stats.lengths[5], 4);
+                ck_assert_int_eq(mr->stats.lengths[10], 1);
+                ck_assert_int_eq(mr->stats.lengths[11], 1);
+
+                mr_parallel_delete(mr);
+            }
+        }
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_filter_mapreduce)
+{
+    int i, t, s, n;
+    ws_type ws_types[NB_WS_TYPES] = {WS_SCHUNKS, WS_IBLOCKS, WS_DYNAMIC};
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "Lorem 2015 ipsum 0xff deadbeef42 dolor, 7 sit amet 31 "
+                    "consectetur.";
+    char *drops[] = {"\\d+", "\\x\\x\\x\\x\\x\\x\\x\\x+"};
+
+    create_file(filename, content);
+
+    /* Numbers, hexadecimal identifiers and short tokens are dropped */
+    Filter *filter = mr_filter_create(drops, 2, NULL, 0, 4, 20, false);
+    ck_assert(filter != NULL);
+
+    for (n=1; n<=2; n++) {
+        for (t=0; t<NB_WS_TYPES; t++) {
+            for (i=1; i<=MAX_THREADS; i++) {
+                /* Each type of dictionary in turn */
+                dc_type dictionary_type = i % DC_NB;
+                Mapreduce *mr = mr_parallel_create(filename, i, ws_types[t],
+                                   FR_MMAP, 4096, dictionary_type, true, false);
+                ck_assert(mr != NULL);
+                mr->ngram = n;
+                mr->filter = filter;
+
+                Mapreduce_parallel_thread *ext =
+                                         (Mapreduce_parallel_thread *) mr->ext;
+                Dictionary *dico = ext->dictionary;
+
+                for (s=0; s<i; s++) {
+                    Wordstreamer *ws = ext[s].wordstreamer;
+
+                    if (ws_types[t] == WS_SCHUNKS) {
+                        ((Wordstreamer_schunks *) ws->ext)->block_size = 8;
+                    } else if (ws_types[t] == WS_IBLOCKS) {
+                        ((Wordstreamer_iblocks *) ws->ext)->block_size = 7;
+                    } else {
+                        ((Wordstreamer_dynamic *) ws->ext)->chunk_size = 5;
+                    }
+                }
+
+                /* Perform map and reduce */
+                mr_parallel_map(mr);
+                mr_parallel_reduce(mr);
+
+                /* 6 words are kept, all tokens are counted in stats */
+                ck_assert_int_eq(total_count(dico), 7 - n);
+                ck_assert_int_eq(mr->stats.words, 11);
+
+                if (n == 1) {
+                    ck_assert_int_eq(mr_dictionary_count_word(dico, "0xff"), 1);
+                    ck_assert_int_eq(mr_dictionary_count_word(dico, "2015"), 0);
+                    ck_assert_int_eq(mr_dictionary_count_word(dico, "sit"), 0);
+                } else {
+                    ck_assert_int_eq(mr_dictionary_count_word(dico,
+                                                          "0xff dolor"), 1);
+                }
+
+                mr->filter = NULL;
+                mr_parallel_delete(mr);
+            }
+        }
+    }
+
+    mr_filter_delete(&filter);
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_tree_merge)
+{
+    int i, j, d;
+    char word[8];
+
+    for (d=0; d<DC_NB; d++) {
+        for (i=1; i<=MAX_THREADS; i++) {
+            Dictionary *dictionaries[i];
+
+            /* Dictionary j holds words "w0" to "w<j>", partitioned or not */
+            for (j=0; j<i; j++) {
+                int k;
+                dictionaries[j] = mr_dictionary_partition(
+                                  mr_dictionary_create(d, false), i%4 + 1);
+
+                for (k=0; k<=j; k++) {
+                    sprintf(word, "w%d", k);
+                    mr_dictionary_put_word(dictionaries[j], word);
+                }
+            }
+
+            mr_parallel_merge(dictionaries, i);
+
+            ck_assert_int_eq(total_count(dictionaries[0]), i*(i+1)/2);
+            for (j=0; j<i; j++) {
+                sprintf(word, "w%d", j);
+                ck_assert_int_eq(mr_dictionary_count_word(dictionaries[0],
+                                                                  word), i - j);
+            }
+
+            for (j=0; j<i; j++) mr_dictionary_delete(&dictionaries[j]);
+        }
+    }
+}
+END_TEST
+
+
 Suite *mapreduce_suite(void) {
     Suite *suite = suite_create("Mapreduce parallel");
     TCase *tcase1 = tcase_create("Case Create Delete");
     TCase *tcase2 = tcase_create("Case Multiple MapReduce");
+    TCase *tcase3 = tcase_create("Case Steal MapReduce");
+    TCase *tcase4 = tcase_create("Case Boundaries MapReduce");
+    TCase *tcase5 = tcase_create("Case Ngram MapReduce");
+    TCase *tcase6 = tcase_create("Case Stopwords MapReduce");
+    TCase *tcase7 = tcase_create("Case Records MapReduce");
+    TCase *tcase8 = tcase_create("Case Stats MapReduce");
+    TCase *tcase9 = tcase_create("Case Filter MapReduce");
+    TCase *tcase10 = tcase_create("Case Tree Merge");
 
     tcase_add_test(tcase1, test_create_delete);
     tcase_add_test(tcase2, test_multiple_mapreduce);
+    tcase_add_test(tcase3, test_steal_mapreduce);
+    tcase_add_test(tcase4, test_boundaries_mapreduce);
+    tcase_add_test(tcase5, test_ngram_mapreduce);
+    tcase_add_test(tcase6, test_stopwords_mapreduce);
+    tcase_add_test(tcase7, test_records_mapreduce);
+    tcase_add_test(tcase8, test_stats_mapreduce);
+    tcase_add_test(tcase9, test_filter_mapreduce);
+    tcase_add_test(tcase10, test_tree_merge);
 
     suite_add_tcase(suite, tcase1);
     suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+    suite_add_tcase(suite, tcase4);
+    suite_add_tcase(suite, tcase5);
+    suite_add_tcase(suite, tcase6);
+    suite_add_tcase(suite, tcase7);
+    suite_add_tcase(suite, tcase8);
+    suite_add_tcase(suite, tcase9);
+    suite_add_tcase(suite, tcase10);
 
     return suite;
 }
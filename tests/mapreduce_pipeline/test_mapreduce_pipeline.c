@@ -0,0 +1,261 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include <check.h>
+#include "mapreduce_pipeline.h"
+
+#define MAX_THREADS 11
+#define NB_WS_TYPES 3
+
+void create_file(const char *filename, const char *content) {
+    FILE *fp;
+    fp = fopen (filename,"w");
+    if (fp!=NULL) {
+        fprintf(fp, "%s", content);
+        fclose (fp);
+    }
+}
+
+
+START_TEST (test_create_delete)
+{
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "content tests";
+    create_file(filename, content);
+
+    Mapreduce *mr = mr_pipeline_create(filename, 1, WS_SCHUNKS, FR_MMAP, 4096,
+                                                       DC_BUCKETS, true, false);
+
+    ck_assert(mr != NULL);
+
+    mr_pipeline_delete(mr);
+
+    /* Delete testfile */
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_multiple_mapreduce)
+{
+    int i, t;
+    ws_type ws_types[NB_WS_TYPES] = {WS_SCHUNKS, WS_IBLOCKS, WS_DYNAMIC};
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
+                    "Donec a diam lectus. Sed sit amet ipsum mauris. Maecenas "
+                    "congue ligula ac quam viverra nec consectetur ante "
+                    "hendrerit. Donec et mollis dolor. Praesent et diam eget "
+                    "libero egestas mattis sit amet vitae augue. Nam tincidunt "
+                    "congue enim, ut porta lorem lacinia consectetur. Donec ut "
+                    "libero sed arcu vehicula ultricies a non tortor. Lorem "
+                    "ipsum dolor sit amet, consectetur adipiscing elit. Aenean "
+                    "ut gravida lorem. Ut turpis felis, pulvinar a semper sed, "
+                    "adipiscing id dolor. Pellentesque auctor nisi id magna "
+                    "consequat sagittis. Curabitur dapibus enim sit amet elit "
+                    "pharetra tincidunt feugiat nisl imperdiet. Ut convallis "
+                    "libero in urna ultrices accumsan. Donec sed odio eros. "
+                    "Donec viverra mi quis quam pulvinar at malesuada arcu "
+                    "rhoncus. Cum sociis natoque penatibus et magnis dis "
+                    "parturient montes, nascetur ridiculus mus. In rutrum "
+                    "accumsan ultricies. Mauris vitae nisi at sem facilisis "
+                    "semper ac in est.";
+
+    create_file(filename, content);
+
+    /* Check several streamers combination, with each type of dictionary */
+    for (t=0; t<NB_WS_TYPES; t++) {
+        for (i=1; i<=MAX_THREADS; i++) {
+            dc_type dictionary_type = i % DC_NB;
+            Mapreduce *mr = mr_pipeline_create(filename, i, ws_types[t],
+                                   FR_MMAP, 4096, dictionary_type, true, false);
+
+            ck_assert(mr != NULL);
+
+            ck_assert(mr->ext != NULL);
+            Mapreduce_pipeline_ext *ext = (Mapreduce_pipeline_ext *) mr->ext;
+
+            ck_assert(ext->nb_producers >= 1 && ext->nb_consumers >= 1);
+            Dictionary *dico = ext->consumers[0].dictionary;
+
+            /* Perform map and reduce */
+            mr_pipeline_map(mr);
+            mr_pipeline_reduce(mr);
+
+            /* Check some occurences */
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "adipiscing"), 3);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "consectetur"), 4);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "amet"), 5);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "pharetra"), 1);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "sit"), 5);
+            ck_assert_int_eq(mr_dictionary_count_word(dico, "viverra"), 2);
+
+            mr_pipeline_delete(mr);
+        }
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_small_batches_mapreduce)
+{
+    int i, p;
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
+                    "Donec a diam lectus. Sed sit amet ipsum mauris. Maecenas "
+                    "congue ligula ac quam viverra nec consectetur ante "
+                    "hendrerit. Donec et mollis dolor. Praesent et diam eget "
+                    "libero egestas mattis sit amet vitae augue. Nam tincidunt "
+                    "congue enim, ut porta lorem lacinia consectetur. Donec ut "
+                    "libero sed arcu vehicula ultricies a non tortor. Lorem "
+                    "ipsum dolor sit amet, consectetur adipiscing elit. Aenean "
+                    "ut gravida lorem. Ut turpis felis, pulvinar a semper sed, "
+                    "adipiscing id dolor. Pellentesque auctor nisi id magna "
+                    "consequat sagittis. Curabitur dapibus enim sit amet elit "
+                    "pharetra tincidunt feugiat nisl imperdiet. Ut convallis "
+                    "libero in urna ultrices accumsan. Donec sed odio eros. "
+                    "Donec viverra mi quis quam pulvinar at malesuada arcu "
+                    "rhoncus. Cum sociis natoque penatibus et magnis dis "
+                    "parturient montes, nascetur ridiculus mus. In rutrum "
+                    "accumsan ultricies. Mauris vitae nisi at sem facilisis "
+                    "semper ac in est.";
+
+    create_file(filename, content);
+
+    for (i=1; i<=MAX_THREADS; i++) {
+        Mapreduce *mr = mr_pipeline_create(filename, i, WS_SCHUNKS, FR_MMAP,
+                                                 4096, DC_BUCKETS, true, false);
+        ck_assert(mr != NULL);
+
+        Mapreduce_pipeline_ext *ext = (Mapreduce_pipeline_ext *) mr->ext;
+        Dictionary *dico = ext->consumers[0].dictionary;
+
+        /* Use tiny batches to fill rings and recycle batches */
+        for (p=0; p<ext->nb_producers; p++) {
+            ext->producers[p].batch_size =
+                             MR_PIPELINE_WORD_SIZE(MAPREDUCE_MAX_WORD_SIZE) + 32;
+        }
+
+        /* Perform map and reduce */
+        mr_pipeline_map(mr);
+        mr_pipeline_reduce(mr);
+
+        /* Check some occurences */
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "adipiscing"), 3);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "consectetur"), 4);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "amet"), 5);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "pharetra"), 1);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "sit"), 5);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "viverra"), 2);
+
+        for (p=0; p<ext->nb_producers; p++) {
+            ck_assert(ext->producers[p].nb_batches > 1);
+        }
+
+        mr_pipeline_delete(mr);
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_long_word_mapreduce)
+{
+    int i, p;
+    /* Create test file with tokens longer than the maximum size */
+    char *filename = "ws_test.txt";
+    char *content = malloc(210000);
+    char key[MAPREDUCE_MAX_WORD_SIZE];
+    ck_assert(content != NULL);
+
+    strcpy(content, "short ");
+    memset(content + 6, 'x', 200000);
+    strcpy(content + 200006, " x ");
+    memset(content + 200009, 'y', 3000);
+    strcpy(content + 203009, " short\n");
+    create_file(filename, content);
+    free(content);
+
+    memset(key, 'x', MAPREDUCE_MAX_WORD_SIZE - 1);
+    key[MAPREDUCE_MAX_WORD_SIZE - 1] = '\0';
+
+    for (i=1; i<=MAX_THREADS; i++) {
+        Mapreduce *mr = mr_pipeline_create(filename, i, WS_SCHUNKS, FR_MMAP,
+                                                 4096, DC_BUCKETS, true, false);
+        ck_assert(mr != NULL);
+
+        Mapreduce_pipeline_ext *ext = (Mapreduce_pipeline_ext *) mr->ext;
+        Dictionary *dico = ext->consumers[0].dictionary;
+
+        /* Batches only have room for a word of the maximum size */
+        for (p=0; p<ext->nb_producers; p++) {
+            ext->producers[p].batch_size =
+                             MR_PIPELINE_WORD_SIZE(MAPREDUCE_MAX_WORD_SIZE) + 32;
+        }
+
+        mr_pipeline_map(mr);
+        mr_pipeline_reduce(mr);
+
+        /* Long tokens are truncated */
+        ck_assert_int_eq(dico->nb_words, 4);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "short"), 2);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "x"), 1);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, key), 1);
+        memset(key, 'y', MAPREDUCE_MAX_WORD_SIZE - 1);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, key), 1);
+        memset(key, 'x', MAPREDUCE_MAX_WORD_SIZE - 1);
+
+        mr_pipeline_delete(mr);
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+Suite *mapreduce_suite(void) {
+    Suite *suite = suite_create("Mapreduce pipeline");
+    TCase *tcase1 = tcase_create("Case Create Delete");
+    TCase *tcase2 = tcase_create("Case Multiple MapReduce");
+    TCase *tcase3 = tcase_create("Case Small Batches MapReduce");
+    TCase *tcase4 = tcase_create("Case Long Words MapReduce");
+
+    tcase_add_test(tcase1, test_create_delete);
+    tcase_add_test(tcase2, test_multiple_mapreduce);
+    tcase_add_test(tcase3, test_small_batches_mapreduce);
+    tcase_add_test(tcase4, test_long_word_mapreduce);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+    suite_add_tcase(suite, tcase4);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = mapreduce_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -33,7 +33,7 @@ START_TEST (test_create_delete)
     create_file(filename, content);
 
     Mapreduce *mr = mr_sequential_create(filename, WS_SCHUNKS, FR_MMAP, 4096,
-                                                                   true, false);
+                                                       DC_BUCKETS, true, false);
 
     ck_assert(mr != NULL);
 
@@ -71,7 +71,7 @@ START_TEST (test_mapreduce)
     create_file(filename, content);
 
     Mapreduce *mr = mr_sequential_create(filename, WS_SCHUNKS, FR_MMAP, 4096,
-                                                                   true, false);
+                                                       DC_BUCKETS, true, false);
     ck_assert(mr != NULL);
 
     ck_assert(mr->ext != NULL);
@@ -0,0 +1,234 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "output.h"
+#include <check.h>
+
+#define NB_TESTS 200000
+#define MAX_CHAR 15
+#define MAX_THREADS 7
+
+
+START_TEST (test_create_delete)
+{
+    Dictionary *dico = mr_dictionary_create(DC_BUCKETS, 0);
+    mr_dictionary_put_word(dico, "sam");
+    mr_dictionary_put_word(dico, "max");
+    mr_dictionary_put_word(dico, "sam");
+
+    Output *output = mr_output_create(dico, 4, false);
+    ck_assert(output != NULL);
+    ck_assert_int_eq(output->nb_records, 2);
+    ck_assert_int_eq(output->nb_threads, 4);
+    ck_assert(output->alphabetical);
+
+    /* Records of ordered dictionaries are not sorted again */
+    mr_output_sort(output, SO_ALPHA);
+    ck_assert(output->buffer == NULL);
+    ck_assert_str_eq(output->records[0].key, "max");
+    ck_assert_int_eq(output->records[1].count, 2);
+
+    mr_output_delete(&output);
+    ck_assert(output == NULL);
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+START_TEST (test_sort)
+{
+    int i;
+    const char *words[] = {"sam", "max", "sa", "samm", "lechuck", "max",
+                           "sam", "sa", "guybrush", "sam", "s"};
+    Dictionary *dico = mr_dictionary_create(DC_HASH, 0);
+
+    for (i=0; i<11; i++) mr_dictionary_put_word(dico, words[i]);
+
+    Output *output = mr_output_create(dico, 1, false);
+    ck_assert(!output->alphabetical);
+
+    /* Shorter keys come first */
+    mr_output_sort(output, SO_ALPHA);
+    ck_assert_str_eq(output->records[0].key, "guybrush");
+    ck_assert_str_eq(output->records[1].key, "lechuck");
+    ck_assert_str_eq(output->records[2].key, "max");
+    ck_assert_str_eq(output->records[3].key, "s");
+    ck_assert_str_eq(output->records[4].key, "sa");
+    ck_assert_str_eq(output->records[5].key, "sam");
+    ck_assert_str_eq(output->records[6].key, "samm");
+
+    /* Ties are broken alphabetically */
+    mr_output_sort(output, SO_COUNT);
+    ck_assert_str_eq(output->records[0].key, "sam");
+    ck_assert_int_eq(output->records[0].count, 3);
+    ck_assert_str_eq(output->records[1].key, "max");
+    ck_assert_str_eq(output->records[2].key, "sa");
+    ck_assert_str_eq(output->records[3].key, "guybrush");
+    ck_assert_str_eq(output->records[6].key, "samm");
+    ck_assert_int_eq(output->records[6].count, 1);
+
+    mr_output_delete(&output);
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+START_TEST (test_parallel_sort)
+{
+    int i, j, t;
+    char buffer[MAX_CHAR+4];
+    srand(1);
+
+    /* Many keys share a prefix, counts are mostly small */
+    Dictionary *dico = mr_dictionary_create(DC_HASH, 0);
+
+    for (i=0; i<NB_TESTS; i++) {
+        int nb_char = rand()%MAX_CHAR + 1;
+        int prefix = (rand()%2) ? 3 : 0;
+
+        memcpy(buffer, "pre", prefix);
+        for (j=prefix; j<prefix+nb_char; j++) {
+            unsigned char character = rand()%70+50;
+            buffer[j] = (char)character;
+        }
+        buffer[j] = '\0';
+
+        dico->add(dico, buffer, j, mr_word_hash(buffer, j),
+                           (rand()%100) ? rand()%20 + 1 : rand()%100000 + 1);
+    }
+
+    Word **words = mr_dictionary_words(dico);
+
+    for (t=1; t<=MAX_THREADS; t+=3) {
+        Output *output = mr_output_create(dico, t, false);
+        Output_record *records = output->records;
+        ck_assert_int_eq(output->nb_records, dico->nb_words);
+
+        /* Same order as words of the dictionary */
+        mr_output_sort(output, SO_ALPHA);
+        for (i=0; i<output->nb_records; i++) {
+            ck_assert(records[i].key == words[i]->name);
+        }
+
+        /* Totals read from a store may not fit on 32 bits */
+        for (i=0; i<output->nb_records; i+=1000) {
+            records[i].count += (uint64_t)(i%3) << 32;
+        }
+
+        /* Counts in decreasing order, then keys in alphabetical order */
+        mr_output_sort(output, SO_COUNT);
+        ck_assert(records[0].count > UINT32_MAX);
+        for (i=1; i<output->nb_records; i++) {
+            ck_assert(records[i-1].count >= records[i].count);
+            if (records[i-1].count == records[i].count) {
+                ck_assert(strcmp(records[i-1].key, records[i].key) < 0);
+            }
+        }
+
+        mr_output_delete(&output);
+    }
+
+    free(words);
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+START_TEST (test_top)
+{
+    int i, j, t;
+    char buffer[MAX_CHAR+1];
+    srand(2);
+
+    /* Few keys have large counts, many share the same small ones */
+    Dictionary *dico = mr_dictionary_create(DC_HASH, 0);
+
+    for (i=0; i<NB_TESTS; i++) {
+        int nb_char = rand()%MAX_CHAR + 1;
+
+        for (j=0; j<nb_char; j++) {
+            unsigned char character = rand()%70+50;
+            buffer[j] = (char)character;
+        }
+        buffer[j] = '\0';
+
+        dico->add(dico, buffer, j, mr_word_hash(buffer, j),
+                           (rand()%100) ? rand()%20 + 1 : rand()%100000 + 1);
+    }
+
+    /* Reference: all records sorted by count */
+    Output *ref = mr_output_create(dico, 1, false);
+    mr_output_sort(ref, SO_COUNT);
+
+    for (t=1; t<=MAX_THREADS; t+=3) {
+        unsigned int tops[] = {1, 10, 1000, 5000};
+
+        for (i=0; i<4; i++) {
+            Output *output = mr_output_create(dico, t, false);
+
+            mr_output_top(output, tops[i]);
+            ck_assert_int_eq(output->nb_records, tops[i]);
+
+            /* Same records as the first ones of the reference */
+            mr_output_sort(output, SO_COUNT);
+            for (j=0; j<tops[i]; j++) {
+                ck_assert(output->records[j].key == ref->records[j].key);
+            }
+
+            mr_output_delete(&output);
+        }
+    }
+
+    /* Nothing to select */
+    Output *output = mr_output_create(dico, 1, false);
+    mr_output_top(output, dico->nb_words + 1);
+    ck_assert_int_eq(output->nb_records, dico->nb_words);
+    mr_output_delete(&output);
+
+    mr_output_delete(&ref);
+    mr_dictionary_delete(&dico);
+}
+END_TEST
+
+
+Suite *output_suite(void) {
+    Suite *suite = suite_create("Output");
+    TCase *tcase1 = tcase_create("Case Create Delete");
+    TCase *tcase2 = tcase_create("Case Sort");
+    TCase *tcase3 = tcase_create("Case Parallel Sort");
+    TCase *tcase4 = tcase_create("Case Top");
+
+    tcase_add_test(tcase1, test_create_delete);
+    tcase_add_test(tcase2, test_sort);
+    tcase_add_test(tcase3, test_parallel_sort);
+    tcase_add_test(tcase4, test_top);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+    suite_add_tcase(suite, tcase4);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = output_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,148 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "records.h"
+#include <check.h>
+
+#define MAX_READ_SIZE 17
+
+void create_file(const char *filename, const char *content) {
+    FILE *fp;
+    fp = fopen (filename,"w");
+    if (fp!=NULL) {
+        fprintf(fp, "%s", content);
+        fclose (fp);
+    }
+}
+
+
+START_TEST (test_create_delete)
+{
+    Records *r = mr_records_create(',', 0x15);
+    ck_assert(r != NULL);
+
+    ck_assert_int_eq(r->delimiter, ',');
+    ck_assert_int_eq(r->last_column, 4);
+
+    mr_records_delete(&r);
+    ck_assert(r == NULL);
+}
+END_TEST
+
+
+START_TEST (test_masks)
+{
+    char block[64];
+
+    memset(block, 'a', 64);
+    block[0] = '"';
+    block[5] = '"';
+    block[33] = '"';
+    block[63] = ',';
+
+    ck_assert(mr_records_mask(block, '"') == ((1ULL<<0) | (1ULL<<5) | (1ULL<<33)));
+    ck_assert(mr_records_mask(block, ',') == (1ULL<<63));
+    ck_assert(mr_records_mask(block, '\n') == 0);
+
+    /* Quoted bytes go from opening quotes (included) to closing quotes */
+    ck_assert(mr_records_prefix_xor((1ULL<<0) | (1ULL<<5)) == 0x1f);
+    ck_assert(mr_records_prefix_xor(1ULL<<33) == ~((1ULL<<33) - 1));
+}
+END_TEST
+
+
+START_TEST (test_get)
+{
+    int s, t;
+    /* Create test file */
+    char *filename = "rc_test.csv";
+    char *content = "id,method,path,comment\n"
+                    "1,GET,/index.html,\"first\nline\"\n"
+                    "2,POST,/form,\"with \"\"quotes\"\" and\n\n newlines\"\n"
+                    "3,GET,\"/a,b\",plain\r\n"
+                    "4,,/,\"a very long comment which spans several blocks "
+                    "of sixty four bytes,\nwith a newline, a comma and more "
+                    "text until the end of the quoted field\"\n"
+                    "5,PUT\n"
+                    "6,GET,/y,\"\"";
+    char *expected[] = {"method", "comment", "GET", "first\nline", "POST",
+                        "with \"quotes\" and\n\n newlines", "GET", "plain",
+                        "a very long comment which spans several blocks of "
+                        "sixty four bytes,\nwith a newline, a comma and more "
+                        "text until the end of the quoted field", "PUT",
+                        "GET"};
+    int nb_expected = sizeof(expected) / sizeof(char*);
+    create_file(filename, content);
+
+    /* Second and fourth columns */
+    Records *r = mr_records_create(',', 0xa);
+
+    /* Any size of read buffer gives the same values */
+    for (t=0; t<2; t++) {
+        for (s=1; s<=(t ? MAX_READ_SIZE : 1); s++) {
+            int i = 0;
+            char buffer[MAPREDUCE_MAX_WORD_SIZE];
+            unsigned int length;
+            Records_parser parser;
+            Filereader *fr = mr_filereader_create_first(filename,
+                                                 t ? FR_READ : FR_MMAP, s);
+
+            mr_filereader_set_offsets(fr, 0, fr->file_size - 1);
+            mr_records_reset(&parser);
+
+            while (!mr_records_get(r, &parser, fr, buffer, &length)) {
+                ck_assert(i < nb_expected);
+                ck_assert_int_eq(length, strlen(expected[i]));
+                ck_assert_str_eq(buffer, expected[i]);
+                i++;
+            }
+
+            ck_assert_int_eq(i, nb_expected);
+            mr_filereader_delete(&fr);
+        }
+    }
+
+    mr_records_delete(&r);
+    remove(filename);
+}
+END_TEST
+
+
+Suite *records_suite(void) {
+    Suite *suite = suite_create("Records");
+    TCase *tcase1 = tcase_create("Case Create Delete");
+    TCase *tcase2 = tcase_create("Case Masks");
+    TCase *tcase3 = tcase_create("Case Get");
+
+    tcase_add_test(tcase1, test_create_delete);
+    tcase_add_test(tcase2, test_masks);
+    tcase_add_test(tcase3, test_get);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = records_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,139 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include "ringbuffer.h"
+#include <check.h>
+
+#define NB_SLOTS 6
+#define NB_TESTS 100000
+
+START_TEST (test_create)
+{
+    Ringbuffer *rb = mr_ringbuffer_create(NB_SLOTS);
+
+    ck_assert(rb != NULL);
+    ck_assert_int_eq(rb->mask, 7);
+    ck_assert_int_eq(mr_ringbuffer_count(rb), 0);
+
+    mr_ringbuffer_delete(&rb);
+}
+END_TEST
+
+
+START_TEST (test_delete)
+{
+    Ringbuffer *rb = mr_ringbuffer_create(NB_SLOTS);
+    ck_assert(rb != NULL);
+
+    mr_ringbuffer_delete(&rb);
+    ck_assert(rb == NULL);
+}
+END_TEST
+
+
+START_TEST (test_push_pop)
+{
+    long i;
+    void *ptr;
+    Ringbuffer *rb = mr_ringbuffer_create(NB_SLOTS);
+
+    /* Empty ring buffer */
+    ck_assert_int_eq(mr_ringbuffer_pop(rb, &ptr), 1);
+
+    /* Fill the ring buffer */
+    for (i=0; i<8; i++) {
+        ck_assert_int_eq(mr_ringbuffer_push(rb, (void*)(i+1)), 0);
+    }
+
+    ck_assert_int_eq(mr_ringbuffer_push(rb, (void*)42), 1);
+    ck_assert_int_eq(mr_ringbuffer_count(rb), 8);
+
+    /* Pointers are popped in the same order */
+    for (i=0; i<8; i++) {
+        ck_assert_int_eq(mr_ringbuffer_pop(rb, &ptr), 0);
+        ck_assert_int_eq((long)ptr, i+1);
+    }
+
+    ck_assert_int_eq(mr_ringbuffer_pop(rb, &ptr), 1);
+    ck_assert_int_eq(mr_ringbuffer_count(rb), 0);
+
+    mr_ringbuffer_delete(&rb);
+}
+END_TEST
+
+
+void* _producer(void *arg) {
+    long i;
+    Ringbuffer *rb = arg;
+
+    for (i=1; i<=NB_TESTS; i++) {
+        while (mr_ringbuffer_push(rb, (void*)i)) sched_yield();
+    }
+
+    return NULL;
+}
+
+
+START_TEST (test_concurrent)
+{
+    long i;
+    void *ptr;
+    pthread_t thread;
+    Ringbuffer *rb = mr_ringbuffer_create(NB_SLOTS);
+
+    pthread_create(&thread, NULL, _producer, rb);
+
+    for (i=1; i<=NB_TESTS; i++) {
+        while (mr_ringbuffer_pop(rb, &ptr)) sched_yield();
+        ck_assert_int_eq((long)ptr, i);
+    }
+
+    pthread_join(thread, NULL);
+    mr_ringbuffer_delete(&rb);
+}
+END_TEST
+
+
+Suite *ringbuffer_suite(void) {
+    Suite *suite = suite_create("Ringbuffer");
+    TCase *tcase1 = tcase_create("Case Create");
+    TCase *tcase2 = tcase_create("Case Delete");
+    TCase *tcase3 = tcase_create("Case Push Pop");
+    TCase *tcase4 = tcase_create("Case Concurrent");
+
+    tcase_add_test(tcase1, test_create);
+    tcase_add_test(tcase2, test_delete);
+    tcase_add_test(tcase3, test_push_pop);
+    tcase_add_test(tcase4, test_concurrent);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+    suite_add_tcase(suite, tcase4);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = ringbuffer_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,218 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "segment.h"
+#include <check.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define NB_TESTS 20000
+#define MAX_CHAR 12
+
+
+/* Build a dictionary and save it in a segment file */
+void create_segment(const char *filename, Dictionary *dico, const bool index) {
+    Output *output = mr_output_create(dico, 1, false);
+    ck_assert_int_eq(mr_segment_save(output, filename, index), 0);
+    mr_output_delete(&output);
+}
+
+
+START_TEST (test_open_close)
+{
+    char *filename = "seg_test.mrds";
+    Dictionary *dico = mr_dictionary_create(DC_HASH, 0);
+    mr_dictionary_put_word(dico, "sam");
+    mr_dictionary_put_word(dico, "max");
+    mr_dictionary_put_word(dico, "sam");
+    create_segment(filename, dico, true);
+
+    Segment *seg = mr_segment_open(filename);
+    ck_assert(seg != NULL);
+    ck_assert_int_eq(seg->nb_keys, 2);
+    ck_assert_int_eq(seg->header->total, 3);
+    ck_assert(seg->index != NULL);
+
+    /* Keys are sorted and ended by '\0' */
+    ck_assert_str_eq(mr_segment_key(seg, 0), "max");
+    ck_assert_str_eq(mr_segment_key(seg, 1), "sam");
+    ck_assert_int_eq(mr_segment_length(seg, 1), 3);
+    ck_assert_int_eq(seg->counts[0], 1);
+    ck_assert_int_eq(seg->counts[1], 2);
+
+    mr_segment_close(&seg);
+    ck_assert(seg == NULL);
+
+    /* Empty dictionary */
+    Dictionary *empty = mr_dictionary_create(DC_BUCKETS, 0);
+    create_segment(filename, empty, true);
+    seg = mr_segment_open(filename);
+    ck_assert(seg != NULL);
+    ck_assert_int_eq(seg->nb_keys, 0);
+    ck_assert_int_eq(mr_segment_count(seg, "sam"), 0);
+    mr_segment_close(&seg);
+
+    mr_dictionary_delete(&empty);
+    mr_dictionary_delete(&dico);
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_invalid)
+{
+    char *filename = "seg_test.mrds";
+    FILE *fp;
+    struct stat st;
+
+    ck_assert(mr_segment_open("seg_missing.mrds") == NULL);
+
+    /* Not a segment */
+    fp = fopen(filename, "w");
+    fprintf(fp, "sam=2\nmax=1\n");
+    fclose(fp);
+    ck_assert(mr_segment_open(filename) == NULL);
+
+    /* Truncated segment */
+    Dictionary *dico = mr_dictionary_create(DC_BUCKETS, 0);
+    mr_dictionary_put_word(dico, "guybrush");
+    mr_dictionary_put_word(dico, "lechuck");
+    create_segment(filename, dico, true);
+    stat(filename, &st);
+    ck_assert_int_eq(truncate(filename, st.st_size - 4), 0);
+    ck_assert(mr_segment_open(filename) == NULL);
+
+    mr_dictionary_delete(&dico);
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_count)
+{
+    int i, j, k;
+    char buffer[MAX_CHAR+2];
+    char *filename = "seg_test.mrds";
+    srand(1);
+
+    Dictionary *dico = mr_dictionary_create(DC_SWISS, 0);
+
+    for (i=0; i<NB_TESTS; i++) {
+        int length = rand()%MAX_CHAR + 1;
+        for (j=0; j<length; j++) buffer[j] = 'a' + rand()%4;
+        buffer[length] = '\0';
+        mr_dictionary_put_word(dico, buffer);
+    }
+
+    /* Same counts with the hash index and with binary searches */
+    for (k=0; k<2; k++) {
+        create_segment(filename, dico, k == 0);
+        Segment *seg = mr_segment_open(filename);
+        ck_assert(seg != NULL);
+        ck_assert((seg->index != NULL) == (k == 0));
+        ck_assert_int_eq(seg->nb_keys, dico->nb_words);
+        ck_assert_int_eq(seg->header->total, NB_TESTS);
+
+        srand(2);
+        for (i=0; i<NB_TESTS; i++) {
+            int length = rand()%(MAX_CHAR+1) + 1;
+            for (j=0; j<length; j++) buffer[j] = 'a' + rand()%5;
+            buffer[length] = '\0';
+            ck_assert_int_eq(mr_segment_count(seg, buffer),
+                             mr_dictionary_count_word(dico, buffer));
+        }
+
+        mr_segment_close(&seg);
+    }
+
+    mr_dictionary_delete(&dico);
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_merge)
+{
+    char *filename = "seg_test.mrds";
+    dc_type types[] = {DC_BUCKETS, DC_HASH, DC_SWISS, DC_COMPACT};
+    int i;
+
+    Dictionary *dico = mr_dictionary_create(DC_BUCKETS, 0);
+    mr_dictionary_put_word(dico, "sam");
+    mr_dictionary_put_word(dico, "max");
+    mr_dictionary_put_word(dico, "sam");
+    mr_dictionary_put_word(dico, "sam max");
+    create_segment(filename, dico, true);
+    mr_dictionary_delete(&dico);
+
+    Segment *seg = mr_segment_open(filename);
+    ck_assert(seg != NULL);
+
+    /* Counts are added to the ones of a dictionary of any type */
+    for (i=0; i<4; i++) {
+        dico = mr_dictionary_create(types[i], 0);
+        mr_dictionary_put_word(dico, "max");
+        mr_dictionary_put_word(dico, "guybrush");
+
+        mr_segment_merge(dico, seg);
+        ck_assert_int_eq(dico->nb_words, 4);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "sam"), 2);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "max"), 2);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "guybrush"), 1);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "sam max"), 1);
+
+        /* Merged twice */
+        mr_segment_merge(dico, seg);
+        ck_assert_int_eq(dico->nb_words, 4);
+        ck_assert_int_eq(mr_dictionary_count_word(dico, "sam"), 4);
+
+        mr_dictionary_delete(&dico);
+    }
+
+    mr_segment_close(&seg);
+    remove(filename);
+}
+END_TEST
+
+
+Suite *segment_suite(void) {
+    Suite *suite = suite_create("Segment");
+    TCase *tcase1 = tcase_create("Case Open Close");
+    TCase *tcase2 = tcase_create("Case Invalid");
+    TCase *tcase3 = tcase_create("Case Count");
+    TCase *tcase4 = tcase_create("Case Merge");
+
+    tcase_add_test(tcase1, test_open_close);
+    tcase_add_test(tcase2, test_invalid);
+    tcase_add_test(tcase3, test_count);
+    tcase_add_test(tcase4, test_merge);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+    suite_add_tcase(suite, tcase4);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = segment_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,167 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "stopwords.h"
+#include <check.h>
+
+#define NB_GENERATED_WORDS 20000
+
+void create_file(const char *filename, const char *content) {
+    FILE *fp;
+    fp = fopen (filename,"w");
+    if (fp!=NULL) {
+        fprintf(fp, "%s", content);
+        fclose (fp);
+    }
+}
+
+
+bool contains(Stopwords *sw, const char *word) {
+    unsigned int length = strlen(word);
+    return mr_stopwords_contains(sw, word, length, mr_word_hash(word, length));
+}
+
+
+START_TEST (test_create_delete)
+{
+    Stopwords *sw = _mr_stopwords_create_from_text("The, the of! And");
+    ck_assert(sw != NULL);
+
+    /* Duplicates are removed and words start with a lower case */
+    ck_assert_int_eq(sw->nb_words, 3);
+    ck_assert(contains(sw, "the"));
+    ck_assert(contains(sw, "of"));
+    ck_assert(contains(sw, "and"));
+    ck_assert(!contains(sw, "The"));
+    ck_assert(!contains(sw, "th"));
+    ck_assert(!contains(sw, "then"));
+    ck_assert(!contains(sw, "lorem"));
+
+    mr_stopwords_delete(&sw);
+    ck_assert(sw == NULL);
+
+    /* Empty set */
+    sw = _mr_stopwords_create_from_text(" ,. ");
+    ck_assert_int_eq(sw->nb_words, 0);
+    ck_assert(!contains(sw, "the"));
+    mr_stopwords_delete(&sw);
+}
+END_TEST
+
+
+START_TEST (test_builtin_file)
+{
+    /* Built-in list */
+    Stopwords *sw = mr_stopwords_create(NULL, false);
+    ck_assert(sw != NULL);
+    ck_assert(sw->nb_words > 100);
+    ck_assert(contains(sw, "the"));
+    ck_assert(contains(sw, "and"));
+    ck_assert(contains(sw, "t"));
+    ck_assert(!contains(sw, "lorem"));
+    mr_stopwords_delete(&sw);
+
+    /* List in a file */
+    char *filename = "sw_test.txt";
+    create_file(filename, "sit\namet\nDolor\n");
+
+    sw = mr_stopwords_create(filename, false);
+    ck_assert_int_eq(sw->nb_words, 3);
+    ck_assert(contains(sw, "sit"));
+    ck_assert(contains(sw, "amet"));
+    ck_assert(contains(sw, "dolor"));
+    ck_assert(!contains(sw, "the"));
+    mr_stopwords_delete(&sw);
+
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_perfect_hash)
+{
+    int i;
+    char word[16];
+    char *text = malloc(NB_GENERATED_WORDS * 16);
+    ck_assert(text != NULL);
+    text[0] = '\0';
+
+    /* Generate words from numbers written with letters */
+    char *ptr = text;
+    for (i=0; i<NB_GENERATED_WORDS; i++) {
+        int v = i * 2;
+        char *w = word;
+        do { *w++ = 'a' + v % 26; v /= 26; } while (v);
+        *w = '\0';
+        ptr += sprintf(ptr, "%s ", word);
+    }
+
+    Stopwords *sw = _mr_stopwords_create_from_text(text);
+    ck_assert_int_eq(sw->nb_words, NB_GENERATED_WORDS);
+
+    /* Slots are a permutation of the words */
+    bool *seen = calloc(NB_GENERATED_WORDS, sizeof(bool));
+    for (i=0; i<NB_GENERATED_WORDS; i++) {
+        uint64_t hash = sw->hashes[i];
+        uint32_t bucket = _mr_stopwords_range(hash, sw->nb_buckets);
+        uint32_t slot = _mr_stopwords_slot(sw, hash,
+                                                   sw->displacements[bucket]);
+        ck_assert_int_eq(slot, i);
+        ck_assert(!seen[slot]);
+        seen[slot] = true;
+    }
+
+    /* Odd numbers are not in the set */
+    for (i=0; i<NB_GENERATED_WORDS; i++) {
+        int v = i * 2 + 1;
+        char *w = word;
+        do { *w++ = 'a' + v % 26; v /= 26; } while (v);
+        *w = '\0';
+        ck_assert(!contains(sw, word));
+    }
+
+    mr_stopwords_delete(&sw);
+    free(seen);
+    free(text);
+}
+END_TEST
+
+
+Suite *stopwords_suite(void) {
+    Suite *suite = suite_create("Stopwords");
+    TCase *tcase1 = tcase_create("Case Create Delete");
+    TCase *tcase2 = tcase_create("Case Built-in and File");
+    TCase *tcase3 = tcase_create("Case Perfect Hash");
+
+    tcase_add_test(tcase1, test_create_delete);
+    tcase_add_test(tcase2, test_builtin_file);
+    tcase_add_test(tcase3, test_perfect_hash);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = stopwords_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
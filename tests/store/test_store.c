@@ -0,0 +1,274 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "store.h"
+#include <check.h>
+#include <dirent.h>
+
+#define STORE_PATH "store_test"
+#define NB_DELTAS 21
+
+
+/* Delete the directory of a store */
+void delete_store(const char *path) {
+    struct dirent *entry;
+    char file[512];
+    DIR *dir = opendir(path);
+
+    if (dir == NULL) return;
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+        remove(file);
+    }
+
+    closedir(dir);
+    remove(path);
+}
+
+
+/* Add a delta with n occurrences of a word and 1 of another */
+void add_delta(Store *store, const char *word, int n, const char *other) {
+    int i;
+    Dictionary *dico = mr_dictionary_create(DC_HASH, 0);
+
+    for (i=0; i<n; i++) mr_dictionary_put_word(dico, word);
+    mr_dictionary_put_word(dico, other);
+
+    Output *output = mr_output_create(dico, 1, false);
+    ck_assert_int_eq(mr_store_add(store, output), 0);
+    mr_output_delete(&output);
+    mr_dictionary_delete(&dico);
+}
+
+
+START_TEST (test_open_close)
+{
+    delete_store(STORE_PATH);
+
+    /* Missing directory */
+    ck_assert(mr_store_open(STORE_PATH, false, false) == NULL);
+
+    Store *store = mr_store_open(STORE_PATH, true, false);
+    ck_assert(store != NULL);
+    ck_assert_int_eq(store->nb_segments, 0);
+    ck_assert_int_eq(store->next, 0);
+    ck_assert_int_eq(mr_store_count(store, "sam"), 0);
+
+    add_delta(store, "sam", 2, "max");
+    ck_assert_int_eq(store->nb_segments, 1);
+    ck_assert_int_eq(store->next, 1);
+    mr_store_close(&store);
+    ck_assert(store == NULL);
+
+    /* Segments are found again */
+    store = mr_store_open(STORE_PATH, false, false);
+    ck_assert(store != NULL);
+    ck_assert_int_eq(store->nb_segments, 1);
+    ck_assert_int_eq(store->next, 1);
+    ck_assert_int_eq(mr_store_count(store, "sam"), 2);
+    ck_assert_int_eq(mr_store_count(store, "max"), 1);
+    mr_store_close(&store);
+
+    delete_store(STORE_PATH);
+}
+END_TEST
+
+
+START_TEST (test_compact)
+{
+    int i;
+    char word[16];
+    delete_store(STORE_PATH);
+
+    Store *store = mr_store_open(STORE_PATH, true, false);
+
+    for (i=0; i<NB_DELTAS; i++) {
+        snprintf(word, sizeof(word), "word%d", i);
+        add_delta(store, "sam", i, word);
+
+        /* Counts are the same whatever the compactions */
+        ck_assert_int_eq(mr_store_count(store, "sam"), i*(i+1)/2);
+        ck_assert_int_eq(mr_store_count(store, word), 1);
+        ck_assert_int_eq(mr_store_count(store, "word0"), 1);
+    }
+
+    /* 21 deltas: 1 segment of level 2, 1 of level 1 and 1 delta */
+    ck_assert_int_eq(store->nb_segments, 3);
+    for (i=0; i<store->nb_segments; i++) {
+        Store_segment *s = &store->segments[i];
+        ck_assert_int_eq(s->last - s->first + 1,
+                         (s->level == 2) ? 16 : (s->level == 1) ? 4 : 1);
+    }
+
+    ck_assert_int_eq(mr_store_compact(store, true), 0);
+    ck_assert_int_eq(store->nb_segments, 1);
+    ck_assert_int_eq(store->segments[0].level, 3);
+    ck_assert_int_eq(store->segments[0].first, 0);
+    ck_assert_int_eq(store->segments[0].last, NB_DELTAS - 1);
+    ck_assert_int_eq(store->segments[0].segment->nb_keys, NB_DELTAS + 1);
+    ck_assert_int_eq(mr_store_count(store, "sam"),
+                     (NB_DELTAS-1)*NB_DELTAS/2);
+    mr_store_close(&store);
+
+    delete_store(STORE_PATH);
+}
+END_TEST
+
+
+START_TEST (test_interrupted)
+{
+    FILE *fp;
+    delete_store(STORE_PATH);
+
+    Store *store = mr_store_open(STORE_PATH, true, false);
+    add_delta(store, "sam", 2, "max");
+    add_delta(store, "sam", 3, "max");
+    ck_assert_int_eq(mr_store_compact(store, true), 0);
+    ck_assert_int_eq(store->nb_segments, 1);
+    mr_store_close(&store);
+
+    /* A delta left by a compaction is already in the merged segment */
+    store = mr_store_open(STORE_PATH, true, false);
+    add_delta(store, "lechuck", 1, "guybrush");
+    mr_store_close(&store);
+    rename(STORE_PATH "/L0-2-2.mrds", STORE_PATH "/L0-1-1.mrds");
+
+    store = mr_store_open(STORE_PATH, false, false);
+    ck_assert_int_eq(store->nb_segments, 1);
+    ck_assert_int_eq(mr_store_count(store, "sam"), 5);
+    ck_assert_int_eq(mr_store_count(store, "lechuck"), 0);
+    mr_store_close(&store);
+
+    /* Files which are not segments are skipped, invalid segments are not */
+    fp = fopen(STORE_PATH "/L0-2-2.mrds.tmp", "w");
+    fprintf(fp, "sam=2\n");
+    fclose(fp);
+
+    store = mr_store_open(STORE_PATH, true, false);
+    ck_assert_int_eq(store->nb_segments, 1);
+    ck_assert_int_eq(store->next, 2);
+    mr_store_close(&store);
+
+    rename(STORE_PATH "/L0-2-2.mrds.tmp", STORE_PATH "/L0-2-2.mrds");
+    ck_assert(mr_store_open(STORE_PATH, false, false) == NULL);
+
+    delete_store(STORE_PATH);
+}
+END_TEST
+
+
+START_TEST (test_merge)
+{
+    delete_store(STORE_PATH);
+
+    Store *store = mr_store_open(STORE_PATH, true, false);
+    add_delta(store, "sam", 2, "max");
+    add_delta(store, "sam", 1, "guybrush");
+
+    Dictionary *dico = mr_dictionary_create(DC_BUCKETS, 0);
+    mr_dictionary_put_word(dico, "max");
+
+    ck_assert_int_eq(mr_store_merge(dico, store), 0);
+    ck_assert_int_eq(dico->nb_words, 3);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "sam"), 3);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "max"), 2);
+    ck_assert_int_eq(mr_dictionary_count_word(dico, "guybrush"), 1);
+
+    mr_dictionary_delete(&dico);
+    mr_store_close(&store);
+
+    delete_store(STORE_PATH);
+}
+END_TEST
+
+
+START_TEST (test_large_counts)
+{
+    Output_record record = {"sam", 3, 3000000000U};
+    delete_store(STORE_PATH);
+
+    /* Totals of the history go beyond 32 bits */
+    Store *store = mr_store_open(STORE_PATH, true, false);
+    mr_store_close(&store);
+    ck_assert_int_eq(mr_segment_save_records(&record, 1,
+                                     STORE_PATH "/L0-0-0.mrds", true), 0);
+    ck_assert_int_eq(mr_segment_save_records(&record, 1,
+                                     STORE_PATH "/L0-1-1.mrds", true), 0);
+
+    store = mr_store_open(STORE_PATH, false, false);
+    ck_assert_int_eq(mr_store_compact(store, true), 0);
+    ck_assert_int_eq(store->nb_segments, 1);
+    ck_assert(mr_store_count(store, "sam") == 6000000000ULL);
+
+    /* They do not fit in a dictionary */
+    Dictionary *dico = mr_dictionary_create(DC_HASH, 0);
+    ck_assert_int_eq(mr_store_merge(dico, store), 1);
+    ck_assert_int_eq(dico->nb_words, 0);
+    mr_dictionary_delete(&dico);
+    mr_store_close(&store);
+
+    /* A compaction which would wrap a total fails and keeps its inputs */
+    record.count = UINT64_MAX - 1;
+    ck_assert_int_eq(mr_segment_save_records(&record, 1,
+                                     STORE_PATH "/L0-2-2.mrds", true), 0);
+
+    store = mr_store_open(STORE_PATH, false, false);
+    ck_assert_int_eq(mr_store_compact(store, true), 1);
+    ck_assert_int_eq(store->nb_segments, 2);
+    mr_store_close(&store);
+
+    store = mr_store_open(STORE_PATH, false, false);
+    ck_assert_int_eq(store->nb_segments, 2);
+    mr_store_close(&store);
+
+    delete_store(STORE_PATH);
+}
+END_TEST
+
+
+Suite *store_suite(void) {
+    Suite *suite = suite_create("Store");
+    TCase *tcase1 = tcase_create("Case Open Close");
+    TCase *tcase2 = tcase_create("Case Compact");
+    TCase *tcase3 = tcase_create("Case Interrupted Compaction");
+    TCase *tcase4 = tcase_create("Case Merge");
+    TCase *tcase5 = tcase_create("Case Large Counts");
+
+    tcase_add_test(tcase1, test_open_close);
+    tcase_add_test(tcase2, test_compact);
+    tcase_add_test(tcase3, test_interrupted);
+    tcase_add_test(tcase4, test_merge);
+    tcase_add_test(tcase5, test_large_counts);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+    suite_add_tcase(suite, tcase4);
+    suite_add_tcase(suite, tcase5);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = store_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
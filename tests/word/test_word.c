@@ -67,6 +67,7 @@ START_TEST (test_massiv_create)
         ck_assert(word != NULL);
         ck_assert_int_eq(word->length, nb_char);
         ck_assert_str_eq(word->name, buffer);
+        ck_assert(word->hash == mr_word_hash(buffer, nb_char));
 
         mr_word_delete(&word);
     }
@@ -74,19 +75,73 @@ START_TEST (test_massiv_create)
 END_TEST
 
 
+START_TEST (test_hash)
+{
+    int i;
+    char *str = "guybrush";
+    uint64_t hash = MR_WORD_HASH_SEED;
+
+    /* Incremental hash gives the same value */
+    for (i=0; i<strlen(str); i++) {
+        hash = mr_word_hash_step(hash, str[i]);
+    }
+
+    ck_assert(mr_word_hash_final(hash) == mr_word_hash(str, strlen(str)));
+
+    /* Words with same characters have different hashes */
+    ck_assert(mr_word_hash("ab", 2) != mr_word_hash("ba", 2));
+    ck_assert(mr_word_hash("a", 1) != mr_word_hash("aa", 2));
+}
+END_TEST
+
+
+START_TEST (test_equal)
+{
+    int i, length;
+    char *str = "threeheadedmonkeyisbehindyou";
+    char other[32];
+
+    /* Every length, with a difference at each position */
+    for (length=0; length<=strlen(str); length++) {
+        Word *word = malloc(sizeof(Word)+length+1);
+        memcpy(word->name, str, length);
+        word->name[length] = '\0';
+        word->length = length;
+
+        ck_assert(mr_word_equal(word, str, length));
+        if (length) ck_assert(!mr_word_equal(word, str, length-1));
+
+        for (i=0; i<length; i++) {
+            memcpy(other, str, length);
+            other[i] ^= 1;
+            ck_assert(!mr_word_equal(word, other, length));
+        }
+
+        free(word);
+    }
+}
+END_TEST
+
+
 Suite *word_suite(void) {
     Suite *suite = suite_create("Word");
     TCase *tcase1 = tcase_create("Case Create");
     TCase *tcase2 = tcase_create("Case Delete");
     TCase *tcase3 = tcase_create("Case Massiv Create");
+    TCase *tcase4 = tcase_create("Case Hash");
+    TCase *tcase5 = tcase_create("Case Equal");
 
     tcase_add_test(tcase1, test_create);
     tcase_add_test(tcase2, test_delete);
     tcase_add_test(tcase3, test_massiv_create);
+    tcase_add_test(tcase4, test_hash);
+    tcase_add_test(tcase5, test_equal);
 
     suite_add_tcase(suite, tcase1);
     suite_add_tcase(suite, tcase2);
     suite_add_tcase(suite, tcase3);
+    suite_add_tcase(suite, tcase4);
+    suite_add_tcase(suite, tcase5);
 
     return suite;
 }
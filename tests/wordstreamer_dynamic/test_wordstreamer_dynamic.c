@@ -0,0 +1,285 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+#include "wordstreamer_dynamic.h"
+#include <check.h>
+
+#define MAX_STREAMERS 11
+#define MAX_CHUNK_SIZE 17
+
+void create_file(const char *filename, const char *content) {
+    FILE *fp;
+    fp = fopen (filename,"w");
+    if (fp!=NULL) {
+        fprintf(fp, "%s", content);
+        fclose (fp);
+    }
+}
+
+
+START_TEST (test_create_delete)
+{
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "content tests";
+    create_file(filename, content);
+
+    Wordstreamer *ws = mr_wordstreamer_dynamic_create_first(filename, 1,
+                                                          FR_MMAP, 4096, false);
+    ck_assert(ws != NULL);
+
+    ck_assert_int_eq(ws->nb_streamers, 1);
+    ck_assert_int_eq(ws->streamer_id, 0);
+    ck_assert_int_eq(ws->profiling, 0);
+
+    Wordstreamer_dynamic *ext = ws->ext;
+    ck_assert(ext != NULL);
+    ck_assert_int_eq(ext->chunk_size, MAPREDUCE_WS_DYNAMIC_CHUNK_SIZE);
+    ck_assert_int_eq(*ext->cursor, 0);
+
+    mr_wordstreamer_dynamic_delete(ws);
+
+    /* Delete testfile */
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_singlestreamer_get)
+{
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = ".Donec!, ut  libero sed. ";
+    create_file(filename, content);
+
+    Wordstreamer *ws = mr_wordstreamer_dynamic_create_first(filename, 1,
+                                                          FR_MMAP, 4096, false);
+    ck_assert(ws != NULL);
+
+    char buffer[32];
+    int ret;
+
+    ret = mr_wordstreamer_dynamic_get(ws, buffer);
+    ck_assert_int_eq(ret, 0);
+    ck_assert_str_eq(buffer, "donec");
+
+    ret = mr_wordstreamer_dynamic_get(ws, buffer);
+    ck_assert_int_eq(ret, 0);
+    ck_assert_str_eq(buffer, "ut");
+
+    ret = mr_wordstreamer_dynamic_get(ws, buffer);
+    ck_assert_int_eq(ret, 0);
+    ck_assert_str_eq(buffer, "libero");
+
+    ret = mr_wordstreamer_dynamic_get(ws, buffer);
+    ck_assert_int_eq(ret, 0);
+    ck_assert_str_eq(buffer, "sed");
+
+    ret = mr_wordstreamer_dynamic_get(ws, buffer);
+    ck_assert_int_eq(ret, 1);
+
+    mr_wordstreamer_dynamic_delete(ws);
+
+    /* Delete testfile */
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_small_chunks_get)
+{
+    int size, r;
+    fr_type readers[2] = {FR_MMAP, FR_READ};
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
+                    "Donec a diam lectus. Sed sit amet ipsum mauris. Maecenas "
+                    "congue ligula ac quam viverra nec consectetur ante "
+                    "hendrerit. Donec et mollis dolor. Praesent et diam eget "
+                    "libero egestas mattis sit amet vitae augue. Nam tincidunt "
+                    "congue enim, ut porta lorem lacinia consectetur. Donec ut "
+                    "libero sed arcu vehicula ultricies a non tortor. Lorem "
+                    "ipsum dolor sit amet, consectetur adipiscing elit. Aenean "
+                    "ut gravida lorem. Ut turpis felis, pulvinar a semper sed, "
+                    "adipiscing id dolor. Pellentesque auctor nisi id magna "
+                    "consequat sagittis. Curabitur dapibus enim sit amet elit "
+                    "pharetra tincidunt feugiat nisl imperdiet. Ut convallis "
+                    "libero in urna ultrices accumsan. Donec sed odio eros. "
+                    "Donec viverra mi quis quam pulvinar at malesuada arcu "
+                    "rhoncus. Cum sociis natoque penatibus et magnis dis "
+                    "parturient montes, nascetur ridiculus mus. In rutrum "
+                    "accumsan ultricies. Mauris vitae nisi at sem facilisis "
+                    "semper ac in est.";
+
+    create_file(filename, content);
+
+    /* Sequential streamer as a reference */
+    Wordstreamer *ws = mr_wordstreamer_dynamic_create_first(filename, 1,
+                                                          FR_MMAP, 4096, false);
+    ck_assert(ws != NULL);
+
+    char ref[4096];
+    char word[128];
+
+    if (!mr_wordstreamer_dynamic_get(ws, word)) strcpy(ref, word);
+
+    while (!mr_wordstreamer_dynamic_get(ws, word)) {
+        strcat(ref, " ");
+        strcat(ref, word);
+    }
+
+    mr_wordstreamer_dynamic_delete(ws);
+
+    /* Check chunk edges with several chunk sizes, smaller than some words */
+    for (r=0; r<2; r++) {
+        for (size=1; size<=MAX_CHUNK_SIZE; size++) {
+            char comp[4096];
+            ws = _mr_wordstreamer_dynamic_create(filename, readers[r], NULL,
+                                           16, 0, 1, NULL, size, false);
+            ck_assert(ws != NULL);
+
+            if (!mr_wordstreamer_dynamic_get(ws, word)) strcpy(comp, word);
+
+            while (!mr_wordstreamer_dynamic_get(ws, word)) {
+                strcat(comp, " ");
+                strcat(comp, word);
+            }
+
+            mr_wordstreamer_dynamic_delete(ws);
+
+            ck_assert_str_eq(comp, ref);
+        }
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+START_TEST (test_multiplestreamer_get)
+{
+    int i;
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
+                    "Donec a diam lectus. Sed sit amet ipsum mauris. Maecenas "
+                    "congue ligula ac quam viverra nec consectetur ante "
+                    "hendrerit. Donec et mollis dolor. Praesent et diam eget "
+                    "libero egestas mattis sit amet vitae augue. Nam tincidunt "
+                    "congue enim, ut porta lorem lacinia consectetur. Donec ut "
+                    "libero sed arcu vehicula ultricies a non tortor. Lorem "
+                    "ipsum dolor sit amet, consectetur adipiscing elit. Aenean "
+                    "ut gravida lorem. Ut turpis felis, pulvinar a semper sed, "
+                    "adipiscing id dolor. Pellentesque auctor nisi id magna "
+                    "consequat sagittis. Curabitur dapibus enim sit amet elit "
+                    "pharetra tincidunt feugiat nisl imperdiet. Ut convallis "
+                    "libero in urna ultrices accumsan. Donec sed odio eros. "
+                    "Donec viverra mi quis quam pulvinar at malesuada arcu "
+                    "rhoncus. Cum sociis natoque penatibus et magnis dis "
+                    "parturient montes, nascetur ridiculus mus. In rutrum "
+                    "accumsan ultricies. Mauris vitae nisi at sem facilisis "
+                    "semper ac in est.";
+
+    create_file(filename, content);
+
+    /* Sequential streamer as a reference */
+    Wordstreamer *ws = mr_wordstreamer_dynamic_create_first(filename, 1,
+                                                          FR_MMAP, 4096, false);
+    ck_assert(ws != NULL);
+
+    char word[128];
+    int ref_words = 0, ref_chars = 0;
+
+    while (!mr_wordstreamer_dynamic_get(ws, word)) {
+        ref_words++;
+        ref_chars += strlen(word);
+    }
+
+    mr_wordstreamer_dynamic_delete(ws);
+
+    /* Streamers claim chunks in turn, check that no word is lost */
+    for (i=2; i<=MAX_STREAMERS; i++) {
+        int s, active = i, words = 0, chars = 0;
+        Wordstreamer *streamers[MAX_STREAMERS];
+        bool ended[MAX_STREAMERS];
+
+        streamers[0] = _mr_wordstreamer_dynamic_create(filename, FR_MMAP, NULL,
+                                            4096, 0, i, NULL, 2*i+1, false);
+        ck_assert(streamers[0] != NULL);
+        ended[0] = false;
+
+        for(s=1; s<i; s++) {
+            streamers[s] =
+                   mr_wordstreamer_dynamic_create_another(streamers[0], s);
+            ck_assert(streamers[s] != NULL);
+            ended[s] = false;
+        }
+
+        while (active) {
+            for(s=0; s<i; s++) {
+                if (ended[s]) continue;
+
+                if (!mr_wordstreamer_dynamic_get(streamers[s], word)) {
+                    words++;
+                    chars += strlen(word);
+                } else {
+                    ended[s] = true;
+                    active--;
+                }
+            }
+        }
+
+        for(s=i-1; s>=0; s--) {
+            mr_wordstreamer_dynamic_delete(streamers[s]);
+        }
+
+        ck_assert_int_eq(words, ref_words);
+        ck_assert_int_eq(chars, ref_chars);
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
+Suite *wordstreamer_dynamic_suite(void) {
+    Suite *suite = suite_create("Wordstreamer Dynamic Chunks");
+    TCase *tcase1 = tcase_create("Case Create Delete");
+    TCase *tcase2 = tcase_create("Case Single streamer Get");
+    TCase *tcase3 = tcase_create("Case Small chunks Get");
+    TCase *tcase4 = tcase_create("Case mutiple streamers Get");
+
+    tcase_add_test(tcase1, test_create_delete);
+    tcase_add_test(tcase2, test_singlestreamer_get);
+    tcase_add_test(tcase3, test_small_chunks_get);
+    tcase_add_test(tcase4, test_multiplestreamer_get);
+
+    suite_add_tcase(suite, tcase1);
+    suite_add_tcase(suite, tcase2);
+    suite_add_tcase(suite, tcase3);
+    suite_add_tcase(suite, tcase4);
+
+    return suite;
+}
+
+
+int main(void) {
+    int number_failed;
+    Suite *suite = wordstreamer_dynamic_suite();
+    SRunner *runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    number_failed = srunner_ntests_failed(runner);
+    srunner_free(runner);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -11,10 +11,11 @@
 * KIND, either express or implied.                                             *
 *******************************************************************************/
 
-#include "wordstreamer_iwords.h"
+#include "wordstreamer_iblocks.h"
 #include <check.h>
 
 #define MAX_STREAMERS 11
+#define MAX_BLOCK_SIZE 17
 
 void create_file(const char *filename, const char *content) {
     FILE *fp;
@@ -33,7 +34,7 @@ START_TEST (test_create_delete)
     char *content = "content tests";
     create_file(filename, content);
 
-    Wordstreamer *ws = mr_wordstreamer_iwords_create_first(filename, 1, FR_MMAP,
+    Wordstreamer *ws = mr_wordstreamer_iblocks_create_first(filename, 1, FR_MMAP,
                                                                    4096, false);
     ck_assert(ws != NULL);
 
@@ -41,7 +42,7 @@ START_TEST (test_create_delete)
     ck_assert_int_eq(ws->streamer_id, 0);
     ck_assert_int_eq(ws->profiling, 0);
 
-    mr_wordstreamer_iwords_delete(ws);
+    mr_wordstreamer_iblocks_delete(ws);
 
     /* Delete testfile */
     remove(filename);
@@ -56,33 +57,33 @@ START_TEST (test_singlestreamer_get)
     char *content = ".Donec!, ut  libero sed. ";
     create_file(filename, content);
 
-    Wordstreamer *ws = mr_wordstreamer_iwords_create_first(filename, 1, FR_MMAP,
+    Wordstreamer *ws = mr_wordstreamer_iblocks_create_first(filename, 1, FR_MMAP,
                                                                    4096, false);
     ck_assert(ws != NULL);
 
     char buffer[32];
     int ret;
 
-    ret = mr_wordstreamer_iwords_get(ws, buffer);
+    ret = mr_wordstreamer_iblocks_get(ws, buffer);
     ck_assert_int_eq(ret, 0);
     ck_assert_str_eq(buffer, "donec");
 
-    ret = mr_wordstreamer_iwords_get(ws, buffer);
+    ret = mr_wordstreamer_iblocks_get(ws, buffer);
     ck_assert_int_eq(ret, 0);
     ck_assert_str_eq(buffer, "ut");
 
-    ret = mr_wordstreamer_iwords_get(ws, buffer);
+    ret = mr_wordstreamer_iblocks_get(ws, buffer);
     ck_assert_int_eq(ret, 0);
     ck_assert_str_eq(buffer, "libero");
 
-    ret = mr_wordstreamer_iwords_get(ws, buffer);
+    ret = mr_wordstreamer_iblocks_get(ws, buffer);
     ck_assert_int_eq(ret, 0);
     ck_assert_str_eq(buffer, "sed");
 
-    ret = mr_wordstreamer_iwords_get(ws, buffer);
+    ret = mr_wordstreamer_iblocks_get(ws, buffer);
     ck_assert_int_eq(ret, 1);
 
-    mr_wordstreamer_iwords_delete(ws);
+    mr_wordstreamer_iblocks_delete(ws);
 
     /* Delete testfile */
     remove(filename);
@@ -92,7 +93,7 @@ END_TEST
 
 START_TEST (test_multiplestreamer_get)
 {
-    int i;
+    int i, size;
     /* Create test file */
     char *filename = "ws_test.txt";
     char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
@@ -117,62 +118,80 @@ START_TEST (test_multiplestreamer_get)
     create_file(filename, content);
 
     /* Sequential streamer as a reference */
-    Wordstreamer *ws_ref = mr_wordstreamer_iwords_create_first(filename, 1,
+    Wordstreamer *ws_ref = mr_wordstreamer_iblocks_create_first(filename, 1,
                                                           FR_MMAP, 4096, false);
     ck_assert(ws_ref != NULL);
     char ref[4096];
     char word[128];
+    int ref_words = 0, ref_chars = 0;
 
-    if (!mr_wordstreamer_iwords_get(ws_ref, word)) strcpy(ref, word);
+    if (!mr_wordstreamer_iblocks_get(ws_ref, word)) {
+        strcpy(ref, word);
+        ref_words++;
+        ref_chars += strlen(word);
+    }
 
-    while (!mr_wordstreamer_iwords_get(ws_ref, word)) {
+    while (!mr_wordstreamer_iblocks_get(ws_ref, word)) {
         strcat(ref, " ");
         strcat(ref, word);
+        ref_words++;
+        ref_chars += strlen(word);
     }
 
-    mr_wordstreamer_iwords_delete(ws_ref);
-
+    mr_wordstreamer_iblocks_delete(ws_ref);
 
-    /* Check several streamers combination */
-    for (i=2; i<=MAX_STREAMERS; i++) {
+    /* A single streamer with small blocks gives the same stream */
+    for (size=1; size<=MAX_BLOCK_SIZE; size++) {
         char comp[4096];
-        int s, ret = 0, first = 1;
+        Wordstreamer *ws = _mr_wordstreamer_iblocks_create(filename, FR_MMAP,
+                                             NULL, 4096, 0, 1, size, false);
+        ck_assert(ws != NULL);
 
-        /* Create streamers */
-        Wordstreamer **ws = malloc(sizeof(Wordstreamer)*i);
-        ws[0] = mr_wordstreamer_iwords_create_first(filename, i, FR_MMAP,
-                                                                   4096, false);
-        ck_assert(ws[0] != NULL);
+        if (!mr_wordstreamer_iblocks_get(ws, word)) strcpy(comp, word);
 
-        for(s=1; s<i; s++) {
-            ws[s] = mr_wordstreamer_iwords_create_another(ws[0], s);
-            ck_assert(ws[s] != NULL);
+        while (!mr_wordstreamer_iblocks_get(ws, word)) {
+            strcat(comp, " ");
+            strcat(comp, word);
         }
 
-        /* Retrieve words */
-        while (! ret) {
+        mr_wordstreamer_iblocks_delete(ws);
+
+        ck_assert_str_eq(comp, ref);
+    }
+
+    /* Check several streamers combination */
+    for (i=2; i<=MAX_STREAMERS; i++) {
+        for (size=1; size<=MAX_BLOCK_SIZE; size++) {
+            int s, words = 0, chars = 0;
+
+            /* Create streamers */
+            Wordstreamer **ws = malloc(sizeof(Wordstreamer*)*i);
+            ws[0] = _mr_wordstreamer_iblocks_create(filename, FR_MMAP, NULL,
+                                                   4096, 0, i, size, false);
+            ck_assert(ws[0] != NULL);
+
+            for(s=1; s<i; s++) {
+                ws[s] = mr_wordstreamer_iblocks_create_another(ws[0], s);
+                ck_assert(ws[s] != NULL);
+            }
+
+            /* Retrieve words */
             for(s=0; s<i; s++) {
-                if (!mr_wordstreamer_iwords_get(ws[s], word)) {
-                    if (first) {
-                        strcpy(comp, word);
-                        first = 0;
-                    } else {
-                        strcat(comp, " ");
-                        strcat(comp, word);
-                    }
-                } else {
-                    ret = 1;
+                while (!mr_wordstreamer_iblocks_get(ws[s], word)) {
+                    words++;
+                    chars += strlen(word);
                 }
             }
-        }
 
-        for(s=0; s<i; s++) {
-            mr_wordstreamer_iwords_delete(ws[s]);
-        }
+            for(s=0; s<i; s++) {
+                mr_wordstreamer_iblocks_delete(ws[s]);
+            }
 
-        free(ws);
+            free(ws);
 
-        ck_assert_str_eq(comp, ref);
+            ck_assert_int_eq(words, ref_words);
+            ck_assert_int_eq(chars, ref_chars);
+        }
     }
 
     remove(filename);
@@ -180,8 +199,8 @@ START_TEST (test_multiplestreamer_get)
 END_TEST
 
 
-Suite *wordstreamer_iwords_suite(void) {
-    Suite *suite = suite_create("Wordstreamer Interleaved Words");
+Suite *wordstreamer_iblocks_suite(void) {
+    Suite *suite = suite_create("Wordstreamer Interleaved Blocks");
     TCase *tcase1 = tcase_create("Case Create Delete");
     TCase *tcase2 = tcase_create("Case Single streamer Get");
     TCase *tcase3 = tcase_create("Case mutiple streamers Get");
@@ -200,7 +219,7 @@ Suite *wordstreamer_iwords_suite(void) {
 
 int main(void) {
     int number_failed;
-    Suite *suite = wordstreamer_iwords_suite();
+    Suite *suite = wordstreamer_iblocks_suite();
     SRunner *runner = srunner_create(suite);
 
     srunner_run_all(runner, CK_NORMAL);
@@ -66,6 +66,8 @@ START_TEST (test_singlestreamer_get)
     ret = mr_wordstreamer_schunks_get(ws, buffer);
     ck_assert_int_eq(ret, 0);
     ck_assert_str_eq(buffer, "donec");
+    ck_assert_int_eq(ws->word_length, 5);
+    ck_assert(ws->word_hash == mr_word_hash("donec", 5));
 
     ret = mr_wordstreamer_schunks_get(ws, buffer);
     ck_assert_int_eq(ret, 0);
@@ -90,6 +92,39 @@ START_TEST (test_singlestreamer_get)
 END_TEST
 
 
+START_TEST (test_long_word)
+{
+    /* Create test file with a token longer than the maximum size */
+    char *filename = "ws_test.txt";
+    char content[MAPREDUCE_MAX_WORD_SIZE*2];
+    memset(content, 'a', sizeof(content) - 6);
+    strcpy(content + sizeof(content) - 6, " end.");
+    create_file(filename, content);
+
+    Wordstreamer *ws = mr_wordstreamer_schunks_create_first(filename, 1,
+                                                          FR_MMAP, 4096, false);
+    ck_assert(ws != NULL);
+
+    char buffer[MAPREDUCE_MAX_WORD_SIZE];
+
+    /* Truncated, the rest of the token is skipped */
+    ck_assert_int_eq(mr_wordstreamer_schunks_get(ws, buffer), 0);
+    ck_assert_int_eq(strlen(buffer), MAPREDUCE_MAX_WORD_SIZE - 1);
+    ck_assert_int_eq(ws->word_length, MAPREDUCE_MAX_WORD_SIZE - 1);
+    ck_assert(ws->word_hash == mr_word_hash(buffer, ws->word_length));
+
+    ck_assert_int_eq(mr_wordstreamer_schunks_get(ws, buffer), 0);
+    ck_assert_str_eq(buffer, "end");
+    ck_assert_int_eq(mr_wordstreamer_schunks_get(ws, buffer), 1);
+
+    mr_wordstreamer_schunks_delete(ws);
+
+    /* Delete testfile */
+    remove(filename);
+}
+END_TEST
+
+
 START_TEST (test_multiplestreamer_get)
 {
     int i;
@@ -171,19 +206,126 @@ START_TEST (test_multiplestreamer_get)
 END_TEST
 
 
+START_TEST (test_steal_get)
+{
+    int i;
+    /* Create test file */
+    char *filename = "ws_test.txt";
+    char *content = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. "
+                    "Donec a diam lectus. Sed sit amet ipsum mauris. Maecenas "
+                    "congue ligula ac quam viverra nec consectetur ante "
+                    "hendrerit. Donec et mollis dolor. Praesent et diam eget "
+                    "libero egestas mattis sit amet vitae augue. Nam tincidunt "
+                    "congue enim, ut porta lorem lacinia consectetur. Donec ut "
+                    "libero sed arcu vehicula ultricies a non tortor. Lorem "
+                    "ipsum dolor sit amet, consectetur adipiscing elit. Aenean "
+                    "ut gravida lorem. Ut turpis felis, pulvinar a semper sed, "
+                    "adipiscing id dolor. Pellentesque auctor nisi id magna "
+                    "consequat sagittis. Curabitur dapibus enim sit amet elit "
+                    "pharetra tincidunt feugiat nisl imperdiet. Ut convallis "
+                    "libero in urna ultrices accumsan. Donec sed odio eros. "
+                    "Donec viverra mi quis quam pulvinar at malesuada arcu "
+                    "rhoncus. Cum sociis natoque penatibus et magnis dis "
+                    "parturient montes, nascetur ridiculus mus. In rutrum "
+                    "accumsan ultricies. Mauris vitae nisi at sem facilisis "
+                    "semper ac in est.";
+
+    create_file(filename, content);
+
+    /* Sequential streamer as a reference */
+    Wordstreamer *ws = mr_wordstreamer_schunks_create_first(filename, 1,
+                                                          FR_MMAP, 4096, false);
+    ck_assert(ws != NULL);
+
+    char word[128];
+    int ref_words = 0, ref_chars = 0;
+
+    while (!mr_wordstreamer_schunks_get(ws, word)) {
+        ref_words++;
+        ref_chars += strlen(word);
+    }
+
+    /* Nothing to steal with a single streamer */
+    ck_assert_int_eq(mr_wordstreamer_schunks_steal(ws), 1);
+
+    mr_wordstreamer_schunks_delete(ws);
+
+    /* Last streamer steals from the others until everything is read */
+    for (i=2; i<=MAX_STREAMERS; i++) {
+        int s, words = 0, chars = 0;
+        Wordstreamer *streamers[MAX_STREAMERS];
+
+        streamers[0] = mr_wordstreamer_schunks_create_first(filename, i,
+                                                       FR_MMAP, 4096, false);
+        ck_assert(streamers[0] != NULL);
+
+        for(s=1; s<i; s++) {
+            streamers[s] =
+                   mr_wordstreamer_schunks_create_another(streamers[0], s);
+            ck_assert(streamers[s] != NULL);
+        }
+
+        /* Use small blocks to steal within the test file */
+        for(s=0; s<i; s++) {
+            Wordstreamer_schunks *ext = streamers[s]->ext;
+            ext->block_size = 8;
+        }
+
+        /* First streamer starts reading its range */
+        for(s=0; s<3 && !mr_wordstreamer_schunks_get(streamers[0], word); s++) {
+            words++;
+            chars += strlen(word);
+        }
+
+        Wordstreamer *thief = streamers[i-1];
+        do {
+            while (!mr_wordstreamer_schunks_get(thief, word)) {
+                words++;
+                chars += strlen(word);
+            }
+        } while (!mr_wordstreamer_steal(thief));
+
+        ck_assert(thief->nb_steals > 0);
+        ck_assert(thief->stolen_bytes > 0);
+
+        /* Other streamers complete what is left in their ranges */
+        for(s=0; s<i-1; s++) {
+            while (!mr_wordstreamer_schunks_get(streamers[s], word)) {
+                words++;
+                chars += strlen(word);
+            }
+        }
+
+        for(s=i-1; s>=0; s--) {
+            mr_wordstreamer_schunks_delete(streamers[s]);
+        }
+
+        ck_assert_int_eq(words, ref_words);
+        ck_assert_int_eq(chars, ref_chars);
+    }
+
+    remove(filename);
+}
+END_TEST
+
+
 Suite *wordstreamer_schunks_suite(void) {
     Suite *suite = suite_create("Wordstreamer Scattered Chunks");
     TCase *tcase1 = tcase_create("Case Create Delete");
     TCase *tcase2 = tcase_create("Case Single streamer Get");
     TCase *tcase3 = tcase_create("Case mutiple streamers Get");
+    TCase *tcase4 = tcase_create("Case Steal Get");
 
     tcase_add_test(tcase1, test_create_delete);
     tcase_add_test(tcase2, test_singlestreamer_get);
+    tcase_add_test(tcase2, test_long_word);
     tcase_add_test(tcase3, test_multiplestreamer_get);
+    tcase_add_test(tcase4, test_steal_get);
 
     suite_add_tcase(suite, tcase1);
     suite_add_tcase(suite, tcase2);
     suite_add_tcase(suite, tcase3);
+    suite_add_tcase(suite, tcase4);
 
     return suite;
 }